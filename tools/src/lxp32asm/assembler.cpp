@@ -7,6 +7,7 @@
  */
 
 #include "assembler.h"
+#include "coreprofile.h"
 #include "utils.h"
 
 #include <iostream>
@@ -21,6 +22,18 @@
 #include <cstdlib>
 
 void Assembler::processFile(const std::string &filename) {
+	_currentFileName=filename;
+	std::ifstream in(filename,std::ios_base::in);
+	if(!in) throw std::runtime_error("Cannot open file \""+filename+"\"");
+	processStream(in,filename);
+}
+
+/*
+ * Process source code from a stream, "filename" is used to name
+ * the object and to report errors
+ */
+
+void Assembler::processStream(std::istream &in,const std::string &filename) {
 	auto nativePath=Utils::normalizeSeparators(filename);
 	auto pos=nativePath.find_last_of('/');
 	if(pos!=std::string::npos) nativePath=filename.substr(pos+1);
@@ -29,13 +42,17 @@ void Assembler::processFile(const std::string &filename) {
 	_line=0;
 	_state=Initial;
 	_currentFileName=filename;
-	processFileRecursive(filename);
+	processStreamRecursive(in,filename);
 	
 	if(!_currentLabels.empty())
 		throw std::runtime_error("Symbol definition must be followed by an instruction or data definition statement");
 	
 	if(!_sectionEnabled.empty())
 		throw std::runtime_error("#endif expected");
+	
+	for(auto const &region: _perfRegions) {
+		if(!region.second) throw std::runtime_error("#perf_end expected for region \""+region.first+"\"");
+	}
 
 // Examine symbol table
 	for(auto const &sym: _obj.symbols()) {
@@ -54,7 +71,10 @@ void Assembler::processFile(const std::string &filename) {
 void Assembler::processFileRecursive(const std::string &filename) {
 	std::ifstream in(filename,std::ios_base::in);
 	if(!in) throw std::runtime_error("Cannot open file \""+filename+"\"");
-	
+	processStreamRecursive(in,filename);
+}
+
+void Assembler::processStreamRecursive(std::istream &in,const std::string &filename) {
 // Process input file line-by-line
 	auto savedLine=_line;
 	auto savedState=_state;
@@ -85,6 +105,16 @@ void Assembler::addIncludeSearchDir(const std::string &dir) {
 	_includeSearchDirs.push_back(std::move(ndir));
 }
 
+/*
+ * Enables rewriting of instructions for the target core (without
+ * a profile, instructions are encoded as written)
+ */
+
+void Assembler::setCoreProfile(const CoreProfile &profile) {
+	_profile=profile;
+	_rewrite=true;
+}
+
 int Assembler::line() const {
 	return _line;
 }
@@ -101,6 +131,10 @@ const LinkableObject &Assembler::object() const {
 	return _obj;
 }
 
+const Assembler::RewriteStats &Assembler::rewrites() const {
+	return _rewrites;
+}
+
 Assembler::TokenList Assembler::tokenize(const std::string &str) {
 	TokenList tokenList;
 	std::string word;
@@ -313,6 +347,37 @@ void Assembler::elaborateDirective(TokenList &list) {
 		auto msg=Utils::dequoteString(list[1]);
 		throw std::runtime_error(msg);
 	}
+	else if(list[0]=="#perf_begin") {
+		if(list.size()!=2) throw std::runtime_error("Wrong number of tokens in the directive");
+		if(!validateIdentifier(list[1])) throw std::runtime_error("Ill-formed identifier: \""+list[1]+"\"");
+		if(_perfRegions.find(list[1])!=_perfRegions.end())
+			throw std::runtime_error("Region \""+list[1]+"\" has been already defined");
+// Region markers are symbols whose names can't clash with identifiers
+		_obj.addSymbol("perf_begin."+list[1],_obj.addPadding());
+		_perfRegions.emplace(list[1],false);
+	}
+	else if(list[0]=="#perf_end") {
+		if(list.size()!=2&&list.size()!=3) throw std::runtime_error("Wrong number of tokens in the directive");
+		auto it=_perfRegions.find(list[1]);
+		if(it==_perfRegions.end()||it->second)
+			throw std::runtime_error("#perf_end without a matching #perf_begin");
+		auto name="perf_end."+list[1];
+		if(list.size()==3) {
+			auto budget=numericLiteral(list[2]);
+			if(budget<=0) throw std::runtime_error("Cycle budget must be positive");
+			name+="."+std::to_string(budget);
+		}
+		_obj.addSymbol(name,_obj.addPadding());
+		it->second=true;
+	}
+	else if(list[0]=="#variant") {
+		if(list.size()!=2) throw std::runtime_error("Wrong number of tokens in the directive");
+		if(!_obj.variant().empty()) throw std::runtime_error("Variant has been already specified");
+		auto variant=Utils::dequoteString(list[1]);
+		if(variant.empty()) throw std::runtime_error("Variant must not be empty");
+		CoreProfile::validateVariant(variant);
+		_obj.setVariant(variant);
+	}
 	else if(list[0]=="#ifdef") {
 		if(list.size()!=2) throw std::runtime_error("Wrong number of tokens in the directive");
 		if(_macros.find(list[1])!=_macros.end()) _sectionEnabled.push_back(true);
@@ -403,6 +468,12 @@ LinkableObject::Word Assembler::elaborateDataDefinition(TokenList &list) {
 LinkableObject::Word Assembler::elaborateInstruction(TokenList &list) {
 	assert(!list.empty());
 	auto rva=_obj.addPadding();
+	_obj.addSourceLine(rva,currentFileName(),line());
+	if(!_rewrite||!rewriteInstruction(list)) encodeInstruction(list);
+	return rva;
+}
+
+void Assembler::encodeInstruction(const TokenList &list) {
 	if(list[0]=="add") encodeAdd(list);
 	else if(list[0]=="and") encodeAnd(list);
 	else if(list[0]=="call") encodeCall(list);
@@ -434,7 +505,6 @@ LinkableObject::Word Assembler::elaborateInstruction(TokenList &list) {
 	else if(list[0]=="sw") encodeSw(list);
 	else if(list[0]=="xor") encodeXor(list);
 	else throw std::runtime_error("Unrecognized instruction: \""+list[0]+"\"");
-	return rva;
 }
 
 bool Assembler::isSectionEnabled() const {
@@ -564,6 +634,269 @@ std::vector<Assembler::Operand> Assembler::getOperands(const TokenList &list) {
 	return arglist;
 }
 
+/*
+ * Member functions to rewrite instructions for the core profile
+ */
+
+namespace {
+// Execution time of the hardware instructions
+	const unsigned DivCycles=36;
+	const unsigned ModCycles=37;
+// Mean execution time of rt_emu_udiv and rt_emu_sdiv (including the
+// return) in lxp32sim, for uniformly distributed dividends and divisor
+// widths
+	const unsigned EmuUdivCycles=373;
+	const unsigned EmuSdivCycles=412;
+}
+
+/*
+ * Returns false if the instruction should be encoded as written:
+ * either the original instruction is faster on the target core or
+ * there is no cheaper equivalent. Malformed instructions are left to
+ * the encoder to report.
+ */
+
+bool Assembler::rewriteInstruction(const TokenList &list) {
+	auto const &op=list[0];
+	bool division=(op=="divu"||op=="divs"||op=="modu"||op=="mods");
+	if(!division&&op!="mul") return false;
+	
+	auto args=getOperands(list);
+	if(args.size()!=3||args[0].type!=Operand::Register) return false;
+	for(std::size_t i=1;i<args.size();i++) {
+		if(args[i].type==Operand::Register) continue;
+		if(args[i].type!=Operand::NumericLiteral) return false;
+		if((args[i].i<-128||args[i].i>127)&&(args[i].i<0xFFFFFF80||args[i].i>0xFFFFFFFF)) return false;
+	}
+	
+// Immediate operands are sign extended by the CPU
+	auto value=[](const Operand &arg) {
+		return static_cast<std::int32_t>(static_cast<LinkableObject::Word>(arg.i));
+	};
+	
+	unsigned hwCycles;
+	if(!division) hwCycles=_profile.mulCycles();
+	else if(op[0]=='d') hwCycles=DivCycles;
+	else hwCycles=ModCycles;
+	
+	Sequence seq;
+	std::string kind=op+" by a constant";
+	
+	if(args[1].type==Operand::NumericLiteral&&args[2].type==Operand::NumericLiteral) {
+// Both operands are constant: load the result
+		auto a=value(args[1]);
+		auto b=value(args[2]);
+		auto ua=static_cast<LinkableObject::Word>(a);
+		auto ub=static_cast<LinkableObject::Word>(b);
+		LinkableObject::Word result=0;
+		bool valid=(b!=0);
+		if(op=="mul") {
+			result=ua*ub;
+			valid=true;
+		}
+		else if(!valid) {} // division by zero is left as is
+		else if(op=="divu") result=ua/ub;
+		else if(op=="modu") result=ua%ub;
+		else if(op=="divs") result=static_cast<LinkableObject::Word>(a/b);
+		else result=static_cast<LinkableObject::Word>(a%b);
+		if(valid) {
+			auto r=static_cast<std::int32_t>(result);
+			if(r>=-1048576&&r<=1048575) seq.push_back(makeInstruction("lcs",{args[0].str,std::to_string(r)}));
+			else seq.push_back(makeInstruction("lc",{args[0].str,std::to_string(result)}));
+		}
+	}
+	else if(args[2].type==Operand::NumericLiteral) {
+		if(division) seq=reduceDivision(op,args[0],args[1],value(args[2]));
+		else seq=reduceMul(args[0],args[1],value(args[2]));
+	}
+	else if(!division&&args[1].type==Operand::NumericLiteral) {
+		seq=reduceMul(args[0],args[2],value(args[1]));
+	}
+	
+	auto estimate=cycles(seq);
+	if(!seq.empty()&&estimate>=hwCycles) seq.clear();
+	
+	if(seq.empty()&&division&&!_profile.divider()) {
+		seq=emulateDivision(op,args);
+		estimate=cycles(seq)+(op[3]=='u'?EmuUdivCycles:EmuSdivCycles);
+		kind=op+" emulated with a call";
+	}
+	
+	if(seq.empty()) return false;
+	
+	for(auto const &instr: seq) encodeInstruction(instr);
+	
+	auto &r=_rewrites[kind];
+	r.count++;
+	r.cycles+=estimate;
+	r.hwCycles+=hwCycles;
+	return true;
+}
+
+/*
+ * Division by a power of two. Signed division rounds towards zero,
+ * so a bias is added to negative dividends; the destination register
+ * holds the bias, thus it must differ from the source one.
+ */
+
+Assembler::Sequence Assembler::reduceDivision(const std::string &op,
+	const Operand &dst,const Operand &src,std::int32_t divisor) const
+{
+	Sequence seq;
+	bool isSigned=(op[3]=='s');
+	bool quotient=(op[0]=='d');
+	
+	auto m=(isSigned&&divisor<0)?-divisor:divisor;
+	if(m<=0||(m&(m-1))!=0) return seq;
+	int k=0;
+	while((1<<k)<m) k++;
+	
+	auto const &rd=dst.str;
+	auto const &rs=src.str;
+	
+	if(!isSigned) {
+		if(!quotient) seq.push_back(makeInstruction("and",{rd,rs,std::to_string(m-1)}));
+		else if(k==0) seq.push_back(makeInstruction("mov",{rd,rs}));
+		else seq.push_back(makeInstruction("sru",{rd,rs,std::to_string(k)}));
+		return seq;
+	}
+	
+	if(k==0) {
+		if(!quotient) seq.push_back(makeInstruction("mov",{rd,"0"}));
+		else if(divisor>0) seq.push_back(makeInstruction("mov",{rd,rs}));
+		else seq.push_back(makeInstruction("neg",{rd,rs}));
+		return seq;
+	}
+	
+	if(dst.reg==src.reg) return seq;
+	
+// Bias: m-1 for negative dividends, 0 otherwise
+	if(k==1) seq.push_back(makeInstruction("sru",{rd,rs,"31"}));
+	else {
+		seq.push_back(makeInstruction("srs",{rd,rs,"31"}));
+		seq.push_back(makeInstruction("sru",{rd,rd,std::to_string(32-k)}));
+	}
+	seq.push_back(makeInstruction("add",{rd,rd,rs}));
+	
+	if(quotient) {
+		seq.push_back(makeInstruction("srs",{rd,rd,std::to_string(k)}));
+		if(divisor<0) seq.push_back(makeInstruction("neg",{rd,rd}));
+	}
+	else {
+		seq.push_back(makeInstruction("and",{rd,rd,std::to_string(-m)}));
+		seq.push_back(makeInstruction("sub",{rd,rs,rd}));
+	}
+	return seq;
+}
+
+/*
+ * Multiplication by a constant: the factor is written in the
+ * non-adjacent form (digits 0, 1 and -1, no two adjacent digits
+ * being non-zero) and the product is accumulated in the destination
+ * register from the most significant digit. With more than one
+ * non-zero digit the source is read after the destination has been
+ * written, so they must differ.
+ */
+
+Assembler::Sequence Assembler::reduceMul(const Operand &dst,const Operand &src,std::int32_t factor) const {
+	Sequence seq;
+	auto const &rd=dst.str;
+	auto const &rs=src.str;
+	
+	if(factor==0) {
+		seq.push_back(makeInstruction("mov",{rd,"0"}));
+		return seq;
+	}
+	
+	std::vector<std::pair<int,int> > digits; // position and sign, the most significant last
+	auto n=(factor<0)?-factor:factor;
+	for(int pos=0;n>0;pos++) {
+		if(n&1) {
+			int digit=2-(n&3);
+			digits.emplace_back(pos,digit);
+			n-=digit;
+		}
+		n>>=1;
+	}
+	
+	if(digits.size()>1&&dst.reg==src.reg) return seq;
+	
+	std::string acc=rs;
+	int pos=digits.back().first;
+	for(auto it=digits.rbegin()+1;it!=digits.rend();++it) {
+		seq.push_back(makeInstruction("sl",{rd,acc,std::to_string(pos-it->first)}));
+		seq.push_back(makeInstruction(it->second>0?"add":"sub",{rd,rd,rs}));
+		acc=rd;
+		pos=it->first;
+	}
+	if(pos>0) seq.push_back(makeInstruction("sl",{rd,acc,std::to_string(pos)}));
+	else if(seq.empty()) seq.push_back(makeInstruction("mov",{rd,rs}));
+	if(factor<0) seq.push_back(makeInstruction("neg",{rd,rd}));
+	return seq;
+}
+
+/*
+ * Calls rt_emu_udiv or rt_emu_sdiv. Operands are passed on the stack,
+ * so that no register other than the destination one is modified:
+ * the helper returns the quotient in place of the dividend and the
+ * remainder in place of the divisor.
+ */
+
+Assembler::Sequence Assembler::emulateDivision(const std::string &op,const std::vector<Operand> &args) {
+	for(auto const &arg: args) {
+		if(arg.type==Operand::Register&&arg.reg==255)
+			throw std::runtime_error("\""+arg.str+"\": the stack pointer can't be used with "+
+				op+" on a core without the divider");
+	}
+	
+	std::string helper=(op[3]=='u')?"rt_emu_udiv":"rt_emu_sdiv";
+	auto it=_obj.symbols().find(helper);
+	if(it==_obj.symbols().end()||it->second.type==LinkableObject::Unknown) _obj.addImportedSymbol(helper);
+	else if(it->second.type!=LinkableObject::Imported)
+		throw std::runtime_error("Symbol \""+helper+"\" is reserved for the division helper");
+	
+	bool quotient=(op[0]=='d');
+	Sequence seq;
+	seq.push_back(makeInstruction("sub",{"sp","sp","4"}));
+	seq.push_back(makeInstruction("sw",{"sp",args[2].str}));
+	seq.push_back(makeInstruction("sub",{"sp","sp","4"}));
+	seq.push_back(makeInstruction("sw",{"sp",args[1].str}));
+	seq.push_back(makeInstruction("sub",{"sp","sp","4"}));
+	seq.push_back(makeInstruction("sw",{"sp","rp"}));
+	seq.push_back(makeInstruction("lc",{"rp",helper}));
+	seq.push_back(makeInstruction("call",{"rp"}));
+	seq.push_back(makeInstruction("lw",{"rp","sp"}));
+	seq.push_back(makeInstruction("add",{"sp","sp",quotient?"4":"8"}));
+	seq.push_back(makeInstruction("lw",{args[0].str,"sp"}));
+	seq.push_back(makeInstruction("add",{"sp","sp",quotient?"8":"4"}));
+	return seq;
+}
+
+Assembler::TokenList Assembler::makeInstruction(const std::string &mnemonic,
+	const std::vector<std::string> &operands)
+{
+	TokenList list{mnemonic};
+	for(std::size_t i=0;i<operands.size();i++) {
+		if(i>0) list.push_back(",");
+		list.push_back(operands[i]);
+	}
+	return list;
+}
+
+// Estimated execution time, assuming memory without wait states
+
+unsigned Assembler::cycles(const Sequence &seq) {
+	unsigned total=0;
+	for(auto const &instr: seq) {
+		auto const &m=instr[0];
+		if(m=="call") total+=4;
+		else if(m=="lw") total+=3;
+		else if(m=="sw"||m=="lc"||m=="sl"||m=="sru"||m=="srs") total+=2;
+		else total+=1;
+	}
+	return total;
+}
+
 /*
  * Member functions to encode LXP32 instructions
  */
@@ -669,6 +1002,7 @@ void Assembler::encodeCjmpxx(const TokenList &list) {
 void Assembler::encodeDivs(const TokenList &list) {
 	auto args=getOperands(list);
 	if(args.size()!=3) throw std::runtime_error("divs instruction requires 3 operands");
+	_obj.setRequirements("div");
 	LinkableObject::Word w=0x54000000;
 	encodeDstOperand(w,args[0]);
 	encodeRd1Operand(w,args[1]);
@@ -679,6 +1013,7 @@ void Assembler::encodeDivs(const TokenList &list) {
 void Assembler::encodeDivu(const TokenList &list) {
 	auto args=getOperands(list);
 	if(args.size()!=3) throw std::runtime_error("divu instruction requires 3 operands");
+	_obj.setRequirements("div");
 	LinkableObject::Word w=0x50000000;
 	encodeDstOperand(w,args[0]);
 	encodeRd1Operand(w,args[1]);
@@ -791,6 +1126,7 @@ void Assembler::encodeLw(const TokenList &list) {
 void Assembler::encodeMods(const TokenList &list) {
 	auto args=getOperands(list);
 	if(args.size()!=3) throw std::runtime_error("mods instruction requires 3 operands");
+	_obj.setRequirements("div");
 	LinkableObject::Word w=0x5C000000;
 	encodeDstOperand(w,args[0]);
 	encodeRd1Operand(w,args[1]);
@@ -801,6 +1137,7 @@ void Assembler::encodeMods(const TokenList &list) {
 void Assembler::encodeModu(const TokenList &list) {
 	auto args=getOperands(list);
 	if(args.size()!=3) throw std::runtime_error("modu instruction requires 3 operands");
+	_obj.setRequirements("div");
 	LinkableObject::Word w=0x58000000;
 	encodeDstOperand(w,args[0]);
 	encodeRd1Operand(w,args[1]);
@@ -5,20 +5,39 @@
  *
  * This module defines the Assembler class which performs
  * compilation of LXP32 assembly source files.
+ *
+ * When a core profile is set, division and multiplication
+ * instructions are rewritten for the target core: operations with
+ * constant operands are replaced with shifts and additions if that
+ * is faster, and divisions on a core without the divider with calls
+ * to the runtime library (rt_emu_udiv and rt_emu_sdiv).
  */
 
 #ifndef ASSEMBLER_H_INCLUDED
 #define ASSEMBLER_H_INCLUDED
 
 #include "linkableobject.h"
+#include "coreprofile.h"
 
+#include <iostream>
 #include <vector>
 #include <map>
 #include <string>
 #include <cstdint>
 
 class Assembler {
+public:
+	struct Rewrite {
+		std::size_t count=0;
+// Estimated cycles per execution of each rewritten instruction once
+		std::size_t cycles=0;
+		std::size_t hwCycles=0; // the same for the original instructions
+	};
+	typedef std::map<std::string,Rewrite> RewriteStats; // by kind
+
+private:
 	typedef std::vector<std::string> TokenList;
+	typedef std::vector<TokenList> Sequence;
 	typedef std::int_least64_t Integer;
 	enum LexerState {
 		Initial,
@@ -43,18 +62,26 @@ class Assembler {
 	std::vector<std::string> _includeSearchDirs;
 	std::vector<std::string> _exportedSymbols;
 	std::vector<bool> _sectionEnabled;
+	std::map<std::string,bool> _perfRegions; // true if the region has been closed
+	bool _rewrite=false; // see setCoreProfile()
+	CoreProfile _profile;
+	RewriteStats _rewrites;
 public:
 	void processFile(const std::string &filename);
+	void processStream(std::istream &in,const std::string &filename);
 	
 	void addIncludeSearchDir(const std::string &dir);
+	void setCoreProfile(const CoreProfile &profile);
 	
 	int line() const;
 	std::string currentFileName() const;
 	
 	LinkableObject &object();
 	const LinkableObject &object() const;
+	const RewriteStats &rewrites() const;
 private:
 	void processFileRecursive(const std::string &filename);
+	void processStreamRecursive(std::istream &in,const std::string &filename);
 	TokenList tokenize(const std::string &str);
 	void expand(TokenList &list);
 	void elaborate(TokenList &list);
@@ -68,7 +95,16 @@ private:
 	static Integer numericLiteral(const std::string &str);
 	static std::vector<Operand> getOperands(const TokenList &list);
 	
+// Rewriting for the core profile
+	bool rewriteInstruction(const TokenList &list);
+	Sequence reduceDivision(const std::string &op,const Operand &dst,const Operand &src,std::int32_t divisor) const;
+	Sequence reduceMul(const Operand &dst,const Operand &src,std::int32_t factor) const;
+	Sequence emulateDivision(const std::string &op,const std::vector<Operand> &args);
+	static TokenList makeInstruction(const std::string &mnemonic,const std::vector<std::string> &operands);
+	static unsigned cycles(const Sequence &seq);
+	
 // LXP32 instructions
+	void encodeInstruction(const TokenList &list);
 	void encodeDstOperand(LinkableObject::Word &word,const Operand &arg);
 	void encodeRd1Operand(LinkableObject::Word &word,const Operand &arg);
 	void encodeRd2Operand(LinkableObject::Word &word,const Operand &arg);
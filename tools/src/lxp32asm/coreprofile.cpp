@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the CoreProfile class.
+ */
+
+#include "coreprofile.h"
+
+#include <stdexcept>
+
+/*
+ * Parses a profile, unspecified items keep their defaults
+ * (lxp32u,div,mul=dsp)
+ */
+
+CoreProfile::CoreProfile(const std::string &str) {
+	for(auto const &item: parse(str)) {
+		if(item.second.size()>1)
+			throw std::runtime_error("Conflicting core profile items in \""+str+"\"");
+		auto const &value=*item.second.begin();
+		if(item.first=="core") _cached=(value=="c");
+		else if(item.first=="div") _divider=(value=="on");
+		else if(value=="dsp") _mulArch=MulDsp;
+		else if(value=="opt") _mulArch=MulOpt;
+		else _mulArch=MulSeq;
+	}
+}
+
+bool CoreProfile::cached() const {
+	return _cached;
+}
+
+bool CoreProfile::divider() const {
+	return _divider;
+}
+
+CoreProfile::MulArch CoreProfile::mulArch() const {
+	return _mulArch;
+}
+
+unsigned CoreProfile::mulCycles() const {
+	return mulCycles(_mulArch);
+}
+
+/*
+ * Execution time of the "mul" instruction, also used by the lxp32sim
+ * timing model
+ */
+
+unsigned CoreProfile::mulCycles(MulArch arch) {
+	switch(arch) {
+	case MulOpt:
+		return 6;
+	case MulSeq:
+		return 34;
+	default:
+		return 2;
+	}
+}
+
+/*
+ * An empty variant matches any profile
+ */
+
+bool CoreProfile::matches(const std::string &variant) const {
+	auto const profile=items();
+	for(auto const &item: parse(variant)) {
+		auto const &value=*profile.at(item.first).begin();
+		if(item.second.find(value)==item.second.end()) return false;
+	}
+	return true;
+}
+
+std::string CoreProfile::str() const {
+	std::string s=_cached?"lxp32c":"lxp32u";
+	s+=_divider?",div":",nodiv";
+	if(_mulArch==MulDsp) s+=",mul=dsp";
+	else if(_mulArch==MulOpt) s+=",mul=opt";
+	else s+=",mul=seq";
+	return s;
+}
+
+void CoreProfile::validateVariant(const std::string &variant) {
+	parse(variant);
+}
+
+/*
+ * Private members
+ */
+
+// Splits a profile or a variant into sets of values by kind
+
+CoreProfile::Items CoreProfile::parse(const std::string &str) {
+	Items result;
+	if(str.empty()) return result;
+	
+	std::string::size_type pos=0;
+	for(;;) {
+		auto end=str.find(',',pos);
+		auto item=str.substr(pos,end==std::string::npos?std::string::npos:end-pos);
+		if(item=="lxp32u") result["core"].insert("u");
+		else if(item=="lxp32c") result["core"].insert("c");
+		else if(item=="div") result["div"].insert("on");
+		else if(item=="nodiv") result["div"].insert("off");
+		else if(item=="mul=dsp"||item=="mul=opt"||item=="mul=seq") result["mul"].insert(item.substr(4));
+		else throw std::runtime_error("Invalid core profile item: \""+item+"\"");
+		if(end==std::string::npos) break;
+		pos=end+1;
+	}
+	return result;
+}
+
+CoreProfile::Items CoreProfile::items() const {
+	Items result;
+	result["core"].insert(_cached?"c":"u");
+	result["div"].insert(_divider?"on":"off");
+	result["mul"].insert(_mulArch==MulDsp?"dsp":(_mulArch==MulOpt?"opt":"seq"));
+	return result;
+}
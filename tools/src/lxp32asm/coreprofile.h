@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the CoreProfile class which describes the
+ * configuration of the target core, e.g. "lxp32u,nodiv,mul=seq".
+ *
+ * The same syntax is used for object variants (see the #variant
+ * directive): a variant lists the configurations an object is
+ * intended for, items of the same kind being alternatives, e.g.
+ * "nodiv,mul=opt,mul=seq". The linker only pulls archive members
+ * whose variant matches the profile.
+ */
+
+#ifndef COREPROFILE_H_INCLUDED
+#define COREPROFILE_H_INCLUDED
+
+#include <map>
+#include <set>
+#include <string>
+
+class CoreProfile {
+public:
+	enum MulArch {MulDsp,MulOpt,MulSeq};
+
+private:
+	bool _cached=false;
+	bool _divider=true;
+	MulArch _mulArch=MulDsp;
+
+public:
+	CoreProfile() {}
+	explicit CoreProfile(const std::string &str);
+	
+	bool cached() const;
+	bool divider() const;
+	MulArch mulArch() const;
+	unsigned mulCycles() const;
+	static unsigned mulCycles(MulArch arch);
+	
+	bool matches(const std::string &variant) const;
+	std::string str() const;
+	
+	static void validateVariant(const std::string &variant);
+
+private:
+	typedef std::map<std::string,std::set<std::string> > Items;
+	static Items parse(const std::string &str);
+	Items items() const;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the LinkableArchive class.
+ */
+
+#include "linkablearchive.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+void LinkableArchive::addMember(const LinkableObject &obj) {
+	_members.push_back(obj);
+}
+
+std::vector<LinkableObject> &LinkableArchive::members() {
+	return _members;
+}
+
+const std::vector<LinkableObject> &LinkableArchive::members() const {
+	return _members;
+}
+
+/*
+ * An archive is a sequence of serialized objects, each one
+ * enclosed in "Start Member" and "End Member" lines
+ */
+
+void LinkableArchive::serialize(const std::string &filename) const {
+	std::ofstream out(filename,std::ios_base::out);
+	if(!out) throw std::runtime_error("Cannot open \""+filename+"\" for writing");
+	
+	out<<"LinkableArchive"<<std::endl;
+	for(auto const &obj: _members) {
+		out<<std::endl;
+		out<<"Start Member"<<std::endl;
+		obj.serialize(out);
+		out<<"End Member"<<std::endl;
+	}
+}
+
+void LinkableArchive::deserialize(const std::string &filename) {
+	std::ifstream in(filename,std::ios_base::in);
+	if(!in) throw std::runtime_error("Cannot open \""+filename+"\"");
+	
+	_members.clear();
+	
+	std::string line,first,second;
+	for(;;) {
+		if(!std::getline(in,line)) throw std::runtime_error("Bad archive format");
+		std::istringstream ss(line);
+		if(!(ss>>first)) continue;
+		if(first!="LinkableArchive") throw std::runtime_error("Bad archive format");
+		break;
+	}
+	
+	while(std::getline(in,line)) {
+		std::istringstream ss(line);
+		if(!(ss>>first)) continue;
+		if(first!="Start"||!(ss>>second)||second!="Member")
+			throw std::runtime_error("Unexpected token: \""+first+"\"");
+			
+// Collect the member text, then parse it as a separate object
+		std::string text;
+		bool complete=false;
+		while(std::getline(in,line)) {
+			std::istringstream ls(line);
+			if(ls>>first>>second&&first=="End"&&second=="Member") {
+				complete=true;
+				break;
+			}
+			text+=line+"\n";
+		}
+		if(!complete) throw std::runtime_error("Unexpected end of file");
+		
+		std::istringstream member(text);
+		LinkableObject obj;
+		obj.deserialize(member);
+		_members.push_back(std::move(obj));
+	}
+}
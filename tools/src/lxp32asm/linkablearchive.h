@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the LinkableArchive class which represents
+ * a library of LXP32 binary objects. The linker only includes
+ * members that define symbols referenced by other objects.
+ */
+
+#ifndef LINKABLEARCHIVE_H_INCLUDED
+#define LINKABLEARCHIVE_H_INCLUDED
+
+#include "linkableobject.h"
+
+#include <vector>
+#include <string>
+
+class LinkableArchive {
+	std::vector<LinkableObject> _members;
+
+public:
+	void addMember(const LinkableObject &obj);
+	std::vector<LinkableObject> &members();
+	const std::vector<LinkableObject> &members() const;
+	
+	void serialize(const std::string &filename) const;
+	void deserialize(const std::string &filename);
+};
+
+#endif
@@ -24,6 +24,22 @@ void LinkableObject::setName(const std::string &str) {
 	_name=str;
 }
 
+std::string LinkableObject::variant() const {
+	return _variant;
+}
+
+void LinkableObject::setVariant(const std::string &str) {
+	_variant=str;
+}
+
+std::string LinkableObject::requirements() const {
+	return _requirements;
+}
+
+void LinkableObject::setRequirements(const std::string &str) {
+	_requirements=str;
+}
+
 LinkableObject::Word LinkableObject::virtualAddress() const {
 	return _virtualAddress;
 }
@@ -136,12 +152,25 @@ const LinkableObject::SymbolTable &LinkableObject::symbols() const {
 	return _symbols;
 }
 
+void LinkableObject::addSourceLine(Word rva,const std::string &source,int line) {
+	_lines[rva]=SourceLine {source,line};
+}
+
+const LinkableObject::LineTable &LinkableObject::lines() const {
+	return _lines;
+}
+
 void LinkableObject::serialize(const std::string &filename) const {
 	std::ofstream out(filename,std::ios_base::out);
 	if(!out) throw std::runtime_error("Cannot open \""+filename+"\" for writing");
-	
+	serialize(out);
+}
+
+void LinkableObject::serialize(std::ostream &out) const {
 	out<<"LinkableObject"<<std::endl;
 	if(!_name.empty()) out<<"Name "<<Utils::urlEncode(_name)<<std::endl;
+	if(!_variant.empty()) out<<"Variant "<<Utils::urlEncode(_variant)<<std::endl;
+	if(!_requirements.empty()) out<<"Requires "<<Utils::urlEncode(_requirements)<<std::endl;
 	out<<"VirtualAddress 0x"<<Utils::hex(_virtualAddress)<<std::endl;
 	
 	out<<std::endl;
@@ -179,7 +208,10 @@ void LinkableObject::serialize(const std::string &filename) const {
 void LinkableObject::deserialize(const std::string &filename) {
 	std::ifstream in(filename,std::ios_base::in);
 	if(!in) throw std::runtime_error("Cannot open \""+filename+"\"");
-	
+	deserialize(in);
+}
+
+void LinkableObject::deserialize(std::istream &in) {
 	operator=(LinkableObject());
 	
 	std::string line;
@@ -196,6 +228,8 @@ void LinkableObject::deserialize(const std::string &filename) {
 		if(tokens.empty()) continue;
 		if(tokens.size()<2) throw std::runtime_error("Unexpected end of line");
 		else if(tokens[0]=="Name") _name=Utils::urlDecode(tokens[1]);
+		else if(tokens[0]=="Variant") _variant=Utils::urlDecode(tokens[1]);
+		else if(tokens[0]=="Requires") _requirements=Utils::urlDecode(tokens[1]);
 		else if(tokens[0]=="VirtualAddress") _virtualAddress=std::strtoul(tokens[1].c_str(),NULL,0);
 		else if(tokens[0]=="Start") {
 			if(tokens[1]=="Code") deserializeCode(in);
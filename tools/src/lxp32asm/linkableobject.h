@@ -40,16 +40,32 @@ public:
 	
 	typedef std::map<std::string,SymbolData> SymbolTable;
 	
+// Source location of each instruction (not stored in object files)
+	struct SourceLine {
+		std::string source;
+		int line;
+	};
+	typedef std::map<Word,SourceLine> LineTable;
+	
 private:
 	std::string _name;
+	std::string _variant; // see CoreProfile
+	std::string _requirements; // core profile items the code relies on
 	std::vector<Byte> _code;
 	SymbolTable _symbols;
+	LineTable _lines;
 	Word _virtualAddress=0;
 	
 public:
 	std::string name() const;
 	void setName(const std::string &str);
 	
+	std::string variant() const;
+	void setVariant(const std::string &str);
+	
+	std::string requirements() const;
+	void setRequirements(const std::string &str);
+	
 	Word virtualAddress() const;
 	void setVirtualAddress(Word addr);
 	
@@ -76,8 +92,13 @@ public:
 	const SymbolData &symbol(const std::string &name) const;
 	const SymbolTable &symbols() const;
 	
+	void addSourceLine(Word rva,const std::string &source,int line);
+	const LineTable &lines() const;
+	
 	void serialize(const std::string &filename) const;
+	void serialize(std::ostream &out) const;
 	void deserialize(const std::string &filename);
+	void deserialize(std::istream &in);
 
 private:
 	void deserializeCode(std::istream &in);
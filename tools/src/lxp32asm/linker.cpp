@@ -23,14 +23,29 @@ void Linker::addObject(LinkableObject &obj) {
 	_objects.push_back(&obj);
 }
 
+void Linker::addArchive(LinkableArchive &archive) {
+	_archives.push_back(&archive);
+}
+
+void Linker::setCoreProfile(const CoreProfile &profile) {
+	_profile=profile;
+}
+
 void Linker::link(OutputWriter &writer) {
 	if(_objects.empty()) throw std::runtime_error("Object set is empty");
+	auto explicitObjects=_objects.size();
+	
+// Add archive members defining the missing symbols
+	pullArchiveMembers();
 	
 // Merge symbol tables
 	buildSymbolTable();
 	
+// Make sure that the image can run on the target core
+	checkRequirements();
+	
 // Determine entry point
-	if(_objects.size()==1) _entryObject=_objects[0];
+	if(explicitObjects==1) _entryObject=_objects[0];
 	else if(_entryObject==nullptr)
 		throw std::runtime_error("Entry point not defined: cannot find \"entry\" or \"Entry\" symbol");
 	
@@ -92,10 +107,88 @@ void Linker::generateMap(std::ostream &s) {
 	}
 }
 
+/*
+ * Returns the linked objects in the order of placement
+ * (unreferenced objects are removed by link())
+ */
+
+const std::vector<LinkableObject*> &Linker::objects() const {
+	return _objects;
+}
+
 /*
  * Private members
  */
 
+/*
+ * Symbols imported by the objects being linked are looked up in the
+ * archives in the order they were added. A member is only included
+ * if its variant matches the core profile; the first matching member
+ * wins. Members can in turn import symbols from other members.
+ */
+
+void Linker::pullArchiveMembers() {
+	std::set<std::string> defined;
+	std::vector<std::string> pending;
+	
+	auto scan=[&](const LinkableObject *obj) {
+		for(auto const &sym: obj->symbols()) {
+			if(sym.second.type==LinkableObject::Exported) defined.insert(sym.first);
+			else if(sym.second.type==LinkableObject::Imported&&!sym.second.refs.empty())
+				pending.push_back(sym.first);
+		}
+	};
+	
+	for(auto const &obj: _objects) scan(obj);
+	
+	while(!pending.empty()) {
+		auto name=std::move(pending.back());
+		pending.pop_back();
+		if(defined.find(name)!=defined.end()) continue;
+		auto obj=findArchiveMember(name);
+		if(!obj) continue; // reported by buildSymbolTable()
+		_objects.push_back(obj);
+		scan(obj);
+	}
+}
+
+LinkableObject *Linker::findArchiveMember(const std::string &symbol) const {
+	const LinkableObject *mismatch=nullptr;
+	
+	for(auto const &archive: _archives) {
+		for(auto &obj: archive->members()) {
+			auto it=obj.symbols().find(symbol);
+			if(it==obj.symbols().end()||it->second.type!=LinkableObject::Exported) continue;
+			if(_profile.matches(obj.variant())) return &obj;
+			if(!mismatch) mismatch=&obj;
+		}
+	}
+	
+	if(mismatch) {
+		std::ostringstream msg;
+		msg<<"Symbol \""<<symbol<<"\" is only defined for other core configurations ";
+		msg<<"(e.g. \""<<mismatch->variant()<<"\" in "<<mismatch->name()<<", the target is \"";
+		msg<<_profile.str()<<"\")";
+		throw std::runtime_error(msg.str());
+	}
+	
+	return nullptr;
+}
+
+/*
+ * Objects assembled without a core profile can contain instructions
+ * the target core doesn't implement. Modules declaring a variant are
+ * trusted (e.g. to detect the divider at run time).
+ */
+
+void Linker::checkRequirements() const {
+	for(auto const &obj: _objects) {
+		if(!obj->variant().empty()||_profile.matches(obj->requirements())) continue;
+		throw std::runtime_error("Object \""+obj->name()+"\" requires \""+obj->requirements()+
+			"\" which the target core ("+_profile.str()+") doesn't have, assemble it for the core profile");
+	}
+}
+
 void Linker::buildSymbolTable() {
 	_globalSymbolTable.clear();
 	
@@ -11,6 +11,8 @@
 #define LINKER_H_INCLUDED
 
 #include "linkableobject.h"
+#include "linkablearchive.h"
+#include "coreprofile.h"
 #include "outputwriter.h"
 
 #include <iostream>
@@ -27,6 +29,8 @@ class Linker {
 	};
 	
 	std::vector<LinkableObject*> _objects;
+	std::vector<LinkableArchive*> _archives;
+	CoreProfile _profile; // selects archive member variants
 	LinkableObject *_entryObject=nullptr;
 	std::map<std::string,GlobalSymbolData> _globalSymbolTable;
 	
@@ -37,12 +41,18 @@ class Linker {
 	std::size_t _bytesWritten=0;
 public:
 	void addObject(LinkableObject &obj);
+	void addArchive(LinkableArchive &archive);
+	void setCoreProfile(const CoreProfile &profile);
 	void link(OutputWriter &writer);
 	void setBase(LinkableObject::Word base);
 	void setAlignment(std::size_t align);
 	void setImageSize(std::size_t size);
 	void generateMap(std::ostream &s);
+	const std::vector<LinkableObject*> &objects() const;
 private:
+	void pullArchiveMembers();
+	LinkableObject *findArchiveMember(const std::string &symbol) const;
+	void checkRequirements() const;
 	void buildSymbolTable();
 	void placeObjects();
 	void relocateObject(LinkableObject *obj);
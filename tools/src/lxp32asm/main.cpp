@@ -8,6 +8,8 @@
 
 #include "assembler.h"
 #include "linker.h"
+#include "linkablearchive.h"
+#include "coreprofile.h"
 #include "utils.h"
 
 #include <iostream>
@@ -25,6 +27,7 @@ struct Options {
 	enum OutputFormat {Bin,Textio,Dec,Hex};
 	
 	bool compileOnly=false;
+	bool createArchive=false;
 	std::string outputFileName;
 	std::string mapFileName;
 	std::vector<std::string> includeSearchDirs;
@@ -32,6 +35,8 @@ struct Options {
 	std::size_t align=4;
 	std::size_t imageSize=0;
 	OutputFormat fmt=Bin;
+	CoreProfile profile;
+	bool profileSpecified=false; // instructions are rewritten for the profile
 };
 
 static void displayUsage(std::ostream &os,const char *program) {
@@ -48,13 +53,19 @@ static void displayUsage(std::ostream &os,const char *program) {
 	os<<"    -i <dir>     Add directory to the list of directories used to search"<<std::endl;
 	os<<"                 for included files (multiple directories can be specified)"<<std::endl;
 	os<<"    -m <file>    Generate map file"<<std::endl;
+	os<<"    -mcore <profile>"<<std::endl;
+	os<<"                 Target core configuration: rewrite instructions for it"<<std::endl;
+	os<<"                 and select archive member variants (default: lxp32u,div,mul=dsp)"<<std::endl;
 	os<<"    -o <file>    Output file name"<<std::endl;
+	os<<"    -r           Create an archive from the input files (don't link)"<<std::endl;
 	os<<"    -s <size>    Output image size"<<std::endl;
 	os<<"    --           Do not interpret subsequent arguments as options"<<std::endl;
 	os<<std::endl;
 	os<<"Object alignment must be a power of two and can't be less than 4."<<std::endl;
 	os<<"Base address must be a multiple of object alignment."<<std::endl;
 	os<<"Image size must be a multiple of 4."<<std::endl;
+	os<<"Core profile is a comma-separated list of items: lxp32u or lxp32c,"<<std::endl;
+	os<<"div or nodiv, mul=dsp, mul=opt or mul=seq."<<std::endl;
 	os<<std::endl;
 	
 	os<<"Output file formats:"<<std::endl;
@@ -65,9 +76,8 @@ static void displayUsage(std::ostream &os,const char *program) {
 	os<<"    hex          Text format, one word per line (hexadecimal)"<<std::endl;
 }
 
-static bool isLinkableObject(const std::string &filename) {
-	static const char *id="LinkableObject";
-	static std::size_t idSize=std::strlen(id);
+static bool hasSignature(const std::string &filename,const char *id) {
+	std::size_t idSize=std::strlen(id);
 	
 	std::ifstream in(filename,std::ios_base::in);
 	if(!in) return false;
@@ -81,6 +91,111 @@ static bool isLinkableObject(const std::string &filename) {
 	return true;
 }
 
+static bool isLinkableObject(const std::string &filename) {
+	return hasSignature(filename,"LinkableObject");
+}
+
+static bool isLinkableArchive(const std::string &filename) {
+	return hasSignature(filename,"LinkableArchive");
+}
+
+/*
+ * Assembles a source file, returns false on error (the message
+ * has been already displayed)
+ */
+
+static bool assemble(const std::string &filename,const Options &options,Assembler &as,
+	Assembler::RewriteStats &rewrites)
+{
+	for(auto const &dir: options.includeSearchDirs) as.addIncludeSearchDir(dir);
+	if(options.profileSpecified) as.setCoreProfile(options.profile);
+	try {
+		as.processFile(filename);
+	}
+	catch(std::exception &ex) {
+		std::cerr<<"Assembler error in "<<as.currentFileName();
+		if(as.line()>0) std::cerr<<":"<<as.line();
+		std::cerr<<": "<<ex.what()<<std::endl;
+		return false;
+	}
+	for(auto const &r: as.rewrites()) {
+		auto &total=rewrites[r.first];
+		total.count+=r.second.count;
+		total.cycles+=r.second.cycles;
+		total.hwCycles+=r.second.hwCycles;
+	}
+	return true;
+}
+
+/*
+ * Summarizes the estimated cycle impact of the instructions rewritten
+ * for the core profile
+ */
+
+static void reportRewrites(const Options &options,const Assembler::RewriteStats &rewrites) {
+	if(rewrites.empty()) return;
+	
+	std::cout<<"Core profile "<<options.profile.str()<<": ";
+	std::cout<<"estimated cycles per execution of rewritten instructions"<<std::endl;
+	
+	Assembler::Rewrite total;
+	for(auto const &r: rewrites) {
+		std::cout<<"    "<<r.first<<": "<<r.second.count<<" instruction(s), ";
+		std::cout<<r.second.cycles<<" cycles ("<<r.second.hwCycles<<" with the hardware instructions)"<<std::endl;
+		total.count+=r.second.count;
+		total.cycles+=r.second.cycles;
+		total.hwCycles+=r.second.hwCycles;
+	}
+	std::cout<<"    Total: "<<total.count<<" instruction(s), ";
+	std::cout<<total.cycles<<" cycles ("<<total.hwCycles<<" with the hardware instructions)"<<std::endl;
+}
+
+/*
+ * Collects source files, objects and other archives into an archive
+ */
+
+static int createArchive(const std::vector<std::string> &inputFiles,const Options &options) {
+	LinkableArchive archive;
+	Assembler::RewriteStats rewrites;
+	
+	for(auto const &filename: inputFiles) {
+		try {
+			if(isLinkableArchive(filename)) {
+				LinkableArchive ar;
+				ar.deserialize(filename);
+				for(auto const &obj: ar.members()) archive.addMember(obj);
+			}
+			else if(isLinkableObject(filename)) {
+				LinkableObject lo;
+				lo.deserialize(filename);
+				archive.addMember(lo);
+			}
+			else {
+				Assembler as;
+				if(!assemble(filename,options,as,rewrites)) return EXIT_FAILURE;
+				archive.addMember(as.object());
+			}
+		}
+		catch(std::exception &ex) {
+			std::cerr<<"Error reading "<<filename<<": "<<ex.what()<<std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	
+	std::string outputFileName=options.outputFileName;
+	if(outputFileName.empty()) {
+		outputFileName=inputFiles[0];
+		auto pos=outputFileName.find_last_of('.');
+		if(pos!=std::string::npos) outputFileName.erase(pos);
+		outputFileName+=".la";
+	}
+	
+	reportRewrites(options,rewrites);
+	archive.serialize(outputFileName);
+	std::cout<<archive.members().size()<<" object(s) archived"<<std::endl;
+	return 0;
+}
+
 int main(int argc,char *argv[]) try {
 	std::vector<std::string> inputFiles;
 	Options options;
@@ -161,6 +276,14 @@ int main(int argc,char *argv[]) try {
 			}
 			options.mapFileName=argv[i];
 		}
+		else if(!strcmp(argv[i],"-mcore")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			options.profile=CoreProfile(argv[i]);
+			options.profileSpecified=true;
+		}
 		else if(!strcmp(argv[i],"-o")) {
 			if(++i==argc) {
 				displayUsage(std::cerr,argv[0]);
@@ -168,6 +291,9 @@ int main(int argc,char *argv[]) try {
 			}
 			options.outputFileName=argv[i];
 		}
+		else if(!strcmp(argv[i],"-r")) {
+			options.createArchive=true;
+		}
 		else if(!strcmp(argv[i],"-s")) {
 			if(++i==argc) {
 				displayUsage(std::cerr,argv[0]);
@@ -187,17 +313,21 @@ int main(int argc,char *argv[]) try {
 	if(options.base%options.align!=0)
 		throw std::runtime_error("Base address must be a multiple of object alignment");
 	
-	if(options.compileOnly) {
+	if(options.compileOnly&&options.createArchive)
+		throw std::runtime_error("-c and -r are mutually exclusive");
+	
+	if(options.compileOnly||options.createArchive) {
+		std::string mode=options.compileOnly?"compile-only":"archive";
 		if(alignmentSpecified)
-			std::cerr<<"Warning: Object alignment is ignored in compile-only mode"<<std::endl;
+			std::cerr<<"Warning: Object alignment is ignored in "<<mode<<" mode"<<std::endl;
 		if(baseSpecified)
-			std::cerr<<"Warning: Base address is ignored in compile-only mode"<<std::endl;
+			std::cerr<<"Warning: Base address is ignored in "<<mode<<" mode"<<std::endl;
 		if(formatSpecified)
-			std::cerr<<"Warning: Output format is ignored in compile-only mode"<<std::endl;
+			std::cerr<<"Warning: Output format is ignored in "<<mode<<" mode"<<std::endl;
 		if(options.imageSize>0)
-			std::cerr<<"Warning: Image size is ignored in compile-only mode"<<std::endl;
+			std::cerr<<"Warning: Image size is ignored in "<<mode<<" mode"<<std::endl;
 		if(!options.mapFileName.empty())
-			std::cerr<<"Warning: Map file is not generated in compile-only mode"<<std::endl;
+			std::cerr<<"Warning: Map file is not generated in "<<mode<<" mode"<<std::endl;
 	}
 	
 	if(inputFiles.empty())
@@ -207,22 +337,28 @@ int main(int argc,char *argv[]) try {
 		throw std::runtime_error("Output file name cannot be specified "
 			"for multiple files in compile-only mode");
 	
+	if(options.createArchive) return createArchive(inputFiles,options);
+	
 	std::vector<Assembler> assemblers;
 	std::vector<LinkableObject> rawObjects;
+	std::vector<LinkableArchive> archives;
+	Assembler::RewriteStats rewrites;
 	
 	for(auto const &filename: inputFiles) {
-		if(options.compileOnly||!isLinkableObject(filename)) {
-			Assembler as;
-			for(auto const &dir: options.includeSearchDirs) as.addIncludeSearchDir(dir);
+		if(!options.compileOnly&&isLinkableArchive(filename)) {
+			LinkableArchive ar;
 			try {
-				as.processFile(filename);
+				ar.deserialize(filename);
 			}
 			catch(std::exception &ex) {
-				std::cerr<<"Assembler error in "<<as.currentFileName();
-				if(as.line()>0) std::cerr<<":"<<as.line();
-				std::cerr<<": "<<ex.what()<<std::endl;
+				std::cerr<<"Error reading archive "<<filename<<": "<<ex.what()<<std::endl;
 				return EXIT_FAILURE;
 			}
+			archives.push_back(std::move(ar));
+		}
+		else if(options.compileOnly||!isLinkableObject(filename)) {
+			Assembler as;
+			if(!assemble(filename,options,as,rewrites)) return EXIT_FAILURE;
 			if(!options.compileOnly) assemblers.push_back(std::move(as));
 			else {
 				std::string outputFileName=options.outputFileName;
@@ -248,11 +384,15 @@ int main(int argc,char *argv[]) try {
 		}
 	}
 	
+	reportRewrites(options,rewrites);
+	
 	if(options.compileOnly) return 0;
 	
 	Linker linker;
 	for(auto &lo: rawObjects) linker.addObject(lo);
 	for(auto &as: assemblers) linker.addObject(as.object());
+	for(auto &ar: archives) linker.addArchive(ar);
+	linker.setCoreProfile(options.profile);
 	linker.setBase(options.base);
 	linker.setAlignment(options.align);
 	linker.setImageSize(options.imageSize);
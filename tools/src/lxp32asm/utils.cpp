@@ -102,6 +102,20 @@ std::string Utils::dequoteString(const std::string &str) {
 	return str.substr(1,str.size()-2);
 }
 
+std::string Utils::jsonString(const std::string &str) {
+	std::string res="\"";
+	for(auto ch: str) {
+		if(ch=='\"'||ch=='\\') {
+			res.push_back('\\');
+			res.push_back(ch);
+		}
+		else if(static_cast<unsigned char>(ch)<0x20) res+="\\u00"+hex(ch);
+		else res.push_back(ch);
+	}
+	res.push_back('\"');
+	return res;
+}
+
 bool Utils::ishexdigit(char ch) {
 	static const char *digits="0123456789ABCDEFabcdef";
 	return (std::strchr(digits,ch)!=NULL);
@@ -49,6 +49,7 @@ namespace Utils {
 	std::string relativePath(const std::string &from,const std::string &to);
 	
 	std::string dequoteString(const std::string &str);
+	std::string jsonString(const std::string &str);
 	
 	bool ishexdigit(char ch);
 	bool isoctdigit(char ch);
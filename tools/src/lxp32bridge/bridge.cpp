@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Bridge class.
+ */
+
+#include "bridge.h"
+
+#include <stdexcept>
+
+Bridge::Bridge(bool dbusRmw,bool dividerEnabled,Cpu::MulArch mulArch,Word startAddr):
+	_cpu(*this),
+	_checkpoint(*this)
+{
+	_cpu.setDbusRmw(dbusRmw);
+	_cpu.setDividerEnabled(dividerEnabled);
+	_cpu.setMulArch(mulArch);
+	_cpu.setStartAddress(startAddr);
+	_cpu.reset();
+	_checkpoint=_cpu;
+}
+
+/*
+ * Inputs are the values sampled on the rising edge, outputs are
+ * driven until the next one (like registered outputs)
+ */
+
+const Bridge::Outputs &Bridge::cycle(const Inputs &in) {
+	if(in.rst) {
+		_cpu.reset();
+		_checkpoint=_cpu;
+		_rollback=false;
+		_log.clear();
+		_samples.clear();
+		_carry=false;
+		_stalled=false;
+		_outputs=Outputs();
+		return _outputs;
+	}
+	
+	if(_stalled) {
+		_samples.push_back(in.irq);
+		if(complete(in)) {
+			_log.push_back(_pending);
+			_stalled=false;
+		}
+	}
+	
+	if(!_stalled) run();
+	drive();
+	return _outputs;
+}
+
+/*
+ * Bus interface used by the CPU model
+ */
+
+unsigned Bridge::fetch(Word addr,Word &data) {
+	auto t=replay(Fetch,addr,0xF,0);
+	if(!t) {
+		data=0;
+		return 0;
+	}
+	data=t->data;
+	return t->cycles-1;
+}
+
+unsigned Bridge::read(Word addr,Word sel,Word &data) {
+	auto t=replay(Read,addr,sel,0);
+	if(!t) {
+		data=0;
+		return 0;
+	}
+	data=t->data;
+	return t->cycles-1;
+}
+
+unsigned Bridge::write(Word addr,Word sel,Word data) {
+	auto t=replay(Write,addr,sel,data);
+	if(!t) return 0;
+	return t->cycles-1;
+}
+
+std::uint8_t Bridge::clock() {
+	if(_stalled) return 0;
+	if(_carry&&!_carryUsed) {
+		_carryUsed=true;
+		return _carryIrq;
+	}
+	if(_covered<_coveredEnd) return _samples[_covered++];
+	auto t=replay(Clock,0,0,0);
+	if(!t) return 0;
+	return _samples[t->samples];
+}
+
+/*
+ * Private members
+ */
+
+// Returns true if the pending transaction has completed on this edge
+
+bool Bridge::complete(const Inputs &in) {
+	_pending.cycles++;
+	switch(_pending.kind) {
+	case Fetch:
+		if(in.lliBusy) return false;
+		if(!_accepted) {
+			_accepted=true; // data are expected on the next cycle
+			return false;
+		}
+		_pending.data=in.lliDat;
+		return true;
+	case Read:
+		if(!in.dbusAck) return false;
+		_pending.data=in.dbusDat;
+		return true;
+	case Write:
+		return in.dbusAck;
+	default:
+		return true;
+	}
+}
+
+/*
+ * Executes instructions until one of them needs a transaction which
+ * hasn't completed yet. Exceptions thrown while the bus is stalled
+ * (e.g. an illegal instruction decoded from a stalled fetch) are
+ * not real.
+ */
+
+void Bridge::run() {
+	for(;;) {
+		if(_rollback) _cpu=_checkpoint;
+		_replayed=0;
+		_covered=0;
+		_coveredEnd=0;
+		_carryUsed=false;
+		try {
+			_cpu.step();
+		}
+		catch(std::exception &) {
+			if(!_stalled) throw;
+		}
+		if(_stalled) {
+			_rollback=true;
+			return;
+		}
+		commit();
+	}
+}
+
+/*
+ * Samples of the cycles not consumed by the instruction are merged and
+ * passed to the next one, so that interrupt request pulses aren't lost
+ */
+
+void Bridge::commit() {
+	std::uint8_t irq=0;
+	bool carry=false;
+	if(_carry&&!_carryUsed) {
+		irq=_carryIrq;
+		carry=true;
+	}
+	for(;_covered<_coveredEnd;_covered++) {
+		irq|=_samples[_covered];
+		carry=true;
+	}
+	_carry=carry;
+	_carryIrq=irq;
+	
+	_checkpoint=_cpu;
+	_rollback=false;
+	_log.clear();
+	_samples.clear();
+}
+
+/*
+ * Returns the completed transaction from the log, or starts a new one
+ * and stalls the bus. Replayed bus cycles cover the subsequent clock
+ * cycles of the instruction.
+ */
+
+const Bridge::Transaction *Bridge::replay(Kind kind,Word addr,Word sel,Word data) {
+	if(_stalled) return nullptr;
+	
+	if(_replayed<_log.size()) {
+		auto const &t=_log[_replayed++];
+		if(t.kind!=kind||t.addr!=addr||t.sel!=sel||(kind==Write&&t.data!=data))
+			throw std::logic_error("Bus transactions of a replayed instruction don't match");
+// Bus transactions are contiguous in the samples unless separated by
+// idle cycles, which are only added when the covered cycles run out
+		if(kind!=Clock) {
+			if(_covered==_coveredEnd) _covered=t.samples;
+			_coveredEnd=t.samples+t.cycles;
+		}
+		return &t;
+	}
+	
+	_pending=Transaction {kind,addr,sel,data,0,_samples.size()};
+	_accepted=false;
+	_stalled=true;
+	return nullptr;
+}
+
+void Bridge::drive() {
+	_outputs=Outputs();
+	if(!_stalled) return;
+	switch(_pending.kind) {
+	case Fetch:
+		if(!_accepted) {
+			_outputs.lliRe=true;
+			_outputs.lliAdr=_pending.addr>>2;
+		}
+		break;
+	case Read:
+	case Write:
+		_outputs.dbusCyc=true;
+		_outputs.dbusWe=(_pending.kind==Write);
+		_outputs.dbusSel=_pending.sel;
+		_outputs.dbusAdr=_pending.addr>>2;
+		if(_pending.kind==Write) _outputs.dbusDat=_pending.data;
+		break;
+	default:
+		break;
+	}
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Bridge class which runs the lxp32sim CPU
+ * model (see Cpu) on the buses of an HDL simulation. The HDL side
+ * calls cycle() on every rising clock edge with the sampled inputs
+ * of lxp32u_top and drives the returned outputs until the next edge.
+ *
+ * The CPU model accesses the bus synchronously, so an instruction
+ * which needs a bus transaction that hasn't completed yet is executed
+ * against a stalled bus (accesses have no effect), its effect is
+ * discarded and the CPU is rolled back to the beginning of the
+ * instruction. When the transaction completes, the instruction is
+ * executed again from the start, with the completed transactions of
+ * this instruction replayed from a log, until it finishes.
+ *
+ * Timing: instruction fetches (LLI) and data bus cycles (WISHBONE)
+ * follow the bus protocols, but fetches are not pipelined, so every
+ * fetch adds a cycle. Clock cycles of an instruction are covered by
+ * the cycles its bus transactions have taken (and see the interrupt
+ * request lines sampled during these cycles); the remaining ones are
+ * idle bus cycles. The bridge is therefore functionally equivalent to
+ * the RTL core, but not cycle accurate.
+ */
+
+#ifndef BRIDGE_H_INCLUDED
+#define BRIDGE_H_INCLUDED
+
+#include "bus.h"
+#include "cpu.h"
+
+#include <vector>
+#include <cstdint>
+
+class Bridge : public Bus {
+public:
+	struct Inputs {
+		bool rst=false;
+		Word lliDat=0;
+		bool lliBusy=false;
+		bool dbusAck=false;
+		Word dbusDat=0;
+		std::uint8_t irq=0;
+	};
+	
+	struct Outputs {
+		bool lliRe=false;
+		Word lliAdr=0; // word address
+		bool dbusCyc=false;
+		bool dbusWe=false;
+		Word dbusSel=0;
+		Word dbusAdr=0; // word address
+		Word dbusDat=0;
+	};
+
+private:
+	enum Kind {Fetch,Read,Write,Clock};
+	
+	struct Transaction {
+		Kind kind;
+		Word addr;
+		Word sel;
+		Word data;
+		unsigned cycles;
+		std::size_t samples; // index of the first interrupt request sample
+	};
+	
+	Cpu _cpu;
+	Cpu _checkpoint; // state at the beginning of the current instruction
+	bool _rollback=false;
+	
+// Completed transactions of the current instruction, the interrupt
+// request lines sampled on every cycle they took, and the replay position
+	std::vector<Transaction> _log;
+	std::vector<std::uint8_t> _samples;
+	std::size_t _replayed=0;
+	
+// Samples of the cycles covered by the replayed bus transactions
+	std::size_t _covered=0;
+	std::size_t _coveredEnd=0;
+	
+// Samples not consumed by the previous instruction, merged
+	bool _carry=false;
+	bool _carryUsed=false;
+	std::uint8_t _carryIrq=0;
+	
+// Transaction in progress on the bus
+	bool _stalled=false;
+	Transaction _pending;
+	bool _accepted=false; // LLI request has been accepted by the slave
+	
+	Outputs _outputs;
+
+public:
+	Bridge(bool dbusRmw,bool dividerEnabled,Cpu::MulArch mulArch,Word startAddr);
+	
+	const Outputs &cycle(const Inputs &in);
+	
+	virtual unsigned fetch(Word addr,Word &data) override;
+	virtual unsigned read(Word addr,Word sel,Word &data) override;
+	virtual unsigned write(Word addr,Word sel,Word data) override;
+	virtual std::uint8_t clock() override;
+
+private:
+	bool complete(const Inputs &in);
+	void run();
+	void commit();
+	const Transaction *replay(Kind kind,Word addr,Word sel,Word data);
+	void drive();
+};
+
+#endif
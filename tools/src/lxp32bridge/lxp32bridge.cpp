@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements the C interface of the lxp32bridge library.
+ * HDL simulators call foreign subprograms from a single thread, so
+ * the instances are not protected by a lock.
+ */
+
+#include "lxp32bridge.h"
+#include "bridge.h"
+
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+	struct Instance {
+		std::unique_ptr<Bridge> bridge;
+		bool failed=false;
+	};
+	
+	std::vector<Instance> instances;
+	
+	std::int32_t toInt(Bridge::Word w) {
+		return static_cast<std::int32_t>(w);
+	}
+	
+	Bridge::Word toWord(std::int32_t i) {
+		return static_cast<Bridge::Word>(i);
+	}
+}
+
+LXP32BRIDGE_EXPORT int32_t lxp32bridge_create(int32_t dbus_rmw,int32_t divider_en,
+	int32_t mul_arch,int32_t start_addr)
+{
+	try {
+		Cpu::MulArch arch;
+		if(mul_arch==0) arch=CoreProfile::MulDsp;
+		else if(mul_arch==1) arch=CoreProfile::MulOpt;
+		else if(mul_arch==2) arch=CoreProfile::MulSeq;
+		else throw std::runtime_error("Invalid multiplier architecture");
+		Instance inst;
+		inst.bridge.reset(new Bridge(dbus_rmw!=0,divider_en!=0,arch,toWord(start_addr)));
+		instances.push_back(std::move(inst));
+		return static_cast<int32_t>(instances.size()-1);
+	}
+	catch(std::exception &ex) {
+		std::cerr<<"lxp32bridge: "<<ex.what()<<std::endl;
+		return -1;
+	}
+}
+
+LXP32BRIDGE_EXPORT void lxp32bridge_cycle(int32_t handle,int32_t rst,
+	int32_t lli_dat,int32_t lli_busy,int32_t dbus_ack,int32_t dbus_dat_in,int32_t irq,
+	int32_t *lli_re,int32_t *lli_adr,int32_t *dbus_cyc,int32_t *dbus_we,int32_t *dbus_sel,
+	int32_t *dbus_adr,int32_t *dbus_dat_out,int32_t *failed)
+{
+	Bridge::Outputs out;
+	*failed=1;
+	
+	if(handle>=0&&static_cast<std::size_t>(handle)<instances.size()&&!instances[handle].failed) {
+		auto &inst=instances[handle];
+		Bridge::Inputs in;
+		in.rst=(rst!=0);
+		in.lliDat=toWord(lli_dat);
+		in.lliBusy=(lli_busy!=0);
+		in.dbusAck=(dbus_ack!=0);
+		in.dbusDat=toWord(dbus_dat_in);
+		in.irq=static_cast<std::uint8_t>(irq);
+		try {
+			out=inst.bridge->cycle(in);
+			*failed=0;
+		}
+		catch(std::exception &ex) {
+			std::cerr<<"lxp32bridge: "<<ex.what()<<std::endl;
+			inst.failed=true;
+			out=Bridge::Outputs();
+		}
+	}
+	
+	*lli_re=out.lliRe?1:0;
+	*lli_adr=toInt(out.lliAdr);
+	*dbus_cyc=out.dbusCyc?1:0;
+	*dbus_we=out.dbusWe?1:0;
+	*dbus_sel=toInt(out.dbusSel);
+	*dbus_adr=toInt(out.dbusAdr);
+	*dbus_dat_out=toInt(out.dbusDat);
+}
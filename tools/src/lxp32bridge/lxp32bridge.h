@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This header defines the C interface of the lxp32bridge shared
+ * library, which runs the lxp32sim CPU model in place of the LXP32U
+ * RTL core in an HDL simulation (see bridge.h). The functions are
+ * called by the lxp32u_iss VHDL entity through the GHDL VHPIDIRECT
+ * foreign subprogram interface (see lxp32bridge_pkg.vhd), so all
+ * arguments are VHDL integers: 32-bit words are passed as signed
+ * values and single bits as 0 or 1. Out parameters are passed by
+ * reference.
+ *
+ * lxp32bridge_create() creates a CPU instance with the values of
+ * the lxp32u_top generics (mul_arch: 0 - dsp, 1 - opt, 2 - seq) and
+ * returns its handle, or -1 on failure.
+ *
+ * lxp32bridge_cycle() is called on every rising clock edge with the
+ * input port values and returns the output port values to drive until
+ * the next edge (addresses are word addresses). "failed" is set to a
+ * non-zero value if the CPU model has failed (e.g. on an illegal
+ * instruction); the message is printed to the standard error stream
+ * and the outputs are inactive from then on.
+ */
+
+#ifndef LXP32BRIDGE_H_INCLUDED
+#define LXP32BRIDGE_H_INCLUDED
+
+#include <stdint.h>
+
+#ifdef _WIN32
+	#define LXP32BRIDGE_VISIBLE __declspec(dllexport)
+#else
+	#define LXP32BRIDGE_VISIBLE __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+	#define LXP32BRIDGE_EXPORT extern "C" LXP32BRIDGE_VISIBLE
+#else
+	#define LXP32BRIDGE_EXPORT LXP32BRIDGE_VISIBLE
+#endif
+
+LXP32BRIDGE_EXPORT int32_t lxp32bridge_create(int32_t dbus_rmw,int32_t divider_en,
+	int32_t mul_arch,int32_t start_addr);
+
+LXP32BRIDGE_EXPORT void lxp32bridge_cycle(int32_t handle,int32_t rst,
+	int32_t lli_dat,int32_t lli_busy,int32_t dbus_ack,int32_t dbus_dat_in,int32_t irq,
+	int32_t *lli_re,int32_t *lli_adr,int32_t *dbus_cyc,int32_t *dbus_we,int32_t *dbus_sel,
+	int32_t *dbus_adr,int32_t *dbus_dat_out,int32_t *failed);
+
+#endif
@@ -0,0 +1,23 @@
+---------------------------------------------------------------------
+-- lxp32bridge foreign subprograms
+--
+-- Part of the LXP32 CPU IP core
+--
+-- Copyright (c) 2016 by Alex I. Kuznetsov
+--
+-- Declares the functions of the lxp32bridge shared library (see
+-- lxp32bridge.h) as GHDL VHPIDIRECT foreign subprograms. Words are
+-- passed as integers, single bits as 0 or 1.
+---------------------------------------------------------------------
+
+package lxp32bridge_pkg is
+	-- Create a CPU instance, return its handle (-1 on failure)
+	impure function lxp32bridge_create(dbus_rmw,divider_en,mul_arch,start_addr: integer) return integer;
+	attribute foreign of lxp32bridge_create: function is "VHPIDIRECT lxp32bridge_create";
+	
+	-- Pass the inputs sampled on a rising clock edge, get the outputs
+	-- to drive until the next edge
+	procedure lxp32bridge_cycle(handle,rst,lli_dat,lli_busy,dbus_ack,dbus_dat_in,irq: integer;
+		lli_re,lli_adr,dbus_cyc,dbus_we,dbus_sel,dbus_adr,dbus_dat_out,failed: out integer);
+	attribute foreign of lxp32bridge_cycle: procedure is "VHPIDIRECT lxp32bridge_cycle";
+end package;
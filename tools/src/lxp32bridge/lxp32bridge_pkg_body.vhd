@@ -0,0 +1,24 @@
+---------------------------------------------------------------------
+-- lxp32bridge foreign subprograms
+--
+-- Part of the LXP32 CPU IP core
+--
+-- Copyright (c) 2016 by Alex I. Kuznetsov
+--
+-- The bodies are required by the language, but are replaced by the
+-- foreign implementations and never executed.
+---------------------------------------------------------------------
+
+package body lxp32bridge_pkg is
+	impure function lxp32bridge_create(dbus_rmw,divider_en,mul_arch,start_addr: integer) return integer is
+	begin
+		report "lxp32bridge_create: the lxp32bridge library is not linked" severity failure;
+		return -1;
+	end function;
+	
+	procedure lxp32bridge_cycle(handle,rst,lli_dat,lli_busy,dbus_ack,dbus_dat_in,irq: integer;
+		lli_re,lli_adr,dbus_cyc,dbus_we,dbus_sel,dbus_adr,dbus_dat_out,failed: out integer) is
+	begin
+		report "lxp32bridge_cycle: the lxp32bridge library is not linked" severity failure;
+	end procedure;
+end package body;
@@ -0,0 +1,142 @@
+---------------------------------------------------------------------
+-- LXP32U instruction set simulator
+--
+-- Part of the LXP32 CPU IP core
+--
+-- Copyright (c) 2016 by Alex I. Kuznetsov
+--
+-- A drop-in replacement for lxp32u_top (same generics and ports)
+-- which runs the lxp32sim CPU model through the lxp32bridge library
+-- instead of simulating the RTL pipeline. Intended for testbenches
+-- of peripherals, where the CPU only has to execute the firmware.
+--
+-- The buses follow the LLI and WISHBONE protocols, but the timing is
+-- not cycle accurate: instruction fetches are not pipelined, and all
+-- outputs are registered.
+--
+-- Requires GHDL: analyze lxp32bridge_pkg.vhd, lxp32bridge_pkg_body.vhd
+-- and this file, then link the library during elaboration, e.g.:
+--     ghdl -e -Wl,-L<dir> -Wl,-llxp32bridge tb
+--
+-- Note: this description is not synthesizable.
+---------------------------------------------------------------------
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+use work.lxp32bridge_pkg.all;
+
+entity lxp32u_iss is
+	generic(
+		DBUS_RMW: boolean:=false;
+		DIVIDER_EN: boolean:=true;
+		MUL_ARCH: string:="dsp";
+		START_ADDR: std_logic_vector(31 downto 0):=(others=>'0')
+	);
+	port(
+		clk_i: in std_logic;
+		rst_i: in std_logic;
+		
+		lli_re_o: out std_logic;
+		lli_adr_o: out std_logic_vector(29 downto 0);
+		lli_dat_i: in std_logic_vector(31 downto 0);
+		lli_busy_i: in std_logic;
+		
+		dbus_cyc_o: out std_logic;
+		dbus_stb_o: out std_logic;
+		dbus_we_o: out std_logic;
+		dbus_sel_o: out std_logic_vector(3 downto 0);
+		dbus_ack_i: in std_logic;
+		dbus_adr_o: out std_logic_vector(31 downto 2);
+		dbus_dat_o: out std_logic_vector(31 downto 0);
+		dbus_dat_i: in std_logic_vector(31 downto 0);
+		
+		irq_i: in std_logic_vector(7 downto 0)
+	);
+end entity;
+
+architecture sim of lxp32u_iss is
+
+function mul_arch_code(arch: string) return integer is
+begin
+	if arch="dsp" then
+		return 0;
+	elsif arch="opt" then
+		return 1;
+	elsif arch="seq" then
+		return 2;
+	end if;
+	report "Invalid MUL_ARCH generic value" severity failure;
+	return 0;
+end function;
+
+-- Metavalues are converted to zeros
+
+function to_int(s: std_logic) return integer is
+begin
+	if to_X01(s)='1' then
+		return 1;
+	else
+		return 0;
+	end if;
+end function;
+
+function to_int(v: std_logic_vector) return integer is
+begin
+	if v'length=32 then
+		return to_integer(to_01(signed(v)));
+	else
+		return to_integer(to_01(unsigned(v)));
+	end if;
+end function;
+
+begin
+
+process (clk_i) is
+	variable handle: integer:=lxp32bridge_create(boolean'pos(DBUS_RMW),
+		boolean'pos(DIVIDER_EN),mul_arch_code(MUL_ARCH),to_int(START_ADDR));
+	variable lli_re: integer;
+	variable lli_adr: integer;
+	variable dbus_cyc: integer;
+	variable dbus_we: integer;
+	variable dbus_sel: integer;
+	variable dbus_adr: integer;
+	variable dbus_dat: integer;
+	variable failed: integer;
+begin
+	if rising_edge(clk_i) then
+		lxp32bridge_cycle(handle,to_int(rst_i),to_int(lli_dat_i),to_int(lli_busy_i),
+			to_int(dbus_ack_i),to_int(dbus_dat_i),to_int(irq_i),
+			lli_re,lli_adr,dbus_cyc,dbus_we,dbus_sel,dbus_adr,dbus_dat,failed);
+		
+		assert failed=0
+			report "LXP32 instruction set simulator has failed (see lxp32bridge messages)"
+			severity failure;
+		
+		if lli_re=0 then
+			lli_re_o<='0';
+		else
+			lli_re_o<='1';
+		end if;
+		lli_adr_o<=std_logic_vector(to_unsigned(lli_adr,30));
+		
+		if dbus_cyc=0 then
+			dbus_cyc_o<='0';
+			dbus_stb_o<='0';
+		else
+			dbus_cyc_o<='1';
+			dbus_stb_o<='1';
+		end if;
+		if dbus_we=0 then
+			dbus_we_o<='0';
+		else
+			dbus_we_o<='1';
+		end if;
+		dbus_sel_o<=std_logic_vector(to_unsigned(dbus_sel,4));
+		dbus_adr_o<=std_logic_vector(to_unsigned(dbus_adr,30));
+		dbus_dat_o<=std_logic_vector(to_signed(dbus_dat,32));
+	end if;
+end process;
+
+end architecture;
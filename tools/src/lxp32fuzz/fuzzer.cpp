@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Fuzzer class.
+ */
+
+#include "fuzzer.h"
+#include "refmodel.h"
+#include "assembler.h"
+#include "linker.h"
+#include "outputwriter.h"
+#include "disassembler.h"
+#include "cpu.h"
+#include "batch.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <random>
+
+namespace {
+	const std::size_t MemoryWords=Generator::DataEnd/4;
+	const std::size_t BatchLanes=4;
+
+/*
+ * Collects linker output in memory
+ */
+	class MemoryOutputWriter : public OutputWriter {
+		std::vector<Fuzzer::Word> &_words;
+		std::string _buf;
+	public:
+		MemoryOutputWriter(std::vector<Fuzzer::Word> &words): _words(words) {}
+	protected:
+		virtual void writeData(const char *data,std::size_t n) override {
+			for(std::size_t i=0;i<n;i++) {
+				_buf.push_back(data[i]);
+				if(_buf.size()==sizeof(Fuzzer::Word)) {
+					_words.push_back((static_cast<unsigned char>(_buf[3])<<24)|
+						(static_cast<unsigned char>(_buf[2])<<16)|
+						(static_cast<unsigned char>(_buf[1])<<8)|
+						static_cast<unsigned char>(_buf[0]));
+					_buf.clear();
+				}
+			}
+		}
+	};
+
+/*
+ * A flat memory without wait states and interrupts. Addresses
+ * wrap around, like in the reference model.
+ */
+	class FlatBus : public Bus {
+		std::vector<Word> _memory;
+	public:
+		FlatBus(const std::vector<Word> &code): _memory(MemoryWords) {
+			for(std::size_t i=0;i<code.size()&&i<_memory.size();i++) _memory[i]=code[i];
+		}
+		
+		Word word(Word addr) const {
+			return _memory[(addr>>2)%_memory.size()];
+		}
+		
+		virtual unsigned fetch(Word addr,Word &data) override {
+			data=word(addr);
+			return 0;
+		}
+		
+		virtual unsigned read(Word addr,Word,Word &data) override {
+			data=word(addr);
+			return 0;
+		}
+		
+		virtual unsigned write(Word addr,Word sel,Word data) override {
+			auto &w=_memory[(addr>>2)%_memory.size()];
+			for(int i=0;i<4;i++) {
+				Word mask=Word(0xFF)<<(i*8);
+				if(sel&(1<<i)) w=(w&~mask)|(data&mask);
+			}
+			return 0;
+		}
+		
+		virtual std::uint8_t clock() override {
+			return 0;
+		}
+	};
+	
+	std::string hex(Fuzzer::Word w) {
+		return "0x"+Disassembler::hex(w);
+	}
+}
+
+void Fuzzer::setMaxItems(std::size_t n) {
+	_maxItems=n;
+}
+
+Fuzzer::Result Fuzzer::run(std::uint64_t seed) const {
+	Result res;
+	res.seed=seed;
+	
+	Generator gen(seed);
+	bool executable=(seed%4)!=0;
+	auto program=gen.generate(executable,_maxItems);
+	
+	res.status=check(program,executable,res.message);
+	if(res.status==Passed) return res;
+	
+	program=minimize(program,executable,res.status);
+	check(program,executable,res.message);
+	res.source=Generator::source(program);
+	return res;
+}
+
+std::string Fuzzer::statusString(Status status) {
+	switch(status) {
+	case Passed:
+		return "passed";
+	case AssemblerError:
+		return "assembler error";
+	case RoundTripMismatch:
+		return "round trip mismatch";
+	default:
+		return "execution mismatch";
+	}
+}
+
+/*
+ * Private members
+ */
+
+Fuzzer::Status Fuzzer::check(const Program &program,bool executable,std::string &message) const {
+	std::vector<Word> code;
+	
+	try {
+		code=assemble(Generator::source(program));
+	}
+	catch(std::exception &ex) {
+		message=ex.what();
+		return AssemblerError;
+	}
+	
+	auto status=roundTrip(code,true,message);
+	if(status==Passed) status=roundTrip(code,false,message);
+	if(status==Passed&&executable) status=execute(code,message);
+	if(status==Passed&&executable) status=executeBatch(code,message);
+	return status;
+}
+
+/*
+ * Try to remove chunks of items, starting with large chunks.
+ * A reduced program is accepted if it fails in the same way.
+ */
+
+Fuzzer::Program Fuzzer::minimize(Program program,bool executable,Status status) const {
+	std::string message;
+	auto chunk=program.size()/2;
+	
+	while(chunk>0) {
+		bool reduced=false;
+		for(std::size_t i=0;i<program.size();) {
+			Program candidate(program.begin(),program.begin()+i);
+			auto end=std::min(i+chunk,program.size());
+			candidate.insert(candidate.end(),program.begin()+end,program.end());
+			if(!candidate.empty()&&check(candidate,executable,message)==status) {
+				program=std::move(candidate);
+				reduced=true;
+			}
+			else i+=chunk;
+		}
+		if(!reduced) chunk/=2;
+	}
+	
+	return program;
+}
+
+Fuzzer::Status Fuzzer::roundTrip(const std::vector<Word> &code,bool aliases,std::string &message) const {
+	auto listing=disassemble(code,aliases);
+	std::vector<Word> code2;
+	
+	try {
+		code2=assemble(listing);
+	}
+	catch(std::exception &ex) {
+		message="disassembler output can't be assembled";
+		if(!aliases) message+=" (aliases disabled)";
+		message+=": ";
+		message+=ex.what();
+		return RoundTripMismatch;
+	}
+	
+	for(std::size_t i=0;i<code.size()||i<code2.size();i++) {
+		if(i<code.size()&&i<code2.size()&&code[i]==code2[i]) continue;
+		std::ostringstream ss;
+		ss<<"word "<<i<<" differs after round trip";
+		if(!aliases) ss<<" (aliases disabled)";
+		ss<<": ";
+		ss<<(i<code.size()?hex(code[i]):"none")<<" (original), ";
+		ss<<(i<code2.size()?hex(code2[i]):"none")<<" (reassembled)";
+		message=ss.str();
+		return RoundTripMismatch;
+	}
+	
+	return Passed;
+}
+
+Fuzzer::Status Fuzzer::execute(const std::vector<Word> &code,std::string &message) const {
+	if(code.size()*4>Generator::DataStart) {
+		message="program doesn't fit below the data area";
+		return AssemblerError;
+	}
+	
+	FlatBus bus(code);
+	Cpu cpu(bus);
+	RefModel ref(MemoryWords*4);
+	ref.load(code);
+	
+	auto end=static_cast<Word>(code.size()*4);
+	auto maxSteps=code.size()+1; // only forward jumps
+	std::size_t steps=0;
+	
+	try {
+		while(cpu.pc()!=end||ref.pc()!=end) {
+			if(steps++>maxSteps) throw std::runtime_error("program doesn't terminate");
+			auto pc=cpu.pc();
+			cpu.step();
+			ref.step();
+			if(cpu.pc()!=ref.pc()) {
+				message="instruction at "+hex(pc)+": next pc "+hex(cpu.pc())+
+					" (simulator), "+hex(ref.pc())+" (reference)";
+				return ExecutionMismatch;
+			}
+		}
+	}
+	catch(std::exception &ex) {
+		message=ex.what();
+		return ExecutionMismatch;
+	}
+	
+	for(int r=0;r<256;r++) {
+		if(cpu.reg(r)==ref.reg(r)) continue;
+		message=Cpu::registerName(r)+" = "+hex(cpu.reg(r))+" (simulator), "+hex(ref.reg(r))+" (reference)";
+		return ExecutionMismatch;
+	}
+	
+	for(Word addr=0;addr<Generator::DataEnd;addr+=4) {
+		if(bus.word(addr)==ref.memoryWord(addr)) continue;
+		message="memory at "+hex(addr)+" = "+hex(bus.word(addr))+" (simulator), "+
+			hex(ref.memoryWord(addr))+" (reference)";
+		return ExecutionMismatch;
+	}
+	
+	return Passed;
+}
+
+/*
+ * Lane 0 runs with zeroed data, like execute(), the other lanes with
+ * pseudo-random data (the same for every program). A lane stops when
+ * it runs past the end of the code, which the batch engine reports as
+ * unsupported, so a lane is expected to have executed as many
+ * instructions as the reference model at that point.
+ */
+
+Fuzzer::Status Fuzzer::executeBatch(const std::vector<Word> &code,std::string &message) const {
+	Batch batch(code,BatchLanes);
+	std::vector<RefModel> refs(BatchLanes,RefModel(MemoryWords*4));
+	std::vector<std::size_t> steps(BatchLanes,0);
+	
+	auto end=static_cast<Word>(code.size()*4);
+	auto maxSteps=code.size()+1; // only forward jumps
+	
+	for(std::size_t lane=0;lane<BatchLanes;lane++) {
+		auto &ref=refs[lane];
+		ref.load(code);
+		if(lane>0) {
+			std::mt19937 rng(static_cast<std::mt19937::result_type>(lane));
+			for(Word addr=Generator::DataStart;addr<Generator::DataEnd;addr+=4) {
+				Word w=rng();
+				batch.write(lane,addr,w);
+				ref.setMemoryWord(addr,w);
+			}
+		}
+		while(ref.pc()!=end) {
+			if(steps[lane]++>maxSteps) {
+				message="batch lane "+std::to_string(lane)+": program doesn't terminate";
+				return ExecutionMismatch;
+			}
+			ref.step();
+		}
+	}
+	
+	try {
+		batch.run(static_cast<Batch::Counter>(maxSteps)*64);
+	}
+	catch(std::exception &ex) {
+		message=ex.what();
+		return ExecutionMismatch;
+	}
+	
+	for(std::size_t lane=0;lane<BatchLanes;lane++) {
+		auto const &ref=refs[lane];
+		std::string prefix="batch lane "+std::to_string(lane)+": ";
+		
+		if(batch.status(lane)!=Batch::Unsupported||batch.instructions(lane)!=steps[lane]) {
+			message=prefix+"stopped after "+std::to_string(batch.instructions(lane))+
+				" instruction(s), "+std::to_string(steps[lane])+" expected";
+			return ExecutionMismatch;
+		}
+		
+		for(int r=0;r<256;r++) {
+			if(batch.reg(lane,r)==ref.reg(r)) continue;
+			message=prefix+Cpu::registerName(r)+" = "+hex(batch.reg(lane,r))+" (batch), "+
+				hex(ref.reg(r))+" (reference)";
+			return ExecutionMismatch;
+		}
+		
+		for(Word addr=0;addr<Generator::DataEnd;addr+=4) {
+			if(batch.read(lane,addr)==ref.memoryWord(addr)) continue;
+			message=prefix+"memory at "+hex(addr)+" = "+hex(batch.read(lane,addr))+" (batch), "+
+				hex(ref.memoryWord(addr))+" (reference)";
+			return ExecutionMismatch;
+		}
+	}
+	
+	return Passed;
+}
+
+std::vector<Fuzzer::Word> Fuzzer::assemble(const std::string &source) {
+	std::istringstream in(source);
+	Assembler as;
+	try {
+		as.processStream(in,"fuzz.asm");
+	}
+	catch(std::exception &ex) {
+		throw std::runtime_error("line "+std::to_string(as.line())+": "+ex.what());
+	}
+	
+	std::vector<Word> code;
+	MemoryOutputWriter writer(code);
+	Linker linker;
+	linker.addObject(as.object());
+	linker.link(writer);
+	return code;
+}
+
+std::string Fuzzer::disassemble(const std::vector<Word> &code,bool aliases) {
+	std::stringstream image(std::ios_base::in|std::ios_base::out|std::ios_base::binary);
+	for(auto w: code) {
+		char buf[4];
+		for(int i=0;i<4;i++) buf[i]=static_cast<char>(w>>(i*8));
+		image.write(buf,4);
+	}
+	
+	std::ostringstream listing;
+	Disassembler disasm(image,listing);
+	disasm.setFormat(Disassembler::Bin);
+	disasm.setPreferAliases(aliases);
+	disasm.dump();
+	return listing.str();
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Fuzzer class which runs a single
+ * differential test case:
+ *
+ * 1. A random program is assembled and linked.
+ * 2. The binary is disassembled (with and without aliases), the
+ *    listing is assembled again and the binaries are compared.
+ * 3. Executable programs are run on the simulator CPU model and
+ *    on an independent reference model (see RefModel), comparing
+ *    the program counter after each instruction and the complete
+ *    architectural state at the end.
+ * 4. Executable programs are also run on the batch engine (see Batch)
+ *    in several lanes, each lane with different data in the data
+ *    area, so that the lanes diverge. The state of each lane at the
+ *    end is compared with a reference model run on the same data.
+ *
+ * Failing programs are minimized by removing items while the
+ * failure persists.
+ */
+
+#ifndef FUZZER_H_INCLUDED
+#define FUZZER_H_INCLUDED
+
+#include "generator.h"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class Fuzzer {
+public:
+	typedef Generator::Word Word;
+	typedef Generator::Program Program;
+	
+	enum Status {Passed,AssemblerError,RoundTripMismatch,ExecutionMismatch};
+	
+	struct Result {
+		std::uint64_t seed;
+		Status status;
+		std::string message;
+		std::string source; // minimized program
+	};
+
+private:
+	std::size_t _maxItems=64;
+
+public:
+	void setMaxItems(std::size_t n);
+	
+	Result run(std::uint64_t seed) const;
+	
+	static std::string statusString(Status status);
+
+private:
+	Status check(const Program &program,bool executable,std::string &message) const;
+	Program minimize(Program program,bool executable,Status status) const;
+	
+	Status roundTrip(const std::vector<Word> &code,bool aliases,std::string &message) const;
+	Status execute(const std::vector<Word> &code,std::string &message) const;
+	Status executeBatch(const std::vector<Word> &code,std::string &message) const;
+	
+	static std::vector<Word> assemble(const std::string &source);
+	static std::string disassemble(const std::vector<Word> &code,bool aliases);
+};
+
+#endif
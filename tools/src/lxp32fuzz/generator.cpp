@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Generator class.
+ */
+
+#include "generator.h"
+
+#include <sstream>
+#include <iomanip>
+
+namespace {
+	const char *aluOps[]={"add","sub","mul","and","or","xor","divu","divs","modu","mods"};
+	const char *shiftOps[]={"sl","sru","srs"};
+	const char *unaryOps[]={"mov","neg","not"};
+	const char *loadOps[]={"lw","lub","lsb"};
+	const char *branchOps[]={"cjmpe","cjmpne","cjmpug","cjmpuge","cjmpul","cjmpule",
+		"cjmpsg","cjmpsge","cjmpsl","cjmpsle"};
+	const char *aliases[]={"iv0","iv1","iv2","iv3","iv4","iv5","iv6","iv7","cr","irp","rp","sp"};
+	
+	template <typename T,std::size_t N> std::size_t count(T (&)[N]) {
+		return N;
+	}
+	
+	std::string hex(Generator::Word w) {
+		std::ostringstream ss;
+		ss<<"0x"<<std::hex<<std::uppercase<<std::setfill('0')<<std::setw(8)<<w;
+		return ss.str();
+	}
+}
+
+Generator::Generator(std::uint64_t seed): _rng(seed) {}
+
+Generator::Program Generator::generate(bool executable,std::size_t maxItems) {
+	Program program;
+	_executable=executable;
+	_labels=0;
+	
+// Executable programs start with random register values
+	if(executable) {
+		for(int i=0;i<DataRegs;i++)
+			program.push_back(Item {"lc r"+std::to_string(i)+", "+hex(randomWord())});
+	}
+	
+	auto n=static_cast<std::size_t>(random(1,static_cast<int>(maxItems)));
+	
+	for(std::size_t i=0;i<n;i++) {
+		auto kind=random(0,99);
+		if(kind<60) program.push_back(instruction());
+		else if(kind<80) program.push_back(memoryAccess());
+		else if(kind<93) program.push_back(branch());
+		else program.push_back(jump());
+	}
+	
+	return program;
+}
+
+std::string Generator::source(const Program &program) {
+	std::string str;
+	for(auto const &item: program) {
+		for(auto const &line: item) str+=line+"\n";
+	}
+	return str;
+}
+
+/*
+ * Private members
+ */
+
+Generator::Item Generator::instruction() {
+	auto kind=random(0,99);
+	std::string dst=reg();
+	
+	if(kind<40) {
+		std::string op=aluOps[random(0,count(aluOps)-1)];
+		return Item {op+" "+dst+", "+rd()+", "+rd()};
+	}
+	else if(kind<55) {
+		std::string op=shiftOps[random(0,count(shiftOps)-1)];
+		return Item {op+" "+dst+", "+rd()+", "+shift()};
+	}
+	else if(kind<70) {
+		std::string op=unaryOps[random(0,count(unaryOps)-1)];
+		return Item {op+" "+dst+", "+rd()};
+	}
+	else if(kind<80) return Item {"lc "+dst+", "+hex(randomWord())};
+	else if(kind<90) return Item {"lcs "+dst+", "+constant()};
+	else if(kind<95||_executable) return Item {"nop"};
+	
+// Instructions that can't be executed by a generated program
+	switch(random(0,3)) {
+	case 0:
+		return Item {"hlt"};
+	case 1:
+		return Item {"ret"};
+	case 2:
+		return Item {"iret"};
+	default:
+		return Item {".word "+hex(randomWord())};
+	}
+}
+
+Generator::Item Generator::memoryAccess() {
+	Item item;
+	std::string base=reg();
+	
+	if(_executable) {
+		base="r"+std::to_string(TempReg);
+		auto addr=static_cast<Word>(random(static_cast<int>(DataStart),static_cast<int>(DataEnd-1)));
+		item.push_back("lcs "+base+", "+hex(addr));
+	}
+	
+	auto kind=random(0,4);
+	if(kind<3) item.push_back(std::string(loadOps[kind])+" "+reg()+", "+base);
+	else if(kind==3) item.push_back("sw "+base+", "+rd());
+	else {
+		std::string src=rd();
+		if(src[0]!='r'&&random(0,1)) src=std::to_string(random(128,255)); // unsigned byte form
+		item.push_back("sb "+base+", "+src);
+	}
+	
+	return item;
+}
+
+/*
+ * Conditional jump over a few instructions. The target is loaded
+ * with "lc" from a label so that the linker relocation is exercised.
+ */
+
+Generator::Item Generator::branch() {
+	Item item;
+	auto target=label();
+	auto temp=_executable?"r"+std::to_string(TempReg):reg();
+	std::string op=branchOps[random(0,count(branchOps)-1)];
+	
+	item.push_back("lc "+temp+", "+target);
+	item.push_back(op+" "+temp+", "+rd()+", "+rd());
+	auto n=random(0,3);
+	for(int i=0;i<n;i++) item.push_back(instruction().at(0));
+	item.push_back(target+":");
+	item.push_back("nop");
+	
+	return item;
+}
+
+Generator::Item Generator::jump() {
+	Item item;
+	auto target=label();
+	auto temp=_executable?"r"+std::to_string(TempReg):reg();
+	
+	item.push_back("lc "+temp+", "+target);
+	item.push_back((random(0,1)?"jmp ":"call ")+temp);
+	auto n=random(0,2);
+	for(int i=0;i<n;i++) item.push_back(instruction().at(0));
+	item.push_back(target+":");
+	item.push_back("nop");
+	
+	return item;
+}
+
+int Generator::random(int min,int max) {
+	return std::uniform_int_distribution<int>(min,max)(_rng);
+}
+
+Generator::Word Generator::randomWord() {
+// Prefer values close to the boundaries
+	switch(random(0,7)) {
+	case 0:
+		return static_cast<Word>(random(-2,2));
+	case 1:
+		return 0x80000000+static_cast<Word>(random(-2,2));
+	default:
+		return static_cast<Word>(_rng());
+	}
+}
+
+std::string Generator::label() {
+	return "L"+std::to_string(_labels++);
+}
+
+std::string Generator::reg() {
+	if(_executable) return "r"+std::to_string(random(0,DataRegs-1));
+	if(random(0,15)==0) return aliases[random(0,count(aliases)-1)];
+	return "r"+std::to_string(random(0,255));
+}
+
+std::string Generator::rd() {
+	if(random(0,1)) return reg();
+	auto value=random(-128,127);
+	if(value>=0&&random(0,1)) {
+		std::ostringstream ss;
+		ss<<"0x"<<std::hex<<value;
+		return ss.str();
+	}
+	return std::to_string(value);
+}
+
+std::string Generator::shift() {
+	if(random(0,1)) return reg();
+	return std::to_string(random(0,31));
+}
+
+std::string Generator::constant() {
+	auto value=random(-1048576,1048575);
+	if(value<0&&random(0,1)) return hex(static_cast<Word>(value)); // 0xFFF00000-0xFFFFFFFF form
+	return std::to_string(value);
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Generator class which produces random
+ * LXP32 assembly programs. A program is a sequence of items, each
+ * item being one or more source lines that must be kept together
+ * (e.g. a constant load followed by a jump that uses it).
+ *
+ * Executable programs only use registers r0-r32, access memory
+ * in the data area and only jump forward, so they always run to
+ * the end of the code.
+ */
+
+#ifndef GENERATOR_H_INCLUDED
+#define GENERATOR_H_INCLUDED
+
+#include <vector>
+#include <string>
+#include <random>
+#include <cstdint>
+
+class Generator {
+public:
+	typedef std::uint32_t Word;
+	typedef std::vector<std::string> Item;
+	typedef std::vector<Item> Program;
+	
+// Data area used by executable programs (code must fit below it)
+	static const Word DataStart=0x8000;
+	static const Word DataEnd=0x10000;
+	static const int DataRegs=32;
+	static const int TempReg=32;
+
+private:
+	std::mt19937_64 _rng;
+	int _labels=0;
+	bool _executable=false;
+
+public:
+	Generator(std::uint64_t seed);
+	
+	Program generate(bool executable,std::size_t maxItems);
+	
+	static std::string source(const Program &program);
+
+private:
+	Item instruction();
+	Item memoryAccess();
+	Item branch();
+	Item jump();
+	
+	int random(int min,int max);
+	Word randomWord();
+	std::string label();
+	std::string reg();
+	std::string rd();
+	std::string shift();
+	std::string constant();
+};
+
+#endif
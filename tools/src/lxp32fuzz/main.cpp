@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * Main translation unit for the LXP32 differential fuzzer.
+ */
+
+#include "fuzzer.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+
+static void displayUsage(std::ostream &os,const char *program) {
+	os<<std::endl;
+	os<<"Usage:"<<std::endl;
+	os<<"    "<<program<<" [ option(s) ]"<<std::endl<<std::endl;
+	
+	os<<"Options:"<<std::endl;
+	os<<"    -h, --help   Display a short help message"<<std::endl;
+	os<<"    -j <n>       Number of worker threads, default: number of host CPU cores"<<std::endl;
+	os<<"    -k           Keep going after a failure"<<std::endl;
+	os<<"    -m <n>       Maximum number of generated items per program, default: 64"<<std::endl;
+	os<<"    -n <cases>   Number of test cases, default: unlimited"<<std::endl;
+	os<<"    -o <dir>     Directory for minimized failing programs, default: current"<<std::endl;
+	os<<"    -p <seconds> Progress report interval, default: 10"<<std::endl;
+	os<<"    -r <seed>    Run a single test case with the specified case seed"<<std::endl;
+	os<<"    -s <seed>    Random seed, default: random"<<std::endl;
+	os<<"    -t <seconds> Time limit, default: 10 (0 for unlimited)"<<std::endl;
+	os<<std::endl;
+	os<<"Each test case is a random program which is assembled, disassembled and"<<std::endl;
+	os<<"assembled again, then (for most cases) executed on the simulator CPU model"<<std::endl;
+	os<<"and on an independent reference model. Failing programs are minimized and"<<std::endl;
+	os<<"saved as assembly source files."<<std::endl;
+}
+
+static std::uint64_t parseNumber(const char *str,const char *what) {
+	try {
+		return std::stoull(str,nullptr,0);
+	}
+	catch(std::exception &) {
+		throw std::runtime_error(std::string("Invalid ")+what);
+	}
+}
+
+// SplitMix64, used to derive independent case seeds from the main seed
+static std::uint64_t caseSeed(std::uint64_t seed,std::uint64_t index) {
+	std::uint64_t z=seed+(index+1)*0x9E3779B97F4A7C15ULL;
+	z=(z^(z>>30))*0xBF58476D1CE4E5B9ULL;
+	z=(z^(z>>27))*0x94D049BB133111EBULL;
+	return z^(z>>31);
+}
+
+static std::string hex(std::uint64_t value) {
+	std::ostringstream ss;
+	ss<<"0x"<<std::hex<<std::uppercase<<std::setfill('0')<<std::setw(16)<<value;
+	return ss.str();
+}
+
+static void reportFailure(const Fuzzer::Result &res,const std::string &dir) {
+	std::ostringstream text;
+	text<<"// "<<Fuzzer::statusString(res.status)<<": "<<res.message<<std::endl;
+	text<<"// Case seed: "<<hex(res.seed)<<std::endl;
+	text<<std::endl;
+	text<<res.source;
+	
+	std::string filename=dir;
+	if(!filename.empty()&&filename.back()!='/'&&filename.back()!='\\') filename.push_back('/');
+	filename+="fuzz-"+hex(res.seed).substr(2)+".asm";
+	
+	std::ofstream out(filename);
+	if(out) out<<text.str();
+	
+	std::cout<<"FAILURE ("<<Fuzzer::statusString(res.status)<<"): "<<res.message<<std::endl;
+	std::cout<<"Case seed: "<<hex(res.seed);
+	if(out) std::cout<<", minimized program written to \""<<filename<<"\"";
+	std::cout<<std::endl;
+}
+
+int main(int argc,char *argv[]) try {
+	Fuzzer fuzzer;
+	unsigned threads=0;
+	bool keepGoing=false;
+	std::uint64_t maxCases=0;
+	std::string outputDir=".";
+	double progressInterval=10;
+	bool replay=false;
+	std::uint64_t replaySeed=0;
+	std::uint64_t seed=(std::uint64_t(std::random_device()())<<32)^std::random_device()();
+	double timeLimit=10;
+	
+	std::cout<<"LXP32 Differential Fuzzer"<<std::endl;
+	std::cout<<"Copyright (c) 2016-2019 by Alex I. Kuznetsov"<<std::endl;
+	
+	for(int i=1;i<argc;i++) {
+		if(!strcmp(argv[i],"-h")||!strcmp(argv[i],"--help")) {
+			displayUsage(std::cout,argv[0]);
+			return 0;
+		}
+		else if(!strcmp(argv[i],"-k")) {
+			keepGoing=true;
+		}
+		else if(!strcmp(argv[i],"-j")||!strcmp(argv[i],"-m")||!strcmp(argv[i],"-n")||
+			!strcmp(argv[i],"-o")||!strcmp(argv[i],"-p")||!strcmp(argv[i],"-r")||
+			!strcmp(argv[i],"-s")||!strcmp(argv[i],"-t"))
+		{
+			if(i+1==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			auto opt=argv[i++][1];
+			if(opt=='j') {
+				threads=static_cast<unsigned>(parseNumber(argv[i],"number of threads"));
+				if(threads==0) throw std::runtime_error("Invalid number of threads");
+			}
+			else if(opt=='m') {
+				auto n=parseNumber(argv[i],"number of items");
+				if(n==0) throw std::runtime_error("Invalid number of items");
+				fuzzer.setMaxItems(static_cast<std::size_t>(n));
+			}
+			else if(opt=='n') maxCases=parseNumber(argv[i],"number of test cases");
+			else if(opt=='o') outputDir=argv[i];
+			else if(opt=='p') progressInterval=static_cast<double>(parseNumber(argv[i],"progress interval"));
+			else if(opt=='r') {
+				replay=true;
+				replaySeed=parseNumber(argv[i],"case seed");
+			}
+			else if(opt=='s') seed=parseNumber(argv[i],"seed");
+			else timeLimit=static_cast<double>(parseNumber(argv[i],"time limit"));
+		}
+		else throw std::runtime_error(std::string("Unrecognized option: \"")+argv[i]+"\"");
+	}
+	
+	if(replay) {
+		auto res=fuzzer.run(replaySeed);
+		if(res.status==Fuzzer::Passed) {
+			std::cout<<"Case "<<hex(replaySeed)<<" passed"<<std::endl;
+			return 0;
+		}
+		reportFailure(res,outputDir);
+		std::cout<<res.source;
+		return EXIT_FAILURE;
+	}
+	
+	if(threads==0) threads=std::max(1u,std::thread::hardware_concurrency());
+	
+	std::cout<<"Seed: "<<hex(seed)<<", threads: "<<threads<<std::endl;
+	
+	std::atomic<std::uint64_t> nextCase(0);
+	std::atomic<std::uint64_t> done(0);
+	std::atomic<std::uint64_t> failures(0);
+	std::atomic<bool> stop(false);
+	std::mutex outputMutex;
+	
+	auto worker=[&]() {
+		while(!stop) {
+			auto index=nextCase++;
+			if(maxCases>0&&index>=maxCases) break;
+			auto res=fuzzer.run(caseSeed(seed,index));
+			if(res.status!=Fuzzer::Passed) {
+				failures++;
+				std::lock_guard<std::mutex> lock(outputMutex);
+				reportFailure(res,outputDir);
+				if(!keepGoing) stop=true;
+			}
+			done++;
+		}
+	};
+	
+	auto start=std::chrono::steady_clock::now();
+	std::vector<std::thread> pool;
+	for(unsigned i=0;i<threads;i++) pool.emplace_back(worker);
+	
+	auto lastReport=start;
+	std::uint64_t lastDone=0;
+	
+	for(;;) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		auto now=std::chrono::steady_clock::now();
+		std::chrono::duration<double> elapsed=now-start;
+		if(maxCases>0&&done>=maxCases) break;
+		if(stop) break;
+		if(timeLimit>0&&elapsed.count()>=timeLimit) break;
+		
+		std::chrono::duration<double> sinceReport=now-lastReport;
+		if(progressInterval>0&&sinceReport.count()>=progressInterval) {
+			std::uint64_t n=done;
+			std::lock_guard<std::mutex> lock(outputMutex);
+			std::cout<<std::fixed<<std::setprecision(0)<<elapsed.count()<<" s: "<<n<<" cases, "<<failures<<
+				" failure(s), "<<static_cast<double>(n-lastDone)/sinceReport.count()<<" cases/s"<<std::endl;
+			lastReport=now;
+			lastDone=n;
+		}
+	}
+	
+	stop=true;
+	for(auto &t: pool) t.join();
+	
+	std::chrono::duration<double> elapsed=std::chrono::steady_clock::now()-start;
+	std::uint64_t n=done;
+	std::cout<<n<<" cases, "<<failures<<" failure(s) in "<<std::fixed<<std::setprecision(2)<<
+		elapsed.count()<<" s ("<<std::setprecision(0)<<static_cast<double>(n)/elapsed.count()<<" cases/s)"<<std::endl;
+	
+	if(failures>0) return EXIT_FAILURE;
+}
+catch(std::exception &ex) {
+	std::cerr<<"Error: "<<ex.what()<<std::endl;
+	return EXIT_FAILURE;
+}
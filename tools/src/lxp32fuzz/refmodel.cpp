@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the RefModel class.
+ */
+
+#include "refmodel.h"
+#include "cpu.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+RefModel::RefModel(std::size_t bytes): _memory(bytes) {
+	std::fill(_regs,_regs+256,0);
+}
+
+void RefModel::load(const std::vector<Word> &code) {
+	for(std::size_t i=0;i<code.size();i++) {
+		for(int b=0;b<4;b++) byte(static_cast<Word>(i*4+b))=static_cast<std::uint8_t>(code[i]>>(b*8));
+	}
+}
+
+void RefModel::setMemoryWord(Word addr,Word data) {
+	addr&=~Word(3);
+	for(int b=0;b<4;b++) byte(addr+b)=static_cast<std::uint8_t>(data>>(b*8));
+}
+
+void RefModel::step() {
+	Word w=read(_pc);
+	Word next=_pc+4;
+	
+	auto opcode=w>>26;
+	auto &dst=_regs[(w>>16)&0xFF];
+	bool t1=(w>>25)&1;
+	bool t2=(w>>24)&1;
+	Word a=t1?_regs[(w>>8)&0xFF]:Word(std::int32_t(std::int8_t((w>>8)&0xFF)));
+	Word b=t2?_regs[w&0xFF]:Word(std::int32_t(std::int8_t(w&0xFF)));
+	
+	if((w>>29)==5) { // lcs: 21-bit signed constant
+		Word c=((w>>8)&0x1F0000)|(w&0xFFFF);
+		dst=(c&0x100000)?(c|0xFFE00000):c;
+		_pc=next;
+		return;
+	}
+	
+	if((w>>30)==3) { // cjmpxx
+		bool taken;
+		switch(opcode&0x0F) {
+		case 0x8:
+			taken=(a==b);
+			break;
+		case 0x4:
+			taken=(a!=b);
+			break;
+		case 0x2:
+			taken=(a>b);
+			break;
+		case 0xA:
+			taken=(a>=b);
+			break;
+		case 0x1:
+			taken=(std::int32_t(a)>std::int32_t(b));
+			break;
+		case 0x9:
+			taken=(std::int32_t(a)>=std::int32_t(b));
+			break;
+		default:
+			throw std::runtime_error("Reference model: unsupported jump condition");
+		}
+		_pc=taken?(dst&~Word(3)):next;
+		return;
+	}
+	
+	switch(opcode) {
+	case 0x00: // nop
+		break;
+	case 0x01: // lc
+		dst=read(next);
+		next+=4;
+		break;
+	case 0x08: // lw
+		dst=read(a);
+		break;
+	case 0x0A: // lub
+		dst=byte(a);
+		break;
+	case 0x0B: // lsb
+		dst=Word(std::int32_t(std::int8_t(byte(a))));
+		break;
+	case 0x0C: // sw
+		for(int i=0;i<4;i++) byte((a&~Word(3))+i)=std::uint8_t(b>>(i*8));
+		break;
+	case 0x0E: // sb
+		byte(a)=std::uint8_t(b);
+		break;
+	case 0x10:
+		dst=a+b;
+		break;
+	case 0x11:
+		dst=a-b;
+		break;
+	case 0x12:
+		dst=Word(std::uint64_t(a)*b);
+		break;
+	case 0x14:
+		dst=divide(a,b,false,false);
+		break;
+	case 0x15:
+		dst=divide(a,b,true,false);
+		break;
+	case 0x16:
+		dst=divide(a,b,false,true);
+		break;
+	case 0x17:
+		dst=divide(a,b,true,true);
+		break;
+	case 0x18:
+		dst=a&b;
+		break;
+	case 0x19:
+		dst=a|b;
+		break;
+	case 0x1A:
+		dst=a^b;
+		break;
+	case 0x1C:
+		dst=a<<(b%32);
+		break;
+	case 0x1E:
+		dst=a>>(b%32);
+		break;
+	case 0x1F: // arithmetic shift, written out explicitly
+		{
+			auto n=b%32;
+			dst=a>>n;
+			if((a&0x80000000)&&n>0) dst|=~(~Word(0)>>n);
+		}
+		break;
+	case 0x20: // jmp
+	case 0x21: // call
+		if(opcode==0x21) dst=next;
+		next=a&~Word(3);
+		break;
+	default:
+		throw std::runtime_error("Reference model: unsupported instruction");
+	}
+	
+	_pc=next;
+}
+
+RefModel::Word RefModel::reg(int r) const {
+	return _regs[r&0xFF];
+}
+
+RefModel::Word RefModel::pc() const {
+	return _pc;
+}
+
+RefModel::Word RefModel::memoryWord(Word addr) const {
+	return read(addr);
+}
+
+/*
+ * Private members
+ */
+
+RefModel::Word RefModel::read(Word addr) const {
+	auto mask=static_cast<Word>(_memory.size()-1);
+	addr&=mask&~Word(3);
+	return Word(_memory[addr])|(Word(_memory[addr+1])<<8)|
+		(Word(_memory[addr+2])<<16)|(Word(_memory[addr+3])<<24);
+}
+
+std::uint8_t &RefModel::byte(Word addr) {
+	return _memory[addr&(_memory.size()-1)];
+}
+
+/*
+ * Plain integer division. Division by zero is the only case where
+ * the result is implementation-defined, so the divider model
+ * of the simulator is used for it.
+ */
+
+RefModel::Word RefModel::divide(Word a,Word b,bool sign,bool mod) {
+	if(b==0) return Cpu::divide(a,b,sign,mod);
+	if(!sign) return mod?(a%b):(a/b);
+	
+	auto sa=std::int64_t(std::int32_t(a));
+	auto sb=std::int64_t(std::int32_t(b));
+	return Word(mod?(sa%sb):(sa/sb));
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the RefModel class, a minimal functional
+ * model of the LXP32 instruction set written independently from
+ * the simulator. It is used as a reference to check the simulator
+ * results. Timing and interrupts are not modeled.
+ */
+
+#ifndef REFMODEL_H_INCLUDED
+#define REFMODEL_H_INCLUDED
+
+#include <vector>
+#include <cstdint>
+
+class RefModel {
+public:
+	typedef std::uint32_t Word;
+
+private:
+	Word _regs[256];
+	Word _pc=0;
+	std::vector<std::uint8_t> _memory;
+
+public:
+	RefModel(std::size_t bytes);
+	
+	void load(const std::vector<Word> &code);
+	void setMemoryWord(Word addr,Word data);
+	void step();
+	
+	Word reg(int r) const;
+	Word pc() const;
+	Word memoryWord(Word addr) const;
+
+private:
+	Word read(Word addr) const;
+	std::uint8_t &byte(Word addr);
+	static Word divide(Word a,Word b,bool sign,bool mod);
+};
+
+#endif
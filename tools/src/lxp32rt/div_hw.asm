@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_divu and rt_divs for cores with the divider and a fast
+ * multiplier: the remainder is obtained by multiplication, which is
+ * faster than a second division.
+ */
+
+#variant "div,mul=dsp,mul=opt"
+
+#export rt_divu
+#export rt_divs
+
+rt_divu:
+	divu r0, r1, r2
+	mul r3, r0, r2
+	sub r1, r1, r3
+	ret
+
+rt_divs:
+	divs r0, r1, r2
+	mul r3, r0, r2
+	sub r1, r1, r3
+	ret
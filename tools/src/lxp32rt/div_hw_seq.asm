@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_divu and rt_divs for cores with the divider and the sequential
+ * multiplier, which is slower than the modulo instructions.
+ */
+
+#variant "div,mul=seq"
+
+#export rt_divu
+#export rt_divs
+
+rt_divu:
+	divu r0, r1, r2
+	modu r1, r1, r2
+	ret
+
+rt_divs:
+	divs r0, r1, r2
+	mods r1, r1, r2
+	ret
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_divu and rt_divs for cores without the divider: the restoring
+ * algorithm is used, since it is faster on LXP32 than the
+ * non-restoring one (not taken branches are cheap, and shifts are
+ * replaced with additions).
+ */
+
+#variant "nodiv"
+
+#define SDIV_ROUTINE rt_divu
+
+#export rt_divu
+#export rt_divs
+
+rt_divs:
+#include "sdiv.inc"
+
+rt_divu:
+#include "udiv_restoring.inc"
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_divs_restoring - signed division of r1 by r2 using the restoring
+ * algorithm, available for all core configurations (see sdiv.inc).
+ * Quotient in r0, remainder in r1. Used by code which selects the
+ * division routine at run time.
+ */
+
+#define SDIV_ROUTINE rt_divu_restoring
+
+#export rt_divs_restoring
+#import rt_divu_restoring
+
+rt_divs_restoring:
+#include "sdiv.inc"
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_divu_nonrestoring - unsigned division of r1 by r2 using the
+ * non-restoring algorithm, available for all core configurations.
+ * Quotient in r0, remainder in r1.
+ *
+ * The partial remainder (r5) is kept in the range [-divisor,divisor),
+ * the divisor is subtracted from it if it is non-negative and added
+ * otherwise, and the quotient bit is 1 if the result is non-negative.
+ * The addend is selected with a mask instead of a branch, so except
+ * for divisors with the top bit set the routine takes the same number
+ * of cycles for any operands. Each quotient bit is set in advance and
+ * cleared at the start of the next step if the partial remainder has
+ * turned out negative, which reuses the mask.
+ */
+
+#export rt_divu_nonrestoring
+
+rt_divu_nonrestoring:
+	lc r3, divu_nonrestoring_big
+	cjmpsl r3, r2, 0
+	neg r8, r2
+	xor r7, r8, r2 // selects -divisor (mask 0) or divisor (mask -1)
+	mov r5, 0
+	mov r4, 4
+	lc r3, divu_nonrestoring_loop
+divu_nonrestoring_loop:
+	srs r6, r5, 31
+	add r1, r1, r6
+	sru r0, r1, 31
+	add r5, r5, r5
+	add r5, r5, r0
+	and r6, r6, r7
+	xor r6, r6, r8
+	add r5, r5, r6
+	add r1, r1, r1
+	add r1, r1, 1
+	srs r6, r5, 31
+	add r1, r1, r6
+	sru r0, r1, 31
+	add r5, r5, r5
+	add r5, r5, r0
+	and r6, r6, r7
+	xor r6, r6, r8
+	add r5, r5, r6
+	add r1, r1, r1
+	add r1, r1, 1
+	srs r6, r5, 31
+	add r1, r1, r6
+	sru r0, r1, 31
+	add r5, r5, r5
+	add r5, r5, r0
+	and r6, r6, r7
+	xor r6, r6, r8
+	add r5, r5, r6
+	add r1, r1, r1
+	add r1, r1, 1
+	srs r6, r5, 31
+	add r1, r1, r6
+	sru r0, r1, 31
+	add r5, r5, r5
+	add r5, r5, r0
+	and r6, r6, r7
+	xor r6, r6, r8
+	add r5, r5, r6
+	add r1, r1, r1
+	add r1, r1, 1
+	srs r6, r5, 31
+	add r1, r1, r6
+	sru r0, r1, 31
+	add r5, r5, r5
+	add r5, r5, r0
+	and r6, r6, r7
+	xor r6, r6, r8
+	add r5, r5, r6
+	add r1, r1, r1
+	add r1, r1, 1
+	srs r6, r5, 31
+	add r1, r1, r6
+	sru r0, r1, 31
+	add r5, r5, r5
+	add r5, r5, r0
+	and r6, r6, r7
+	xor r6, r6, r8
+	add r5, r5, r6
+	add r1, r1, r1
+	add r1, r1, 1
+	srs r6, r5, 31
+	add r1, r1, r6
+	sru r0, r1, 31
+	add r5, r5, r5
+	add r5, r5, r0
+	and r6, r6, r7
+	xor r6, r6, r8
+	add r5, r5, r6
+	add r1, r1, r1
+	add r1, r1, 1
+	srs r6, r5, 31
+	add r1, r1, r6
+	sru r0, r1, 31
+	add r5, r5, r5
+	add r5, r5, r0
+	and r6, r6, r7
+	xor r6, r6, r8
+	add r5, r5, r6
+	add r1, r1, r1
+	add r1, r1, 1
+	sub r4, r4, 1
+	cjmpne r3, r4, 0 // divu_nonrestoring_loop
+// Last quotient bit, restore a negative remainder
+	srs r6, r5, 31
+	add r1, r1, r6
+	and r6, r6, r2
+	add r5, r5, r6
+	mov r0, r1
+	mov r1, r5
+	ret
+divu_nonrestoring_big:
+// The quotient is 0 or 1
+	mov r0, 0
+	lc r3, divu_nonrestoring_done
+	cjmpul r3, r1, r2
+	sub r1, r1, r2
+	mov r0, 1
+divu_nonrestoring_done:
+	ret
@@ -0,0 +1,14 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_divu_restoring - unsigned division of r1 by r2 using the
+ * restoring algorithm, available for all core configurations
+ * (see udiv_restoring.inc). Quotient in r0, remainder in r1.
+ */
+
+#export rt_divu_restoring
+
+rt_divu_restoring:
+#include "udiv_restoring.inc"
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_emu_sdiv replaces "divs" and "mods" instructions on cores
+ * without the divider (see emu_frame.inc).
+ */
+
+#define EMU_ROUTINE rt_divs
+#define EMU_FRAME 56
+#define EMU_SIGNED
+
+#export rt_emu_sdiv
+#import rt_divs
+
+rt_emu_sdiv:
+#include "emu_frame.inc"
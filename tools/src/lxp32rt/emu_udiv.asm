@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_emu_udiv replaces "divu" and "modu" instructions on cores
+ * without the divider (see emu_frame.inc).
+ */
+
+#define EMU_ROUTINE rt_divu
+#define EMU_FRAME 44
+
+#export rt_emu_udiv
+#import rt_divu
+
+rt_emu_udiv:
+#include "emu_frame.inc"
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_memcpy - copies r3 bytes from r2 to r1 (the areas must not
+ * overlap), returns the destination address in r0. Available for
+ * all core configurations.
+ *
+ * Byte accesses are only used for up to 3 bytes at each end: the
+ * destination is aligned first, then whole words are copied, in
+ * blocks of 4 if the source is aligned too. Otherwise each word is
+ * assembled from two aligned source words with shifts; no word is
+ * read beyond the one holding the last source byte. Short blocks are
+ * copied byte by byte.
+ */
+
+#export rt_memcpy
+
+rt_memcpy:
+	mov r0, r1
+	lc r10, memcpy_bytes
+	cjmpul r10, r3, 8
+// Align the destination
+	lc r10, memcpy_head
+	lc r11, memcpy_aligned
+memcpy_head:
+	and r4, r1, 3
+	cjmpe r11, r4, 0 // memcpy_aligned
+	lub r5, r2
+	sb r1, r5
+	add r1, r1, 1
+	add r2, r2, 1
+	sub r3, r3, 1
+	jmp r10 // memcpy_head
+memcpy_aligned:
+	and r4, r2, 3
+	lc r10, memcpy_shifted
+	cjmpne r10, r4, 0
+// Both pointers are aligned: blocks of 4 words
+	sru r4, r3, 4
+	and r3, r3, 15
+	lc r10, memcpy_block
+	lc r11, memcpy_words
+	cjmpe r11, r4, 0 // memcpy_words
+memcpy_block:
+	lw r5, r2
+	add r2, r2, 4
+	lw r6, r2
+	add r2, r2, 4
+	lw r7, r2
+	add r2, r2, 4
+	lw r8, r2
+	add r2, r2, 4
+	sw r1, r5
+	add r1, r1, 4
+	sw r1, r6
+	add r1, r1, 4
+	sw r1, r7
+	add r1, r1, 4
+	sw r1, r8
+	add r1, r1, 4
+	sub r4, r4, 1
+	cjmpne r10, r4, 0 // memcpy_block
+memcpy_words:
+	sru r4, r3, 2
+	and r3, r3, 3
+	lc r10, memcpy_word
+	lc r11, memcpy_bytes
+	cjmpe r11, r4, 0 // memcpy_bytes
+memcpy_word:
+	lw r5, r2
+	add r2, r2, 4
+	sw r1, r5
+	add r1, r1, 4
+	sub r4, r4, 1
+	cjmpne r10, r4, 0 // memcpy_word
+memcpy_bytes:
+	lc r10, memcpy_byte
+	lc r11, memcpy_done
+	cjmpe r11, r3, 0 // memcpy_done
+memcpy_byte:
+	lub r5, r2
+	sb r1, r5
+	add r1, r1, 1
+	add r2, r2, 1
+	sub r3, r3, 1
+	cjmpne r10, r3, 0 // memcpy_byte
+memcpy_done:
+	ret
+memcpy_shifted:
+// The source is r4 bytes past a word boundary (little-endian): the
+// output word is the upper part of the current source word followed
+// by the lower part of the next one
+	sl r6, r4, 3
+	neg r7, r6
+	add r7, r7, 32
+	sub r2, r2, r4
+	sru r8, r3, 2 // at least one word
+	and r3, r3, 3
+	lw r5, r2
+// Copy one word if the number of words is odd, then pairs
+	and r9, r8, 1
+	lc r10, memcpy_shifted_pairs
+	cjmpe r10, r9, 0
+	add r2, r2, 4
+	lw r9, r2
+	sru r5, r5, r6
+	sl r11, r9, r7
+	or r5, r5, r11
+	sw r1, r5
+	add r1, r1, 4
+	mov r5, r9
+memcpy_shifted_pairs:
+	sru r8, r8, 1
+	lc r10, memcpy_shifted_pair
+	lc r11, memcpy_shifted_done
+	cjmpe r11, r8, 0 // memcpy_shifted_done
+memcpy_shifted_pair:
+	add r2, r2, 4
+	lw r9, r2
+	sru r5, r5, r6
+	sl r11, r9, r7
+	or r5, r5, r11
+	sw r1, r5
+	add r1, r1, 4
+	add r2, r2, 4
+	lw r5, r2
+	sru r9, r9, r6
+	sl r11, r5, r7
+	or r9, r9, r11
+	sw r1, r9
+	add r1, r1, 4
+	sub r8, r8, 1
+	cjmpne r10, r8, 0 // memcpy_shifted_pair
+memcpy_shifted_done:
+	add r2, r2, r4
+	lc r10, memcpy_bytes
+	jmp r10
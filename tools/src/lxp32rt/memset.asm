@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_memset - fills r3 bytes at r1 with the lower byte of r2,
+ * returns the destination address in r0. Available for all core
+ * configurations.
+ *
+ * Byte stores are only used for up to 3 bytes at each end, the rest
+ * is filled with word stores, in blocks of 4. Short blocks are filled
+ * byte by byte.
+ */
+
+#export rt_memset
+
+rt_memset:
+	mov r0, r1
+	sl r2, r2, 24
+	sru r2, r2, 24
+	lc r10, memset_bytes
+	cjmpul r10, r3, 8
+// Replicate the byte
+	sl r4, r2, 8
+	or r2, r2, r4
+	sl r4, r2, 16
+	or r2, r2, r4
+// Align the destination
+	lc r10, memset_head
+	lc r11, memset_aligned
+memset_head:
+	and r4, r1, 3
+	cjmpe r11, r4, 0 // memset_aligned
+	sb r1, r2
+	add r1, r1, 1
+	sub r3, r3, 1
+	jmp r10 // memset_head
+memset_aligned:
+	sru r4, r3, 4
+	and r3, r3, 15
+	lc r10, memset_block
+	lc r11, memset_words
+	cjmpe r11, r4, 0 // memset_words
+memset_block:
+	sw r1, r2
+	add r1, r1, 4
+	sw r1, r2
+	add r1, r1, 4
+	sw r1, r2
+	add r1, r1, 4
+	sw r1, r2
+	add r1, r1, 4
+	sub r4, r4, 1
+	cjmpne r10, r4, 0 // memset_block
+memset_words:
+	sru r4, r3, 2
+	and r3, r3, 3
+	lc r10, memset_word
+	lc r11, memset_bytes
+	cjmpe r11, r4, 0 // memset_bytes
+memset_word:
+	sw r1, r2
+	add r1, r1, 4
+	sub r4, r4, 1
+	cjmpne r10, r4, 0 // memset_word
+memset_bytes:
+	lc r10, memset_byte
+	lc r11, memset_done
+	cjmpe r11, r3, 0 // memset_done
+memset_byte:
+	sb r1, r2
+	add r1, r1, 1
+	sub r3, r3, 1
+	cjmpne r10, r3, 0 // memset_byte
+memset_done:
+	ret
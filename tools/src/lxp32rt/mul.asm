@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_mul for cores with a fast multiplier. Multiplies r1 by r2,
+ * the lower 32 bits of the product are returned in r0.
+ */
+
+#variant "mul=dsp,mul=opt"
+
+#export rt_mul
+
+rt_mul:
+	mul r0, r1, r2
+	ret
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * 64-bit multiplication routines based on rt_mulu64, available for
+ * all core configurations.
+ *
+ * rt_muls64 - signed 32x32 to 64-bit multiplication of r1 by r2:
+ *             lower word of the product in r0, upper word in r1
+ * rt_mul64  - 64x64 to 64-bit multiplication of r2:r1 by r4:r3
+ *             (upper:lower words), the product is returned in r1:r0
+ */
+
+#export rt_muls64
+#export rt_mul64
+#import rt_mulu64
+
+// The unsigned product of two's complement numbers is corrected
+// by subtracting each operand from the upper word if the other one
+// is negative
+
+rt_muls64:
+	mov r15, rp
+	mov r13, r1
+	mov r14, r2
+	lc r0, rt_mulu64
+	call r0
+	srs r3, r13, 31
+	and r3, r3, r14
+	sub r1, r1, r3
+	srs r3, r14, 31
+	and r3, r3, r13
+	sub r1, r1, r3
+	jmp r15
+	
+// Only the lower words of the cross products contribute
+
+rt_mul64:
+	mov r15, rp
+	mul r13, r1, r4
+	mul r14, r2, r3
+	add r13, r13, r14
+	mov r2, r3
+	lc r0, rt_mulu64
+	call r0
+	add r1, r1, r13
+	jmp r15
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_mul for cores with the sequential multiplier. Multiplies r1 by
+ * r2, the lower 32 bits of the product are returned in r0.
+ *
+ * The multiplier takes 34 cycles regardless of the operands, so
+ * shifts and additions (see mul_shiftadd.inc) are only faster when
+ * the smaller operand is less than MUL_SEQ_THRESHOLD.
+ */
+
+#variant "mul=seq"
+
+#define MUL_SEQ_THRESHOLD 4
+
+#export rt_mul
+
+rt_mul:
+	lc r3, mul_seq_ordered
+	cjmpuge r3, r1, r2
+	mov r3, r1
+	mov r1, r2
+	mov r2, r3
+mul_seq_ordered:
+	lc r3, mul_seq_hw
+	cjmpuge r3, r2, MUL_SEQ_THRESHOLD
+#include "mul_shiftadd.inc"
+mul_seq_hw:
+	mul r0, r1, r2
+	ret
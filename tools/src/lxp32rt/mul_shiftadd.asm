@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_mul_shiftadd - multiplication by shifts and additions,
+ * available for all core configurations (see mul_shiftadd.inc).
+ * Multiplies r1 by r2, the lower 32 bits of the product are returned
+ * in r0. The time is proportional to the number of significant bits
+ * of the smaller operand.
+ */
+
+#export rt_mul_shiftadd
+
+rt_mul_shiftadd:
+	lc r3, mul_shiftadd_ordered
+	cjmpuge r3, r1, r2
+	mov r3, r1
+	mov r1, r2
+	mov r2, r3
+mul_shiftadd_ordered:
+#include "mul_shiftadd.inc"
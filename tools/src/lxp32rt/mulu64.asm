@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_mulu64 for cores with a fast multiplier: unsigned 32x32 to
+ * 64-bit multiplication (see mulu64_full.inc).
+ */
+
+#variant "mul=dsp,mul=opt"
+
+#export rt_mulu64
+
+rt_mulu64:
+#include "mulu64_full.inc"
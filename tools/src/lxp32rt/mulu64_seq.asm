@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * rt_mulu64 for cores with the sequential multiplier: unsigned
+ * 32x32 to 64-bit multiplication (see mulu64_full.inc). Each
+ * multiplication takes 34 cycles, so partial products of zero upper
+ * halves are skipped: one multiplication is performed if both
+ * operands are less than 2^16, two if one of them is.
+ */
+
+#variant "mul=seq"
+
+#export rt_mulu64
+
+rt_mulu64:
+	sru r4, r1, 16
+	sru r6, r2, 16
+	lc r3, mulu64_seq_half
+	cjmpe r3, r4, 0
+	lc r3, mulu64_seq_full
+	cjmpne r3, r6, 0
+// Swap the operands, so that the upper half of r1 is zero
+	mov r3, r1
+	mov r1, r2
+	mov r2, r3
+	mov r6, r4
+mulu64_seq_half:
+	lcs r7, 0xFFFF
+	and r5, r2, r7
+	mul r0, r1, r5
+	lc r3, mulu64_seq_single
+	cjmpe r3, r6, 0
+	mul r3, r1, r6 // worth 2^16
+	sl r4, r3, 16
+	sru r1, r3, 16
+	add r0, r0, r4
+	lc r3, mulu64_seq_done
+	cjmpuge r3, r0, r4
+	add r1, r1, 1
+mulu64_seq_done:
+	ret
+mulu64_seq_single:
+	mov r1, 0
+	ret
+mulu64_seq_full:
+#include "mulu64_full.inc"
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Baseline class.
+ */
+
+#include "baseline.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iterator>
+#include <utility>
+#include <stdexcept>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+// A minimal JSON reader, sufficient for reports written by lxp32sim
+
+	struct Value {
+		enum Type {Null,Bool,Number,String,Array,Object};
+		
+		Type type=Null;
+		bool flag=false;
+		std::string str; // also the text of a number
+		std::vector<Value> items;
+		std::vector<std::pair<std::string,Value> > members;
+		
+		const Value *member(const std::string &name) const {
+			for(auto const &m: members) {
+				if(m.first==name) return &m.second;
+			}
+			return nullptr;
+		}
+	};
+	
+	class Parser {
+		const std::string &_text;
+		std::size_t _pos=0;
+	public:
+		Parser(const std::string &text): _text(text) {}
+		
+		Value parse() {
+			auto v=value();
+			skipSpace();
+			if(_pos!=_text.size()) error();
+			return v;
+		}
+	private:
+		Value value() {
+			Value v;
+			skipSpace();
+			if(_pos==_text.size()) error();
+			auto ch=_text[_pos];
+			if(ch=='{') {
+				v.type=Value::Object;
+				_pos++;
+				if(!consume('}')) {
+					do {
+						skipSpace();
+						auto name=string();
+						if(!consume(':')) error();
+						v.members.emplace_back(name,value());
+					} while(consume(','));
+					if(!consume('}')) error();
+				}
+			}
+			else if(ch=='[') {
+				v.type=Value::Array;
+				_pos++;
+				if(!consume(']')) {
+					do v.items.push_back(value()); while(consume(','));
+					if(!consume(']')) error();
+				}
+			}
+			else if(ch=='\"') {
+				v.type=Value::String;
+				v.str=string();
+			}
+			else if(ch=='-'||std::isdigit(static_cast<unsigned char>(ch))) {
+				v.type=Value::Number;
+				while(_pos<_text.size()&&std::strchr("+-.eE0123456789",_text[_pos])) v.str.push_back(_text[_pos++]);
+			}
+			else if(keyword("true")) {
+				v.type=Value::Bool;
+				v.flag=true;
+			}
+			else if(keyword("false")) v.type=Value::Bool;
+			else if(!keyword("null")) error();
+			return v;
+		}
+		
+		std::string string() {
+			if(_pos==_text.size()||_text[_pos]!='\"') error();
+			_pos++;
+			std::string str;
+			for(;;) {
+				if(_pos==_text.size()) error();
+				auto ch=_text[_pos++];
+				if(ch=='\"') break;
+				if(ch!='\\') {
+					str.push_back(ch);
+					continue;
+				}
+				if(_pos==_text.size()) error();
+				ch=_text[_pos++];
+				switch(ch) {
+				case 'b':
+					str.push_back('\b');
+					break;
+				case 'f':
+					str.push_back('\f');
+					break;
+				case 'n':
+					str.push_back('\n');
+					break;
+				case 'r':
+					str.push_back('\r');
+					break;
+				case 't':
+					str.push_back('\t');
+					break;
+				case 'u':
+					{
+						if(_pos+4>_text.size()) error();
+						auto code=std::stoul(_text.substr(_pos,4),nullptr,16);
+						_pos+=4;
+						str.push_back(code<0x80?static_cast<char>(code):'?'); // only ASCII is written
+					}
+					break;
+				default:
+					str.push_back(ch);
+				}
+			}
+			return str;
+		}
+		
+		bool consume(char ch) {
+			skipSpace();
+			if(_pos<_text.size()&&_text[_pos]==ch) {
+				_pos++;
+				return true;
+			}
+			return false;
+		}
+		
+		bool keyword(const char *word) {
+			std::string w(word);
+			if(_text.compare(_pos,w.size(),w)!=0) return false;
+			_pos+=w.size();
+			return true;
+		}
+		
+		void skipSpace() {
+			while(_pos<_text.size()&&std::isspace(static_cast<unsigned char>(_text[_pos]))) _pos++;
+		}
+		
+		void error() const {
+			throw std::runtime_error("JSON syntax error at offset "+std::to_string(_pos));
+		}
+	};
+	
+	const Value &require(const Value &obj,const std::string &name,Value::Type type) {
+		auto v=obj.member(name);
+		if(!v||v->type!=type) throw std::runtime_error("Missing or invalid \""+name+"\" field");
+		return *v;
+	}
+	
+	unsigned toUnsigned(const Value &v) {
+		if(v.type!=Value::Number) throw std::runtime_error("Number expected");
+		return static_cast<unsigned>(std::stoul(v.str));
+	}
+	
+// Tests are matched by file name, so that the baseline does not depend on the working directory
+	std::string testName(const std::string &path) {
+		auto pos=path.find_last_of("/\\");
+		if(pos==std::string::npos) return path;
+		return path.substr(pos+1);
+	}
+}
+
+void Baseline::load(const std::string &filename) {
+	std::ifstream in(filename);
+	if(!in) throw std::runtime_error("Cannot open \""+filename+"\"");
+	std::string text((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+	
+	_filename=filename;
+	_entries.clear();
+	
+	try {
+		auto root=Parser(text).parse();
+		if(root.type!=Value::Object) throw std::runtime_error("Object expected");
+		
+		auto const &tests=require(root,"tests",Value::Array);
+		for(auto const &config: require(root,"configurations",Value::Array).items) {
+			if(config.type!=Value::Object) throw std::runtime_error("Object expected");
+			
+			Explorer::Point p;
+			p.cached=(require(config,"core",Value::String).str=="lxp32c");
+			auto const &mul=require(config,"mul",Value::String).str;
+			if(mul=="dsp") p.mulArch=CoreProfile::MulDsp;
+			else if(mul=="opt") p.mulArch=CoreProfile::MulOpt;
+			else if(mul=="seq") p.mulArch=CoreProfile::MulSeq;
+			else throw std::runtime_error("Invalid multiplier architecture: \""+mul+"\"");
+			p.dividerEnabled=require(config,"divider",Value::Bool).flag;
+			p.dbusRmw=require(config,"rmw",Value::Bool).flag;
+			if(p.cached) {
+				p.latency=toUnsigned(require(config,"latency",Value::Number));
+				p.burstSize=toUnsigned(require(config,"burst",Value::Number));
+				p.prefetchSize=toUnsigned(require(config,"prefetch",Value::Number));
+			}
+			
+			auto const &cycles=require(config,"test_cycles",Value::Array).items;
+			if(cycles.size()!=tests.items.size()) throw std::runtime_error("Wrong number of test results");
+			
+			auto &results=_entries[Explorer::describe(p)];
+			for(std::size_t i=0;i<cycles.size();i++) {
+				if(tests.items[i].type!=Value::String) throw std::runtime_error("Test name expected");
+				Entry e;
+				if(cycles[i].type==Value::Number) {
+					e.passed=true;
+					e.cycles=std::stoull(cycles[i].str);
+				}
+				results[testName(tests.items[i].str)]=e;
+			}
+		}
+	}
+	catch(std::exception &ex) {
+		throw std::runtime_error("Bad baseline \""+filename+"\": "+ex.what());
+	}
+}
+
+/*
+ * Writes a line for each result that differs from the baseline,
+ * followed by a summary
+ */
+
+Baseline::Summary Baseline::compare(const std::vector<std::string> &tests,
+	const std::vector<Explorer::Outcome> &outcomes,std::ostream &os) const
+{
+	Summary summary;
+	
+	os<<"Comparison with the baseline \""<<_filename<<"\":"<<std::endl;
+	for(auto const &o: outcomes) {
+		auto config=Explorer::describe(o.point);
+		auto it=_entries.find(config);
+		for(std::size_t i=0;i<o.results.size();i++) {
+			auto const &res=o.results[i];
+			bool passed=(res.status==Runner::Result::Success);
+			
+			const Entry *base=nullptr;
+			if(it!=_entries.end()) {
+				auto jt=it->second.find(testName(tests[i]));
+				if(jt!=it->second.end()) base=&jt->second;
+			}
+			
+			std::ostringstream line;
+			line<<"    "<<config<<", \""<<testName(tests[i])<<"\": ";
+			if(!base) {
+				summary.missing++;
+				line<<"not in the baseline";
+			}
+			else if(!passed) {
+				if(!base->passed) {
+					summary.unchanged++;
+					continue;
+				}
+				summary.regressions++;
+				line<<"FAILED (was "<<base->cycles<<" cycles)";
+			}
+			else if(!base->passed) {
+				summary.improvements++;
+				line<<"passed, "<<res.cycles<<" cycles (failed in the baseline)";
+			}
+			else if(res.cycles==base->cycles) {
+				summary.unchanged++;
+				continue;
+			}
+			else {
+				auto delta=100.0*(static_cast<double>(res.cycles)-static_cast<double>(base->cycles))/
+					static_cast<double>(base->cycles);
+				line<<base->cycles<<" -> "<<res.cycles<<" cycles (";
+				line<<std::showpos<<std::fixed<<std::setprecision(2)<<delta<<"%)";
+				if(res.cycles>base->cycles) {
+					summary.regressions++;
+					line<<" REGRESSION";
+				}
+				else summary.improvements++;
+			}
+			os<<line.str()<<std::endl;
+		}
+	}
+	
+	os<<"    "<<summary.regressions<<" regression(s), "<<summary.improvements<<" improvement(s), ";
+	os<<summary.unchanged<<" unchanged, "<<summary.missing<<" not in the baseline"<<std::endl;
+	return summary;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Baseline class which compares the results
+ * of a design space exploration against a JSON report written by an
+ * earlier one (see Explorer::writeJson()), so that performance
+ * regressions of benchmarks are detected automatically.
+ *
+ * Results are matched by configuration and test file name. Cycle
+ * counts are deterministic, so any increase is a regression, and so
+ * is a test that fails where it used to pass. Configurations and
+ * tests missing from the baseline are reported, but not treated as
+ * regressions.
+ */
+
+#ifndef BASELINE_H_INCLUDED
+#define BASELINE_H_INCLUDED
+
+#include "explorer.h"
+
+#include <vector>
+#include <map>
+#include <string>
+#include <iostream>
+
+class Baseline {
+public:
+	struct Summary {
+		std::size_t regressions=0;
+		std::size_t improvements=0;
+		std::size_t unchanged=0;
+		std::size_t missing=0; // not in the baseline
+	};
+
+private:
+	struct Entry {
+		bool passed=false;
+		Cpu::Counter cycles=0;
+	};
+	
+	std::string _filename;
+// Configuration (see Explorer::describe()) -> test -> result
+	std::map<std::string,std::map<std::string,Entry> > _entries;
+
+public:
+	void load(const std::string &filename);
+	Summary compare(const std::vector<std::string> &tests,
+		const std::vector<Explorer::Outcome> &outcomes,std::ostream &os) const;
+};
+
+#endif
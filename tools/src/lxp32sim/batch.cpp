@@ -0,0 +1,515 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Batch class.
+ */
+
+#include "batch.h"
+#include "peripherals.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+Batch::Batch(const std::vector<Word> &image,std::size_t lanes):
+	_lanes(lanes),
+	_code(ProgramRam::Size/4),
+	_codeEnd(0),
+	_regs(256*lanes,0),
+	_pc(lanes,0),
+	_cycles(lanes,0),
+	_instructions(lanes,0),
+	_status(lanes,Running),
+	_result(lanes,0),
+	_log(lanes),
+	_running(lanes),
+	_mask(lanes,0),
+	_op1(lanes,0),
+	_op2(lanes,0),
+	_res(lanes,0),
+	_wait(lanes,0)
+{
+	_pcs.reserve(lanes);
+	_counts.reserve(lanes);
+	if(image.size()>_code.size()) throw std::runtime_error("Program size is too large");
+	for(std::size_t i=0;i<image.size();i++) _code.write(i,image[i]);
+	_codeEnd=static_cast<Word>(image.size()*4);
+	_codeWritten.assign(image.size(),0);
+	_memory.assign(lanes,_code); // pages are shared until written
+}
+
+void Batch::setMulArch(Cpu::MulArch arch) {
+	_mulArch=arch;
+}
+
+void Batch::setDividerEnabled(bool b) {
+	_dividerEnabled=b;
+}
+
+void Batch::setDbusRmw(bool b) {
+	_dbusRmw=b;
+}
+
+void Batch::setVerbose(bool b) {
+	_verbose=b;
+}
+
+std::size_t Batch::lanes() const {
+	return _lanes;
+}
+
+void Batch::write(std::size_t lane,Word addr,Word data) {
+	if(addr>=ProgramRam::Size) throw std::runtime_error("Address 0x"+Utils::hex(addr)+" is outside of the program RAM");
+	_memory[lane].write(addr/4,data);
+	if(addr<_codeEnd) _codeWritten[addr/4]=1;
+}
+
+/*
+ * Each step issues the instruction at the program counter shared by
+ * the largest number of running lanes (the lowest one on a tie). The
+ * lanes left behind catch up once they outnumber the others, which
+ * also works for loops with several back edges, where issuing the
+ * lowest program counter first keeps lanes apart.
+ */
+
+void Batch::run(Counter cycleLimit) {
+	_pcs.clear();
+	_counts.clear();
+	for(std::size_t i=0;i<_lanes;i++) {
+		if(_status[i]!=Running) continue;
+		if(_cycles[i]>=cycleLimit) stop(i,Timeout);
+		else addGroup(_pc[i]);
+	}
+	
+	while(!_pcs.empty()) {
+		std::size_t g=0;
+		for(std::size_t j=1;j<_pcs.size();j++) {
+			if(_counts[j]>_counts[g]||(_counts[j]==_counts[g]&&_pcs[j]<_pcs[g])) g=j;
+		}
+		auto pc=_pcs[g];
+		_steps++;
+		_activeSlots+=_counts[g];
+		_runningSlots+=_running;
+		_pcs[g]=_pcs.back();
+		_pcs.pop_back();
+		_counts[g]=_counts.back();
+		_counts.pop_back();
+		
+		for(std::size_t i=0;i<_lanes;i++) _mask[i]=(_pc[i]==pc)?~Word(0):0;
+		
+		step(pc);
+		
+		for(std::size_t i=0;i<_lanes;i++) {
+			if(!_mask[i]) continue;
+			if(_status[i]==Running&&_cycles[i]>=cycleLimit) _status[i]=Timeout;
+			if(_status[i]!=Running) stop(i,_status[i]);
+			else addGroup(_pc[i]);
+		}
+	}
+}
+
+Batch::Status Batch::status(std::size_t lane) const {
+	return _status[lane];
+}
+
+Batch::Word Batch::result(std::size_t lane) const {
+	return _result[lane];
+}
+
+Batch::Word Batch::reg(std::size_t lane,int r) const {
+	return _regs[r*_lanes+lane];
+}
+
+// Reads a word of the program RAM, the address wraps around
+
+Batch::Word Batch::read(std::size_t lane,Word addr) const {
+	return _memory[lane].read((addr/4)%(ProgramRam::Size/4));
+}
+
+Batch::Counter Batch::cycles(std::size_t lane) const {
+	return _cycles[lane];
+}
+
+Batch::Counter Batch::instructions(std::size_t lane) const {
+	return _instructions[lane];
+}
+
+const std::string &Batch::log(std::size_t lane) const {
+	return _log[lane];
+}
+
+Batch::Counter Batch::steps() const {
+	return _steps;
+}
+
+// Average share of the running lanes that execute the issued instruction
+
+double Batch::utilization() const {
+	if(_runningSlots==0) return 0;
+	return static_cast<double>(_activeSlots)/static_cast<double>(_runningSlots);
+}
+
+/*
+ * Private members
+ */
+
+Batch::Word *Batch::row(Word r) {
+	return &_regs[r*_lanes];
+}
+
+const Batch::Word *Batch::operand(Word field,bool reg,std::vector<Word> &imm) {
+	if(reg) return row(field&0xFF);
+	std::fill(imm.begin(),imm.end(),static_cast<Word>(static_cast<std::int8_t>(field)));
+	return imm.data();
+}
+
+/*
+ * The code is shared by all lanes. Instructions in the words of the
+ * program image written by any lane are checked against the memory
+ * of each lane.
+ */
+
+bool Batch::fetch(Word addr,Word &w) {
+	if(addr>=_codeEnd) {
+		for(std::size_t i=0;i<_lanes;i++) {
+			if(_mask[i]) stop(i,Unsupported);
+		}
+		return false;
+	}
+	
+	w=_code.read(addr/4);
+	if(_codeWritten[addr/4]) {
+		for(std::size_t i=0;i<_lanes;i++) {
+			if(_mask[i]&&_memory[i].read(addr/4)!=w) stop(i,Unsupported);
+		}
+	}
+	return true;
+}
+
+void Batch::step(Word pc) {
+	Word w;
+	if(!fetch(pc,w)) return;
+	
+	auto opcode=w>>26;
+	auto dst=row((w>>16)&0xFF);
+	Word next=pc+4;
+	
+	if((opcode>>3)==0x05) { // lcs
+		Word value=(w&0xFFFF)|((w>>8)&0x1F0000);
+		if(value&0x100000) value|=0xFFE00000;
+		std::fill(_res.begin(),_res.end(),value);
+		commit(dst);
+		advance(next,1);
+		return;
+	}
+	
+	auto rd1=operand(w>>8,(w&0x02000000)!=0,_op1);
+	auto rd2=operand(w,(w&0x01000000)!=0,_op2);
+	
+	if((opcode>>4)==0x03) { // cjmpxx
+		Word eq=(opcode>>3)&1;
+		Word ne=(opcode>>2)&1;
+		Word ug=(opcode>>1)&1;
+		Word sg=opcode&1;
+		auto res=_res.data();
+		auto wait=_wait.data();
+		for(std::size_t i=0;i<_lanes;i++) {
+			Word taken=(eq&Word(rd1[i]==rd2[i]))|(ne&Word(rd1[i]!=rd2[i]))|(ug&Word(rd1[i]>rd2[i]))|
+				(sg&Word(static_cast<std::int32_t>(rd1[i])>static_cast<std::int32_t>(rd2[i])));
+			Word t=Word(0)-taken;
+			res[i]=(dst[i]&~Word(3)&t)|(next&~t);
+			wait[i]=2+(t&3);
+		}
+		advanceJump();
+		return;
+	}
+	
+	switch(opcode) {
+	case 0x00: // nop
+		advance(next,1);
+		break;
+	case 0x01: // lc
+		{
+			Word value;
+			if(!fetch(next,value)) return;
+			std::fill(_res.begin(),_res.end(),value);
+			commit(dst);
+			advance(next+4,2);
+		}
+		break;
+	case 0x08: // lw
+		load(dst,rd1,false,false);
+		advanceWait(next);
+		break;
+	case 0x0A: // lub
+		load(dst,rd1,true,false);
+		advanceWait(next);
+		break;
+	case 0x0B: // lsb
+		load(dst,rd1,true,true);
+		advanceWait(next);
+		break;
+	case 0x0C: // sw
+		store(rd1,rd2,false);
+		advanceWait(next);
+		break;
+	case 0x0E: // sb
+		store(rd1,rd2,true);
+		advanceWait(next);
+		break;
+	case 0x10: // add
+		alu(dst,rd1,rd2,[](Word a,Word b) {return a+b;});
+		advance(next,1);
+		break;
+	case 0x11: // sub
+		alu(dst,rd1,rd2,[](Word a,Word b) {return a-b;});
+		advance(next,1);
+		break;
+	case 0x12: // mul
+		alu(dst,rd1,rd2,[](Word a,Word b) {return a*b;});
+		advance(next,mulCycles());
+		break;
+	case 0x14: // divu
+	case 0x15: // divs
+	case 0x16: // modu
+	case 0x17: // mods
+		if(_dividerEnabled) {
+			divide(dst,rd1,rd2,(opcode&1)!=0,(opcode&2)!=0);
+			advance(next,(opcode&2)?37:36);
+		}
+		else {
+			std::fill(_res.begin(),_res.end(),0);
+			commit(dst);
+			advance(next,2);
+		}
+		break;
+	case 0x18: // and
+		alu(dst,rd1,rd2,[](Word a,Word b) {return a&b;});
+		advance(next,1);
+		break;
+	case 0x19: // or
+		alu(dst,rd1,rd2,[](Word a,Word b) {return a|b;});
+		advance(next,1);
+		break;
+	case 0x1A: // xor
+		alu(dst,rd1,rd2,[](Word a,Word b) {return a^b;});
+		advance(next,1);
+		break;
+	case 0x1C: // sl
+		alu(dst,rd1,rd2,[](Word a,Word b) {return a<<(b&0x1F);});
+		advance(next,2);
+		break;
+	case 0x1E: // sru
+		alu(dst,rd1,rd2,[](Word a,Word b) {return a>>(b&0x1F);});
+		advance(next,2);
+		break;
+	case 0x1F: // srs
+		alu(dst,rd1,rd2,[](Word a,Word b) {
+			return static_cast<Word>(static_cast<std::int32_t>(a)>>(b&0x1F));
+		});
+		advance(next,2);
+		break;
+	case 0x20: // jmp
+	case 0x21: // call
+		{
+			auto res=_res.data();
+			auto wait=_wait.data();
+			for(std::size_t i=0;i<_lanes;i++) {
+				res[i]=rd1[i]&~Word(3);
+				wait[i]=4;
+			}
+			if(opcode&1) {
+				auto mask=_mask.data();
+				for(std::size_t i=0;i<_lanes;i++) dst[i]=(next&mask[i])|(dst[i]&~mask[i]);
+			}
+			advanceJump();
+		}
+		break;
+	default: // hlt waits for an interrupt, illegal instructions are reported by the Cpu class
+		for(std::size_t i=0;i<_lanes;i++) {
+			if(_mask[i]) stop(i,Unsupported);
+		}
+	}
+}
+
+void Batch::addGroup(Word pc) {
+	auto j=_pcs.size();
+	if(j>0&&_pcs[j-1]==pc) j--; // usually the lane before went to the same place
+	else {
+		for(j=0;j<_pcs.size()&&_pcs[j]!=pc;j++);
+		if(j==_pcs.size()) {
+			_pcs.push_back(pc);
+			_counts.push_back(0);
+		}
+	}
+	_counts[j]++;
+}
+
+void Batch::stop(std::size_t lane,Status status) {
+	_status[lane]=status;
+	_mask[lane]=0;
+	_pc[lane]=Retired;
+	_running--;
+}
+
+template <typename Op> void Batch::alu(Word *dst,const Word *rd1,const Word *rd2,Op op) {
+	auto res=_res.data();
+	for(std::size_t i=0;i<_lanes;i++) res[i]=op(rd1[i],rd2[i]);
+	commit(dst);
+}
+
+void Batch::load(Word *dst,const Word *rd1,bool byte,bool sign) {
+	for(std::size_t i=0;i<_lanes;i++) {
+		if(!_mask[i]) continue;
+		Word addr=rd1[i];
+		Word data;
+		unsigned waitStates;
+		if(!busRead(i,addr&~Word(3),data,waitStates)) {
+			stop(i,Unsupported);
+			continue;
+		}
+		if(byte) {
+			data=(data>>((addr&3)*8))&0xFF;
+			if(sign&&(data&0x80)) data|=0xFFFFFF00;
+		}
+		_res[i]=data;
+		_wait[i]=3+waitStates;
+	}
+	commit(dst);
+}
+
+void Batch::store(const Word *rd1,const Word *rd2,bool byte) {
+	for(std::size_t i=0;i<_lanes;i++) {
+		if(!_mask[i]) continue;
+		Word addr=rd1[i];
+		unsigned waitStates=0;
+		bool supported;
+		if(!byte) supported=busWrite(i,addr&~Word(3),0xF,rd2[i],waitStates);
+		else if(!_dbusRmw) supported=busWrite(i,addr&~Word(3),Word(1)<<(addr&3),(rd2[i]&0xFF)*0x01010101,waitStates);
+		else {
+			int shift=(addr&3)*8;
+			Word data;
+			unsigned readWaitStates;
+			supported=busRead(i,addr&~Word(3),data,readWaitStates);
+			if(supported) {
+				data=(data&~(Word(0xFF)<<shift))|((rd2[i]&0xFF)<<shift);
+				supported=busWrite(i,addr&~Word(3),0xF,data,waitStates);
+				waitStates+=readWaitStates+1;
+			}
+		}
+		if(!supported) {
+			stop(i,Unsupported);
+			continue;
+		}
+		_wait[i]=2+waitStates;
+	}
+}
+
+void Batch::divide(Word *dst,const Word *rd1,const Word *rd2,bool sign,bool mod) {
+	for(std::size_t i=0;i<_lanes;i++) {
+		if(_mask[i]) _res[i]=Cpu::divide(rd1[i],rd2[i],sign,mod);
+	}
+	commit(dst);
+}
+
+// Write the results of the lanes executing the instruction to a register
+
+void Batch::commit(Word *dst) {
+	auto res=_res.data();
+	auto mask=_mask.data();
+	for(std::size_t i=0;i<_lanes;i++) dst[i]=(res[i]&mask[i])|(dst[i]&~mask[i]);
+}
+
+void Batch::advance(Word next,Word cycles) {
+	auto mask=_mask.data();
+	auto pc=_pc.data();
+	auto cnt=_cycles.data();
+	auto instr=_instructions.data();
+	for(std::size_t i=0;i<_lanes;i++) {
+		pc[i]=(next&mask[i])|(pc[i]&~mask[i]);
+		cnt[i]+=cycles&mask[i];
+		instr[i]+=mask[i]&1;
+	}
+}
+
+void Batch::advanceWait(Word next) {
+	auto mask=_mask.data();
+	auto wait=_wait.data();
+	auto pc=_pc.data();
+	auto cnt=_cycles.data();
+	auto instr=_instructions.data();
+	for(std::size_t i=0;i<_lanes;i++) {
+		pc[i]=(next&mask[i])|(pc[i]&~mask[i]);
+		cnt[i]+=wait[i]&mask[i];
+		instr[i]+=mask[i]&1;
+	}
+}
+
+// Branch targets are taken from _res, cycles from _wait
+
+void Batch::advanceJump() {
+	auto mask=_mask.data();
+	auto res=_res.data();
+	auto wait=_wait.data();
+	auto pc=_pc.data();
+	auto cnt=_cycles.data();
+	auto instr=_instructions.data();
+	for(std::size_t i=0;i<_lanes;i++) {
+		pc[i]=(res[i]&mask[i])|(pc[i]&~mask[i]);
+		cnt[i]+=wait[i]&mask[i];
+		instr[i]+=mask[i]&1;
+	}
+}
+
+/*
+ * Bus accesses have the same effect and timing as on the test
+ * platform. They return false for slaves that are not modeled.
+ */
+
+bool Batch::busRead(std::size_t lane,Word addr,Word &data,unsigned &waitStates) {
+	switch(addr>>28) {
+	case 0: // program RAM, the address wraps around
+		data=_memory[lane].read((addr/4)%(ProgramRam::Size/4));
+		waitStates=1;
+		return true;
+	case 1: // test monitor
+		data=0;
+		waitStates=0;
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool Batch::busWrite(std::size_t lane,Word addr,Word sel,Word data,unsigned &waitStates) {
+	waitStates=0;
+	switch(addr>>28) {
+	case 0: // program RAM
+		if(addr<ProgramRam::Size) {
+			auto &mem=_memory[lane];
+			mem.write(addr/4,Slave::merge(mem.read(addr/4),sel,data));
+			if(addr<_codeEnd) _codeWritten[addr/4]=1;
+		}
+		return true;
+	case 1: // test monitor (byte-granular access is an error)
+		if(sel!=0xF) return false;
+		addr&=0x0FFFFFFF;
+		if(_verbose) {
+			_log[lane]+="Monitor: value 0x"+Utils::hex(data)+
+				" written to address 0x"+Utils::hex(addr>>2)+"\n";
+		}
+		if(addr==0) {
+			_result[lane]=data;
+			_status[lane]=Finished;
+		}
+		return true;
+	default:
+		return false;
+	}
+}
+
+unsigned Batch::mulCycles() const {
+	return CoreProfile::mulCycles(_mulArch);
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Batch class which runs many instances
+ * (lanes) of the same program in lockstep, e.g. a firmware image
+ * processing different inputs. Lane state is stored as a structure
+ * of arrays (one array per register, indexed by lane), so each
+ * instruction is fetched and decoded once and executed for all lanes
+ * by simple loops over the arrays which the compiler vectorizes.
+ *
+ * Lanes whose control flow diverges are masked: every step executes
+ * one instruction for the lanes whose program counter points to it,
+ * the others wait. The instruction is chosen so that divergent lanes
+ * are regrouped when their paths meet again (see run()).
+ *
+ * Only the program RAM and the test monitor are modeled. A lane that
+ * does anything else (accesses another slave, halts, executes an
+ * illegal instruction, runs code outside of the program image or code
+ * it has modified) is stopped as Unsupported, so that the caller can
+ * rerun it on the complete test platform (see Simulator). Without
+ * interrupts and bus throttling, instruction timing is the same as
+ * in the Cpu class, and so are the cycle counts.
+ */
+
+#ifndef BATCH_H_INCLUDED
+#define BATCH_H_INCLUDED
+
+#include "cpu.h"
+#include "memory.h"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class Batch {
+public:
+	typedef Cpu::Word Word;
+	typedef Cpu::Counter Counter;
+	
+	enum Status {Running,Finished,Timeout,Unsupported};
+
+private:
+	static const Word Retired=0xFFFFFFFF; // program counter of a lane that has stopped
+	
+	std::size_t _lanes;
+	Memory _code;
+	Word _codeEnd;
+	
+// Per-lane state; register "r" of lane "i" is _regs[r*_lanes+i]
+	std::vector<Word> _regs;
+	std::vector<Word> _pc;
+	std::vector<Counter> _cycles;
+	std::vector<Counter> _instructions;
+	std::vector<Memory> _memory;
+	std::vector<Status> _status;
+	std::vector<Word> _result;
+	std::vector<std::string> _log;
+	std::size_t _running;
+	
+// Words of the program image written by any lane
+	std::vector<std::uint8_t> _codeWritten;
+	
+// Current step: lanes executing the instruction (all ones) or not (zero), operands, results and cycles
+	std::vector<Word> _mask;
+	std::vector<Word> _op1;
+	std::vector<Word> _op2;
+	std::vector<Word> _res;
+	std::vector<Word> _wait;
+	
+// Program counters of the running lanes (except the ones executing) and the number of lanes at each
+	std::vector<Word> _pcs;
+	std::vector<std::size_t> _counts;
+	
+// Statistics: instructions issued and lane slots executed or waiting
+	Counter _steps=0;
+	Counter _activeSlots=0;
+	Counter _runningSlots=0;
+	
+// Configuration
+	Cpu::MulArch _mulArch=CoreProfile::MulDsp;
+	bool _dividerEnabled=true;
+	bool _dbusRmw=false;
+	bool _verbose=false;
+
+public:
+	Batch(const std::vector<Word> &image,std::size_t lanes);
+	
+	void setMulArch(Cpu::MulArch arch);
+	void setDividerEnabled(bool b);
+	void setDbusRmw(bool b);
+	void setVerbose(bool b);
+	
+	std::size_t lanes() const;
+	void write(std::size_t lane,Word addr,Word data);
+	void run(Counter cycleLimit);
+	
+	Status status(std::size_t lane) const;
+	Word result(std::size_t lane) const;
+	Word reg(std::size_t lane,int r) const;
+	Word read(std::size_t lane,Word addr) const;
+	Counter cycles(std::size_t lane) const;
+	Counter instructions(std::size_t lane) const;
+	const std::string &log(std::size_t lane) const;
+	
+	Counter steps() const;
+	double utilization() const;
+
+private:
+	Word *row(Word r);
+	const Word *operand(Word field,bool reg,std::vector<Word> &imm);
+	bool fetch(Word addr,Word &w);
+	void step(Word pc);
+	void addGroup(Word pc);
+	void stop(std::size_t lane,Status status);
+	
+	template <typename Op> void alu(Word *dst,const Word *rd1,const Word *rd2,Op op);
+	void load(Word *dst,const Word *rd1,bool byte,bool sign);
+	void store(const Word *rd1,const Word *rd2,bool byte);
+	void divide(Word *dst,const Word *rd1,const Word *rd2,bool sign,bool mod);
+	
+	void commit(Word *dst);
+	void advance(Word next,Word cycles);
+	void advanceWait(Word next);
+	void advanceJump();
+	
+	bool busRead(std::size_t lane,Word addr,Word &data,unsigned &waitStates);
+	bool busWrite(std::size_t lane,Word addr,Word sel,Word data,unsigned &waitStates);
+	unsigned mulCycles() const;
+};
+
+#endif
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Breakpoints class.
+ */
+
+#include "breakpoints.h"
+
+Breakpoints::Breakpoints(): _pages(std::size_t(1)<<(32-PageBits)) {}
+
+bool Breakpoints::insert(Word addr) {
+	if(!_addrs.insert(addr).second) return false;
+	_pages[addr>>PageBits]++;
+	return true;
+}
+
+bool Breakpoints::remove(Word addr) {
+	if(!_addrs.erase(addr)) return false;
+	_pages[addr>>PageBits]--;
+	return true;
+}
+
+bool Breakpoints::empty() const {
+	return _addrs.empty();
+}
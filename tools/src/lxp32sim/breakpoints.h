@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Breakpoints class which stores code
+ * breakpoints for the debugger. A per-page counter is checked
+ * first, so that a lookup for an address without breakpoints
+ * in its page is a single memory access.
+ */
+
+#ifndef BREAKPOINTS_H_INCLUDED
+#define BREAKPOINTS_H_INCLUDED
+
+#include <vector>
+#include <set>
+#include <cstdint>
+
+class Breakpoints {
+public:
+	typedef std::uint32_t Word;
+	
+	static const int PageBits=12;
+
+private:
+	std::vector<std::uint16_t> _pages;
+	std::set<Word> _addrs;
+
+public:
+	Breakpoints();
+	
+	bool hit(Word addr) const {
+		return _pages[addr>>PageBits]!=0&&_addrs.count(addr)!=0;
+	}
+	
+	bool insert(Word addr);
+	bool remove(Word addr);
+	bool empty() const;
+};
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Bus abstract class which represents
+ * everything the simulated CPU is connected to: the instruction
+ * bus, the data bus and the interrupt request lines.
+ */
+
+#ifndef BUS_H_INCLUDED
+#define BUS_H_INCLUDED
+
+#include <cstdint>
+
+class Bus {
+public:
+	typedef std::uint32_t Word;
+	typedef std::uint64_t Counter;
+	
+	virtual ~Bus() {}
+
+/*
+ * Bus access functions return the number of wait states inserted
+ * by the slave (0 means that the cycle was terminated immediately).
+ * "addr" is a byte address, "sel" is a 4-bit byte enable mask.
+ */
+	virtual unsigned fetch(Word addr,Word &data)=0;
+	virtual unsigned read(Word addr,Word sel,Word &data)=0;
+	virtual unsigned write(Word addr,Word sel,Word data)=0;
+	
+// Advance the system by one clock cycle, return IRQ line states
+	virtual std::uint8_t clock()=0;
+
+/*
+ * Idle skipping support. quietCycles() returns the number of
+ * subsequent clock cycles (at most "limit") during which the IRQ
+ * line states and the data returned by the slaves are guaranteed
+ * not to change. If "accesses" is set, the number of wait states
+ * must be predictable as well. skip() advances the system by "n"
+ * such cycles at once. By default, skipping is not supported.
+ */
+	virtual Counter quietCycles(Counter,bool) {return 0;}
+	virtual void skip(Counter) {}
+};
+
+#endif
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the CallGraph class.
+ */
+
+#include "callgraph.h"
+
+#include <iomanip>
+#include <algorithm>
+
+// Return address of a context root: never matches an aligned jump target
+static const CallGraph::Word noReturn=1;
+
+CallGraph::CallGraph() {
+	reset(0);
+}
+
+void CallGraph::reset(Word entry) {
+	_nodes.clear();
+	_contexts.clear();
+	
+// Node 0 is a virtual root for all contexts, it is not printed
+	_nodes.push_back(Node {0,0,-1,0,{}});
+	auto root=child(0,entry,entry,-1);
+	_contexts.push_back(Stack {Frame {root,noReturn}});
+}
+
+void CallGraph::call(Word target,Word returnAddr) {
+	auto &stack=_contexts.back();
+	auto node=child(stack.back().node,target,target,-1);
+	stack.push_back(Frame {node,returnAddr});
+}
+
+/*
+ * A jump to a return address of a pending call returns from that call
+ * (and from all calls made after it). Other jumps, including tail
+ * calls, don't change the stack.
+ */
+
+void CallGraph::jump(Word target) {
+	auto &stack=_contexts.back();
+	for(std::size_t i=stack.size();i-->1;) {
+		if(stack[i].returnAddr==target) {
+			stack.resize(i);
+			return;
+		}
+	}
+}
+
+/*
+ * A non-returnable interrupt never gets back to the interrupted code,
+ * so the interrupted context is discarded in this case.
+ */
+
+void CallGraph::interrupt(int vector,Word handler,bool returnable) {
+	auto irq=child(0,(std::uint64_t(1)<<32)|static_cast<unsigned>(vector),0,vector);
+	auto node=child(irq,handler,handler,-1);
+	Stack stack {Frame {irq,noReturn},Frame {node,noReturn}};
+	if(returnable) _contexts.push_back(stack);
+	else _contexts.back()=stack;
+}
+
+void CallGraph::interruptReturn() {
+	if(_contexts.size()>1) _contexts.pop_back();
+}
+
+/*
+ * Folded stack format: one line per call stack with non-zero exclusive
+ * cycles, frames separated by semicolons, followed by the cycle count.
+ * Suitable as input for flame graph tools.
+ */
+
+void CallGraph::writeFolded(std::ostream &os,const SymbolMap &symbols) const {
+	std::vector<std::string> paths(_nodes.size());
+	for(std::size_t i=1;i<_nodes.size();i++) {
+		auto const &parent=_nodes[i].parent;
+		if(parent==0) paths[i]=nodeName(i,symbols);
+		else paths[i]=paths[parent]+";"+nodeName(i,symbols);
+		if(_nodes[i].cycles>0) os<<paths[i]<<' '<<_nodes[i].cycles<<std::endl;
+	}
+}
+
+/*
+ * Call tree with inclusive and exclusive cycle counts, children
+ * sorted by inclusive cycles
+ */
+
+void CallGraph::writeTree(std::ostream &os,const SymbolMap &symbols) const {
+	auto inclusive=inclusiveCycles();
+	os<<"// Call tree: "<<inclusive[0]<<" cycles"<<std::endl;
+	os<<"//"<<std::endl;
+	os<<"//    Inclusive        %     Exclusive        %  Function"<<std::endl;
+	writeSubtree(os,symbols,inclusive,0,0);
+}
+
+/*
+ * Private members
+ */
+
+std::size_t CallGraph::child(std::size_t parent,std::uint64_t key,Word function,int vector) {
+	auto it=_nodes[parent].children.find(key);
+	if(it!=_nodes[parent].children.end()) return it->second;
+	auto node=_nodes.size();
+	_nodes.push_back(Node {parent,function,vector,0,{}});
+	_nodes[parent].children.emplace(key,node);
+	return node;
+}
+
+std::string CallGraph::nodeName(std::size_t node,const SymbolMap &symbols) const {
+	auto const &n=_nodes[node];
+	if(n.vector>=0) return "[irq"+std::to_string(n.vector)+"]";
+	return symbols.resolve(n.function);
+}
+
+std::vector<CallGraph::Counter> CallGraph::inclusiveCycles() const {
+	std::vector<Counter> inclusive(_nodes.size());
+	for(std::size_t i=_nodes.size();i-->0;) {
+		inclusive[i]+=_nodes[i].cycles;
+		if(i>0) inclusive[_nodes[i].parent]+=inclusive[i]; // children always follow parents
+	}
+	return inclusive;
+}
+
+void CallGraph::writeSubtree(std::ostream &os,const SymbolMap &symbols,
+	const std::vector<Counter> &inclusive,std::size_t node,int depth) const
+{
+	auto total=inclusive[0];
+	auto pct=[total](Counter value) {
+		return (total>0)?100.0*static_cast<double>(value)/static_cast<double>(total):0.0;
+	};
+	
+	if(node>0) {
+		os<<"// "<<std::setw(12)<<inclusive[node]<<"  ";
+		os<<std::fixed<<std::setprecision(2)<<std::setw(6)<<pct(inclusive[node])<<"%  ";
+		os<<std::setw(12)<<_nodes[node].cycles<<"  ";
+		os<<std::setw(6)<<pct(_nodes[node].cycles)<<"%  ";
+		os<<std::string(depth*2,' ')<<nodeName(node,symbols)<<std::endl;
+	}
+	
+	std::vector<std::size_t> children;
+	for(auto const &c: _nodes[node].children) children.push_back(c.second);
+	std::stable_sort(children.begin(),children.end(),[&inclusive](std::size_t a,std::size_t b) {
+		return inclusive[a]>inclusive[b];
+	});
+	
+	for(auto c: children) writeSubtree(os,symbols,inclusive,c,(node>0)?depth+1:0);
+}
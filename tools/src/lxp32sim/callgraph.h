@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the CallGraph class which maintains a shadow
+ * call stack of the simulated program and attributes cycles to full
+ * call stacks. Calls are detected from the "call" instruction,
+ * returns from jumps to a pending return address. Interrupt handlers
+ * are shown as separate roots.
+ */
+
+#ifndef CALLGRAPH_H_INCLUDED
+#define CALLGRAPH_H_INCLUDED
+
+#include "symbolmap.h"
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+
+class CallGraph {
+public:
+	typedef std::uint32_t Word;
+	typedef std::uint64_t Counter;
+
+private:
+	struct Node {
+		std::size_t parent;
+		Word function;
+		int vector; // interrupt vector for interrupt roots, -1 otherwise
+		Counter cycles; // exclusive
+		std::map<std::uint64_t,std::size_t> children;
+	};
+	
+	struct Frame {
+		std::size_t node;
+		Word returnAddr;
+	};
+	
+	typedef std::vector<Frame> Stack;
+	
+	std::vector<Node> _nodes;
+	std::vector<Stack> _contexts; // the last one is active
+
+public:
+	CallGraph();
+	
+	void reset(Word entry);
+	
+	void addCycles(Counter cycles) {
+		_nodes[_contexts.back().back().node].cycles+=cycles;
+	}
+	
+	void call(Word target,Word returnAddr);
+	void jump(Word target);
+	void interrupt(int vector,Word handler,bool returnable);
+	void interruptReturn();
+	
+	void writeFolded(std::ostream &os,const SymbolMap &symbols) const;
+	void writeTree(std::ostream &os,const SymbolMap &symbols) const;
+
+private:
+	std::size_t child(std::size_t parent,std::uint64_t key,Word function,int vector);
+	std::string nodeName(std::size_t node,const SymbolMap &symbols) const;
+	std::vector<Counter> inclusiveCycles() const;
+	void writeSubtree(std::ostream &os,const SymbolMap &symbols,
+		const std::vector<Counter> &inclusive,std::size_t node,int depth) const;
+};
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Coverage class.
+ */
+
+#include "coverage.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+	struct OpcodeInfo {
+		Coverage::Word opcode;
+		const char *name;
+		int operands; // 0: none, 1: Rd1 (register only), 2: Rd1 and Rd2
+		bool rd1Immediate; // Rd1 can be an immediate
+	};
+	
+	const OpcodeInfo opcodes[]={
+		{0x00,"nop",0,false},
+		{0x01,"lc",0,false},
+		{0x02,"hlt",0,false},
+		{0x08,"lw",1,false},
+		{0x0A,"lub",1,false},
+		{0x0B,"lsb",1,false},
+		{0x0C,"sw",2,false},
+		{0x0E,"sb",2,false},
+		{0x10,"add",2,true},
+		{0x11,"sub",2,true},
+		{0x12,"mul",2,true},
+		{0x14,"divu",2,true},
+		{0x15,"divs",2,true},
+		{0x16,"modu",2,true},
+		{0x17,"mods",2,true},
+		{0x18,"and",2,true},
+		{0x19,"or",2,true},
+		{0x1A,"xor",2,true},
+		{0x1C,"sl",2,true},
+		{0x1E,"sru",2,true},
+		{0x1F,"srs",2,true},
+		{0x20,"jmp",1,false},
+		{0x21,"call",1,false},
+		{0x28,"lcs",0,false},
+		{0x31,"cjmpsg",2,true},
+		{0x32,"cjmpug",2,true},
+		{0x34,"cjmpne",2,true},
+		{0x38,"cjmpe",2,true},
+		{0x39,"cjmpsge",2,true},
+		{0x3A,"cjmpuge",2,true}
+	};
+	
+	const OpcodeInfo *findOpcode(Coverage::Word opcode) {
+		for(auto const &op: opcodes) {
+			if(op.opcode==opcode) return &op;
+		}
+		return nullptr;
+	}
+}
+
+Coverage::Coverage(std::size_t words):
+	_executions(words),
+	_taken(words)
+{
+	std::fill(_encodings,_encodings+Encodings,0);
+}
+
+void Coverage::merge(const Coverage &other) {
+	if(other._executions.size()!=_executions.size())
+		throw std::runtime_error("Cannot merge coverage data for different programs");
+	for(unsigned i=0;i<Encodings;i++) _encodings[i]+=other._encodings[i];
+	for(std::size_t i=0;i<_executions.size();i++) {
+		_executions[i]+=other._executions[i];
+		_taken[i]+=other._taken[i];
+	}
+}
+
+std::size_t Coverage::words() const {
+	return _executions.size();
+}
+
+Coverage::Counter Coverage::encoding(unsigned cls) const {
+	if(cls>=Encodings) return 0;
+	return _encodings[cls];
+}
+
+Coverage::Counter Coverage::executions(Word pc) const {
+	auto i=pc>>2;
+	if(i>=_executions.size()) return 0;
+	return _executions[i];
+}
+
+Coverage::Counter Coverage::taken(Word pc) const {
+	auto i=pc>>2;
+	if(i>=_taken.size()) return 0;
+	return _taken[i];
+}
+
+bool Coverage::isBranch(Word w) {
+	return (w>>30)==0x03;
+}
+
+/*
+ * Returns the mnemonic followed by the operand form,
+ * e.g. "add r,i" ("r" for a register, "i" for an immediate)
+ */
+
+std::string Coverage::encodingName(unsigned cls) {
+	auto opcode=static_cast<Word>(cls>>2);
+	auto op=findOpcode(opcode);
+	if(!op) return "<illegal opcode "+std::to_string(opcode)+">";
+	
+	std::string name=op->name;
+	if(op->operands>=1) name+=(cls&2)?" r":" i";
+	if(op->operands>=2) name+=(cls&1)?",r":",i";
+	return name;
+}
+
+/*
+ * Returns all encoding classes that the assembler can produce
+ */
+
+const std::vector<unsigned> &Coverage::validEncodings() {
+	static const std::vector<unsigned> encodings=[]() {
+		std::vector<unsigned> v;
+		for(auto const &op: opcodes) {
+			auto base=static_cast<unsigned>(op.opcode<<2);
+			if(op.operands==0) v.push_back(base);
+			else if(op.operands==1) v.push_back(base|2);
+			else {
+				v.push_back(base|3);
+				v.push_back(base|2);
+				if(op.rd1Immediate) {
+					v.push_back(base|1);
+					v.push_back(base);
+				}
+			}
+		}
+		return v;
+	}();
+	return encodings;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Coverage class which records which
+ * instruction encodings were executed (opcode, cjmpxx condition
+ * and register/immediate form of the Rd1 and Rd2 operands),
+ * as well as execution counts and branch outcomes for each
+ * instruction address.
+ */
+
+#ifndef COVERAGE_H_INCLUDED
+#define COVERAGE_H_INCLUDED
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class Coverage {
+public:
+	typedef std::uint32_t Word;
+	typedef std::uint64_t Counter;
+	
+// Number of encoding classes, see encodingClass()
+	static const unsigned Encodings=256;
+
+private:
+	Counter _encodings[Encodings];
+	std::vector<Counter> _executions;
+	std::vector<Counter> _taken;
+
+public:
+	Coverage(std::size_t words=0);
+	
+// "next" is the program counter after the instruction was executed
+	void addExecution(Word pc,Word w,Word next) {
+		_encodings[encodingClass(w)]++;
+		auto i=pc>>2;
+		if(i>=_executions.size()) return;
+		_executions[i]++;
+		if((w>>30)==0x03&&next!=pc+4) _taken[i]++; // cjmpxx
+	}
+	
+	void merge(const Coverage &other);
+	
+	std::size_t words() const;
+	Counter encoding(unsigned cls) const;
+	Counter executions(Word pc) const;
+	Counter taken(Word pc) const;
+
+/*
+ * The encoding class is the most significant byte of the
+ * instruction word (opcode and operand type bits). For lcs,
+ * these bits are partially occupied by the operand and are
+ * ignored.
+ */
+	static unsigned encodingClass(Word w) {
+		if((w>>29)==0x05) return 0xA0; // lcs
+		return w>>24;
+	}
+	
+	static bool isBranch(Word w);
+	static std::string encodingName(unsigned cls);
+	static const std::vector<unsigned> &validEncodings();
+};
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the CoverageReport class.
+ */
+
+#include "coveragereport.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+static std::string percentage(std::size_t value,std::size_t total) {
+	std::ostringstream ss;
+	double pct=100;
+	if(total>0) pct=100.0*static_cast<double>(value)/static_cast<double>(total);
+	ss<<std::fixed<<std::setprecision(2)<<pct<<'%';
+	return ss.str();
+}
+
+static std::vector<std::string> readSource(const std::string &filename) {
+	std::vector<std::string> lines;
+	std::ifstream in(filename,std::ios_base::in);
+	std::string line;
+	while(std::getline(in,line)) {
+		if(!line.empty()&&line.back()=='\r') line.pop_back();
+		auto pos=line.find_first_not_of(" \t");
+		if(pos==std::string::npos) line.clear();
+		else line.erase(0,pos);
+		lines.push_back(std::move(line));
+	}
+	return lines;
+}
+
+CoverageReport::CoverageReport() {
+	std::fill(_encodings,_encodings+Coverage::Encodings,0);
+}
+
+/*
+ * Merge coverage data of a single program. Data are merged by
+ * source line, so that code shared between tests (e.g. an included
+ * file) is covered if any of the tests covers it.
+ */
+
+void CoverageReport::add(const std::string &name,const Coverage &cov,
+	const std::vector<Word> &code,const Image::LineTable &lines)
+{
+	for(unsigned i=0;i<Coverage::Encodings;i++) _encodings[i]+=cov.encoding(i);
+	
+	if(lines.empty()) {
+		_noLineInfo.push_back(name);
+		return;
+	}
+	
+	for(auto const &l: lines) {
+		auto i=l.first>>2;
+		if(i>=code.size()) continue;
+		
+		auto it=_lines.emplace(std::make_pair(l.second.source,l.second.line),LineData {0,false,0,0}).first;
+		auto &data=it->second;
+		auto n=cov.executions(l.first);
+		data.executions+=n;
+		if(Coverage::isBranch(code[i])) {
+			auto taken=cov.taken(l.first);
+			data.branch=true;
+			data.taken+=taken;
+			data.notTaken+=n-taken;
+		}
+	}
+}
+
+/*
+ * Gaps are reported in the "file:line: message" format understood
+ * by most editors, followed by the source text
+ */
+
+void CoverageReport::write(std::ostream &os) const {
+	auto const &valid=Coverage::validEncodings();
+	std::size_t encodingsCovered=0;
+	for(auto cls: valid) {
+		if(_encodings[cls]>0) encodingsCovered++;
+	}
+	
+	std::size_t linesCovered=0;
+	std::size_t branchOutcomes=0;
+	std::size_t branchOutcomesCovered=0;
+	for(auto const &l: _lines) {
+		if(l.second.executions>0) linesCovered++;
+		if(l.second.branch) {
+			branchOutcomes+=2;
+			if(l.second.taken>0) branchOutcomesCovered++;
+			if(l.second.notTaken>0) branchOutcomesCovered++;
+		}
+	}
+	
+	os<<"// Instruction encodings: "<<encodingsCovered<<" of "<<valid.size()<<
+		" ("<<percentage(encodingsCovered,valid.size())<<")"<<std::endl;
+	os<<"// Source lines: "<<linesCovered<<" of "<<_lines.size()<<
+		" ("<<percentage(linesCovered,_lines.size())<<")"<<std::endl;
+	os<<"// Branch outcomes: "<<branchOutcomesCovered<<" of "<<branchOutcomes<<
+		" ("<<percentage(branchOutcomesCovered,branchOutcomes)<<")"<<std::endl;
+	for(auto const &name: _noLineInfo)
+		os<<"// No source line information for \""<<name<<"\" (not a source file)"<<std::endl;
+	os<<std::endl;
+	
+	os<<"// Instruction encodings (r: register operand, i: immediate operand)"<<std::endl;
+	for(auto cls: valid) {
+		auto name=Coverage::encodingName(cls);
+		os<<"//     "<<name<<std::string(16-std::min<std::size_t>(name.size(),15),' ');
+		if(_encodings[cls]>0) os<<_encodings[cls]<<std::endl;
+		else os<<"NOT EXECUTED"<<std::endl;
+	}
+	
+	for(unsigned cls=0;cls<Coverage::Encodings;cls++) {
+		if(_encodings[cls]==0) continue;
+		if(std::find(valid.begin(),valid.end(),cls)!=valid.end()) continue;
+		os<<"//     "<<Coverage::encodingName(cls)<<" (non-standard encoding 0x";
+		os<<std::hex<<std::setw(2)<<std::setfill('0')<<cls<<std::dec<<std::setfill(' ');
+		os<<"): "<<_encodings[cls]<<std::endl;
+	}
+	
+	if(linesCovered==_lines.size()&&branchOutcomesCovered==branchOutcomes) return;
+	
+	os<<std::endl;
+	os<<"// Source line coverage gaps"<<std::endl;
+	
+	std::string currentSource;
+	std::vector<std::string> text;
+	
+	for(auto const &l: _lines) {
+		auto const &data=l.second;
+		std::string msg;
+		if(data.executions==0) msg="not executed";
+		else if(data.branch&&data.taken==0) msg="branch never taken ("+std::to_string(data.executions)+" executions)";
+		else if(data.branch&&data.notTaken==0) msg="branch always taken ("+std::to_string(data.executions)+" executions)";
+		else continue;
+		
+		if(l.first.first!=currentSource) {
+			currentSource=l.first.first;
+			text=readSource(currentSource);
+		}
+		
+		os<<l.first.first<<":"<<l.first.second<<": "<<msg;
+		auto line=static_cast<std::size_t>(l.first.second);
+		if(line>0&&line<=text.size()) os<<": "<<text[line-1];
+		os<<std::endl;
+	}
+}
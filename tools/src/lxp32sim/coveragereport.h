@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the CoverageReport class which merges
+ * coverage data collected by multiple tests and reports coverage
+ * gaps: instruction encodings that were never executed, as well
+ * as source lines that were never executed and branches that
+ * were never (or always) taken.
+ */
+
+#ifndef COVERAGEREPORT_H_INCLUDED
+#define COVERAGEREPORT_H_INCLUDED
+
+#include "coverage.h"
+#include "image.h"
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <string>
+#include <utility>
+
+class CoverageReport {
+public:
+	typedef Coverage::Word Word;
+	typedef Coverage::Counter Counter;
+
+private:
+	struct LineData {
+		Counter executions;
+		bool branch;
+		Counter taken;
+		Counter notTaken;
+	};
+	
+	Counter _encodings[Coverage::Encodings];
+	std::map<std::pair<std::string,int>,LineData> _lines;
+	std::vector<std::string> _noLineInfo;
+
+public:
+	CoverageReport();
+	
+	void add(const std::string &name,const Coverage &cov,
+		const std::vector<Word> &code,const Image::LineTable &lines);
+	void write(std::ostream &os) const;
+};
+
+#endif
@@ -0,0 +1,619 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Cpu class.
+ */
+
+#include "cpu.h"
+#include "profile.h"
+#include "callgraph.h"
+#include "tracewriter.h"
+#include "coverage.h"
+#include "irqschedule.h"
+#include "irqstats.h"
+#include "perfregions.h"
+#include "utils.h"
+
+#include <stdexcept>
+#include <cstring>
+
+Cpu::Cpu(Bus &bus): _bus(&bus) {
+	reset();
+}
+
+void Cpu::setBus(Bus &bus) {
+	_bus=&bus;
+	resetLoopDetection();
+}
+
+void Cpu::setMulArch(MulArch arch) {
+	_mulArch=arch;
+}
+
+void Cpu::setDividerEnabled(bool b) {
+	_dividerEnabled=b;
+}
+
+void Cpu::setDbusRmw(bool b) {
+	_dbusRmw=b;
+}
+
+void Cpu::setStartAddress(Word addr) {
+	_startAddr=addr;
+}
+
+void Cpu::setICache(unsigned latency,Word burstSize,Word prefetchSize) {
+	_icache.configure(latency,burstSize,prefetchSize);
+	_icacheEnabled=true;
+}
+
+// Iteration timing can change, so polling loops must be detected anew
+
+void Cpu::setICacheTiming(bool b) {
+	if(b!=_icacheTiming) resetLoopDetection();
+	_icacheTiming=b;
+}
+
+const ICache *Cpu::icache() const {
+	if(!_icacheEnabled) return nullptr;
+	return &_icache;
+}
+
+void Cpu::setProfile(Profile *profile) {
+	_profile=profile;
+	updateInstrumented();
+}
+
+void Cpu::setCallGraph(CallGraph *callGraph) {
+	_callGraph=callGraph;
+	updateInstrumented();
+}
+
+void Cpu::setTrace(TraceWriter *trace) {
+	_trace=trace;
+	updateInstrumented();
+}
+
+void Cpu::setCoverage(Coverage *coverage) {
+	_coverage=coverage;
+	updateInstrumented();
+}
+
+void Cpu::setIrqSchedule(IrqSchedule *schedule) {
+	_irqSchedule=schedule;
+}
+
+void Cpu::setIrqStats(IrqStats *stats) {
+	_irqStats=stats;
+}
+
+void Cpu::setPerfRegions(PerfRegions *regions) {
+	_perfRegions=regions;
+}
+
+void Cpu::reset() {
+	std::memset(_regs,0,sizeof(_regs));
+	_pc=_startAddr;
+	_halted=false;
+	_wakeupReg=false;
+	_cycles=0;
+	_instructions=0;
+	_irqReg=0;
+	_pendingInterrupts=0;
+	_muxState=Ready;
+	_interruptVector=0;
+	resetLoopDetection();
+}
+
+/*
+ * Execute one instruction (or enter an interrupt, or wait for one
+ * cycle in the halted state). Up to "maxSkip" cycles can be skipped
+ * at once if the CPU is idle; 0 disables idle skipping.
+ */
+
+void Cpu::step(Counter maxSkip) {
+	if(_halted) {
+		if(_muxState==Requested||_wakeupReg) _halted=false;
+		else {
+			clock(1);
+			Counter cycles=1;
+// Interrupt multiplexer state can only change when IRQ lines do, unless
+// an edge-triggered request latched as pending is yet to be accepted
+			if(maxSkip>1&&_muxState!=Requested&&!_wakeupReg&&
+				!(_muxState==Ready&&_pendingInterrupts))
+			{
+				auto quiet=quietCycles(maxSkip-1,false);
+				_bus->skip(quiet);
+				_cycles+=quiet;
+				cycles+=quiet;
+			}
+			if(_profile) _profile->addCycles(_pc-4,cycles); // attribute to the hlt instruction
+			if(_callGraph) _callGraph->addCycles(cycles);
+			return;
+		}
+	}
+	
+	auto start=_cycles;
+	
+	if(_muxState==Requested) {
+		if(_trace) _trace->interrupt(start,_interruptVector);
+		enterInterrupt();
+		if(_profile) _profile->addCycles(_pc,_cycles-start); // attribute to the handler
+		if(_callGraph) {
+			_callGraph->interrupt(_interruptVector,_pc,_muxState==WaitForExit);
+			_callGraph->addCycles(_cycles-start);
+		}
+		return;
+	}
+	
+	auto pc=_pc;
+	auto muxState=_muxState;
+	if(_perfRegions) _perfRegions->instruction(pc,start);
+	unsigned waitStates=0;
+	Word w=fetchWord(_pc,waitStates);
+	if(waitStates>0) clock(waitStates);
+	if(_trace) _trace->instruction(start,pc,w);
+	execute(w);
+	_instructions++;
+	if(_coverage) _coverage->addExecution(pc,w,_pc);
+	if(_profile) _profile->addExecution(pc,_cycles-start);
+	if(_callGraph) trackCallGraph(pc,w,muxState,_cycles-start);
+// The next interrupt can already be requested during the cycles of "iret"
+	if(_irqStats&&muxState==WaitForExit&&_muxState!=WaitForExit) _irqStats->exit(_cycles);
+	
+// Skipped iterations can't be instrumented
+	if(_pc<=pc&&maxSkip>_cycles-start&&!_instrumented)
+		skipPollingLoop(maxSkip-(_cycles-start));
+}
+
+/*
+ * Must be called when the platform state is modified by anything
+ * other than the CPU
+ */
+
+void Cpu::resetLoopDetection() {
+	_loop.valid=false;
+}
+
+Cpu::Word Cpu::reg(int r) const {
+	return _regs[r&0xFF];
+}
+
+void Cpu::setReg(int r,Word value) {
+	_regs[r&0xFF]=value;
+}
+
+Cpu::Word Cpu::pc() const {
+	return _pc;
+}
+
+void Cpu::setPc(Word addr) {
+	_pc=addr&~Word(3);
+}
+
+bool Cpu::halted() const {
+	return _halted;
+}
+
+Cpu::Counter Cpu::cycles() const {
+	return _cycles;
+}
+
+Cpu::Counter Cpu::instructions() const {
+	return _instructions;
+}
+
+void Cpu::saveState(StateWriter &w) const {
+	for(auto r: _regs) w.word(r);
+	w.word(_pc);
+	w.flag(_halted);
+	w.flag(_wakeupReg);
+	w.counter(_cycles);
+	w.counter(_instructions);
+	w.word(_irqReg);
+	w.word(_pendingInterrupts);
+	w.word(static_cast<Word>(_muxState));
+	w.word(static_cast<Word>(_interruptVector));
+}
+
+void Cpu::loadState(StateReader &r) {
+	for(auto &reg: _regs) reg=r.word();
+	_pc=r.word();
+	_halted=r.flag();
+	_wakeupReg=r.flag();
+	_cycles=r.counter();
+	_instructions=r.counter();
+	_irqReg=static_cast<std::uint8_t>(r.word());
+	_pendingInterrupts=static_cast<std::uint8_t>(r.word());
+	auto state=r.word();
+	if(state>WaitForExit) throw std::runtime_error("Bad interrupt multiplexer state");
+	_muxState=static_cast<MuxState>(state);
+	_interruptVector=static_cast<int>(r.word()&7);
+	resetLoopDetection();
+}
+
+/*
+ * Bit-exact model of the non-restoring divider (lxp32_divider.vhd),
+ * including the result of division by zero
+ */
+
+Cpu::Word Cpu::divide(Word op1,Word op2,bool sign,bool mod) {
+	static const std::uint64_t Mask33=0x1FFFFFFFFULL;
+	
+	bool op1Negative=sign&&(op1&0x80000000)!=0;
+	bool op2Negative=sign&&(op2&0x80000000)!=0;
+	
+	Word dividendPos=op1Negative?Word(-op1):op1;
+	std::uint64_t divisor=op2|(op2Negative?0x100000000ULL:0);
+	
+	Word dividend=dividendPos<<1;
+	std::uint64_t partialRemainder=dividendPos>>31;
+	bool sub=!op2Negative;
+	bool sumPositive=false;
+	
+	for(int i=0;i<32;i++) {
+		std::uint64_t addend=(sub?~divisor:divisor)&Mask33;
+		std::uint64_t sum=(partialRemainder+addend+(sub?1:0))&Mask33;
+		sumPositive=(sum&0x100000000ULL)==0;
+		partialRemainder=((sum<<1)&Mask33)|(dividend>>31);
+		dividend=(dividend<<1)|(sumPositive?1:0);
+		sub=sumPositive!=op2Negative;
+	}
+	
+	Word result;
+	bool invert;
+	
+	if(!mod) {
+		result=dividend;
+		invert=op1Negative!=op2Negative;
+	}
+	else {
+		Word corrector=0;
+		if(!sumPositive) corrector=op2Negative?Word(~op2+1):op2;
+		result=Word(partialRemainder>>1)+corrector;
+		invert=op1Negative;
+	}
+	
+	return invert?Word(-result):result;
+}
+
+/*
+ * Returns the register name, using aliases for special purpose registers
+ */
+
+std::string Cpu::registerName(int r) {
+	if(r>=IvBase&&r<IvBase+8) return "iv"+std::to_string(r-IvBase);
+	if(r==Cr) return "cr";
+	if(r==Irp) return "irp";
+	if(r==Rp) return "rp";
+	if(r==Sp) return "sp";
+	return "r"+std::to_string(r);
+}
+
+/*
+ * Private members
+ */
+
+void Cpu::clock(Counter n) {
+	for(Counter i=0;i<n;i++) {
+		auto irq=_bus->clock();
+		if(_irqSchedule) irq=_irqSchedule->clock(irq,_instructions,_cycles,_regs[Cr]);
+		clockInterruptMux(irq);
+		_cycles++;
+	}
+}
+
+// A replayed interrupt schedule can limit idle skipping too
+
+Cpu::Counter Cpu::quietCycles(Counter limit,bool accesses) {
+	auto quiet=_bus->quietCycles(limit,accesses);
+	if(_irqSchedule) quiet=_irqSchedule->quietCycles(quiet,accesses,_instructions,_cycles);
+	return quiet;
+}
+
+void Cpu::clockInterruptMux(std::uint8_t irqIn) {
+	auto cr=_regs[Cr];
+	auto enabled=static_cast<std::uint8_t>(cr);
+	auto wakeup=static_cast<std::uint8_t>(cr>>8);
+	auto level=static_cast<std::uint8_t>(cr>>16);
+	auto invert=static_cast<std::uint8_t>(cr>>24);
+	
+	auto irq=static_cast<std::uint8_t>(irqIn^invert);
+	auto pending=static_cast<std::uint8_t>((_pendingInterrupts|(irq&~_irqReg))&
+		~level&enabled&~wakeup);
+	
+	if(_muxState==Ready) {
+		for(int i=0;i<8;i++) { // lower interrupts have priority
+			std::uint8_t mask=1<<i;
+			if((!(level&mask)&&(_pendingInterrupts&mask))||
+				((level&mask)&&(irq&mask)&&(enabled&mask)&&!(wakeup&mask)))
+			{
+				pending&=~mask;
+				_interruptVector=i;
+				_muxState=Requested;
+				break;
+			}
+		}
+	}
+	
+	if(_irqStats) {
+		auto requests=static_cast<std::uint8_t>(pending|(level&irq&enabled&~wakeup));
+		if(_muxState==Requested) requests|=1<<_interruptVector;
+		_irqStats->update(requests,_cycles);
+	}
+	
+	auto wakeupEnabled=static_cast<std::uint8_t>(enabled&wakeup);
+	if((wakeupEnabled&~level&irq&~_irqReg)||(wakeupEnabled&level&irq)) _wakeupReg=true;
+	
+	_irqReg=irq;
+	_pendingInterrupts=pending;
+}
+
+void Cpu::enterInterrupt() {
+	_regs[Irp]=_pc|1; // LSB indicates interrupt return
+	_muxState=WaitForExit;
+	jump(_regs[IvBase+_interruptVector]); // IRF bit makes the interrupt non-returnable
+	if(_irqStats) _irqStats->enter(_interruptVector,_cycles+4,_muxState==WaitForExit); // after the cycles below
+	clock(4);
+}
+
+void Cpu::jump(Word target) {
+	if((target&1)&&_muxState==WaitForExit) _muxState=Ready;
+	_pc=target&~Word(3);
+}
+
+void Cpu::execute(Word w) {
+	auto opcode=w>>26;
+	int dst=(w>>16)&0xFF;
+	
+	Word rd1,rd2;
+	if(w&0x02000000) rd1=_regs[(w>>8)&0xFF];
+	else rd1=static_cast<Word>(static_cast<std::int8_t>(w>>8));
+	if(w&0x01000000) rd2=_regs[w&0xFF];
+	else rd2=static_cast<Word>(static_cast<std::int8_t>(w));
+	
+	Word next=_pc+4;
+	unsigned cycles=1;
+	unsigned waitStates=0;
+	
+	if((opcode>>3)==0x05) { // lcs
+		Word value=(w&0xFFFF)|((w>>8)&0x1F0000);
+		if(value&0x100000) value|=0xFFE00000;
+		_regs[dst]=value;
+		_pc=next;
+		clock(1);
+		return;
+	}
+	
+	if((opcode>>4)==0x03) { // cjmpxx
+		bool taken=((opcode&0x08)&&rd1==rd2)||
+			((opcode&0x04)&&rd1!=rd2)||
+			((opcode&0x02)&&rd1>rd2)||
+			((opcode&0x01)&&static_cast<std::int32_t>(rd1)>static_cast<std::int32_t>(rd2));
+		if(taken) {
+			jump(_regs[dst]);
+			clock(5);
+		}
+		else {
+			_pc=next;
+			clock(2);
+		}
+		return;
+	}
+	
+	switch(opcode) {
+	case 0x00: // nop
+		break;
+	case 0x01: // lc
+		_regs[dst]=fetchWord(next,waitStates);
+		next+=4;
+		cycles=2;
+		break;
+	case 0x02: // hlt
+		_pc=next;
+		_halted=true;
+		_wakeupReg=false;
+		clock(1);
+		return;
+	case 0x08: // lw
+		_regs[dst]=loadWord(rd1,waitStates);
+		cycles=3;
+		break;
+	case 0x0A: // lub
+		_regs[dst]=loadByte(rd1,false,waitStates);
+		cycles=3;
+		break;
+	case 0x0B: // lsb
+		_regs[dst]=loadByte(rd1,true,waitStates);
+		cycles=3;
+		break;
+	case 0x0C: // sw
+		storeWord(rd1,rd2,waitStates);
+		cycles=2;
+		break;
+	case 0x0E: // sb
+		storeByte(rd1,rd2,waitStates);
+		cycles=2;
+		break;
+	case 0x10: // add
+		_regs[dst]=rd1+rd2;
+		break;
+	case 0x11: // sub
+		_regs[dst]=rd1-rd2;
+		break;
+	case 0x12: // mul
+		_regs[dst]=rd1*rd2;
+		cycles=mulCycles();
+		break;
+	case 0x14: // divu
+	case 0x15: // divs
+	case 0x16: // modu
+	case 0x17: // mods
+		if(_dividerEnabled) {
+			_regs[dst]=divide(rd1,rd2,(opcode&1)!=0,(opcode&2)!=0);
+			cycles=(opcode&2)?37:36;
+		}
+		else {
+			_regs[dst]=0;
+			cycles=2;
+		}
+		break;
+	case 0x18: // and
+		_regs[dst]=rd1&rd2;
+		break;
+	case 0x19: // or
+		_regs[dst]=rd1|rd2;
+		break;
+	case 0x1A: // xor
+		_regs[dst]=rd1^rd2;
+		break;
+	case 0x1C: // sl
+		_regs[dst]=rd1<<(rd2&0x1F);
+		cycles=2;
+		break;
+	case 0x1E: // sru
+		_regs[dst]=rd1>>(rd2&0x1F);
+		cycles=2;
+		break;
+	case 0x1F: // srs
+		_regs[dst]=static_cast<Word>(static_cast<std::int32_t>(rd1)>>(rd2&0x1F));
+		cycles=2;
+		break;
+	case 0x20: // jmp
+	case 0x21: // call
+		if(opcode&1) _regs[dst]=next;
+		jump(rd1);
+		clock(4);
+		return;
+	default:
+		throw std::runtime_error("Illegal instruction 0x"+Utils::hex(w)+" at address 0x"+Utils::hex(_pc));
+	}
+	
+	_pc=next;
+	clock(cycles+waitStates);
+}
+
+/*
+ * Cycles are attributed before the stack is updated, so that a call
+ * instruction is charged to the caller and a return to the callee
+ */
+
+void Cpu::trackCallGraph(Word pc,Word w,MuxState muxState,Counter cycles) {
+	_callGraph->addCycles(cycles);
+	
+	auto opcode=w>>26;
+	if(opcode==0x21) _callGraph->call(_pc,pc+4);
+	else if(muxState==WaitForExit&&_muxState==Ready) _callGraph->interruptReturn();
+	else if((opcode==0x20||(opcode>>4)==0x03)&&_pc!=pc+4) _callGraph->jump(_pc);
+}
+
+/*
+ * Called after a backward jump. If the loop iteration that has just
+ * completed didn't write to the bus, left the CPU state unchanged,
+ * didn't start or end a performance region and took place while the
+ * bus was quiet, all subsequent iterations will be identical until
+ * the next peripheral event, so they are skipped.
+ */
+
+void Cpu::skipPollingLoop(Counter maxSkip) {
+	Counter perfEvents=_perfRegions?_perfRegions->events():0;
+	
+	if(_loop.valid&&!_loop.written&&_loop.pc==_pc&&_cycles<=_loop.quietEnd&&
+		_loop.wakeupReg==_wakeupReg&&_loop.irqReg==_irqReg&&
+		_loop.pendingInterrupts==_pendingInterrupts&&_loop.muxState==_muxState&&
+		_loop.perfEvents==perfEvents&&!std::memcmp(_loop.regs,_regs,sizeof(_regs)))
+	{
+		auto period=_cycles-_loop.cycles;
+		auto iterations=quietCycles(maxSkip,true)/period;
+		if(iterations>0) {
+			_bus->skip(iterations*period);
+			_cycles+=iterations*period;
+			_instructions+=iterations*(_instructions-_loop.instructions);
+			maxSkip-=iterations*period;
+		}
+	}
+	
+	auto quiet=quietCycles(maxSkip,true);
+	_loop.valid=(quiet>0);
+	if(!_loop.valid) return;
+	_loop.written=false;
+	_loop.pc=_pc;
+	_loop.cycles=_cycles;
+	_loop.instructions=_instructions;
+	_loop.quietEnd=_cycles+quiet;
+	_loop.wakeupReg=_wakeupReg;
+	_loop.irqReg=_irqReg;
+	_loop.pendingInterrupts=_pendingInterrupts;
+	_loop.muxState=_muxState;
+	_loop.perfEvents=perfEvents;
+	std::memcpy(_loop.regs,_regs,sizeof(_regs));
+}
+
+/*
+ * Skipped polling loop iterations aren't seen by the profiler, the
+ * call graph, the trace writer and coverage collection. The rest of
+ * the instrumentation only observes interrupts and performance region
+ * events, which can't occur in skipped iterations.
+ */
+
+void Cpu::updateInstrumented() {
+	_instrumented=(_profile||_callGraph||_trace||_coverage);
+}
+
+Cpu::Word Cpu::fetchWord(Word addr,unsigned &waitStates) {
+	Word data;
+	waitStates+=_bus->fetch(addr,data);
+	if(_icacheEnabled) waitStates+=_icache.fetch(addr>>2,_cycles+waitStates,_icacheTiming);
+	return data;
+}
+
+unsigned Cpu::busRead(Word addr,Word sel,Word &data) {
+	auto waitStates=_bus->read(addr,sel,data);
+	if(_trace) _trace->read(addr,static_cast<std::uint8_t>(sel),data);
+	return waitStates;
+}
+
+unsigned Cpu::busWrite(Word addr,Word sel,Word data) {
+	_loop.written=true;
+	if(_trace) _trace->write(addr,static_cast<std::uint8_t>(sel),data);
+	return _bus->write(addr,sel,data);
+}
+
+Cpu::Word Cpu::loadWord(Word addr,unsigned &waitStates) {
+	Word data;
+	waitStates+=busRead(addr&~Word(3),0xF,data);
+	return data;
+}
+
+Cpu::Word Cpu::loadByte(Word addr,bool sign,unsigned &waitStates) {
+	Word data;
+	int shift=(addr&3)*8;
+	waitStates+=busRead(addr&~Word(3),Word(1)<<(addr&3),data);
+	Word b=(data>>shift)&0xFF;
+	if(sign&&(b&0x80)) b|=0xFFFFFF00;
+	return b;
+}
+
+void Cpu::storeWord(Word addr,Word value,unsigned &waitStates) {
+	waitStates+=busWrite(addr&~Word(3),0xF,value);
+}
+
+void Cpu::storeByte(Word addr,Word value,unsigned &waitStates) {
+	int shift=(addr&3)*8;
+	Word b=value&0xFF;
+	if(!_dbusRmw) {
+		waitStates+=busWrite(addr&~Word(3),Word(1)<<(addr&3),b*0x01010101);
+	}
+	else {
+		Word data;
+		waitStates+=busRead(addr&~Word(3),0xF,data);
+		data=(data&~(Word(0xFF)<<shift))|(b<<shift);
+		waitStates+=busWrite(addr&~Word(3),0xF,data)+1;
+	}
+}
+
+unsigned Cpu::mulCycles() const {
+	return CoreProfile::mulCycles(_mulArch);
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Cpu class which models the LXP32
+ * instruction set together with the interrupt multiplexer.
+ * Cycle counts follow the instruction timing table from the
+ * LXP32 Technical Reference Manual.
+ *
+ * When allowed by the caller, idle periods are skipped: a halted
+ * CPU is advanced straight to the next peripheral event, and so
+ * is a polling loop whose iterations don't change anything.
+ *
+ * Instruction fetches can optionally go through a model of the LXP32C
+ * instruction cache (see ICache). Its timing can be turned off for
+ * fast functional simulation, in which case the cache is only warmed.
+ */
+
+#ifndef CPU_H_INCLUDED
+#define CPU_H_INCLUDED
+
+#include "bus.h"
+#include "state.h"
+#include "icache.h"
+#include "coreprofile.h"
+
+#include <string>
+#include <cstdint>
+
+class Profile;
+class CallGraph;
+class TraceWriter;
+class Coverage;
+class IrqSchedule;
+class IrqStats;
+class PerfRegions;
+
+class Cpu {
+public:
+	typedef std::uint32_t Word;
+	typedef std::uint64_t Counter;
+	
+	typedef CoreProfile::MulArch MulArch;
+	
+// Special purpose registers
+	static const int IvBase=240;
+	static const int Cr=252;
+	static const int Irp=253;
+	static const int Rp=254;
+	static const int Sp=255;
+
+private:
+	enum MuxState {Ready,Requested,WaitForExit};
+	
+	Bus *_bus;
+	
+	Word _regs[256];
+	Word _pc;
+	bool _halted;
+	bool _wakeupReg;
+	Counter _cycles;
+	Counter _instructions;
+	
+// Interrupt multiplexer state (see lxp32_interrupt_mux.vhd)
+	std::uint8_t _irqReg;
+	std::uint8_t _pendingInterrupts;
+	MuxState _muxState;
+	int _interruptVector;
+	
+// Polling loop detection: state at the beginning of the last iteration
+	struct LoopState {
+		bool valid=false;
+		bool written=false;
+		Word pc=0;
+		Counter cycles=0;
+		Counter instructions=0;
+		Counter quietEnd=0;
+		bool wakeupReg=false;
+		std::uint8_t irqReg=0;
+		std::uint8_t pendingInterrupts=0;
+		MuxState muxState=Ready;
+		Counter perfEvents=0;
+		Word regs[256];
+	};
+	
+	LoopState _loop;
+	
+// Configuration
+	MulArch _mulArch=CoreProfile::MulDsp;
+	bool _dividerEnabled=true;
+	bool _dbusRmw=false;
+	Word _startAddr=0;
+	
+// Instruction cache (not a part of snapshots: starts empty after a restore)
+	ICache _icache;
+	bool _icacheEnabled=false;
+	bool _icacheTiming=true;
+	
+// Optional instrumentation
+	Profile *_profile=nullptr;
+	CallGraph *_callGraph=nullptr;
+	TraceWriter *_trace=nullptr;
+	Coverage *_coverage=nullptr;
+	IrqSchedule *_irqSchedule=nullptr;
+	IrqStats *_irqStats=nullptr;
+	PerfRegions *_perfRegions=nullptr;
+	bool _instrumented=false; // some of the above must see every instruction
+
+public:
+	Cpu(Bus &bus);
+	
+	void setBus(Bus &bus);
+	
+	void setMulArch(MulArch arch);
+	void setDividerEnabled(bool b);
+	void setDbusRmw(bool b);
+	void setStartAddress(Word addr);
+	void setICache(unsigned latency,Word burstSize,Word prefetchSize);
+	void setICacheTiming(bool b);
+	const ICache *icache() const;
+	void setProfile(Profile *profile);
+	void setCallGraph(CallGraph *callGraph);
+	void setTrace(TraceWriter *trace);
+	void setCoverage(Coverage *coverage);
+	void setIrqSchedule(IrqSchedule *schedule);
+	void setIrqStats(IrqStats *stats);
+	void setPerfRegions(PerfRegions *regions);
+	
+	void reset();
+	void step(Counter maxSkip=0);
+	void resetLoopDetection();
+	
+	Word reg(int r) const;
+	void setReg(int r,Word value);
+	Word pc() const;
+	void setPc(Word addr);
+	bool halted() const;
+	
+	Counter cycles() const;
+	Counter instructions() const;
+	
+	void saveState(StateWriter &w) const;
+	void loadState(StateReader &r);
+	
+	static Word divide(Word op1,Word op2,bool sign,bool mod);
+	static std::string registerName(int r);
+
+private:
+	void clock(Counter n);
+	Counter quietCycles(Counter limit,bool accesses);
+	void clockInterruptMux(std::uint8_t irq);
+	void enterInterrupt();
+	void jump(Word target);
+	void execute(Word w);
+	void trackCallGraph(Word pc,Word w,MuxState muxState,Counter cycles);
+	void skipPollingLoop(Counter maxSkip);
+	void updateInstrumented();
+	
+	Word fetchWord(Word addr,unsigned &waitStates);
+	unsigned busRead(Word addr,Word sel,Word &data);
+	unsigned busWrite(Word addr,Word sel,Word data);
+	Word loadWord(Word addr,unsigned &waitStates);
+	Word loadByte(Word addr,bool sign,unsigned &waitStates);
+	void storeWord(Word addr,Word value,unsigned &waitStates);
+	void storeByte(Word addr,Word value,unsigned &waitStates);
+	
+	unsigned mulCycles() const;
+};
+
+#endif
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Dma class.
+ */
+
+#include "dma.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+/*
+ * Called by the bus after a write to the registers: a started engine
+ * requests the bus in the "now" cycle
+ */
+
+void Dma::wake(Counter now) {
+	if(_state!=Idle&&_request==Never) _request=now;
+}
+
+bool Dma::busy() const {
+	return _state!=Idle;
+}
+
+Dma::Counter Dma::request() const {
+	return _request;
+}
+
+/*
+ * Performs the next bus cycle of the engine, which has been granted
+ * the bus in the "start" cycle. Returns the length of the bus cycle.
+ * Every beat takes the wait states reported by the slave plus one
+ * cycle; with registered feedback, the slaves are assumed to support
+ * incrementing bursts, so all beats but the first take one cycle.
+ */
+
+unsigned Dma::cycle(Master &bus,Counter start,bool registeredFeedback) {
+	unsigned cycles=0;
+	auto beat=[&](unsigned waitStates,bool first) {
+		if(registeredFeedback&&!first) cycles++;
+		else cycles+=waitStates+1;
+	};
+	
+	switch(_state) {
+	case Idle:
+		return 0;
+	case Fetch:
+		{
+			Word d[4];
+			for(Word i=0;i<4;i++) beat(bus.read(_head+i*4,d[i]),i==0);
+			if(!(d[2]&Own)) {
+				_state=Idle;
+				break;
+			}
+			_src=d[0]&~Word(3);
+			_dst=d[1]&~Word(3);
+			_flags=d[2];
+			_left=d[2]&CountMask;
+			_next=d[3]&~Word(3);
+			_state=(_left>0)?Read:WriteBack;
+		}
+		break;
+	case Read:
+		_buffer.resize(std::min(_left,_burst));
+		for(Word i=0;i<_buffer.size();i++) {
+			beat(bus.read(_src,_buffer[i]),i==0);
+			if(!(_flags&FixedSrc)) _src+=4;
+		}
+		_state=Write;
+		break;
+	case Write:
+		for(Word i=0;i<_buffer.size();i++) {
+			beat(bus.write(_dst,_buffer[i]),i==0);
+			if(!(_flags&FixedDst)) _dst+=4;
+		}
+		_left-=static_cast<Word>(_buffer.size());
+		_stats.words+=_buffer.size();
+		_state=(_left>0)?Read:WriteBack;
+		break;
+	case WriteBack:
+		beat(bus.write(_head+8,_flags&~Own),true);
+		if(_flags&Irq) _irq=true;
+		_head=_next;
+		_done++;
+		_stats.descriptors++;
+		_state=Fetch;
+		break;
+	}
+	
+	_stats.busCycles+=cycles;
+	if(_state==Idle) _request=Never;
+	else _request=start+cycles+1;
+	return cycles;
+}
+
+const Dma::Stats &Dma::stats() const {
+	return _stats;
+}
+
+unsigned Dma::read(Word addr,Word,Word &data) {
+	switch(addr) {
+	case Start:
+		data=busy()?1:0;
+		break;
+	case Head:
+		data=_head;
+		break;
+	case Status:
+		data=_irq?1:0;
+		break;
+	case Burst:
+		data=_burst;
+		break;
+	case Done:
+		data=_done;
+		break;
+	default:
+		data=0;
+	}
+	return 0;
+}
+
+/*
+ * Registers are only written as whole words. The descriptor address
+ * can only be changed while the engine is stopped.
+ */
+
+unsigned Dma::write(Word addr,Word sel,Word data) {
+	if(sel!=0xF) return 0;
+	switch(addr) {
+	case Start:
+		if(_state==Idle) {
+			_state=Fetch;
+			_request=Never; // see wake()
+		}
+		break;
+	case Head:
+		if(_state==Idle) _head=data&~Word(3);
+		break;
+	case Status:
+		if(data&1) _irq=false;
+		break;
+	case Burst:
+		_burst=std::max<Word>(1,std::min(data,Word(MaxBurst)));
+		break;
+	}
+	return 0;
+}
+
+bool Dma::irq() const {
+	return _irq;
+}
+
+void Dma::saveState(StateWriter &w) const {
+	w.word(static_cast<Word>(_state));
+	w.counter(_request);
+	w.word(_head);
+	w.word(_burst);
+	w.word(_done);
+	w.flag(_irq);
+	w.word(_src);
+	w.word(_dst);
+	w.word(_flags);
+	w.word(_next);
+	w.word(_left);
+	w.word(static_cast<Word>(_buffer.size()));
+	for(auto word: _buffer) w.word(word);
+}
+
+void Dma::loadState(StateReader &r) {
+	auto state=r.word();
+	if(state>WriteBack) throw std::runtime_error("Bad DMA engine state");
+	_state=static_cast<State>(state);
+	_request=r.counter();
+	_head=r.word();
+	_burst=r.word();
+	_done=r.word();
+	_irq=r.flag();
+	_src=r.word();
+	_dst=r.word();
+	_flags=r.word();
+	_next=r.word();
+	_left=r.word();
+	auto size=r.word();
+	if(size>MaxBurst) throw std::runtime_error("Bad DMA buffer size");
+	_buffer.resize(size);
+	for(auto &word: _buffer) word=r.word();
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Dma class, a simulator-only DMA engine
+ * which is both a slave (its registers) and a second bus master.
+ *
+ * The engine processes a chain of 16-byte descriptors in memory:
+ *     +0  source address
+ *     +4  destination address
+ *     +8  word count (bits 23..0) and flags (Own, Irq, FixedSrc, FixedDst)
+ *     +12 next descriptor address
+ * A descriptor is processed only if its Own flag is set. When it is
+ * done, the flag is cleared in memory, and a completion interrupt is
+ * raised if requested. A descriptor without the Own flag stops the
+ * engine; it is fetched again when the engine is restarted, so that
+ * a ring of descriptors can be refilled by the software.
+ *
+ * Every bus cycle issued by the engine is one WISHBONE cycle: the
+ * descriptor fetch (an incrementing burst of 4 words), a read burst
+ * into the internal buffer, a write burst from the buffer and the
+ * descriptor write-back. The engine deasserts CYC for at least one
+ * cycle between bus cycles, giving other masters a chance to win the
+ * arbitration. The bus itself is provided by the caller (see
+ * Platform) through the Master interface.
+ */
+
+#ifndef DMA_H_INCLUDED
+#define DMA_H_INCLUDED
+
+#include "peripherals.h"
+
+#include <vector>
+
+class Dma : public Slave {
+public:
+	enum Register {
+		Start=0x00, // W: start processing descriptors at HEAD; R: 1 if busy
+		Head=0x04, // RW: address of the current descriptor
+		Status=0x08, // R: interrupt pending (bit 0); W: 1 clears the interrupt
+		Burst=0x0C, // RW: maximum burst length in words (1-256)
+		Done=0x10 // R: number of descriptors completed since reset
+	};
+	
+	static const Word Own=0x80000000;
+	static const Word Irq=0x40000000;
+	static const Word FixedSrc=0x20000000;
+	static const Word FixedDst=0x10000000;
+	static const Word CountMask=0x00FFFFFF;
+	static const Word MaxBurst=256;
+	
+	class Master {
+	public:
+		virtual ~Master() {}
+		virtual unsigned read(Word addr,Word &data)=0;
+		virtual unsigned write(Word addr,Word data)=0;
+	};
+	
+	struct Stats {
+		Counter descriptors=0;
+		Counter words=0;
+		Counter busCycles=0;
+	};
+
+private:
+	enum State {Idle,Fetch,Read,Write,WriteBack};
+	
+	State _state=Idle;
+	Counter _request=Never;
+	Word _head=0;
+	Word _burst=8;
+	Word _done=0;
+	bool _irq=false;
+	
+// Current descriptor
+	Word _src=0;
+	Word _dst=0;
+	Word _flags=0;
+	Word _next=0;
+	Word _left=0;
+	std::vector<Word> _buffer;
+	
+	Stats _stats;
+
+public:
+	void wake(Counter now);
+	bool busy() const;
+	Counter request() const;
+	unsigned cycle(Master &bus,Counter start,bool registeredFeedback);
+	const Stats &stats() const;
+	
+	virtual unsigned read(Word addr,Word sel,Word &data) override;
+	virtual unsigned write(Word addr,Word sel,Word data) override;
+	virtual bool irq() const override;
+	virtual void saveState(StateWriter &w) const override;
+	virtual void loadState(StateReader &r) override;
+};
+
+#endif
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Explorer class.
+ */
+
+#include "explorer.h"
+#include "icache.h"
+#include "parallel.h"
+#include "utils.h"
+
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+
+/*
+ * Explorer::Grid members
+ */
+
+// Parameter specification: "<name>=<value>[,<value>...]"
+
+void Explorer::Grid::set(const std::string &spec) {
+	auto eq=spec.find('=');
+	if(eq==std::string::npos) throw std::runtime_error("Invalid grid parameter specification: \""+spec+"\"");
+	auto name=spec.substr(0,eq);
+	
+	std::vector<std::string> values;
+	std::istringstream ss(spec.substr(eq+1));
+	std::string value;
+	while(std::getline(ss,value,',')) values.push_back(value);
+	if(values.empty()) throw std::runtime_error("No values for grid parameter \""+name+"\"");
+	
+	auto invalid=[&](const std::string &v) {
+		return std::runtime_error("Invalid value of grid parameter \""+name+"\": \""+v+"\"");
+	};
+	
+	auto toBool=[&](std::vector<bool> &list) {
+		list.clear();
+		for(auto const &v: values) {
+			if(v=="on") list.push_back(true);
+			else if(v=="off") list.push_back(false);
+			else throw invalid(v);
+		}
+	};
+	
+	auto toUnsigned=[&](std::vector<unsigned> &list) {
+		list.clear();
+		for(auto const &v: values) {
+			try {
+				std::size_t end;
+				auto n=std::stoul(v,&end,0);
+				if(end!=v.size()) throw std::exception();
+				list.push_back(static_cast<unsigned>(n));
+			}
+			catch(std::exception &) {
+				throw invalid(v);
+			}
+		}
+	};
+	
+	if(name=="core") {
+		cached.clear();
+		for(auto const &v: values) {
+			if(v=="u") cached.push_back(false);
+			else if(v=="c") cached.push_back(true);
+			else throw invalid(v);
+		}
+	}
+	else if(name=="mul") {
+		mulArch.clear();
+		for(auto const &v: values) {
+			if(v=="dsp") mulArch.push_back(CoreProfile::MulDsp);
+			else if(v=="opt") mulArch.push_back(CoreProfile::MulOpt);
+			else if(v=="seq") mulArch.push_back(CoreProfile::MulSeq);
+			else throw invalid(v);
+		}
+	}
+	else if(name=="div") toBool(dividerEnabled);
+	else if(name=="rmw") toBool(dbusRmw);
+	else if(name=="latency") toUnsigned(latency);
+	else if(name=="burst") toUnsigned(burstSize);
+	else if(name=="prefetch") toUnsigned(prefetchSize);
+	else throw std::runtime_error("Unrecognized grid parameter: \""+name+"\"");
+}
+
+// Instruction cache parameters only multiply LXP32C configurations
+
+std::vector<Explorer::Point> Explorer::Grid::points() const {
+	std::vector<Point> list;
+	Point p;
+	
+	for(bool c: cached) {
+		p.cached=c;
+		for(auto arch: mulArch) {
+			p.mulArch=arch;
+			for(bool div: dividerEnabled) {
+				p.dividerEnabled=div;
+				for(bool rmw: dbusRmw) {
+					p.dbusRmw=rmw;
+					if(!c) {
+						list.push_back(p);
+						continue;
+					}
+					for(auto lat: latency) {
+						p.latency=lat;
+						for(auto burst: burstSize) {
+							p.burstSize=burst;
+							for(auto prefetch: prefetchSize) {
+								p.prefetchSize=prefetch;
+								list.push_back(p);
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	
+	return list;
+}
+
+/*
+ * Explorer members
+ */
+
+void Explorer::setSettings(const Runner::Settings &s) {
+	_settings=s;
+}
+
+void Explorer::setThreads(unsigned n) {
+	_threads=n;
+}
+
+void Explorer::addFile(const std::string &filename) {
+	_files.push_back(filename);
+}
+
+/*
+ * Each test is run on each configuration as a separate job by its own
+ * single-threaded Runner, so that all host cores are kept busy even
+ * when there are fewer tests than cores.
+ */
+
+std::vector<Explorer::Outcome> Explorer::run(const Grid &grid) const {
+	auto points=grid.points();
+	
+	for(auto const &p: points) {
+		if(p.cached) ICache().configure(p.latency,p.burstSize,p.prefetchSize); // throws on invalid parameters
+	}
+	
+	std::vector<Outcome> outcomes(points.size());
+	for(std::size_t i=0;i<points.size();i++) {
+		outcomes[i].point=points[i];
+		outcomes[i].results.resize(_files.size());
+	}
+	
+	Parallel::forEach(points.size()*_files.size(),_threads,[&](std::size_t j) {
+		auto const &p=points[j/_files.size()];
+		auto &res=outcomes[j/_files.size()].results[j%_files.size()];
+		
+		Runner::Settings s=_settings;
+		s.mulArch=p.mulArch;
+		s.dividerEnabled=p.dividerEnabled;
+		s.dbusRmw=p.dbusRmw;
+		s.icache=p.cached;
+		s.icacheLatency=p.latency;
+		s.icacheBurstSize=p.burstSize;
+		s.icachePrefetchSize=p.prefetchSize;
+		
+		Runner runner;
+		runner.setSettings(s);
+		runner.setThreads(1);
+		runner.addFile(_files[j%_files.size()]);
+		res=runner.run().front();
+	});
+	
+	for(auto &o: outcomes) {
+		o.passed=true;
+		for(auto const &res: o.results) {
+			if(res.status!=Runner::Result::Success) o.passed=false;
+			o.cycles+=res.cycles;
+		}
+	}
+	
+	for(auto &o: outcomes) {
+		if(!o.passed) continue;
+		o.pareto=std::none_of(outcomes.begin(),outcomes.end(),[&](const Outcome &other) {
+			return dominates(other,o);
+		});
+	}
+	
+	return outcomes;
+}
+
+void Explorer::writeCsv(std::ostream &os,const std::vector<Outcome> &outcomes) const {
+	os<<"core,mul,divider,rmw,latency,burst,prefetch,passed,cycles,pareto";
+	for(auto const &filename: _files) os<<","<<csvField(filename);
+	os<<std::endl;
+	
+	for(auto const &o: outcomes) {
+		auto const &p=o.point;
+		os<<(p.cached?"lxp32c":"lxp32u")<<","<<mulArchName(p.mulArch)<<",";
+		os<<(p.dividerEnabled?"on":"off")<<","<<(p.dbusRmw?"on":"off")<<",";
+		if(p.cached) os<<p.latency<<","<<p.burstSize<<","<<p.prefetchSize<<",";
+		else os<<",,,";
+		os<<(o.passed?"yes":"no")<<","<<o.cycles<<","<<(o.pareto?"yes":"no");
+		for(auto const &res: o.results) {
+			os<<",";
+			if(res.status==Runner::Result::Success) os<<res.cycles;
+		}
+		os<<std::endl;
+	}
+}
+
+void Explorer::writeJson(std::ostream &os,const std::vector<Outcome> &outcomes) const {
+	os<<"{"<<std::endl;
+	os<<"  \"tests\": [";
+	for(std::size_t i=0;i<_files.size();i++) {
+		if(i>0) os<<", ";
+		os<<Utils::jsonString(_files[i]);
+	}
+	os<<"],"<<std::endl;
+	
+	os<<"  \"configurations\": ["<<std::endl;
+	for(std::size_t i=0;i<outcomes.size();i++) {
+		auto const &o=outcomes[i];
+		auto const &p=o.point;
+		os<<"    {\"core\": \""<<(p.cached?"lxp32c":"lxp32u")<<"\", ";
+		os<<"\"mul\": \""<<mulArchName(p.mulArch)<<"\", ";
+		os<<"\"divider\": "<<(p.dividerEnabled?"true":"false")<<", ";
+		os<<"\"rmw\": "<<(p.dbusRmw?"true":"false")<<", ";
+		if(p.cached) {
+			os<<"\"latency\": "<<p.latency<<", \"burst\": "<<p.burstSize<<", ";
+			os<<"\"prefetch\": "<<p.prefetchSize<<", ";
+		}
+		else os<<"\"latency\": null, \"burst\": null, \"prefetch\": null, ";
+		os<<"\"passed\": "<<(o.passed?"true":"false")<<", ";
+		os<<"\"cycles\": "<<o.cycles<<", ";
+		os<<"\"pareto\": "<<(o.pareto?"true":"false")<<", ";
+		os<<"\"test_cycles\": [";
+		for(std::size_t j=0;j<o.results.size();j++) {
+			if(j>0) os<<", ";
+			if(o.results[j].status==Runner::Result::Success) os<<o.results[j].cycles;
+			else os<<"null";
+		}
+		os<<"]}"<<(i+1<outcomes.size()?",":"")<<std::endl;
+	}
+	os<<"  ]"<<std::endl;
+	os<<"}"<<std::endl;
+}
+
+std::string Explorer::describe(const Point &p) {
+	std::ostringstream ss;
+	ss<<(p.cached?"lxp32c":"lxp32u")<<" mul="<<mulArchName(p.mulArch);
+	ss<<" div="<<(p.dividerEnabled?"on":"off")<<" rmw="<<(p.dbusRmw?"on":"off");
+	if(p.cached) ss<<" latency="<<p.latency<<" burst="<<p.burstSize<<" prefetch="<<p.prefetchSize;
+	return ss.str();
+}
+
+/*
+ * Private members
+ */
+
+bool Explorer::dominates(const Outcome &a,const Outcome &b) {
+	if(!a.passed||!b.passed) return false;
+	
+	auto const &pa=a.point;
+	auto const &pb=b.point;
+	
+// System properties must match
+	if(pa.dbusRmw!=pb.dbusRmw) return false;
+	if(pa.cached&&pb.cached&&pa.latency!=pb.latency) return false;
+	
+// Cost ranks: MulDsp, MulOpt and MulSeq are declared from the most to the least expensive
+	int mulA=-static_cast<int>(pa.mulArch);
+	int mulB=-static_cast<int>(pb.mulArch);
+	
+	if(pa.cached>pb.cached||pa.dividerEnabled>pb.dividerEnabled||mulA>mulB||a.cycles>b.cycles) return false;
+	return pa.cached<pb.cached||pa.dividerEnabled<pb.dividerEnabled||mulA<mulB||a.cycles<b.cycles;
+}
+
+const char *Explorer::mulArchName(Cpu::MulArch arch) {
+	switch(arch) {
+	case CoreProfile::MulOpt:
+		return "opt";
+	case CoreProfile::MulSeq:
+		return "seq";
+	default:
+		return "dsp";
+	}
+}
+
+std::string Explorer::csvField(const std::string &str) {
+	if(str.find_first_of(",\"\r\n")==std::string::npos) return str;
+	std::string quoted="\"";
+	for(auto ch: str) {
+		if(ch=='\"') quoted+="\"\"";
+		else quoted+=ch;
+	}
+	return quoted+"\"";
+}
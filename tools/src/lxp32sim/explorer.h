@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Explorer class which runs a set of firmware
+ * tests on every core configuration of a parameter grid (core version,
+ * multiplier architecture, divider, DBUS_RMW, instruction cache
+ * generics) and finds the Pareto-optimal configurations, i.e. those
+ * for which no other configuration is both cheaper and faster.
+ *
+ * There is no area model: configurations are only compared if one of
+ * them is at least as cheap as the other in every hardware parameter
+ * (LXP32U is cheaper than LXP32C, no divider is cheaper than a divider,
+ * "seq" is cheaper than "opt" which is cheaper than "dsp"). DBUS_RMW and
+ * the instruction bus latency are properties of the system rather than
+ * of the core, so configurations are only compared if they match.
+ * Instruction cache burst and prefetch sizes are not considered costs.
+ */
+
+#ifndef EXPLORER_H_INCLUDED
+#define EXPLORER_H_INCLUDED
+
+#include "runner.h"
+
+#include <vector>
+#include <string>
+#include <iostream>
+
+class Explorer {
+public:
+	struct Point {
+		bool cached=false; // LXP32C
+		Cpu::MulArch mulArch=CoreProfile::MulDsp;
+		bool dividerEnabled=true;
+		bool dbusRmw=false;
+		unsigned latency=0;
+		unsigned burstSize=16;
+		unsigned prefetchSize=32;
+	};
+	
+	struct Grid {
+		std::vector<bool> cached {false,true};
+		std::vector<Cpu::MulArch> mulArch {CoreProfile::MulDsp,CoreProfile::MulOpt,CoreProfile::MulSeq};
+		std::vector<bool> dividerEnabled {true,false};
+		std::vector<bool> dbusRmw {false};
+		std::vector<unsigned> latency {0};
+		std::vector<unsigned> burstSize {16};
+		std::vector<unsigned> prefetchSize {32};
+		
+		void set(const std::string &spec);
+		std::vector<Point> points() const;
+	};
+	
+	struct Outcome {
+		Point point;
+		bool passed=false; // all tests have passed
+		Cpu::Counter cycles=0; // total for all tests
+		std::vector<Runner::Result> results;
+		bool pareto=false;
+	};
+
+private:
+	Runner::Settings _settings;
+	unsigned _threads=0;
+	std::vector<std::string> _files;
+
+public:
+	void setSettings(const Runner::Settings &s);
+	void setThreads(unsigned n);
+	void addFile(const std::string &filename);
+	
+	std::vector<Outcome> run(const Grid &grid) const;
+	
+	void writeCsv(std::ostream &os,const std::vector<Outcome> &outcomes) const;
+	void writeJson(std::ostream &os,const std::vector<Outcome> &outcomes) const;
+	
+	static std::string describe(const Point &p);
+
+private:
+	static bool dominates(const Outcome &a,const Outcome &b);
+	static const char *mulArchName(Cpu::MulArch arch);
+	static std::string csvField(const std::string &str);
+};
+
+#endif
@@ -0,0 +1,673 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the GdbServer class.
+ */
+
+#include "gdbserver.h"
+#include "utils.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+
+#ifndef _WIN32
+	#include <sys/types.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <netinet/in.h>
+	#include <netinet/tcp.h>
+	#include <arpa/inet.h>
+	#include <poll.h>
+	#include <unistd.h>
+#endif
+
+#if !defined(_WIN32)&&defined(MSG_NOSIGNAL)
+	static const int SendFlags=MSG_NOSIGNAL; // don't raise SIGPIPE if the debugger has gone
+#else
+	static const int SendFlags=0;
+#endif
+
+// GDB signal numbers
+static const int SigInt=2;
+static const int SigTrap=5;
+static const int SigAlrm=14;
+
+// Number of instructions between checks for a debugger interrupt request
+static const Cpu::Counter PollInterval=65536;
+
+// Maximum packet size reported to the debugger (also limits memory reads)
+static const std::size_t PacketSize=0x4000;
+
+static const char *hexDigits="0123456789abcdef";
+
+static std::string hexByte(unsigned b) {
+	return std::string(1,hexDigits[(b>>4)&0xF])+hexDigits[b&0xF];
+}
+
+static std::string hexString(const std::string &str) {
+	std::string res;
+	for(auto ch: str) res+=hexByte(static_cast<unsigned char>(ch));
+	return res;
+}
+
+// Register values are transferred in target (little-endian) byte order
+static std::string hexWordLE(Cpu::Word w) {
+	std::string res;
+	for(int i=0;i<4;i++) res+=hexByte((w>>(i*8))&0xFF);
+	return res;
+}
+
+static unsigned hexDigit(char ch) {
+	if(ch>='0'&&ch<='9') return ch-'0';
+	if(ch>='a'&&ch<='f') return ch-'a'+10;
+	if(ch>='A'&&ch<='F') return ch-'A'+10;
+	throw std::runtime_error("Malformed GDB packet");
+}
+
+static std::string unhexString(const std::string &str) {
+	std::string res;
+	for(std::size_t i=0;i+1<str.size();i+=2)
+		res.push_back(static_cast<char>((hexDigit(str[i])<<4)|hexDigit(str[i+1])));
+	return res;
+}
+
+static Cpu::Word parseWordLE(const std::string &str,std::size_t pos) {
+	if(pos+8>str.size()) throw std::runtime_error("Malformed GDB packet");
+	Cpu::Word w=0;
+	for(int i=0;i<4;i++) {
+		w|=static_cast<Cpu::Word>((hexDigit(str[pos+i*2])<<4)|hexDigit(str[pos+i*2+1]))<<(i*8);
+	}
+	return w;
+}
+
+static Cpu::Word parseHex(const std::string &str) {
+	return static_cast<Cpu::Word>(std::stoul(str,nullptr,16));
+}
+
+GdbServer::GdbServer(Simulator &sim,const SymbolMap &symbols):
+	_sim(sim),
+	_symbols(symbols)
+{
+	_watchpoints.setTarget(_sim.platform());
+	_sim.cpu().setBus(_watchpoints);
+}
+
+GdbServer::~GdbServer() {
+	_sim.cpu().setBus(_sim.platform());
+	closeSockets();
+}
+
+void GdbServer::setCycleLimit(Counter cycles) {
+	_cycleLimit=cycles;
+}
+
+bool GdbServer::killed() const {
+	return _killed;
+}
+
+/*
+ * Address is either "[host:]port" (TCP, host defaults to 127.0.0.1)
+ * or "unix:path" (Unix domain socket). Returns a human-readable
+ * description of the address.
+ */
+
+std::string GdbServer::listen(const std::string &address) {
+#ifdef _WIN32
+	(void)address;
+	throw std::runtime_error("GDB server is not supported on this platform");
+#else
+	if(address.compare(0,5,"unix:")==0) {
+		sockaddr_un sa;
+		std::memset(&sa,0,sizeof(sa));
+		sa.sun_family=AF_UNIX;
+		auto path=address.substr(5);
+		if(path.empty()||path.size()>=sizeof(sa.sun_path)) throw std::runtime_error("Invalid socket path: \""+path+"\"");
+		std::strcpy(sa.sun_path,path.c_str());
+		::unlink(path.c_str());
+		
+		_listener=::socket(AF_UNIX,SOCK_STREAM,0);
+		if(_listener<0) throw std::runtime_error("Cannot create socket");
+		if(::bind(_listener,reinterpret_cast<sockaddr*>(&sa),sizeof(sa))<0)
+			throw std::runtime_error("Cannot bind to \""+path+"\"");
+		_unixPath=path;
+	}
+	else {
+		std::string host="127.0.0.1";
+		std::string port=address;
+		auto colon=address.rfind(':');
+		if(colon!=std::string::npos) {
+			host=address.substr(0,colon);
+			port=address.substr(colon+1);
+		}
+		
+		sockaddr_in sa;
+		std::memset(&sa,0,sizeof(sa));
+		sa.sin_family=AF_INET;
+		try {
+			auto p=std::stoul(port);
+			if(p>65535) throw std::exception();
+			sa.sin_port=htons(static_cast<std::uint16_t>(p));
+		}
+		catch(std::exception &) {
+			throw std::runtime_error("Invalid port: \""+port+"\"");
+		}
+		if(::inet_pton(AF_INET,host.c_str(),&sa.sin_addr)!=1)
+			throw std::runtime_error("Invalid host address: \""+host+"\"");
+		
+		_listener=::socket(AF_INET,SOCK_STREAM,0);
+		if(_listener<0) throw std::runtime_error("Cannot create socket");
+		int one=1;
+		::setsockopt(_listener,SOL_SOCKET,SO_REUSEADDR,&one,sizeof(one));
+		if(::bind(_listener,reinterpret_cast<sockaddr*>(&sa),sizeof(sa))<0)
+			throw std::runtime_error("Cannot bind to "+host+":"+port);
+	}
+	
+	if(::listen(_listener,1)<0) throw std::runtime_error("Cannot listen on "+address);
+	
+	if(!_unixPath.empty()) return "Unix socket \""+_unixPath+"\"";
+	return "TCP port "+address;
+#endif
+}
+
+/*
+ * Serve a single debugger connection. Returns when the debugger
+ * detaches, kills the target or closes the connection.
+ */
+
+void GdbServer::serve() {
+#ifndef _WIN32
+	_socket=::accept(_listener,nullptr,nullptr);
+	if(_socket<0) throw std::runtime_error("Cannot accept GDB connection");
+	if(_unixPath.empty()) {
+		int one=1;
+		::setsockopt(_socket,IPPROTO_TCP,TCP_NODELAY,&one,sizeof(one));
+	}
+	
+	std::string packet;
+	while(readPacket(packet)) {
+		if(!handlePacket(packet)) break;
+	}
+	
+	closeSockets();
+#endif
+}
+
+/*
+ * Private members
+ */
+
+bool GdbServer::handlePacket(const std::string &packet) {
+	auto &cpu=_sim.cpu();
+	
+	if(packet=="\x03") {
+		sendPacket(stopReply(SigInt));
+		return true;
+	}
+	
+	if(packet.empty()) {
+		sendPacket("");
+		return true;
+	}
+	
+	try {
+		switch(packet[0]) {
+		case '?':
+			sendPacket(_sim.finished()?exitReply():stopReply(SigTrap));
+			return true;
+		case 'g':
+			sendPacket(readRegisters());
+			return true;
+		case 'G':
+			for(int r=0;r<=256;r++) {
+				auto w=parseWordLE(packet,1+r*8);
+				if(r<256) cpu.setReg(r,w);
+				else cpu.setPc(w);
+			}
+			sendPacket("OK");
+			return true;
+		case 'p':
+			{
+				auto r=parseHex(packet.substr(1));
+				if(r<256) sendPacket(hexWordLE(cpu.reg(r)));
+				else if(r==256) sendPacket(hexWordLE(cpu.pc()));
+				else sendPacket("E01");
+			}
+			return true;
+		case 'P':
+			{
+				auto eq=packet.find('=');
+				if(eq==std::string::npos) throw std::runtime_error("Malformed GDB packet");
+				auto r=parseHex(packet.substr(1,eq-1));
+				auto w=parseWordLE(packet,eq+1);
+				if(r<256) cpu.setReg(r,w);
+				else if(r==256) cpu.setPc(w);
+				else {
+					sendPacket("E01");
+					return true;
+				}
+				sendPacket("OK");
+			}
+			return true;
+		case 'm':
+			{
+				auto comma=packet.find(',');
+				if(comma==std::string::npos) throw std::runtime_error("Malformed GDB packet");
+				sendPacket(readMemory(parseHex(packet.substr(1,comma-1)),parseHex(packet.substr(comma+1))));
+			}
+			return true;
+		case 'M':
+			{
+				auto comma=packet.find(',');
+				auto colon=packet.find(':');
+				if(comma==std::string::npos||colon==std::string::npos) throw std::runtime_error("Malformed GDB packet");
+				sendPacket(writeMemory(parseHex(packet.substr(1,comma-1)),packet.substr(colon+1)));
+			}
+			return true;
+		case 'c':
+		case 's':
+			if(packet.size()>1) cpu.setPc(parseHex(packet.substr(1)));
+			sendPacket(resume(packet[0]=='s'));
+			return true;
+		case 'Z':
+		case 'z':
+			sendPacket(breakpoint(packet));
+			return true;
+		case 'H':
+		case 'T':
+			sendPacket("OK");
+			return true;
+		case 'D':
+			sendPacket("OK");
+			return false;
+		case 'k':
+			_killed=true;
+			return false;
+		default:
+			break;
+		}
+		
+		if(packet=="vCont?") sendPacket("vCont;c;C;s;S");
+		else if(packet.compare(0,6,"vCont;")==0) {
+			auto action=packet[6];
+			sendPacket(resume(action=='s'||action=='S'));
+		}
+		else if(packet.compare(0,10,"qSupported")==0) {
+			std::ostringstream ss;
+			ss<<"PacketSize="<<std::hex<<PacketSize<<";qXfer:features:read+;QStartNoAckMode+";
+			sendPacket(ss.str());
+		}
+		else if(packet=="QStartNoAckMode") {
+			sendPacket("OK");
+			_ackMode=false;
+		}
+		else if(packet.compare(0,30,"qXfer:features:read:target.xml")==0) {
+			auto colon=packet.find(':',30);
+			auto comma=packet.find(',',30);
+			if(colon==std::string::npos||comma==std::string::npos) throw std::runtime_error("Malformed GDB packet");
+			auto offset=parseHex(packet.substr(colon+1,comma-colon-1));
+			auto len=parseHex(packet.substr(comma+1));
+			auto xml=targetDescription();
+			if(offset>=xml.size()) sendPacket("l");
+			else {
+				auto chunk=xml.substr(offset,len);
+				sendPacket(((offset+chunk.size()<xml.size())?"m":"l")+chunk);
+			}
+		}
+		else if(packet=="qAttached") sendPacket("1");
+		else if(packet=="qC") sendPacket("QC1");
+		else if(packet=="qfThreadInfo") sendPacket("m1");
+		else if(packet=="qsThreadInfo") sendPacket("l");
+		else if(packet=="qOffsets") sendPacket("Text=0;Data=0;Bss=0");
+		else if(packet.compare(0,7,"qSymbol")==0) sendPacket("OK");
+		else if(packet.compare(0,6,"qRcmd,")==0) {
+			auto output=monitorCommand(unhexString(packet.substr(6)));
+			if(!output.empty()) sendPacket("O"+hexString(output));
+			sendPacket("OK");
+		}
+		else sendPacket(""); // unsupported
+	}
+	catch(std::exception &) {
+		sendPacket("E01");
+	}
+	
+	return true;
+}
+
+/*
+ * Run until a breakpoint or watchpoint is hit, the test finishes,
+ * the cycle limit is reached or the debugger requests an interrupt.
+ * The instruction at the current PC is always executed, even if
+ * there is a breakpoint.
+ */
+
+std::string GdbServer::resume(bool step) {
+	auto &cpu=_sim.cpu();
+	Counter n=0;
+	
+	_watchpoints.clearHit();
+	
+	for(;;) {
+		if(_sim.finished()) return exitReply();
+		if(cpu.cycles()>=_cycleLimit) return stopReply(SigAlrm);
+		
+		cpu.step();
+		
+		if(_watchpoints.hit()) {
+			auto const &w=_watchpoints.lastHit();
+			std::string kind="awatch";
+			if(w.type==Watchpoints::WatchWrite) kind="watch";
+			else if(w.type==Watchpoints::WatchRead) kind="rwatch";
+			std::ostringstream ss;
+			ss<<"T"<<hexByte(SigTrap)<<kind<<":"<<std::hex<<w.addr<<";";
+			return ss.str();
+		}
+		
+		if(step) return stopReply(SigTrap);
+		if(_breakpoints.hit(cpu.pc())) return stopReply(SigTrap);
+		
+		if(++n==PollInterval) {
+			n=0;
+			if(interrupted()) return stopReply(SigInt);
+		}
+	}
+}
+
+std::string GdbServer::stopReply(int signal) const {
+	return "T"+hexByte(signal)+"100:"+hexWordLE(_sim.cpu().pc())+";";
+}
+
+/*
+ * The test monitor result is reported as the exit code:
+ * 0 for success (1 written to the monitor), otherwise
+ * the least significant byte of the result (or 255 if it is 0).
+ * A semihosting exit code is reported as is.
+ */
+
+std::string GdbServer::exitReply() const {
+	if(!_sim.platform().monitor().finished()&&_sim.platform().semihost().exited())
+		return "W"+hexByte(_sim.platform().semihost().exitCode()&0xFF);
+	auto result=_sim.platform().monitor().result();
+	unsigned code=0;
+	if(result!=1) {
+		code=result&0xFF;
+		if(code==0) code=0xFF;
+	}
+	return "W"+hexByte(code);
+}
+
+std::string GdbServer::readRegisters() const {
+	std::string res;
+	for(int r=0;r<256;r++) res+=hexWordLE(_sim.cpu().reg(r));
+	res+=hexWordLE(_sim.cpu().pc());
+	return res;
+}
+
+/*
+ * Debugger memory accesses bypass the watchpoints and reach only
+ * the memories (see Platform::peek()): reading a peripheral register
+ * can change the peripheral state, so such accesses fail with E01.
+ * The reply must fit into a packet, so reads are limited to
+ * PacketSize/2 bytes.
+ */
+
+std::string GdbServer::readMemory(Word addr,Word len) {
+	if(len>PacketSize/2) return "E01";
+	
+	std::string res;
+	Word word=0;
+	Word wordAddr=1; // never matches an aligned address
+	
+	for(Word i=0;i<len;i++) {
+		Word a=addr+i;
+		if((a&~Word(3))!=wordAddr) {
+			wordAddr=a&~Word(3);
+			if(!_sim.platform().peek(wordAddr,word)) return "E01";
+		}
+		res+=hexByte((word>>((a&3)*8))&0xFF);
+	}
+	
+	return res;
+}
+
+std::string GdbServer::writeMemory(Word addr,const std::string &hexData) {
+	auto data=unhexString(hexData);
+	for(std::size_t i=0;i<data.size();i++) {
+		Word a=addr+static_cast<Word>(i);
+		Word b=static_cast<unsigned char>(data[i]);
+		if(!_sim.platform().poke(a&~Word(3),Word(1)<<(a&3),b<<((a&3)*8))) return "E01";
+	}
+	return "OK";
+}
+
+/*
+ * Z/z packets: 0 and 1 - code breakpoints, 2 - write watchpoints,
+ * 3 - read watchpoints, 4 - access watchpoints
+ */
+
+std::string GdbServer::breakpoint(const std::string &packet) {
+	bool insert=(packet[0]=='Z');
+	auto c1=packet.find(',');
+	auto c2=packet.find(',',c1+1);
+	if(c1==std::string::npos||c2==std::string::npos) return "E01";
+	
+	auto type=packet.substr(1,c1-1);
+	auto addr=parseHex(packet.substr(c1+1,c2-c1-1));
+	auto len=parseHex(packet.substr(c2+1));
+	
+	if(type=="0"||type=="1") {
+		if(insert) _breakpoints.insert(addr&~Word(3));
+		else _breakpoints.remove(addr&~Word(3));
+		return "OK";
+	}
+	
+	Watchpoints::Type wt;
+	if(type=="2") wt=Watchpoints::WatchWrite;
+	else if(type=="3") wt=Watchpoints::WatchRead;
+	else if(type=="4") wt=Watchpoints::WatchAccess;
+	else return "";
+	
+	if(insert) _watchpoints.insert(wt,addr,len);
+	else _watchpoints.remove(wt,addr,len);
+	return "OK";
+}
+
+std::string GdbServer::targetDescription() const {
+	std::ostringstream ss;
+	ss<<"<?xml version=\"1.0\"?>"<<std::endl;
+	ss<<"<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"<<std::endl;
+	ss<<"<target version=\"1.0\">"<<std::endl;
+	ss<<"<architecture>lxp32</architecture>"<<std::endl;
+	ss<<"<feature name=\"org.lxp32.core\">"<<std::endl;
+	for(int r=0;r<256;r++) {
+		ss<<"<reg name=\""<<Cpu::registerName(r)<<"\" bitsize=\"32\" regnum=\""<<r<<"\"";
+		if(r==Cpu::Sp) ss<<" type=\"data_ptr\"";
+		ss<<"/>"<<std::endl;
+	}
+	ss<<"<reg name=\"pc\" bitsize=\"32\" regnum=\"256\" type=\"code_ptr\"/>"<<std::endl;
+	ss<<"</feature>"<<std::endl;
+	ss<<"</target>"<<std::endl;
+	return ss.str();
+}
+
+/*
+ * "monitor" commands. Symbols come from the linker map.
+ */
+
+std::string GdbServer::monitorCommand(const std::string &cmd) {
+	std::istringstream in(cmd);
+	std::string name,arg;
+	in>>name>>arg;
+	std::ostringstream out;
+	
+	if(name=="where") {
+		auto pc=_sim.cpu().pc();
+		out<<"pc = 0x"<<Utils::hex(pc);
+		if(!_symbols.empty()) out<<" <"<<_symbols.resolve(pc)<<">";
+		out<<std::endl;
+	}
+	else if(name=="symbol") {
+		Word addr;
+		if(_symbols.find(arg,addr)) out<<arg<<" = 0x"<<Utils::hex(addr)<<std::endl;
+		else out<<"Symbol \""<<arg<<"\" not found"<<std::endl;
+	}
+	else if(name=="symbols") {
+		for(auto const &sym: _symbols.symbols()) out<<"0x"<<Utils::hex(sym.first)<<" "<<sym.second<<std::endl;
+	}
+	else if(name=="stats") {
+		out<<_sim.cpu().cycles()<<" cycles, "<<_sim.cpu().instructions()<<" instructions"<<std::endl;
+	}
+	else {
+		out<<"Supported commands:"<<std::endl;
+		out<<"    where          Display the current location"<<std::endl;
+		out<<"    symbol <name>  Display the address of a symbol"<<std::endl;
+		out<<"    symbols        List all symbols"<<std::endl;
+		out<<"    stats          Display cycle and instruction counters"<<std::endl;
+	}
+	
+	return out.str();
+}
+
+/*
+ * Read the next packet (without the framing). An interrupt request
+ * is returned as a packet consisting of the 0x03 character.
+ * Returns false if the connection has been closed.
+ */
+
+bool GdbServer::readPacket(std::string &packet) {
+	for(;;) {
+		int ch=getChar(true);
+		if(ch<0) return false;
+		if(ch==0x03) {
+			packet="\x03";
+			return true;
+		}
+		if(ch!='$') continue; // acknowledgements and garbage
+		
+		packet.clear();
+		unsigned sum=0;
+		for(;;) {
+			ch=getChar(true);
+			if(ch<0) return false;
+			if(ch=='#') break;
+			packet.push_back(static_cast<char>(ch));
+			sum+=static_cast<unsigned char>(ch);
+		}
+		
+		int c1=getChar(true);
+		int c2=getChar(true);
+		if(c1<0||c2<0) return false;
+		
+		if(_ackMode) {
+			unsigned expected;
+			try {
+				expected=(hexDigit(static_cast<char>(c1))<<4)|hexDigit(static_cast<char>(c2));
+			}
+			catch(std::exception &) {
+				expected=~sum;
+			}
+			if(expected!=(sum&0xFF)) {
+				sendRaw("-");
+				continue;
+			}
+			sendRaw("+");
+		}
+		
+		return true;
+	}
+}
+
+void GdbServer::sendPacket(const std::string &data) {
+	unsigned sum=0;
+	for(auto ch: data) sum+=static_cast<unsigned char>(ch);
+	auto frame="$"+data+"#"+hexByte(sum&0xFF);
+	
+	for(;;) {
+		sendRaw(frame);
+		if(!_ackMode) return;
+		int ch;
+		do ch=getChar(true);
+		while(ch>=0&&ch!='+'&&ch!='-');
+		if(ch!='-') return;
+	}
+}
+
+/*
+ * Returns the next character, -1 if there is no data (when not
+ * waiting) or -2 if the connection has been closed
+ */
+
+int GdbServer::getChar(bool wait) {
+#ifdef _WIN32
+	(void)wait;
+	return -2;
+#else
+	if(_inputPos>=_input.size()) {
+		if(_socket<0) return -2;
+		if(!wait) {
+			pollfd pfd;
+			pfd.fd=_socket;
+			pfd.events=POLLIN;
+			pfd.revents=0;
+			if(::poll(&pfd,1,0)<=0) return -1;
+		}
+		char buf[4096];
+		auto n=::recv(_socket,buf,sizeof(buf),0);
+		if(n<=0) {
+			closeSockets();
+			return -2;
+		}
+		_input.assign(buf,n);
+		_inputPos=0;
+	}
+	
+	return static_cast<unsigned char>(_input[_inputPos++]);
+#endif
+}
+
+/*
+ * Checks for an interrupt request (or a closed connection) while the
+ * target is running. Characters that readPacket() would skip are
+ * consumed, a packet is left in the input buffer.
+ */
+
+bool GdbServer::interrupted() {
+	for(;;) {
+		int ch=getChar(false);
+		if(ch==-1) return false;
+		if(ch=='$') {
+			_inputPos--;
+			return false;
+		}
+		if(ch==0x03||ch==-2) return true;
+	}
+}
+
+void GdbServer::sendRaw(const std::string &data) {
+#ifdef _WIN32
+	(void)data;
+#else
+	std::size_t sent=0;
+	while(sent<data.size()&&_socket>=0) {
+		auto n=::send(_socket,data.data()+sent,data.size()-sent,SendFlags);
+		if(n<=0) {
+			closeSockets();
+			return;
+		}
+		sent+=n;
+	}
+#endif
+}
+
+void GdbServer::closeSockets() {
+#ifndef _WIN32
+	if(_socket>=0) ::close(_socket);
+	_socket=-1;
+	if(_listener>=0) ::close(_listener);
+	_listener=-1;
+	if(!_unixPath.empty()) ::unlink(_unixPath.c_str());
+	_unixPath.clear();
+#endif
+}
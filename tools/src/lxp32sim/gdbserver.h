@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the GdbServer class which implements
+ * the GDB Remote Serial Protocol for the simulator. It listens
+ * on a local TCP port or a Unix domain socket and serves a single
+ * debugger connection.
+ *
+ * Registers are numbered 0-255 (r0-r255) and 256 (pc).
+ */
+
+#ifndef GDBSERVER_H_INCLUDED
+#define GDBSERVER_H_INCLUDED
+
+#include "simulator.h"
+#include "symbolmap.h"
+#include "breakpoints.h"
+#include "watchpoints.h"
+
+#include <string>
+
+class GdbServer {
+public:
+	typedef Cpu::Word Word;
+	typedef Cpu::Counter Counter;
+
+private:
+	Simulator &_sim;
+	const SymbolMap &_symbols;
+	Breakpoints _breakpoints;
+	Watchpoints _watchpoints;
+	Counter _cycleLimit=~Counter(0);
+	
+	int _listener=-1;
+	int _socket=-1;
+	std::string _unixPath;
+	std::string _input;
+	std::size_t _inputPos=0;
+	bool _ackMode=true;
+	bool _killed=false;
+
+public:
+	GdbServer(Simulator &sim,const SymbolMap &symbols);
+	~GdbServer();
+	
+	GdbServer(const GdbServer &)=delete;
+	GdbServer &operator=(const GdbServer &)=delete;
+	
+	void setCycleLimit(Counter cycles);
+	bool killed() const;
+	
+	std::string listen(const std::string &address);
+	void serve();
+
+private:
+	bool handlePacket(const std::string &packet);
+	std::string resume(bool step);
+	bool interrupted();
+	std::string stopReply(int signal) const;
+	std::string exitReply() const;
+	
+	std::string readRegisters() const;
+	std::string readMemory(Word addr,Word len);
+	std::string writeMemory(Word addr,const std::string &hexData);
+	std::string breakpoint(const std::string &packet);
+	std::string targetDescription() const;
+	std::string monitorCommand(const std::string &cmd);
+	
+	bool readPacket(std::string &packet);
+	void sendPacket(const std::string &data);
+	int getChar(bool wait);
+	void sendRaw(const std::string &data);
+	void closeSockets();
+};
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the ICache class.
+ */
+
+#include "icache.h"
+
+#include <stdexcept>
+#include <cstring>
+
+ICache::ICache() {
+	invalidate();
+}
+
+// Parameter restrictions are the same as in lxp32_icache.vhd
+
+void ICache::configure(unsigned latency,Word burstSize,Word prefetchSize) {
+	if(burstSize<4) throw std::runtime_error("Instruction bus burst size can't be less than 4");
+	if(prefetchSize<4) throw std::runtime_error("Instruction cache prefetch size can't be less than 4");
+	if(burstSize+prefetchSize>128)
+		throw std::runtime_error("Instruction bus burst size and prefetch size combined can't be greater than 128");
+	_latency=latency;
+	_burstSize=burstSize;
+	_prefetchSize=prefetchSize;
+	invalidate();
+}
+
+void ICache::invalidate() {
+	std::memset(_tags,0,sizeof(_tags));
+	_filling=false;
+}
+
+unsigned ICache::fetch(Word addr,Counter now,bool timing) {
+	_stats.fetches++;
+	if(!timing) {
+		warm(addr);
+		return 0;
+	}
+	
+	advance(now);
+	_read=addr;
+	
+	if(hit(addr)) {
+		if(!_filling&&_next<addr+_prefetchSize) startBurst(now);
+		return 0;
+	}
+	
+	if(!_filling||addr<_next||addr-_next>_burstSize/2) {
+		_stats.misses++;
+		invalidate();
+		_next=addr;
+		startBurst(now+1); // the miss is detected one cycle later
+	}
+	
+// Wait for the word to arrive
+	Counter ready=now;
+	while(!hit(addr)) {
+		ready=_arrival;
+		advance(ready);
+	}
+	
+	auto stall=static_cast<unsigned>(ready-now);
+	_stats.stallCycles+=stall;
+	return stall;
+}
+
+const ICache::Stats &ICache::stats() const {
+	return _stats;
+}
+
+/*
+ * Private members
+ */
+
+bool ICache::hit(Word addr) const {
+	return _tags[addr%Size]==addr+1;
+}
+
+/*
+ * Stores the words that have arrived by "now". When a burst ends,
+ * the next one follows immediately if the prefetch distance from
+ * the last requested word hasn't been reached yet.
+ */
+
+void ICache::advance(Counter now) {
+	while(_filling&&_arrival<=now) {
+		_tags[_next%Size]=_next+1;
+		_next++;
+		if(--_burstLeft>0) _arrival++;
+		else if(_next<_read+_prefetchSize) {
+			_burstLeft=_burstSize;
+			_arrival+=_latency+1;
+		}
+		else _filling=false;
+	}
+}
+
+void ICache::startBurst(Counter now) {
+	_filling=true;
+	_burstLeft=_burstSize;
+	_arrival=now+_latency;
+}
+
+void ICache::warm(Word addr) {
+	_read=addr;
+	if(!hit(addr)&&(addr<_next||addr-_next>_burstSize/2)) {
+		_stats.misses++;
+		invalidate();
+		_next=addr;
+	}
+	_filling=false;
+	while(_next<addr+_prefetchSize) {
+		_tags[_next%Size]=_next+1;
+		_next++;
+	}
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the ICache class, a cycle-approximate model
+ * of the LXP32C instruction cache (lxp32_icache.vhd): a 256-word ring
+ * buffer filled by incrementing bursts of IBUS_BURST_SIZE words over
+ * the instruction bus, reading up to IBUS_PREFETCH_SIZE words ahead.
+ * A miss invalidates the buffer and restarts the fill at the requested
+ * address, unless the word is about to be fetched anyway (a near miss).
+ * "latency" is the number of cycles before the first word of a burst
+ * is acknowledged; the rest follow one per cycle.
+ *
+ * Without timing (functional warming), fills complete instantly, so
+ * the cache contents follow the instruction stream at no cost.
+ */
+
+#ifndef ICACHE_H_INCLUDED
+#define ICACHE_H_INCLUDED
+
+#include <cstdint>
+
+class ICache {
+public:
+	typedef std::uint32_t Word;
+	typedef std::uint64_t Counter;
+	
+	static const Word Size=256;
+	
+	struct Stats {
+		Counter fetches=0;
+		Counter misses=0;
+		Counter stallCycles=0;
+	};
+
+private:
+	unsigned _latency=4;
+	Word _burstSize=16;
+	Word _prefetchSize=32;
+	
+// Word address stored in each slot plus one (0: invalid)
+	Word _tags[Size];
+	
+// Last requested word, next word to be requested from the bus and when it arrives
+	Word _read=0;
+	bool _filling=false;
+	Word _next=0;
+	Counter _arrival=0;
+	Word _burstLeft=0;
+	
+	Stats _stats;
+
+public:
+	ICache();
+	
+	void configure(unsigned latency,Word burstSize,Word prefetchSize);
+	void invalidate();
+	
+// "addr" is a word address; returns the number of stall cycles
+	unsigned fetch(Word addr,Counter now,bool timing);
+	
+	const Stats &stats() const;
+
+private:
+	bool hit(Word addr) const;
+	void advance(Counter now);
+	void startBurst(Counter now);
+	void warm(Word addr);
+};
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Image class.
+ */
+
+#include "image.h"
+#include "assembler.h"
+#include "linker.h"
+#include "outputwriter.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+
+/*
+ * Collects linker output in memory
+ */
+
+namespace {
+	class ImageOutputWriter : public OutputWriter {
+		std::vector<Image::Word> &_words;
+		std::string _buf;
+	public:
+		ImageOutputWriter(std::vector<Image::Word> &words): _words(words) {}
+	protected:
+		virtual void writeData(const char *data,std::size_t n) override {
+			for(std::size_t i=0;i<n;i++) {
+				_buf.push_back(data[i]);
+				if(_buf.size()==sizeof(Image::Word)) {
+					_words.push_back((static_cast<unsigned char>(_buf[3])<<24)|
+						(static_cast<unsigned char>(_buf[2])<<16)|
+						(static_cast<unsigned char>(_buf[1])<<8)|
+						static_cast<unsigned char>(_buf[0]));
+					_buf.clear();
+				}
+			}
+		}
+	};
+}
+
+void Image::load(const std::string &filename,const std::vector<std::string> &includeDirs) {
+	if(isSourceFile(filename)) assemble(std::vector<std::string>{filename},includeDirs);
+	else loadImage(filename);
+}
+
+void Image::loadImage(const std::string &filename) {
+	std::ifstream in(filename,std::ios_base::in|std::ios_base::binary);
+	if(!in) throw std::runtime_error("Cannot open \""+filename+"\"");
+	loadImage(filename,detectFormat(in));
+}
+
+void Image::loadImage(const std::string &filename,Format fmt) {
+	std::ifstream in;
+	
+	if(fmt==Bin) in.open(filename,std::ios_base::in|std::ios_base::binary);
+	else in.open(filename,std::ios_base::in);
+	if(!in) throw std::runtime_error("Cannot open \""+filename+"\"");
+	
+	_words.clear();
+	_map.clear();
+	_lines.clear();
+	
+	if(fmt==Bin) {
+		for(;;) {
+			char buf[sizeof(Word)] {}; // zero-initialize
+			in.read(buf,sizeof(Word));
+			if(in.gcount()==0) break;
+			_words.push_back((static_cast<unsigned char>(buf[3])<<24)|
+				(static_cast<unsigned char>(buf[2])<<16)|
+				(static_cast<unsigned char>(buf[1])<<8)|
+				static_cast<unsigned char>(buf[0]));
+		}
+	}
+	else {
+		std::string line;
+		int lineNumber=0;
+		while(std::getline(in,line)) {
+			lineNumber++;
+			if(line.find_first_not_of(" \t\r")==std::string::npos) continue;
+			try {
+				if(fmt==Textio) _words.push_back(std::stoul(line,nullptr,2));
+				else if(fmt==Dec) _words.push_back(std::stoul(line,nullptr,10));
+				else _words.push_back(std::stoul(line,nullptr,16));
+			}
+			catch(std::exception &) {
+				throw std::runtime_error(filename+": bad literal at line "+std::to_string(lineNumber));
+			}
+		}
+	}
+}
+
+void Image::assemble(const std::vector<std::string> &sources,const std::vector<std::string> &includeDirs) {
+	std::vector<Assembler> assemblers;
+	
+	for(auto const &filename: sources) {
+		Assembler as;
+		for(auto const &dir: includeDirs) as.addIncludeSearchDir(dir);
+		try {
+			as.processFile(filename);
+		}
+		catch(std::exception &ex) {
+			std::string msg="Assembler error in "+as.currentFileName();
+			if(as.line()>0) msg+=":"+std::to_string(as.line());
+			throw std::runtime_error(msg+": "+ex.what());
+		}
+		assemblers.push_back(std::move(as));
+	}
+	
+	Linker linker;
+	for(auto &as: assemblers) linker.addObject(as.object());
+	
+	_words.clear();
+	ImageOutputWriter writer(_words);
+	
+	try {
+		linker.link(writer);
+	}
+	catch(std::exception &ex) {
+		throw std::runtime_error(std::string("Linker error: ")+ex.what());
+	}
+	
+	std::ostringstream map;
+	linker.generateMap(map);
+	_map=map.str();
+	
+	_lines.clear();
+	for(auto const &obj: linker.objects()) {
+		for(auto const &l: obj->lines())
+			_lines[obj->virtualAddress()+l.first]=SourceLine {l.second.source,l.second.line};
+	}
+}
+
+const std::vector<Image::Word> &Image::words() const {
+	return _words;
+}
+
+const std::string &Image::map() const {
+	return _map;
+}
+
+const Image::LineTable &Image::lines() const {
+	return _lines;
+}
+
+bool Image::isSourceFile(const std::string &filename) {
+	auto pos=filename.find_last_of('.');
+	if(pos==std::string::npos) return false;
+	auto ext=filename.substr(pos);
+	return ext==".asm"||ext==".s";
+}
+
+Image::Format Image::detectFormat(std::istream &in) {
+	static const std::size_t Size=256;
+	static const char *textio="01\r\n \t";
+	static const char *dec="0123456789\r\n \t";
+	static const char *hex="0123456789ABCDEFabcdef\r\n \t";
+	
+	char buf[Size];
+	in.read(buf,Size);
+	auto s=static_cast<std::size_t>(in.gcount());
+	in.clear();
+	in.seekg(0);
+	
+	Format fmt=Textio;
+	
+	for(std::size_t i=0;i<s;i++) {
+		if(fmt==Textio&&!strchr(textio,buf[i])) fmt=Dec;
+		if(fmt==Dec&&!strchr(dec,buf[i])) fmt=Hex;
+		if(fmt==Hex&&!strchr(hex,buf[i])) {
+			fmt=Bin;
+			break;
+		}
+	}
+	
+	return fmt;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Image class which represents an LXP32
+ * executable image. An image can be read from a file produced
+ * by lxp32asm or built from assembly sources on the fly. Images
+ * built from sources also carry the source line of each instruction.
+ */
+
+#ifndef IMAGE_H_INCLUDED
+#define IMAGE_H_INCLUDED
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+
+class Image {
+public:
+	typedef std::uint32_t Word;
+	enum Format {Bin,Textio,Dec,Hex};
+	
+	struct SourceLine {
+		std::string source;
+		int line;
+	};
+	typedef std::map<Word,SourceLine> LineTable;
+
+private:
+	std::vector<Word> _words;
+	std::string _map;
+	LineTable _lines;
+
+public:
+	void load(const std::string &filename,const std::vector<std::string> &includeDirs);
+	void loadImage(const std::string &filename);
+	void loadImage(const std::string &filename,Format fmt);
+	void assemble(const std::vector<std::string> &sources,const std::vector<std::string> &includeDirs);
+	
+	const std::vector<Word> &words() const;
+	const std::string &map() const;
+	const LineTable &lines() const;
+	
+	static bool isSourceFile(const std::string &filename);
+	static Format detectFormat(std::istream &in);
+};
+
+#endif
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Intercon class.
+ */
+
+#include "intercon.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+#include <iomanip>
+
+Intercon::Intercon(int masters):
+	_masters(masters),
+	_stats(masters)
+{
+	if(masters<1) throw std::runtime_error("Invalid number of masters");
+}
+
+void Intercon::setPipelinedArbiter(bool b) {
+	_pipelinedArbiter=b;
+}
+
+/*
+ * Registered feedback only routes the CTI/BTE signals to the slaves,
+ * which matters for incrementing bursts. Classic cycles (the only ones
+ * issued by the LXP32 data bus) are not affected.
+ */
+
+void Intercon::setRegisteredFeedback(bool b) {
+	_registeredFeedback=b;
+}
+
+void Intercon::setUnsafeDecoder(bool b) {
+	_unsafeDecoder=b;
+}
+
+int Intercon::masters() const {
+	return _masters;
+}
+
+bool Intercon::pipelinedArbiter() const {
+	return _pipelinedArbiter;
+}
+
+bool Intercon::registeredFeedback() const {
+	return _registeredFeedback;
+}
+
+bool Intercon::unsafeDecoder() const {
+	return _unsafeDecoder;
+}
+
+void Intercon::addSlave(Slave &slave) {
+	if(_slaves.size()>=(std::size_t(1)<<(_addrWidth-_slaveAddrWidth)))
+		throw std::runtime_error("Too many slaves");
+	_slaves.push_back(&slave);
+}
+
+/*
+ * "requests" holds the cycle each master has issued its pending
+ * request in (Never if there is none). Returns the index of the master
+ * to be granted the bus and the cycle the decision is made in, or -1
+ * if there are no requests. Masters with lower port numbers have
+ * higher priority; ongoing cycles are not interrupted.
+ */
+
+int Intercon::arbitrate(const std::vector<Counter> &requests,Counter &decision) const {
+	Counter earliest=Never;
+	for(auto t: requests) earliest=std::min(earliest,t);
+	if(earliest==Never) return -1;
+	decision=std::max(earliest,_busyUntil);
+	for(int i=0;i<_masters;i++) {
+		if(requests[i]<=decision) return i;
+	}
+	return -1;
+}
+
+unsigned Intercon::read(int master,Counter request,Counter decision,Word addr,Word sel,Word &data) {
+	auto start=begin(master,request,decision);
+	unsigned waitStates=0;
+	auto slave=decode(addr);
+	if(slave) waitStates=slave->read(addr&((Word(1)<<_slaveAddrWidth)-1),sel,data);
+	else data=0; // fallback slave
+	_stats[master].reads++;
+	return end(master,request,start,waitStates);
+}
+
+unsigned Intercon::write(int master,Counter request,Counter decision,Word addr,Word sel,Word data) {
+	auto start=begin(master,request,decision);
+	unsigned waitStates=0;
+	auto slave=decode(addr);
+	if(slave) waitStates=slave->write(addr&((Word(1)<<_slaveAddrWidth)-1),sel,data);
+	_stats[master].writes++;
+	return end(master,request,start,waitStates);
+}
+
+int Intercon::currentMaster() const {
+	return _current;
+}
+
+Intercon::Counter Intercon::busyUntil() const {
+	return _busyUntil;
+}
+
+const Intercon::Stats &Intercon::stats(int master) const {
+	return _stats[master];
+}
+
+/*
+ * A pipelined arbiter registers the grant, so the cycle can only
+ * start one clock cycle after the decision. With a single master
+ * wigen doesn't generate an arbiter at all.
+ */
+
+Intercon::Counter Intercon::begin(int master,Counter request,Counter decision) {
+	if(request>decision||decision<_busyUntil) throw std::logic_error("Invalid arbitration decision");
+	auto start=decision;
+	if(_masters>1&&_pipelinedArbiter) start++;
+	for(auto slave: _slaves) slave->advance(start-_time);
+	_time=start;
+	_current=master;
+	return start;
+}
+
+unsigned Intercon::end(int master,Counter request,Counter start,unsigned waitStates) {
+	auto &s=_stats[master];
+	auto stall=start-request;
+	_busyUntil=start+waitStates+1;
+	s.busCycles+=waitStates+1;
+	s.stallCycles+=stall;
+	s.maxStall=std::max(s.maxStall,stall);
+	_current=-1;
+	return static_cast<unsigned>(stall)+waitStates;
+}
+
+/*
+ * Private members
+ */
+
+Slave *Intercon::decode(Word addr) const {
+	Word index=addr>>_slaveAddrWidth;
+	if(_unsafeDecoder&&_slaves.size()>1) {
+// Only the bits required to encode the slave number are decoded
+		int bits=0;
+		while((std::size_t(1)<<bits)<_slaves.size()) bits++;
+		index&=(Word(1)<<bits)-1;
+		if(index>=_slaves.size()) {
+			std::ostringstream msg;
+			msg<<"Access to undecoded address 0x"<<std::hex<<std::setw(8)<<std::setfill('0')<<addr;
+			msg<<" (unsafe slave decoder)";
+			throw std::runtime_error(msg.str());
+		}
+	}
+	else if(_unsafeDecoder) index=0;
+	if(index>=_slaves.size()) return nullptr;
+	return _slaves[index];
+}
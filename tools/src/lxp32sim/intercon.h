@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Intercon class which models a WISHBONE
+ * shared bus interconnect produced by wigen: a priority arbiter
+ * (optionally pipelined), a slave decoder (optionally unsafe) and
+ * a fallback slave for undecoded addresses.
+ *
+ * The model is transaction-level: masters submit requests stamped
+ * with the cycle they were issued in, the arbiter picks the winner
+ * the same way the generated hardware does, and the number of wait
+ * states seen by the master includes the cycles spent waiting for
+ * the grant. The caller is responsible for submitting requests in
+ * a causally consistent order (see MultiCore).
+ */
+
+#ifndef INTERCON_H_INCLUDED
+#define INTERCON_H_INCLUDED
+
+#include "peripherals.h"
+
+#include <vector>
+#include <cstdint>
+
+class Intercon {
+public:
+	typedef std::uint32_t Word;
+	typedef std::uint64_t Counter;
+	
+	static const Counter Never=~Counter(0);
+	
+	struct Stats {
+		Counter reads=0;
+		Counter writes=0;
+		Counter busCycles=0; // cycles the master owned the bus
+		Counter stallCycles=0; // cycles spent waiting for the grant
+		Counter maxStall=0;
+	};
+
+private:
+	int _masters;
+	int _addrWidth=32;
+	int _slaveAddrWidth=28;
+	bool _pipelinedArbiter=false;
+	bool _registeredFeedback=false;
+	bool _unsafeDecoder=false;
+	
+	std::vector<Slave*> _slaves;
+	std::vector<Stats> _stats;
+	
+	Counter _time=0; // cycle the slaves have been advanced to
+	Counter _busyUntil=0; // first cycle the bus is free
+	int _current=-1;
+
+public:
+	Intercon(int masters);
+	
+	void setPipelinedArbiter(bool b);
+	void setRegisteredFeedback(bool b);
+	void setUnsafeDecoder(bool b);
+	
+	int masters() const;
+	bool pipelinedArbiter() const;
+	bool registeredFeedback() const;
+	bool unsafeDecoder() const;
+	
+	void addSlave(Slave &slave);
+	
+	int arbitrate(const std::vector<Counter> &requests,Counter &decision) const;
+	unsigned read(int master,Counter request,Counter decision,Word addr,Word sel,Word &data);
+	unsigned write(int master,Counter request,Counter decision,Word addr,Word sel,Word data);
+	
+// For masters that access their slaves directly (see Platform)
+	Counter begin(int master,Counter request,Counter decision);
+	unsigned end(int master,Counter request,Counter start,unsigned waitStates);
+	
+	int currentMaster() const;
+	Counter busyUntil() const;
+	const Stats &stats(int master) const;
+
+private:
+	Slave *decode(Word addr) const;
+};
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the IrqSchedule class.
+ */
+
+#include "irqschedule.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+#include <cstring>
+
+const char IrqSchedule::FileId[]="LXP32IRQ";
+
+static const std::size_t IdSize=8;
+
+IrqSchedule::IrqSchedule(const std::string &filename,Mode mode):
+	_mode(mode),
+	_filename(filename)
+{
+	if(_mode==Record) {
+		_os.open(filename,std::ios_base::out|std::ios_base::binary);
+		if(!_os) throw std::runtime_error("Cannot open \""+filename+"\" for writing");
+		_os.write(FileId,IdSize);
+		for(int i=0;i<4;i++) _os.put(static_cast<char>(Version>>(i*8)));
+	}
+	else {
+		_is.open(filename,std::ios_base::in|std::ios_base::binary);
+		if(!_is) throw std::runtime_error("Cannot open \""+filename+"\"");
+		char id[IdSize];
+		_is.read(id,IdSize);
+		if(_is.gcount()!=IdSize||std::memcmp(id,FileId,IdSize))
+			throw std::runtime_error("\""+filename+"\" is not an interrupt schedule file");
+		Word version=0;
+		for(int i=0;i<4;i++) version|=static_cast<Word>(static_cast<std::uint8_t>(_is.get()))<<(i*8);
+		if(!_is||version!=Version) throw std::runtime_error("Unsupported interrupt schedule file version");
+		readNext();
+	}
+}
+
+IrqSchedule::~IrqSchedule() {
+	try {
+		close();
+	}
+	catch(std::exception &) {}
+}
+
+IrqSchedule::Mode IrqSchedule::mode() const {
+	return _mode;
+}
+
+// Number of changes recorded or replayed so far
+
+IrqSchedule::Counter IrqSchedule::changes() const {
+	return _changes;
+}
+
+bool IrqSchedule::exhausted() const {
+	return !_pending;
+}
+
+/*
+ * Limits idle skipping so that it doesn't cross the next replayed
+ * change. "retiring" is set if instructions are executed during the
+ * skipped cycles (a polling loop), in which case the instruction
+ * count can grow by at most one per cycle.
+ */
+
+IrqSchedule::Counter IrqSchedule::quietCycles(Counter limit,bool retiring,Counter instructions,Counter cycles) const {
+	if(_mode==Record||!_pending) return limit;
+	if(_next.instructions<instructions) return 0;
+	if(_next.instructions==instructions) {
+		if(retiring||instructions!=_instructions) return 0;
+		auto due=_base+_next.offset;
+		if(cycles>=due) return 0;
+		return std::min(limit,due-cycles);
+	}
+	if(!retiring) return limit;
+	return std::min(limit,_next.instructions-instructions-1);
+}
+
+void IrqSchedule::close() {
+	if(_closed) return;
+	_closed=true;
+	if(_mode==Record) {
+		_os.close();
+		if(!_os) throw std::runtime_error("Cannot write to \""+_filename+"\"");
+	}
+}
+
+/*
+ * Private members
+ */
+
+void IrqSchedule::record(std::uint8_t irq,Counter cycles,Word cr) {
+	Change c;
+	c.instructions=_instructions;
+	c.offset=cycles-_base;
+	c.irq=irq;
+	c.mask=static_cast<std::uint8_t>(cr);
+	bool maskChanged=(c.mask!=_last.mask);
+	putVarint(((c.instructions-_last.instructions)<<1)|(maskChanged?1:0));
+	putVarint(c.offset);
+	_os.put(static_cast<char>(c.irq));
+	if(maskChanged) _os.put(static_cast<char>(c.mask));
+	_last=c;
+	_irq=irq;
+	_changes++;
+}
+
+void IrqSchedule::replay(Counter instructions,Word cr) {
+	auto mask=static_cast<std::uint8_t>(cr);
+	if(mask!=_next.mask) {
+		std::ostringstream msg;
+		msg<<"Interrupt schedule diverged at instruction "<<instructions<<" (change "<<_changes+1<<"): ";
+		msg<<"enable mask is 0x"<<Utils::hex(mask)<<", recorded 0x"<<Utils::hex(_next.mask);
+		throw std::runtime_error(msg.str());
+	}
+	_irq=_next.irq;
+	_last=_next;
+	_changes++;
+	readNext();
+}
+
+// A truncated record at the end of the file (e.g. an interrupted recording) is ignored
+
+void IrqSchedule::readNext() {
+	Counter delta,offset;
+	_pending=false;
+	if(!getVarint(delta)||!getVarint(offset)) return;
+	auto irq=_is.get();
+	if(irq==std::char_traits<char>::eof()) return;
+	_next.instructions=_last.instructions+(delta>>1);
+	_next.offset=offset;
+	_next.irq=static_cast<std::uint8_t>(irq);
+	_next.mask=_last.mask;
+	if(delta&1) {
+		auto mask=_is.get();
+		if(mask==std::char_traits<char>::eof()) return;
+		_next.mask=static_cast<std::uint8_t>(mask);
+	}
+	_pending=true;
+}
+
+void IrqSchedule::putVarint(Counter value) {
+	while(value>=0x80) {
+		_os.put(static_cast<char>((value&0x7F)|0x80));
+		value>>=7;
+	}
+	_os.put(static_cast<char>(value));
+}
+
+bool IrqSchedule::getVarint(Counter &value) {
+	value=0;
+	for(int shift=0;shift<64;shift+=7) {
+		auto b=_is.get();
+		if(b==std::char_traits<char>::eof()) return false;
+		value|=static_cast<Counter>(b&0x7F)<<shift;
+		if(!(b&0x80)) return true;
+	}
+	throw std::runtime_error("\""+_filename+"\" is corrupted");
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the IrqSchedule class which records the states
+ * of the interrupt request lines seen by the CPU or replays them
+ * instead of the platform interrupt lines.
+ *
+ * Each change is stamped with the number of instructions retired so
+ * far and the number of cycles elapsed since the CPU was first clocked
+ * with that instruction count, so even a single-cycle pulse during
+ * a multi-cycle instruction is replayed at exactly the same point of
+ * the instruction stream. The interrupt enable mask (the low byte of
+ * the "cr" register) at the time of the change is recorded too:
+ * a different mask during replay means that the execution has diverged
+ * from the recorded one, and the replay is stopped with an error.
+ *
+ * File format: an 8-byte identifier, a little-endian version word,
+ * then one record per change:
+ *   - instruction count delta shifted left by one, bit 0 is set if
+ *     the enable mask differs from the previous record;
+ *   - cycle offset;
+ *   - IRQ line states (1 byte);
+ *   - enable mask (1 byte, only if bit 0 of the first field is set).
+ * The first two fields are variable-length integers: 7 bits per byte,
+ * least significant group first. A typical record takes 3-4 bytes.
+ */
+
+#ifndef IRQSCHEDULE_H_INCLUDED
+#define IRQSCHEDULE_H_INCLUDED
+
+#include <fstream>
+#include <string>
+#include <cstdint>
+
+class IrqSchedule {
+public:
+	typedef std::uint32_t Word;
+	typedef std::uint64_t Counter;
+	
+	enum Mode {Record,Replay};
+	
+	static const char FileId[];
+	static const Word Version=1;
+
+private:
+	struct Change {
+		Counter instructions=0;
+		Counter offset=0;
+		std::uint8_t irq=0;
+		std::uint8_t mask=0;
+	};
+	
+	Mode _mode;
+	std::string _filename;
+	std::ofstream _os;
+	std::ifstream _is;
+	bool _closed=false;
+	
+// Instruction count at the last clock cycle and the cycle it was first seen at
+	Counter _instructions=~Counter(0);
+	Counter _base=0;
+	
+	std::uint8_t _irq=0;
+	Change _last;
+	Change _next;
+	bool _pending=false;
+	Counter _changes=0;
+
+public:
+	IrqSchedule(const std::string &filename,Mode mode);
+	~IrqSchedule();
+	
+	Mode mode() const;
+	Counter changes() const;
+	bool exhausted() const;
+	
+// Called every clock cycle with the platform IRQ line states, returns the states seen by the CPU
+	std::uint8_t clock(std::uint8_t irq,Counter instructions,Counter cycles,Word cr) {
+		if(instructions!=_instructions) {
+			_instructions=instructions;
+			_base=cycles;
+		}
+		if(_mode==Record) {
+			if(irq!=_irq) record(irq,cycles,cr);
+			return irq;
+		}
+		while(_pending&&(_next.instructions<instructions||
+			(_next.instructions==instructions&&cycles-_base>=_next.offset))) replay(instructions,cr);
+		return _irq;
+	}
+	
+	Counter quietCycles(Counter limit,bool retiring,Counter instructions,Counter cycles) const;
+	void close();
+
+private:
+	void record(std::uint8_t irq,Counter cycles,Word cr);
+	void replay(Counter instructions,Word cr);
+	void readNext();
+	void putVarint(Counter value);
+	bool getVarint(Counter &value);
+};
+
+#endif
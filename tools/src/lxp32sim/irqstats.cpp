@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the IrqStats class.
+ */
+
+#include "irqstats.h"
+
+#include <iomanip>
+
+/*
+ * Called by the interrupt multiplexer every cycle with the set of
+ * vectors being requested, including the one selected for execution
+ */
+
+void IrqStats::update(std::uint8_t requests,Counter cycle) {
+	auto raised=static_cast<std::uint8_t>(requests&~_requested);
+	for(int i=0;raised;i++,raised>>=1) {
+		if(raised&1) _requestCycles[i]=cycle;
+	}
+	_requested=requests;
+}
+
+void IrqStats::enter(int vector,Counter cycle,bool returnable) {
+	auto &v=_vectors[vector];
+	v.interrupts++;
+	if(_requested&(1<<vector)) v.latency[cycle-_requestCycles[vector]]++;
+	_requested&=~(1<<vector);
+	
+	if(returnable) {
+		_active=vector;
+		_entryCycle=cycle;
+	}
+	else {
+		v.nonReturnable++;
+		_active=-1;
+	}
+}
+
+void IrqStats::exit(Counter cycle) {
+	if(_active<0) return;
+	_vectors[_active].duration[cycle-_entryCycle]++;
+	_active=-1;
+}
+
+const IrqStats::Vector &IrqStats::vector(int i) const {
+	return _vectors[i&7];
+}
+
+/*
+ * Writes a JSON array with an object for each vector that has been
+ * taken at least once
+ */
+
+void IrqStats::writeJson(std::ostream &os,const char *indent) const {
+	bool first=true;
+	os<<"[";
+	
+	for(int i=0;i<8;i++) {
+		auto const &v=_vectors[i];
+		if(v.interrupts==0) continue;
+		
+		if(!first) os<<",";
+		first=false;
+		os<<std::endl<<indent<<"  {\"vector\": "<<i<<", \"interrupts\": "<<v.interrupts;
+		os<<", \"non_returnable\": "<<v.nonReturnable<<","<<std::endl;
+		
+		const char *names[]={"latency","duration"};
+		const Histogram *histograms[]={&v.latency,&v.duration};
+		for(int j=0;j<2;j++) {
+			auto const &h=*histograms[j];
+			Counter total=0;
+			Counter sum=0;
+			for(auto const &bin: h) {
+				total+=bin.second;
+				sum+=bin.first*bin.second;
+			}
+			os<<indent<<"   \""<<names[j]<<"\": {\"count\": "<<total;
+			if(total>0) {
+				os<<", \"min\": "<<h.begin()->first<<", \"max\": "<<h.rbegin()->first;
+				os<<", \"mean\": "<<std::fixed<<std::setprecision(2)<<static_cast<double>(sum)/total;
+				os<<", \"p50\": "<<percentile(h,total,50)<<", \"p90\": "<<percentile(h,total,90);
+				os<<", \"p99\": "<<percentile(h,total,99);
+			}
+			os<<", \"histogram\": ";
+			writeHistogram(os,h);
+			os<<"}"<<(j==0?",\n":"}");
+		}
+	}
+	
+	if(!first) os<<std::endl<<indent;
+	os<<"]";
+}
+
+/*
+ * Private members
+ */
+
+// Pairs of [value, occurrences] in ascending order of values
+
+void IrqStats::writeHistogram(std::ostream &os,const Histogram &h) {
+	os<<"[";
+	for(auto it=h.begin();it!=h.end();++it) {
+		if(it!=h.begin()) os<<", ";
+		os<<"["<<it->first<<", "<<it->second<<"]";
+	}
+	os<<"]";
+}
+
+// The smallest value which is not exceeded by "p" percent of the samples
+
+IrqStats::Counter IrqStats::percentile(const Histogram &h,Counter total,unsigned p) {
+	Counter seen=0;
+	for(auto const &bin: h) {
+		seen+=bin.second;
+		if(seen*100>=total*p) return bin.first;
+	}
+	return h.empty()?0:h.rbegin()->first;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the IrqStats class which measures interrupt
+ * latency and handler duration for each interrupt vector.
+ *
+ * An interrupt request is timestamped in the cycle when it reaches the
+ * interrupt multiplexer (an edge on an edge-triggered line, or an active
+ * level-triggered line) with the interrupt enabled. Latency is the number
+ * of cycles from the request to the first instruction of the handler
+ * (the address taken from iv0..iv7), including the time spent waiting
+ * for another handler to return. Handler duration is the number of
+ * cycles from the first instruction of the handler to the end of the
+ * matching "iret". A level-triggered request that is withdrawn before
+ * it is served is not counted.
+ *
+ * Histograms are exact: each distinct value is stored with the number
+ * of its occurrences.
+ */
+
+#ifndef IRQSTATS_H_INCLUDED
+#define IRQSTATS_H_INCLUDED
+
+#include <map>
+#include <iostream>
+#include <cstdint>
+
+class IrqStats {
+public:
+	typedef std::uint64_t Counter;
+	typedef std::map<Counter,Counter> Histogram; // value -> occurrences
+	
+	struct Vector {
+		Counter interrupts=0;
+		Counter nonReturnable=0;
+		Histogram latency;
+		Histogram duration;
+	};
+
+private:
+	Vector _vectors[8];
+	
+// Requests waiting to be served and their timestamps
+	std::uint8_t _requested=0;
+	Counter _requestCycles[8];
+	
+// Handler being executed (-1: none) and the cycle it was entered
+	int _active=-1;
+	Counter _entryCycle=0;
+
+public:
+	void update(std::uint8_t requests,Counter cycle);
+	void enter(int vector,Counter cycle,bool returnable);
+	void exit(Counter cycle);
+	
+	const Vector &vector(int i) const;
+	void writeJson(std::ostream &os,const char *indent) const;
+
+private:
+	static void writeHistogram(std::ostream &os,const Histogram &h);
+	static Counter percentile(const Histogram &h,Counter total,unsigned p);
+};
+
+#endif
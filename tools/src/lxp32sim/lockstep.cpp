@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Lockstep class.
+ */
+
+#include "lockstep.h"
+#include "utils.h"
+
+#include <sstream>
+
+static const char *resetMarker="reset";
+
+static Bus::Word byteMask(Bus::Word sel) {
+	Bus::Word mask=0;
+	for(int i=0;i<4;i++) if(sel&(1<<i)) mask|=Bus::Word(0xFF)<<(i*8);
+	return mask;
+}
+
+std::string Lockstep::Transaction::str() const {
+	return std::string(write?"W":"R")+" "+Utils::hex(addr)+" "+
+		Utils::hex(static_cast<std::uint8_t>(sel)).substr(1)+" "+Utils::hex(data);
+}
+
+Lockstep::Lockstep(std::istream &log,const std::string &logName):
+	_log(log),
+	_logName(logName) {}
+
+void Lockstep::setTarget(Bus &target) {
+	_target=&target;
+}
+
+/*
+ * Skip reset markers preceding the transactions of the next test
+ */
+
+void Lockstep::beginTest() {
+	std::string line;
+	while(peekLine(line)&&line==resetMarker) consumeLine();
+}
+
+/*
+ * The test has finished: the log must not contain more transactions
+ * before the next reset marker
+ */
+
+void Lockstep::endTest() {
+	std::string line;
+	if(peekLine(line)&&line!=resetMarker) {
+		throw Divergence("Simulation finished, but the log contains more transactions (line "+
+			std::to_string(_line+1)+": \""+line+"\")");
+	}
+}
+
+/*
+ * Discard the rest of the current test
+ */
+
+void Lockstep::skipTest() {
+	std::string line;
+	while(peekLine(line)&&line!=resetMarker) consumeLine();
+}
+
+Lockstep::Counter Lockstep::transactions() const {
+	return _transactions;
+}
+
+unsigned Lockstep::fetch(Word addr,Word &data) {
+	return _target->fetch(addr,data);
+}
+
+unsigned Lockstep::read(Word addr,Word sel,Word &data) {
+	auto waitStates=_target->read(addr,sel,data);
+	check(Transaction {false,addr,sel,data});
+	return waitStates;
+}
+
+unsigned Lockstep::write(Word addr,Word sel,Word data) {
+	check(Transaction {true,addr,sel,data});
+	return _target->write(addr,sel,data);
+}
+
+std::uint8_t Lockstep::clock() {
+	return _target->clock();
+}
+
+/*
+ * Private members
+ */
+
+void Lockstep::check(const Transaction &actual) {
+	std::string line;
+	if(!peekLine(line)||line==resetMarker) {
+		throw Divergence("Transaction "+actual.str()+" is missing from the log (line "+
+			std::to_string(_line+1)+")");
+	}
+	
+	auto expected=parse(line);
+	auto mask=byteMask(actual.sel);
+	if(expected.write!=actual.write||expected.addr!=actual.addr||expected.sel!=actual.sel||
+		((expected.data^actual.data)&mask)!=0)
+	{
+		throw Divergence("Transaction "+std::to_string(_transactions)+" differs (line "+
+			std::to_string(_line+1)+"): expected "+expected.str()+", got "+actual.str());
+	}
+	
+	consumeLine();
+	_transactions++;
+}
+
+bool Lockstep::peekLine(std::string &line) {
+	while(!_hasPending) {
+		if(!std::getline(_log,_pending)) return false;
+		if(!_pending.empty()&&_pending.back()=='\r') _pending.pop_back();
+		if(_pending.find_first_not_of(" \t")==std::string::npos) {
+			_line++; // skip empty lines
+			continue;
+		}
+		_hasPending=true;
+	}
+	line=_pending;
+	return true;
+}
+
+void Lockstep::consumeLine() {
+	_hasPending=false;
+	_line++;
+}
+
+Lockstep::Transaction Lockstep::parse(const std::string &line) const {
+	std::istringstream ss(line);
+	std::string type,addr,sel,data;
+	Transaction t {false,0,0,0};
+	
+	try {
+		if(!(ss>>type>>addr>>sel>>data)||(type!="R"&&type!="W")) throw std::exception();
+		t.write=(type=="W");
+		t.addr=std::stoul(addr,nullptr,16);
+		t.sel=std::stoul(sel,nullptr,16);
+		t.data=std::stoul(data,nullptr,16);
+	}
+	catch(std::exception &) {
+		throw std::runtime_error(_logName+":"+std::to_string(_line+1)+": bad transaction \""+line+"\"");
+	}
+	
+	return t;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Lockstep class which compares data bus
+ * transactions of the simulated CPU against a log produced by the
+ * dbus_monitor testbench component (see dbus_monitor.vhd).
+ *
+ * Lockstep is inserted between the CPU and the platform. Each data
+ * bus transaction is checked against the next logged transaction;
+ * a Divergence exception is thrown at the first mismatch.
+ */
+
+#ifndef LOCKSTEP_H_INCLUDED
+#define LOCKSTEP_H_INCLUDED
+
+#include "bus.h"
+
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+
+class Lockstep : public Bus {
+public:
+	typedef std::uint64_t Counter;
+	
+	struct Transaction {
+		bool write;
+		Word addr;
+		Word sel;
+		Word data;
+		
+		std::string str() const;
+	};
+	
+	class Divergence : public std::runtime_error {
+	public:
+		Divergence(const std::string &what): std::runtime_error(what) {}
+	};
+
+private:
+	Bus *_target=nullptr;
+	std::istream &_log;
+	std::string _logName;
+	Counter _line=0;
+	Counter _transactions=0;
+	std::string _pending;
+	bool _hasPending=false;
+
+public:
+	Lockstep(std::istream &log,const std::string &logName);
+	
+	void setTarget(Bus &target);
+	
+	void beginTest();
+	void endTest();
+	void skipTest();
+	Counter transactions() const;
+	
+	virtual unsigned fetch(Word addr,Word &data) override;
+	virtual unsigned read(Word addr,Word sel,Word &data) override;
+	virtual unsigned write(Word addr,Word sel,Word data) override;
+	virtual std::uint8_t clock() override;
+
+private:
+	void check(const Transaction &actual);
+	bool peekLine(std::string &line);
+	void consumeLine();
+	Transaction parse(const std::string &line) const;
+};
+
+#endif
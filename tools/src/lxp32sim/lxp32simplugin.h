@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This header defines the C interface between lxp32sim and peripheral
+ * plugins: shared objects modelling WISHBONE slaves attached to the
+ * data bus of the simulated test platform. It doesn't depend on any
+ * other lxp32sim header and can be used from both C and C++.
+ *
+ * A plugin exports one function, lxp32sim_create_device(). lxp32sim
+ * calls it once per simulated platform with a zero-initialized device
+ * descriptor whose abi_version field is set to the version supported
+ * by the simulator. The plugin fills in the descriptor (setting
+ * abi_version to the version it was built for) and returns zero,
+ * or returns a non-zero value and optionally points "error" to a
+ * message describing the failure.
+ *
+ * The device occupies one or more address ranges (regions) in the
+ * part of the address space not used by the test platform (0x50000000
+ * and above). Words are passed in the host byte order; bit 0 of "sel"
+ * selects bits 7:0 of the data word.
+ *
+ *   - IO regions are served by the read() and write() callbacks, which
+ *     return the number of wait states to insert.
+ *
+ *   - RAM and ROM regions are served by the simulator directly from
+ *     memory, without calling the plugin. The memory can be provided
+ *     by the plugin (e.g. a frame buffer it displays); if "memory" is
+ *     NULL, lxp32sim allocates zero-initialized memory and stores the
+ *     pointer in the region descriptor. Writes to ROM regions are
+ *     ignored.
+ *
+ * Time: tick() advances the device by the given number of clock
+ * cycles. The simulator doesn't call it every cycle: quiet_cycles()
+ * returns how many of the following cycles can pass without the
+ * device changing its interrupt request or the data it returns, and
+ * the device is only advanced when these cycles have elapsed or when
+ * it is accessed. A device without quiet_cycles() is ticked every
+ * cycle, a device without tick() is never ticked.
+ *
+ * Posted writes (the batched fast path): a device setting the
+ * LXP32SIM_DEVICE_POSTED_WRITES flag guarantees that writes to its IO
+ * regions neither change its interrupt request nor the value returned
+ * by quiet_cycles(), and are always acknowledged with
+ * "posted_wait_states" wait states. The simulator then queues writes
+ * without bringing the device up to date and delivers them in order
+ * to write_batch(), stamped with the cycle they were issued in, before
+ * the next tick() or read() and before the device is destroyed.
+ * write() is not called for such a device.
+ */
+
+#ifndef LXP32SIMPLUGIN_H_INCLUDED
+#define LXP32SIMPLUGIN_H_INCLUDED
+
+#include <stdint.h>
+
+#define LXP32SIM_PLUGIN_ABI_VERSION 1
+
+#ifdef _WIN32
+	#define LXP32SIM_PLUGIN_VISIBLE __declspec(dllexport)
+#else
+	#define LXP32SIM_PLUGIN_VISIBLE __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+	#define LXP32SIM_PLUGIN_EXPORT extern "C" LXP32SIM_PLUGIN_VISIBLE
+#else
+	#define LXP32SIM_PLUGIN_EXPORT LXP32SIM_PLUGIN_VISIBLE
+#endif
+
+/* Region kinds */
+
+#define LXP32SIM_REGION_IO 0
+#define LXP32SIM_REGION_RAM 1
+#define LXP32SIM_REGION_ROM 2
+
+/* Device flags */
+
+#define LXP32SIM_DEVICE_POSTED_WRITES 0x1
+
+typedef struct lxp32sim_region {
+	uint32_t base; /* byte address, a multiple of 4 */
+	uint32_t size; /* in bytes, a multiple of 4 */
+	uint32_t kind; /* LXP32SIM_REGION_* */
+	uint32_t wait_states; /* RAM and ROM regions: wait states per access */
+	uint32_t *memory; /* RAM and ROM regions: size/4 words or NULL */
+} lxp32sim_region;
+
+typedef struct lxp32sim_access {
+	uint64_t cycle; /* cycle the write was issued in */
+	uint32_t region; /* index in the region table */
+	uint32_t offset; /* byte offset from the region base */
+	uint32_t sel;
+	uint32_t data;
+} lxp32sim_access;
+
+typedef struct lxp32sim_device {
+	uint32_t abi_version;
+	uint32_t flags; /* LXP32SIM_DEVICE_* */
+	const char *name;
+	const char *error; /* set by a failed lxp32sim_create_device() */
+	void *instance; /* passed to the callbacks */
+	
+	lxp32sim_region *regions;
+	uint32_t num_regions;
+	
+	int irq_line; /* interrupt request line (0-7) or -1 */
+	uint32_t posted_wait_states;
+
+/* Any callback can be NULL if not used */
+	unsigned (*read)(void *instance,uint32_t region,uint32_t offset,uint32_t sel,uint32_t *data);
+	unsigned (*write)(void *instance,uint32_t region,uint32_t offset,uint32_t sel,uint32_t data);
+	void (*write_batch)(void *instance,const lxp32sim_access *accesses,uint32_t n);
+	void (*tick)(void *instance,uint64_t cycles);
+	uint64_t (*quiet_cycles)(void *instance);
+	int (*irq)(void *instance);
+	void (*destroy)(void *instance);
+} lxp32sim_device;
+
+/* "args" is the argument string from the command line (empty if none) */
+
+typedef int (*lxp32sim_create_device_fn)(const char *args,lxp32sim_device *device);
+
+#define LXP32SIM_CREATE_DEVICE_SYMBOL "lxp32sim_create_device"
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Lz namespace.
+ *
+ * A compressed block is a sequence of tokens. Each token starts with
+ * a byte containing the literal length (high nibble) and the match
+ * length minus 4 (low nibble), with the value 15 meaning that more
+ * length bytes follow (each 255 byte adds 255, the first other byte
+ * terminates the length). It is followed by the literals and
+ * the 16-bit little-endian match offset. The last token has
+ * no match.
+ */
+
+#include "lz.h"
+
+#include <stdexcept>
+
+static const int HashBits=14;
+static const std::size_t MinMatch=4;
+static const std::size_t MaxOffset=0xFFFF;
+
+static std::uint32_t read32(const std::uint8_t *p) {
+	return static_cast<std::uint32_t>(p[0])|(static_cast<std::uint32_t>(p[1])<<8)|
+		(static_cast<std::uint32_t>(p[2])<<16)|(static_cast<std::uint32_t>(p[3])<<24);
+}
+
+static void putLength(Lz::Buffer &out,std::size_t len) {
+	while(len>=255) {
+		out.push_back(255);
+		len-=255;
+	}
+	out.push_back(static_cast<std::uint8_t>(len));
+}
+
+static void putToken(Lz::Buffer &out,const std::uint8_t *literals,std::size_t literalLen,
+	std::size_t offset,std::size_t matchLen)
+{
+	std::size_t m=(matchLen>0)?matchLen-MinMatch:0;
+	std::uint8_t token=static_cast<std::uint8_t>(((literalLen<15?literalLen:15)<<4)|(m<15?m:15));
+	out.push_back(token);
+	if(literalLen>=15) putLength(out,literalLen-15);
+	out.insert(out.end(),literals,literals+literalLen);
+	if(matchLen==0) return;
+	out.push_back(static_cast<std::uint8_t>(offset));
+	out.push_back(static_cast<std::uint8_t>(offset>>8));
+	if(m>=15) putLength(out,m-15);
+}
+
+void Lz::compress(const Buffer &in,Buffer &out) {
+	out.clear();
+	auto n=in.size();
+	auto data=in.data();
+	std::vector<std::uint32_t> table(std::size_t(1)<<HashBits,0); // position+1, 0 means empty
+	
+	std::size_t anchor=0;
+	std::size_t i=0;
+	
+	while(i+MinMatch<=n) {
+		auto v=read32(data+i);
+		auto h=(v*2654435761u)>>(32-HashBits);
+		std::size_t candidate=table[h];
+		table[h]=static_cast<std::uint32_t>(i+1);
+		
+		if(candidate>0&&i-(candidate-1)<=MaxOffset&&read32(data+candidate-1)==v) {
+			candidate--;
+			auto len=MinMatch;
+			while(i+len<n&&data[candidate+len]==data[i+len]) len++;
+			putToken(out,data+anchor,i-anchor,i-candidate,len);
+			i+=len;
+			anchor=i;
+		}
+		else i++;
+	}
+	
+	if(anchor<n) putToken(out,data+anchor,n-anchor,0,0);
+}
+
+void Lz::decompress(const Buffer &in,std::size_t size,Buffer &out) {
+	out.clear();
+	out.reserve(size);
+	std::size_t pos=0;
+	
+	auto byte=[&]()->std::uint8_t {
+		if(pos>=in.size()) throw std::runtime_error("Corrupted compressed block");
+		return in[pos++];
+	};
+	
+	auto length=[&](std::size_t len)->std::size_t {
+		if(len<15) return len;
+		for(;;) {
+			auto b=byte();
+			len+=b;
+			if(b!=255) return len;
+		}
+	};
+	
+	while(out.size()<size) {
+		auto token=byte();
+		auto literalLen=length(token>>4);
+		if(pos+literalLen>in.size()||out.size()+literalLen>size)
+			throw std::runtime_error("Corrupted compressed block");
+		out.insert(out.end(),in.begin()+pos,in.begin()+pos+literalLen);
+		pos+=literalLen;
+		if(out.size()==size) break;
+		
+		std::size_t offset=byte();
+		offset|=static_cast<std::size_t>(byte())<<8;
+		auto matchLen=length(token&0x0F)+MinMatch;
+		if(offset==0||offset>out.size()||out.size()+matchLen>size)
+			throw std::runtime_error("Corrupted compressed block");
+		auto from=out.size()-offset;
+		for(std::size_t i=0;i<matchLen;i++) out.push_back(out[from+i]); // may overlap
+	}
+}
@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module declares the members of the Lz namespace which
+ * implements a simple byte-oriented LZ77 block compressor. It is
+ * designed for speed rather than compression ratio.
+ */
+
+#ifndef LZ_H_INCLUDED
+#define LZ_H_INCLUDED
+
+#include <vector>
+#include <cstdint>
+
+namespace Lz {
+	typedef std::vector<std::uint8_t> Buffer;
+	
+	void compress(const Buffer &in,Buffer &out);
+	void decompress(const Buffer &in,std::size_t size,Buffer &out);
+}
+
+#endif
@@ -0,0 +1,655 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * Main translation unit for the LXP32 platform simulator.
+ */
+
+#include "runner.h"
+#include "explorer.h"
+#include "baseline.h"
+#include "utils.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+static void displayUsage(std::ostream &os,const char *program) {
+	os<<std::endl;
+	os<<"Usage:"<<std::endl;
+	os<<"    "<<program<<" [ option(s) | input file(s) ]"<<std::endl<<std::endl;
+	
+	os<<"Options:"<<std::endl;
+	os<<"    -baseline <file>"<<std::endl;
+	os<<"                 Compare the -dse results with a JSON report written by an"<<std::endl;
+	os<<"                 earlier run, fail if any test got slower or stopped passing"<<std::endl;
+	os<<"    -batch <addr>[,<lanes>]"<<std::endl;
+	os<<"                 Batch mode: run the first input file (the program) once for"<<std::endl;
+	os<<"                 each of the other files (inputs), <lanes> inputs in lockstep"<<std::endl;
+	os<<"                 (default: 64); each input is stored at <addr> as its size"<<std::endl;
+	os<<"                 in bytes followed by the data"<<std::endl;
+	os<<"    -calltree <file>"<<std::endl;
+	os<<"                 Write a call tree with inclusive and exclusive cycles"<<std::endl;
+	os<<"    -cores <n>   Simulate a system of <n> cores sharing the peripherals"<<std::endl;
+	os<<"                 through a wigen interconnect (interrupts are not connected)"<<std::endl;
+	os<<"    -cov <file>  Write an instruction and branch coverage report"<<std::endl;
+	os<<"    -dma         Enable the DMA engine at 0x70000000 (see dma.inc), which"<<std::endl;
+	os<<"                 shares the data bus with the CPU through a wigen interconnect"<<std::endl;
+	os<<"    -dse <file>  Design space exploration: run all tests on every core"<<std::endl;
+	os<<"                 configuration of the -grid and write the results with"<<std::endl;
+	os<<"                 Pareto-optimal configurations marked (CSV, or JSON for"<<std::endl;
+	os<<"                 \".json\" files)"<<std::endl;
+	os<<"    -fold <file> Write call stacks in the folded format (for flame graphs)"<<std::endl;
+	os<<"    -fork <cycles> Run each test up to the specified cycle once, then fork"<<std::endl;
+	os<<"                 continuations from this checkpoint (see -poke)"<<std::endl;
+	os<<"    -gdb [<host>:]<port> | unix:<path>"<<std::endl;
+	os<<"                 Wait for a GDB connection on a TCP port or a Unix socket"<<std::endl;
+	os<<"    -grid <param>=<v1>[,<v2>...]"<<std::endl;
+	os<<"                 Values of a -dse parameter: core (u, c), mul (dsp, opt, seq),"<<std::endl;
+	os<<"                 div (on, off), rmw (on, off), latency, burst, prefetch"<<std::endl;
+	os<<"                 (instruction cache); default: core=u,c mul=dsp,opt,seq"<<std::endl;
+	os<<"                 div=on,off rmw=off latency=0 burst=16 prefetch=32"<<std::endl;
+	os<<"    -h, --help   Display a short help message"<<std::endl;
+	os<<"    -i <dir>     Add directory to the list of directories used to search"<<std::endl;
+	os<<"                 for included files (multiple directories can be specified)"<<std::endl;
+	os<<"    -icache <latency>[,<burst>[,<prefetch>]]"<<std::endl;
+	os<<"                 Fetch instructions through a model of the LXP32C instruction"<<std::endl;
+	os<<"                 cache with the specified instruction bus latency, burst size"<<std::endl;
+	os<<"                 (default: 16) and prefetch size (default: 32)"<<std::endl;
+	os<<"    -intercon <options>"<<std::endl;
+	os<<"                 Interconnect options for -cores and -dma: p (pipelined"<<std::endl;
+	os<<"                 arbiter), r (registered feedback), u (unsafe slave decoder,"<<std::endl;
+	os<<"                 -cores only)"<<std::endl;
+	os<<"    -irqplay <file>"<<std::endl;
+	os<<"                 Replay interrupt line changes recorded with -irqrec"<<std::endl;
+	os<<"    -irqrec <file>"<<std::endl;
+	os<<"                 Record interrupt line changes with instruction counts"<<std::endl;
+	os<<"    -irqstat <file>"<<std::endl;
+	os<<"                 Write interrupt latency and handler duration histograms"<<std::endl;
+	os<<"                 for each vector (JSON)"<<std::endl;
+	os<<"    -j <n>       Number of worker threads, default: number of host CPU cores"<<std::endl;
+	os<<"    -l <cycles>  Cycle limit for each test, default: 100000000"<<std::endl;
+	os<<"    -lockstep <file>"<<std::endl;
+	os<<"                 Check data bus transactions against a dbus_monitor log"<<std::endl;
+	os<<"                 (\"-\" for the standard input)"<<std::endl;
+	os<<"    -m <arch>    Multiplier architecture (dsp, opt, seq), default: dsp"<<std::endl;
+	os<<"    -map <file>  Read symbols from a map file produced by lxp32asm"<<std::endl;
+	os<<"    -nd          Simulate a CPU without the divider (DIVIDER_EN=false)"<<std::endl;
+	os<<"    -noskip      Simulate idle periods (halted CPU, polling loops) cycle by cycle"<<std::endl;
+	os<<"    -plugin <file>[=<args>]"<<std::endl;
+	os<<"                 Attach a peripheral model loaded from a shared object"<<std::endl;
+	os<<"                 (multiple plugins can be specified)"<<std::endl;
+	os<<"    -poke <addr>=<v1>[,<v2>...]"<<std::endl;
+	os<<"                 Fork one continuation per value; each continuation writes"<<std::endl;
+	os<<"                 its value to the specified bus address before resuming"<<std::endl;
+	os<<"    -prof <file> Write a flat profile and an annotated disassembly listing"<<std::endl;
+	os<<"    -r           Use read-modify-write cycles for byte stores (DBUS_RMW=true)"<<std::endl;
+	os<<"    -save <file> Save a snapshot of the simulator state when the test stops"<<std::endl;
+	os<<"    -sample <period>,<window>[,<warmup>]"<<std::endl;
+	os<<"                 Sampling mode: simulate the instruction cache timing only for"<<std::endl;
+	os<<"                 the last <warmup>+<window> instructions of every <period>,"<<std::endl;
+	os<<"                 extrapolate total cycles from the measured windows (-icache)"<<std::endl;
+	os<<"    -semihost    Enable the semihosting slave at 0x60000000 (console output,"<<std::endl;
+	os<<"                 host files, cycle counter, exit code; see semihost.inc)"<<std::endl;
+	os<<"    -t           Perform pseudo-random instruction and data bus throttling"<<std::endl;
+	os<<"    -trace <file> Record an execution trace (see lxp32trace)"<<std::endl;
+	os<<"    -v           Report everything that is written to the test monitor"<<std::endl;
+	os<<"                 address space"<<std::endl;
+	os<<"    --           Do not interpret subsequent arguments as options"<<std::endl;
+	os<<std::endl;
+	os<<"Each input file is executed as a separate test. Files with \".asm\" or \".s\""<<std::endl;
+	os<<"extensions are assembled on the fly, other files are treated as executable"<<std::endl;
+	os<<"images (bin, textio, dec or hex, detected automatically) or snapshots"<<std::endl;
+	os<<"saved with the -save option."<<std::endl;
+	os<<std::endl;
+	os<<"A test passes when it writes 1 to the test result address (0x10000000)."<<std::endl;
+	os<<"It fails if a region delimited by #perf_begin and #perf_end exceeds its"<<std::endl;
+	os<<"cycle budget."<<std::endl;
+}
+
+/*
+ * Runs the design space exploration, writes the report and displays
+ * the Pareto-optimal configurations, fastest first. With a baseline,
+ * the results are also compared against it.
+ */
+
+static int explore(const Explorer &explorer,const Explorer::Grid &grid,const std::string &filename,
+	const std::vector<std::string> &tests,const std::string &baselineFileName)
+{
+// Read the baseline first: it can be the report being overwritten
+	Baseline baseline;
+	if(!baselineFileName.empty()) baseline.load(baselineFileName);
+	
+	auto start=std::chrono::steady_clock::now();
+	auto outcomes=explorer.run(grid);
+	std::chrono::duration<double> elapsed=std::chrono::steady_clock::now()-start;
+	
+	std::ofstream out(filename,std::ios_base::out);
+	if(!out) throw std::runtime_error("Cannot open \""+filename+"\"");
+	auto ext=filename.substr(std::min(filename.size(),filename.rfind('.')));
+	if(ext==".json"||ext==".JSON") explorer.writeJson(out,outcomes);
+	else explorer.writeCsv(out,outcomes);
+	
+	std::vector<const Explorer::Outcome*> pareto;
+	std::size_t passed=0;
+	for(auto const &o: outcomes) {
+		if(o.passed) passed++;
+		if(o.pareto) pareto.push_back(&o);
+	}
+	std::stable_sort(pareto.begin(),pareto.end(),[](const Explorer::Outcome *a,const Explorer::Outcome *b) {
+		return a->cycles<b->cycles;
+	});
+	
+	std::cout<<"Pareto-optimal configurations:"<<std::endl;
+	for(auto o: pareto) std::cout<<std::setw(14)<<o->cycles<<" cycles  "<<Explorer::describe(o->point)<<std::endl;
+	std::cout<<passed<<" of "<<outcomes.size()<<" configuration(s) passed all tests in "<<
+		std::fixed<<std::setprecision(2)<<elapsed.count()<<" s"<<std::endl;
+	
+	if(!baselineFileName.empty()) {
+		auto summary=baseline.compare(tests,outcomes,std::cout);
+		if(summary.regressions>0) return EXIT_FAILURE;
+	}
+	
+	if(passed==0) return EXIT_FAILURE;
+	return 0;
+}
+
+int main(int argc,char *argv[]) try {
+	std::vector<std::string> inputFiles;
+	Runner runner;
+	Runner::Settings settings;
+	Explorer explorer;
+	Explorer::Grid grid;
+	std::string dseFileName;
+	std::string baselineFileName;
+	bool gridSpecified=false;
+	bool coreOptions=false; // -m, -nd, -r or -icache
+	bool noMoreOptions=false;
+	
+	std::cout<<"LXP32 Platform Simulator"<<std::endl;
+	std::cout<<"Copyright (c) 2016-2019 by Alex I. Kuznetsov"<<std::endl;
+	
+	if(argc<=1) {
+		displayUsage(std::cout,argv[0]);
+		return 0;
+	}
+	
+	for(int i=1;i<argc;i++) {
+		if(argv[i][0]!='-'||noMoreOptions) inputFiles.push_back(argv[i]);
+		else if(!strcmp(argv[i],"--")) noMoreOptions=true;
+		else if(!strcmp(argv[i],"-baseline")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			baselineFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-batch")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			try {
+				std::istringstream values(argv[i]);
+				std::vector<unsigned long long> v;
+				std::string value;
+				while(std::getline(values,value,',')) v.push_back(std::stoull(value,nullptr,0));
+				if(v.empty()||v.size()>2) throw std::exception();
+				if(v[0]%4!=0||v[0]>=ProgramRam::Size) throw std::exception();
+				settings.batch=true;
+				settings.batchInputAddr=static_cast<Cpu::Word>(v[0]);
+				if(v.size()>1) {
+					if(v[1]<1||v[1]>4096) throw std::exception();
+					settings.batchLanes=static_cast<std::size_t>(v[1]);
+				}
+			}
+			catch(std::exception &) {
+				throw std::runtime_error("Invalid -batch argument");
+			}
+		}
+		else if(!strcmp(argv[i],"-calltree")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			settings.callTreeFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-cores")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			try {
+				settings.cores=std::stoi(argv[i]);
+			}
+			catch(std::exception &) {
+				throw std::runtime_error("Invalid number of cores");
+			}
+			if(settings.cores<1||settings.cores>64) throw std::runtime_error("Invalid number of cores");
+		}
+		else if(!strcmp(argv[i],"-cov")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			settings.coverageFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-dma")) {
+			settings.dma=true;
+		}
+		else if(!strcmp(argv[i],"-dse")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			dseFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-fold")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			settings.foldedFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-fork")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			try {
+				settings.forkCycle=std::stoull(argv[i],nullptr,0);
+			}
+			catch(std::exception &) {
+				throw std::runtime_error("Invalid fork point");
+			}
+		}
+		else if(!strcmp(argv[i],"-gdb")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			settings.gdbAddress=argv[i];
+		}
+		else if(!strcmp(argv[i],"-grid")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			grid.set(argv[i]);
+			gridSpecified=true;
+		}
+		else if(!strcmp(argv[i],"-h")||!strcmp(argv[i],"--help")) {
+			displayUsage(std::cout,argv[0]);
+			return 0;
+		}
+		else if(!strcmp(argv[i],"-i")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			settings.includeSearchDirs.push_back(argv[i]);
+		}
+		else if(!strcmp(argv[i],"-icache")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			try {
+				std::istringstream values(argv[i]);
+				std::vector<unsigned long> v;
+				std::string value;
+				while(std::getline(values,value,',')) v.push_back(std::stoul(value,nullptr,0));
+				if(v.empty()||v.size()>3) throw std::exception();
+				settings.icacheLatency=static_cast<unsigned>(v[0]);
+				if(v.size()>1) settings.icacheBurstSize=static_cast<unsigned>(v[1]);
+				if(v.size()>2) settings.icachePrefetchSize=static_cast<unsigned>(v[2]);
+				settings.icache=true;
+				coreOptions=true;
+			}
+			catch(std::exception &) {
+				throw std::runtime_error("Invalid -icache argument");
+			}
+		}
+		else if(!strcmp(argv[i],"-intercon")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			for(const char *p=argv[i];*p;p++) {
+				if(*p=='p') settings.pipelinedArbiter=true;
+				else if(*p=='r') settings.registeredFeedback=true;
+				else if(*p=='u') settings.unsafeDecoder=true;
+				else throw std::runtime_error("Invalid interconnect options");
+			}
+		}
+		else if(!strcmp(argv[i],"-irqplay")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			settings.irqReplayFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-irqrec")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			settings.irqRecordFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-irqstat")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			settings.irqStatsFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-j")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			try {
+				auto n=std::stoul(argv[i],nullptr,0);
+				if(n==0) throw std::exception();
+				runner.setThreads(static_cast<unsigned>(n));
+				explorer.setThreads(static_cast<unsigned>(n));
+			}
+			catch(std::exception &) {
+				throw std::runtime_error("Invalid number of threads");
+			}
+		}
+		else if(!strcmp(argv[i],"-l")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			try {
+				settings.cycleLimit=std::stoull(argv[i],nullptr,0);
+			}
+			catch(std::exception &) {
+				throw std::runtime_error("Invalid cycle limit");
+			}
+		}
+		else if(!strcmp(argv[i],"-lockstep")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			settings.lockstepFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-m")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			if(!strcmp(argv[i],"dsp")) settings.mulArch=CoreProfile::MulDsp;
+			else if(!strcmp(argv[i],"opt")) settings.mulArch=CoreProfile::MulOpt;
+			else if(!strcmp(argv[i],"seq")) settings.mulArch=CoreProfile::MulSeq;
+			else throw std::runtime_error("Unrecognized multiplier architecture");
+			coreOptions=true;
+		}
+		else if(!strcmp(argv[i],"-map")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			settings.mapFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-nd")) {
+			settings.dividerEnabled=false;
+			coreOptions=true;
+		}
+		else if(!strcmp(argv[i],"-noskip")) {
+			settings.idleSkipping=false;
+		}
+		else if(!strcmp(argv[i],"-plugin")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			std::string str(argv[i]);
+			auto eq=str.find('=');
+			if(eq==std::string::npos) settings.plugins.emplace_back(str,std::string());
+			else settings.plugins.emplace_back(str.substr(0,eq),str.substr(eq+1));
+		}
+		else if(!strcmp(argv[i],"-poke")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			try {
+				std::string str(argv[i]);
+				auto eq=str.find('=');
+				if(eq==std::string::npos) throw std::exception();
+				settings.pokeAddr=std::stoul(str.substr(0,eq),nullptr,0);
+				std::istringstream values(str.substr(eq+1));
+				std::string value;
+				while(std::getline(values,value,',')) settings.pokeValues.push_back(std::stoul(value,nullptr,0));
+				if(settings.pokeValues.empty()) throw std::exception();
+				settings.poke=true;
+			}
+			catch(std::exception &) {
+				throw std::runtime_error("Invalid -poke argument");
+			}
+		}
+		else if(!strcmp(argv[i],"-prof")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			settings.profileFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-r")) {
+			settings.dbusRmw=true;
+			coreOptions=true;
+		}
+		else if(!strcmp(argv[i],"-save")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			settings.snapshotFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-sample")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			try {
+				std::istringstream values(argv[i]);
+				std::vector<Cpu::Counter> v;
+				std::string value;
+				while(std::getline(values,value,',')) v.push_back(std::stoull(value,nullptr,0));
+				if(v.size()<2||v.size()>3) throw std::exception();
+				settings.samplePeriod=v[0];
+				settings.sampleWindow=v[1];
+				if(v.size()>2) settings.sampleWarmup=v[2];
+				if(settings.sampleWindow==0||settings.samplePeriod<settings.sampleWindow+settings.sampleWarmup)
+					throw std::exception();
+			}
+			catch(std::exception &) {
+				throw std::runtime_error("Invalid -sample argument");
+			}
+		}
+		else if(!strcmp(argv[i],"-semihost")) {
+			settings.semihosting=true;
+		}
+		else if(!strcmp(argv[i],"-trace")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			settings.traceFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-t")) {
+			settings.throttleIbus=true;
+			settings.throttleDbus=true;
+		}
+		else if(!strcmp(argv[i],"-v")) {
+			settings.verbose=true;
+		}
+		else throw std::runtime_error(std::string("Unrecognized option: \"")+argv[i]+"\"");
+	}
+	
+	if(inputFiles.empty())
+		throw std::runtime_error("No input files were specified");
+	
+	if(!settings.snapshotFileName.empty()&&(inputFiles.size()>1||settings.poke))
+		throw std::runtime_error("Snapshot can only be saved for a single test without -poke");
+	
+	bool profiling=!settings.profileFileName.empty()||
+		!settings.foldedFileName.empty()||!settings.callTreeFileName.empty();
+	if(profiling&&(inputFiles.size()>1||settings.poke))
+		throw std::runtime_error("Profile can only be collected for a single test without -poke");
+	
+	if(!settings.traceFileName.empty()&&(inputFiles.size()>1||settings.poke))
+		throw std::runtime_error("Trace can only be recorded for a single test without -poke");
+	
+	bool irqSchedule=!settings.irqRecordFileName.empty()||!settings.irqReplayFileName.empty();
+	if(irqSchedule&&(inputFiles.size()>1||settings.poke))
+		throw std::runtime_error("Interrupt schedule can only be recorded or replayed for a single test without -poke");
+	if(!settings.irqRecordFileName.empty()&&!settings.irqReplayFileName.empty())
+		throw std::runtime_error("Interrupt schedule can't be recorded and replayed at the same time");
+	
+	bool coverage=!settings.coverageFileName.empty();
+	
+	if(!settings.lockstepFileName.empty()&&(profiling||coverage||settings.forkCycle>0||settings.poke||
+		!settings.snapshotFileName.empty()||!settings.traceFileName.empty()||irqSchedule))
+	{
+		throw std::runtime_error("Lockstep mode can't be combined with checkpointing, profiling, coverage, "
+			"tracing or interrupt schedules");
+	}
+	
+	if(!settings.gdbAddress.empty()&&(inputFiles.size()!=1||profiling||coverage||settings.forkCycle>0||settings.poke||
+		!settings.snapshotFileName.empty()||!settings.traceFileName.empty()||!settings.lockstepFileName.empty()))
+	{
+		throw std::runtime_error("GDB server requires a single test and can't be combined with checkpointing, "
+			"profiling, coverage, tracing or lockstep mode");
+	}
+	
+	if(settings.cores>0&&(profiling||coverage||settings.forkCycle>0||settings.poke||settings.throttleIbus||
+		!settings.snapshotFileName.empty()||!settings.traceFileName.empty()||irqSchedule||
+		!settings.lockstepFileName.empty()||!settings.gdbAddress.empty()))
+	{
+		throw std::runtime_error("Multi-core mode can't be combined with checkpointing, profiling, coverage, "
+			"tracing, interrupt schedules, bus throttling, lockstep mode or GDB server");
+	}
+	
+	if(!settings.plugins.empty()&&(settings.poke||!settings.snapshotFileName.empty()||settings.cores>0))
+		throw std::runtime_error("Plugins can't be combined with -poke, snapshots or multi-core mode");
+	
+	if(settings.semihosting&&(settings.poke||!settings.snapshotFileName.empty()||settings.cores>0||
+		!settings.lockstepFileName.empty()))
+	{
+		throw std::runtime_error("Semihosting can't be combined with -poke, snapshots, multi-core mode "
+			"or lockstep mode");
+	}
+	
+	if(settings.dma&&(!settings.snapshotFileName.empty()||settings.cores>0||settings.batch||
+		!settings.lockstepFileName.empty()||settings.samplePeriod>0))
+	{
+		throw std::runtime_error("DMA engine can't be combined with snapshots, multi-core mode, batch mode, "
+			"lockstep mode or sampling");
+	}
+	
+	if(settings.samplePeriod>0&&(!settings.icache||settings.forkCycle>0||settings.poke||
+		!settings.lockstepFileName.empty()||!settings.gdbAddress.empty()))
+	{
+		throw std::runtime_error("Sampling requires -icache and can't be combined with checkpointing, "
+			"lockstep mode or GDB server");
+	}
+	
+	if(settings.icache&&settings.cores>0)
+		throw std::runtime_error("Instruction cache model is not supported in multi-core mode");
+	
+	if(settings.batch&&inputFiles.size()<2)
+		throw std::runtime_error("Batch mode requires a program and at least one input file");
+	
+	if(settings.batch&&(profiling||coverage||settings.forkCycle>0||settings.poke||
+		!settings.snapshotFileName.empty()||!settings.traceFileName.empty()||irqSchedule||
+		settings.throttleIbus||settings.icache||!settings.plugins.empty()||
+		!settings.lockstepFileName.empty()||!settings.gdbAddress.empty()||settings.cores>0))
+	{
+		throw std::runtime_error("Batch mode can't be combined with checkpointing, profiling, coverage, "
+			"tracing, interrupt schedules, bus throttling, instruction cache model, plugins, lockstep mode, "
+			"GDB server or multi-core mode");
+	}
+	
+	if(!settings.irqStatsFileName.empty()&&(!settings.lockstepFileName.empty()||!settings.gdbAddress.empty()||
+		settings.cores>0||settings.batch||!dseFileName.empty()))
+	{
+		throw std::runtime_error("Interrupt statistics can't be collected in lockstep mode, multi-core mode, "
+			"batch mode, with GDB server or during design space exploration");
+	}
+	
+	if(gridSpecified&&dseFileName.empty())
+		throw std::runtime_error("-grid requires -dse");
+	
+	if(!baselineFileName.empty()&&dseFileName.empty())
+		throw std::runtime_error("-baseline requires -dse");
+	
+	if(!dseFileName.empty()&&(coreOptions||settings.samplePeriod>0||profiling||coverage||
+		settings.forkCycle>0||settings.poke||!settings.snapshotFileName.empty()||!settings.traceFileName.empty()||
+		irqSchedule||!settings.lockstepFileName.empty()||!settings.gdbAddress.empty()||settings.cores>0||
+		settings.batch))
+	{
+		throw std::runtime_error("Design space exploration can't be combined with core options (use -grid), "
+			"sampling, checkpointing, profiling, coverage, tracing, interrupt schedules, lockstep mode, "
+			"GDB server, multi-core mode or batch mode");
+	}
+	
+	if(!dseFileName.empty()) {
+		explorer.setSettings(settings);
+		for(auto const &filename: inputFiles) explorer.addFile(filename);
+		return explore(explorer,grid,dseFileName,inputFiles,baselineFileName);
+	}
+	
+	runner.setSettings(settings);
+	for(auto const &filename: inputFiles) runner.addFile(filename);
+	
+	auto start=std::chrono::steady_clock::now();
+	auto results=runner.run();
+	std::chrono::duration<double> elapsed=std::chrono::steady_clock::now()-start;
+	
+	std::size_t passed=0;
+	
+	for(auto const &res: results) {
+		std::cout<<res.log;
+		std::cout<<"TEST \""<<res.filename<<"\" RESULT: ";
+		switch(res.status) {
+		case Runner::Result::Success:
+			std::cout<<"SUCCESS (return code 0x"<<Utils::hex(res.returnCode)<<")";
+			passed++;
+			break;
+		case Runner::Result::Failure:
+			if(!res.message.empty()) std::cout<<"FAILURE ("<<res.message<<")";
+			else std::cout<<"FAILURE (return code 0x"<<Utils::hex(res.returnCode)<<")";
+			break;
+		case Runner::Result::Timeout:
+			std::cout<<"TIMEOUT (cycle limit exceeded)";
+			break;
+		default:
+			std::cout<<"ERROR ("<<res.message<<")";
+			break;
+		}
+		std::cout<<", "<<res.cycles<<" cycles, "<<res.instructions<<" instructions"<<std::endl;
+	}
+	
+	std::cout<<passed<<" of "<<results.size()<<" test(s) passed in "<<
+		std::fixed<<std::setprecision(2)<<elapsed.count()<<" s"<<std::endl;
+	
+	if(passed!=results.size()) return EXIT_FAILURE;
+}
+catch(std::exception &ex) {
+	std::cerr<<"Error: "<<ex.what()<<std::endl;
+	return EXIT_FAILURE;
+}
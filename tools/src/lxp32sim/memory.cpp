@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Memory class.
+ */
+
+#include "memory.h"
+
+#include <stdexcept>
+
+Memory::Memory(std::size_t words):
+	_pages((words+PageWords-1)/PageWords),
+	_words(words) {}
+
+std::size_t Memory::size() const {
+	return _words;
+}
+
+void Memory::write(std::size_t index,Word value) {
+	auto &page=_pages[index>>PageBits];
+	if(!page) {
+		if(value==0) return; // unallocated pages read as zero anyway
+		page=std::make_shared<Page>();
+		page->fill(0);
+	}
+	else if(page.use_count()>1) {
+		page=std::make_shared<Page>(*page); // copy on write
+	}
+	(*page)[index&(PageWords-1)]=value;
+}
+
+std::size_t Memory::allocatedPages() const {
+	std::size_t n=0;
+	for(auto const &page: _pages) {
+		if(page) n++;
+	}
+	return n;
+}
+
+std::size_t Memory::sharedPages() const {
+	std::size_t n=0;
+	for(auto const &page: _pages) {
+		if(page&&page.use_count()>1) n++;
+	}
+	return n;
+}
+
+void Memory::saveState(StateWriter &w) const {
+	w.word(static_cast<Word>(_words));
+	w.word(static_cast<Word>(allocatedPages()));
+	for(std::size_t i=0;i<_pages.size();i++) {
+		if(!_pages[i]) continue;
+		w.word(static_cast<Word>(i));
+		for(auto word: *_pages[i]) w.word(word);
+	}
+}
+
+void Memory::loadState(StateReader &r) {
+	if(r.word()!=_words) throw std::runtime_error("Memory size mismatch");
+	auto n=r.word();
+	for(auto &page: _pages) page.reset();
+	for(Word i=0;i<n;i++) {
+		auto index=r.word();
+		if(index>=_pages.size()) throw std::runtime_error("Bad memory page index");
+		auto page=std::make_shared<Page>();
+		for(auto &word: *page) word=r.word();
+		_pages[index]=page;
+	}
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Memory class which represents a paged
+ * word-addressable memory. Pages are shared between copies of
+ * a Memory object and duplicated on the first write (copy-on-write),
+ * so a copy of a large memory is cheap. Pages that were never
+ * written to are not allocated and read as zero.
+ */
+
+#ifndef MEMORY_H_INCLUDED
+#define MEMORY_H_INCLUDED
+
+#include "state.h"
+
+#include <vector>
+#include <memory>
+#include <array>
+#include <cstdint>
+
+class Memory {
+public:
+	typedef std::uint32_t Word;
+	
+	static const std::size_t PageBits=8;
+	static const std::size_t PageWords=std::size_t(1)<<PageBits;
+
+private:
+	typedef std::array<Word,PageWords> Page;
+	
+	std::vector<std::shared_ptr<Page> > _pages;
+	std::size_t _words;
+
+public:
+	Memory(std::size_t words);
+	
+	std::size_t size() const;
+	
+	Word read(std::size_t index) const {
+		auto const &page=_pages[index>>PageBits];
+		if(!page) return 0;
+		return (*page)[index&(PageWords-1)];
+	}
+	
+	void write(std::size_t index,Word value);
+	
+	std::size_t allocatedPages() const;
+	std::size_t sharedPages() const;
+	
+	void saveState(StateWriter &w) const;
+	void loadState(StateReader &r);
+};
+
+#endif
@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the MultiCore class.
+ */
+
+#include "multicore.h"
+
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+
+/*
+ * MultiCore::CoreInfo members
+ */
+
+MultiCore::CoreInfo::CoreInfo(const Intercon &intercon):
+	_intercon(intercon) {}
+
+unsigned MultiCore::CoreInfo::read(Word addr,Word,Word &data) {
+	if(addr==0) data=static_cast<Word>(_intercon.currentMaster());
+	else if(addr==4) data=static_cast<Word>(_intercon.masters());
+	else data=0;
+	return 0;
+}
+
+unsigned MultiCore::CoreInfo::write(Word,Word,Word) {
+	return 0;
+}
+
+void MultiCore::CoreInfo::saveState(StateWriter &) const {}
+
+void MultiCore::CoreInfo::loadState(StateReader &) {}
+
+/*
+ * MultiCore::CoreBus members
+ */
+
+MultiCore::CoreBus::CoreBus(MultiCore &system,int index):
+	_system(system),
+	_index(index) {}
+
+void MultiCore::CoreBus::setCode(const ProgramRam &ram) {
+	_code=ram;
+}
+
+MultiCore::Counter MultiCore::CoreBus::now() const {
+	return _now;
+}
+
+/*
+ * Instructions are fetched from a private copy of the program RAM,
+ * so code is not expected to be modified while the system runs
+ */
+
+unsigned MultiCore::CoreBus::fetch(Word addr,Word &data) {
+	data=_code.fetch(addr);
+	return 0;
+}
+
+/*
+ * Several data bus cycles can be issued by one instruction (e.g. a
+ * read-modify-write sequence); each of them is requested after the
+ * previous one has been acknowledged
+ */
+
+unsigned MultiCore::CoreBus::read(Word addr,Word sel,Word &data) {
+	auto waitStates=_system.access(_index,_now+_offset,false,addr,sel,data);
+	_offset+=waitStates+1;
+	return waitStates;
+}
+
+unsigned MultiCore::CoreBus::write(Word addr,Word sel,Word data) {
+	auto waitStates=_system.access(_index,_now+_offset,true,addr,sel,data);
+	_offset+=waitStates+1;
+	return waitStates;
+}
+
+std::uint8_t MultiCore::CoreBus::clock() {
+	_now++;
+	_offset=0;
+	return 0;
+}
+
+/*
+ * With no interrupt lines connected, a halted core can be skipped
+ * to the end of the run. Polling loops are not skipped since they
+ * may depend on data written by other cores.
+ */
+
+MultiCore::Counter MultiCore::CoreBus::quietCycles(Counter limit,bool accesses) {
+	if(accesses) return 0;
+	return limit;
+}
+
+void MultiCore::CoreBus::skip(Counter n) {
+	_now+=n;
+	_offset=0;
+}
+
+/*
+ * MultiCore members
+ */
+
+MultiCore::MultiCore(int cores):
+	_intercon(cores),
+	_coreInfo(_intercon),
+	_stop(false)
+{
+	_intercon.addSlave(_ram);
+	_intercon.addSlave(_monitor);
+	_intercon.addSlave(_timer);
+	_intercon.addSlave(_coprocessor);
+	_intercon.addSlave(_timer2);
+	_intercon.addSlave(_coreInfo);
+	
+	for(int i=0;i<cores;i++) {
+		Core core;
+		core.bus.reset(new CoreBus(*this,i));
+		core.cpu.reset(new Cpu(*core.bus));
+		_cores.push_back(std::move(core));
+	}
+}
+
+int MultiCore::cores() const {
+	return static_cast<int>(_cores.size());
+}
+
+Cpu &MultiCore::cpu(int core) {
+	return *_cores[core].cpu;
+}
+
+const Cpu &MultiCore::cpu(int core) const {
+	return *_cores[core].cpu;
+}
+
+Intercon &MultiCore::intercon() {
+	return _intercon;
+}
+
+const Intercon &MultiCore::intercon() const {
+	return _intercon;
+}
+
+Monitor &MultiCore::monitor() {
+	return _monitor;
+}
+
+void MultiCore::setIdleSkipping(bool b) {
+	_idleSkipping=b;
+}
+
+void MultiCore::loadImage(const std::vector<Word> &image) {
+	_ram.load(image);
+}
+
+bool MultiCore::finished() const {
+	return _finishingCore>=0;
+}
+
+/*
+ * Runs all cores until the test monitor is written to or every
+ * core has executed "cycles" clock cycles
+ */
+
+void MultiCore::run(Counter cycles) {
+	auto n=_cores.size();
+	
+	_clocks.reset(new std::atomic<Counter>[n]);
+	_requests.assign(n,Counter(Never));
+	_stop=false;
+	_finishingCore=-1;
+	_error.clear();
+	
+	for(std::size_t i=0;i<n;i++) {
+		auto &core=_cores[i];
+		core.bus->setCode(_ram);
+		core.history.assign(2*MaxLag,Step());
+		core.steps=0;
+		core.horizon=0;
+		core.aborted=false;
+		core.cpu->resetLoopDetection();
+		_clocks[i].store(core.bus->now());
+	}
+	
+	std::vector<std::thread> threads;
+	for(std::size_t i=0;i<n;i++) threads.emplace_back(&MultiCore::runCore,this,static_cast<int>(i),cycles);
+	for(auto &t: threads) t.join();
+	
+// Cores that were not involved in the final transaction could have
+// run ahead; count only instructions started before it
+	_cycles=0;
+	for(std::size_t i=0;i<n;i++) {
+		auto &core=_cores[i];
+		if(_finishingCore<0||static_cast<int>(i)==_finishingCore) core.instructions=core.cpu->instructions();
+		else core.instructions=instructionsAt(static_cast<int>(i),_finishTime);
+		if(_finishingCore<0) _cycles=std::max(_cycles,core.cpu->cycles());
+	}
+	if(_finishingCore>=0) _cycles=_cores[_finishingCore].cpu->cycles();
+	
+	if(!_error.empty()) throw std::runtime_error(_error);
+}
+
+MultiCore::Counter MultiCore::cycles() const {
+	return _cycles;
+}
+
+MultiCore::Counter MultiCore::instructions() const {
+	Counter total=0;
+	for(auto const &core: _cores) total+=core.instructions;
+	return total;
+}
+
+MultiCore::Counter MultiCore::instructions(int core) const {
+	return _cores[core].instructions;
+}
+
+/*
+ * Private members
+ */
+
+void MultiCore::runCore(int index,Counter cycles) {
+	auto &core=_cores[index];
+	
+	try {
+		while(!_stop.load(std::memory_order_acquire)) {
+			auto now=core.bus->now();
+			if(now>=cycles) break;
+			_clocks[index].store(now,std::memory_order_release);
+			if(now>core.horizon) {
+				waitForLag(index,now);
+				if(_stop.load(std::memory_order_acquire)) break;
+			}
+			core.history[core.steps%core.history.size()]={now,core.cpu->instructions()};
+			core.steps++;
+			core.cpu->step(_idleSkipping?cycles-now:0);
+		}
+	}
+	catch(std::exception &ex) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(_error.empty()&&!core.aborted) _error="Core "+std::to_string(index)+": "+ex.what();
+		_stop=true;
+	}
+	
+	_clocks[index].store(Never,std::memory_order_release);
+}
+
+/*
+ * Limits how far a core can run ahead of the others. This bounds
+ * the step history needed to count instructions at the end of the run.
+ */
+
+void MultiCore::waitForLag(int index,Counter now) {
+	auto &core=_cores[index];
+	
+	for(;;) {
+		Counter slowest=Never;
+		for(std::size_t i=0;i<_cores.size();i++) {
+			if(static_cast<int>(i)!=index) slowest=std::min(slowest,_clocks[i].load(std::memory_order_acquire));
+		}
+		if(slowest==Never) {
+			core.horizon=Never;
+			return;
+		}
+		if(now<=slowest+MaxLag) {
+			core.horizon=slowest+MaxLag;
+			return;
+		}
+		if(_stop.load(std::memory_order_acquire)) return;
+		std::this_thread::yield();
+	}
+}
+
+/*
+ * A request is served when its master wins arbitration and no other
+ * core can issue an earlier request anymore, i.e. every core that
+ * is not waiting for the bus has advanced past the decision cycle.
+ * The clock of a waiting core is the earliest cycle its request
+ * can be served in (a low priority core can be starved by others).
+ */
+
+unsigned MultiCore::access(int index,Counter request,bool write,Word addr,Word sel,Word &data) {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_requests[index]=request;
+		_clocks[index].store(std::max(request,_intercon.busyUntil()),std::memory_order_release);
+	}
+	
+	for(;;) {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			
+			if(_stop.load(std::memory_order_acquire)) {
+				_requests[index]=Never;
+				_cores[index].aborted=true;
+				if(!write) data=0;
+				return 0;
+			}
+			
+			Counter decision;
+			if(_intercon.arbitrate(_requests,decision)==index) {
+				bool ready=true;
+				for(std::size_t i=0;i<_cores.size()&&ready;i++) {
+					if(_requests[i]==Never&&_clocks[i].load(std::memory_order_acquire)<=decision) ready=false;
+				}
+				if(ready) {
+					_requests[index]=Never;
+					unsigned waitStates;
+					if(write) waitStates=_intercon.write(index,request,decision,addr,sel,data);
+					else waitStates=_intercon.read(index,request,decision,addr,sel,data);
+					for(std::size_t i=0;i<_cores.size();i++) {
+						if(_requests[i]!=Never) _clocks[i].store(std::max(_requests[i],_intercon.busyUntil()),std::memory_order_release);
+					}
+					if(_monitor.finished()) {
+						_finishingCore=index;
+						_finishTime=decision;
+						_stop.store(true,std::memory_order_release);
+					}
+					return waitStates;
+				}
+			}
+		}
+		std::this_thread::yield();
+	}
+}
+
+/*
+ * Returns the number of instructions a core had completed by the
+ * beginning of the first step that started after "time"
+ */
+
+MultiCore::Counter MultiCore::instructionsAt(int index,Counter time) const {
+	auto const &core=_cores[index];
+	auto size=core.history.size();
+	Counter first=(core.steps>size)?(core.steps-size):0;
+	
+	for(auto i=first;i<core.steps;i++) {
+		auto const &step=core.history[i%size];
+		if(step.cycles>time) {
+			if(i==first&&first>0) throw std::logic_error("Step history overflow");
+			return step.instructions;
+		}
+	}
+	
+// An aborted step has not been completed
+	if(core.aborted&&core.steps>0) return core.history[(core.steps-1)%size].instructions;
+	return core.cpu->instructions();
+}
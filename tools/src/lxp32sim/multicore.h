@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the MultiCore class which models a system of
+ * several LXP32 cores sharing the test platform peripherals through
+ * a wigen interconnect (see Intercon). Each core has a private
+ * instruction bus port to its own copy of the program RAM (like the
+ * LLI port in the test platform); data bus cycles go through the
+ * shared interconnect. An additional slave (at CoreInfoBase) lets
+ * the firmware identify the core it runs on.
+ *
+ * Every core is simulated by its own host thread. Threads are kept
+ * in sync conservatively: a bus request issued in cycle "t" is only
+ * arbitrated once every other core has either advanced past "t" or
+ * is waiting for the bus itself, so the simulated timing does not
+ * depend on host thread scheduling.
+ *
+ * Interrupt lines are not connected in a multi-core system.
+ */
+
+#ifndef MULTICORE_H_INCLUDED
+#define MULTICORE_H_INCLUDED
+
+#include "cpu.h"
+#include "bus.h"
+#include "peripherals.h"
+#include "intercon.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+
+class MultiCore {
+public:
+	typedef Cpu::Word Word;
+	typedef Cpu::Counter Counter;
+	
+	static const Counter Never=~Counter(0);
+	static const Word CoreInfoBase=0x50000000;
+
+private:
+/*
+ * Core identification slave: offset 0 reads the index of the
+ * requesting core, offset 4 reads the number of cores
+ */
+	class CoreInfo : public Slave {
+		const Intercon &_intercon;
+	public:
+		CoreInfo(const Intercon &intercon);
+		virtual unsigned read(Word addr,Word sel,Word &data) override;
+		virtual unsigned write(Word addr,Word sel,Word data) override;
+		virtual void saveState(StateWriter &w) const override;
+		virtual void loadState(StateReader &r) override;
+	};
+	
+	class CoreBus : public Bus {
+		MultiCore &_system;
+		int _index;
+		ProgramRam _code;
+		Counter _now=0;
+		Counter _offset=0; // cycles taken by earlier accesses in the same clock cycle
+	public:
+		CoreBus(MultiCore &system,int index);
+		void setCode(const ProgramRam &ram);
+		Counter now() const;
+		
+		virtual unsigned fetch(Word addr,Word &data) override;
+		virtual unsigned read(Word addr,Word sel,Word &data) override;
+		virtual unsigned write(Word addr,Word sel,Word data) override;
+		virtual std::uint8_t clock() override;
+		virtual Counter quietCycles(Counter limit,bool accesses) override;
+		virtual void skip(Counter n) override;
+	};
+	
+// Cycle and instruction counters at the beginning of a recent step
+	struct Step {
+		Counter cycles;
+		Counter instructions;
+	};
+	
+	struct Core {
+		std::unique_ptr<CoreBus> bus;
+		std::unique_ptr<Cpu> cpu;
+		std::vector<Step> history;
+		Counter steps=0;
+		Counter horizon=0;
+		bool aborted=false;
+		Counter instructions=0;
+	};
+	
+// Cores may not run ahead of the slowest one by more than this
+	static const Counter MaxLag=4096;
+	
+	ProgramRam _ram;
+	Monitor _monitor;
+	Timer _timer;
+	Coprocessor _coprocessor;
+	Timer _timer2;
+	Intercon _intercon;
+	CoreInfo _coreInfo;
+	
+	std::vector<Core> _cores;
+	bool _idleSkipping=true;
+	
+// Shared between the core threads
+	std::unique_ptr<std::atomic<Counter>[]> _clocks;
+	std::vector<Counter> _requests; // guarded by _mutex
+	std::mutex _mutex;
+	std::atomic<bool> _stop;
+	int _finishingCore=-1;
+	Counter _finishTime=0;
+	std::string _error;
+	
+	Counter _cycles=0;
+
+public:
+	MultiCore(int cores);
+	MultiCore(const MultiCore &)=delete;
+	MultiCore &operator=(const MultiCore &)=delete;
+	
+	int cores() const;
+	Cpu &cpu(int core);
+	const Cpu &cpu(int core) const;
+	Intercon &intercon();
+	const Intercon &intercon() const;
+	Monitor &monitor();
+	
+	void setIdleSkipping(bool b);
+	
+	void loadImage(const std::vector<Word> &image);
+	bool finished() const;
+	void run(Counter cycles);
+	
+	Counter cycles() const;
+	Counter instructions() const;
+	Counter instructions(int core) const;
+
+private:
+	void runCore(int index,Counter cycles);
+	void waitForLag(int index,Counter now);
+	unsigned access(int index,Counter request,bool write,Word addr,Word sel,Word &data);
+	Counter instructionsAt(int index,Counter time) const;
+};
+
+#endif
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Parallel namespace.
+ */
+
+#include "parallel.h"
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+/*
+ * Calls f(i) for every i in [0,n) on up to the given number of
+ * threads (0 means one per host CPU core), handing the indices out
+ * one at a time. f must not throw.
+ */
+
+void Parallel::forEach(std::size_t n,unsigned threads,const std::function<void(std::size_t)> &f) {
+	std::atomic<std::size_t> next(0);
+	
+	auto worker=[&]() {
+		for(;;) {
+			auto i=next++;
+			if(i>=n) break;
+			f(i);
+		}
+	};
+	
+	if(threads==0) threads=std::max(1u,std::thread::hardware_concurrency());
+	threads=static_cast<unsigned>(std::min<std::size_t>(threads,n));
+	
+	std::vector<std::thread> pool;
+	for(unsigned i=1;i<threads;i++) pool.emplace_back(worker);
+	worker(); // the calling thread participates too
+	for(auto &t: pool) t.join();
+}
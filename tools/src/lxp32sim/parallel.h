@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module declares the members of the Parallel namespace.
+ */
+
+#ifndef PARALLEL_H_INCLUDED
+#define PARALLEL_H_INCLUDED
+
+#include <functional>
+#include <cstddef>
+
+namespace Parallel {
+	void forEach(std::size_t n,unsigned threads,const std::function<void(std::size_t)> &f);
+}
+
+#endif
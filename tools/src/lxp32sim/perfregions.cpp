@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the PerfRegions class.
+ */
+
+#include "perfregions.h"
+
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+
+/*
+ * Reads region markers from a map file produced by the linker
+ * (see Linker::generateMap()), other symbols are ignored
+ */
+
+void PerfRegions::load(std::istream &map) {
+	std::string line;
+	
+	while(std::getline(map,line)) {
+// name XXXXXXXX Local|Exported
+		std::istringstream ss(line);
+		std::string name,addr,type;
+		if(!(ss>>name>>addr>>type)) continue;
+		if(type!="Local"&&type!="Exported") continue;
+		if(!isMarker(name)) continue;
+		
+		Word a;
+		try {
+			a=static_cast<Word>(std::stoul(addr,nullptr,16));
+		}
+		catch(std::exception &) {
+			throw std::runtime_error("Bad map file line: \""+line+"\"");
+		}
+		
+		auto dot=name.find('.');
+		auto kind=name.substr(0,dot);
+		auto rest=name.substr(dot+1);
+		
+		if(kind=="perf_begin") {
+			auto &r=region(rest);
+			if(r.hasBegin) throw std::runtime_error("Region \""+rest+"\" is defined more than once");
+			r.begin=a;
+			r.hasBegin=true;
+		}
+		else {
+			dot=rest.find('.');
+			auto &r=region(rest.substr(0,dot));
+			if(r.hasEnd) throw std::runtime_error("Region \""+r.name+"\" is defined more than once");
+			if(dot!=std::string::npos) {
+				try {
+					r.budget=std::stoull(rest.substr(dot+1));
+				}
+				catch(std::exception &) {
+					throw std::runtime_error("Bad cycle budget in \""+name+"\"");
+				}
+			}
+			r.end=a;
+			r.hasEnd=true;
+		}
+	}
+	
+	_marked.clear();
+	for(auto const &r: _regions) {
+		if(!r.hasBegin||!r.hasEnd) throw std::runtime_error("Region \""+r.name+"\" is incomplete");
+		auto i=std::max(r.begin,r.end)>>2;
+		if(i>=_marked.size()) _marked.resize(i+1,false);
+		_marked[r.begin>>2]=true;
+		_marked[r.end>>2]=true;
+	}
+}
+
+bool PerfRegions::empty() const {
+	return _regions.empty();
+}
+
+const std::vector<PerfRegions::Region> &PerfRegions::regions() const {
+	return _regions;
+}
+
+bool PerfRegions::withinBudget() const {
+	for(auto const &r: _regions) {
+		if(r.budget>0&&r.maxCycles>r.budget) return false;
+	}
+	return true;
+}
+
+void PerfRegions::report(std::ostream &os) const {
+	for(auto const &r: _regions) {
+		os<<"Region \""<<r.name<<"\": ";
+		if(r.runs==0) os<<"not completed";
+		else {
+			os<<r.runs<<" run(s), min "<<r.minCycles<<", max "<<r.maxCycles;
+			os<<", mean "<<r.totalCycles/r.runs<<" cycles";
+		}
+		if(r.budget>0) {
+			os<<", budget "<<r.budget;
+			if(r.maxCycles>r.budget) os<<" (EXCEEDED)";
+		}
+		os<<std::endl;
+	}
+}
+
+bool PerfRegions::isMarker(const std::string &symbol) {
+	return symbol.compare(0,11,"perf_begin.")==0||symbol.compare(0,9,"perf_end.")==0;
+}
+
+/*
+ * Private members
+ */
+
+// Ends are processed first, so that one region can start where another ends
+
+void PerfRegions::mark(Word pc,Counter cycle) {
+	for(auto &r: _regions) {
+		if(r.end!=pc||!r.open) continue;
+		auto cycles=cycle-r.start;
+		if(r.runs==0||cycles<r.minCycles) r.minCycles=cycles;
+		if(cycles>r.maxCycles) r.maxCycles=cycles;
+		r.totalCycles+=cycles;
+		r.runs++;
+		r.open=false;
+		_events++;
+	}
+	for(auto &r: _regions) {
+		if(r.begin!=pc||r.open) continue;
+		r.start=cycle;
+		r.open=true;
+		_events++;
+	}
+}
+
+PerfRegions::Region &PerfRegions::region(const std::string &name) {
+	for(auto &r: _regions) {
+		if(r.name==name) return r;
+	}
+	_regions.emplace_back();
+	_regions.back().name=name;
+	return _regions.back();
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the PerfRegions class which measures the
+ * duration of firmware regions delimited by the #perf_begin and
+ * #perf_end assembler directives and checks it against their
+ * cycle budgets.
+ *
+ * The directives define symbols named "perf_begin.<name>" and
+ * "perf_end.<name>[.<budget>]" at the next instruction, which are
+ * read from the linker map. A run of a region lasts from the start
+ * of the instruction at its beginning to the start of the instruction
+ * at its end, including interrupt handlers executed in between.
+ * Reaching the beginning again before the end has no effect, so a
+ * region can begin at the head of a loop.
+ */
+
+#ifndef PERFREGIONS_H_INCLUDED
+#define PERFREGIONS_H_INCLUDED
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstdint>
+
+class PerfRegions {
+public:
+	typedef std::uint32_t Word;
+	typedef std::uint64_t Counter;
+	
+	struct Region {
+		std::string name;
+		Word begin=0;
+		Word end=0;
+		bool hasBegin=false;
+		bool hasEnd=false;
+		Counter budget=0; // 0: no budget
+		Counter runs=0;
+		Counter minCycles=0;
+		Counter maxCycles=0;
+		Counter totalCycles=0;
+		bool open=false;
+		Counter start=0;
+	};
+
+private:
+	std::vector<Region> _regions;
+	std::vector<bool> _marked; // addresses with markers, indexed by word
+	Counter _events=0; // region starts and ends so far
+
+public:
+	void load(std::istream &map);
+	
+	bool empty() const;
+	const std::vector<Region> &regions() const;
+	
+// Called at the start of each instruction
+	void instruction(Word pc,Counter cycle) {
+		auto i=pc>>2;
+		if(i<_marked.size()&&_marked[i]) mark(pc,cycle);
+	}
+	
+// Polling loops whose iterations start or end a region can't be skipped
+	Counter events() const {return _events;}
+	
+	bool withinBudget() const;
+	void report(std::ostream &os) const;
+	
+	static bool isMarker(const std::string &symbol);
+
+private:
+	void mark(Word pc,Counter cycle);
+	Region &region(const std::string &name);
+};
+
+#endif
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Slave class
+ * and its derived classes.
+ */
+
+#include "peripherals.h"
+#include "utils.h"
+
+#include <stdexcept>
+
+/*
+ * Slave members
+ */
+
+Slave::Word Slave::merge(Word oldValue,Word sel,Word data) {
+	Word mask=0;
+	for(int i=0;i<4;i++) {
+		if(sel&(1<<i)) mask|=Word(0xFF)<<(i*8);
+	}
+	return (oldValue&~mask)|(data&mask);
+}
+
+void Slave::advance(Counter n) {
+	while(n>0) {
+		auto quiet=quietCycles();
+		if(quiet>=n) {
+			skip(n);
+			return;
+		}
+		if(quiet>0) skip(quiet);
+		clock();
+		n-=quiet+1;
+	}
+}
+
+/*
+ * ProgramRam members
+ */
+
+ProgramRam::ProgramRam(): _data(Size/4) {}
+
+void ProgramRam::load(const std::vector<Word> &image) {
+	if(image.size()>_data.size()) throw std::runtime_error("Program size is too large");
+	for(std::size_t i=0;i<image.size();i++) _data.write(i,image[i]);
+}
+
+ProgramRam::Word ProgramRam::fetch(Word addr) const {
+	if(addr>=Size) throw std::runtime_error("Attempted to fetch instruction "
+		"from a non-existent address 0x"+Utils::hex(addr));
+	return _data.read(addr/4);
+}
+
+const Memory &ProgramRam::memory() const {
+	return _data;
+}
+
+unsigned ProgramRam::read(Word addr,Word,Word &data) {
+	data=_data.read((addr/4)%_data.size());
+	return 1;
+}
+
+unsigned ProgramRam::write(Word addr,Word sel,Word data) {
+	if(addr<Size) _data.write(addr/4,merge(_data.read(addr/4),sel,data));
+	return 0;
+}
+
+void ProgramRam::saveState(StateWriter &w) const {
+	_data.saveState(w);
+}
+
+void ProgramRam::loadState(StateReader &r) {
+	_data.loadState(r);
+}
+
+/*
+ * Monitor members
+ */
+
+void Monitor::setLog(std::ostream *os) {
+	_log=os;
+}
+
+bool Monitor::finished() const {
+	return _finished;
+}
+
+Monitor::Word Monitor::result() const {
+	return _result;
+}
+
+unsigned Monitor::read(Word,Word,Word &data) {
+	data=0;
+	return 0;
+}
+
+unsigned Monitor::write(Word addr,Word sel,Word data) {
+	if(sel!=0xF) throw std::runtime_error("Monitor doesn't support "
+		"byte-granular access (SEL_I() is 0x"+Utils::hex(static_cast<std::uint8_t>(sel))+")");
+	if(_log) *_log<<"Monitor: value 0x"<<Utils::hex(data)<<
+		" written to address 0x"<<Utils::hex(addr>>2)<<std::endl;
+	if(addr==0) {
+		_result=data;
+		_finished=true;
+	}
+	return 0;
+}
+
+void Monitor::saveState(StateWriter &w) const {
+	w.flag(_finished);
+	w.word(_result);
+}
+
+void Monitor::loadState(StateReader &r) {
+	_finished=r.flag();
+	_result=r.word();
+}
+
+/*
+ * Timer members
+ */
+
+unsigned Timer::read(Word addr,Word,Word &data) {
+	if(addr==0) data=_pulses;
+	else if(addr==4) data=_interval;
+	else data=0;
+	return 0;
+}
+
+unsigned Timer::write(Word addr,Word sel,Word data) {
+	if(addr==0) {
+		_pulses=merge(_pulses,sel,data);
+		_cnt=0;
+	}
+	else if(addr==4) {
+		_interval=merge(_interval,sel,data);
+		_cnt=0;
+	}
+	else if(addr==8&&(sel&1)) {
+		_levelTriggered=(data&1)!=0;
+		_invert=(data&2)!=0;
+	}
+	else if(addr==12&&(sel&1)&&(data&1)) {
+		_elapsed=false;
+	}
+	return 0;
+}
+
+void Timer::clock() {
+	if(!_levelTriggered) _elapsed=false;
+	if(_pulses!=0||_cnt!=0) {
+		if(_cnt==1) _elapsed=true;
+		if(_cnt==0) {
+			if(_pulses!=0) _cnt=_interval;
+			if(_pulses!=0xFFFFFFFF) _pulses--;
+		}
+		else _cnt--;
+	}
+}
+
+bool Timer::irq() const {
+	return _elapsed!=_invert;
+}
+
+/*
+ * The next event is either the cycle when the counter reaches 1
+ * (the interrupt is raised), or a reload which changes the visible
+ * number of remaining pulses
+ */
+
+Timer::Counter Timer::quietCycles() const {
+	if(_elapsed&&!_levelTriggered) return 0; // cleared on the next cycle
+	if(_cnt>0) return _cnt-1;
+	if(_pulses==0) return Never;
+	if(_pulses!=0xFFFFFFFF) return 0;
+	if(_interval==0) return Never;
+	return _interval;
+}
+
+void Timer::skip(Counter n) {
+	if(n==0||(_cnt==0&&(_pulses==0||_interval==0))) return;
+	if(_cnt==0) { // reload without decrementing the infinite pulse count
+		_cnt=_interval;
+		n--;
+	}
+	_cnt-=static_cast<Word>(n);
+}
+
+void Timer::saveState(StateWriter &w) const {
+	w.flag(_levelTriggered);
+	w.flag(_invert);
+	w.word(_pulses);
+	w.word(_interval);
+	w.word(_cnt);
+	w.flag(_elapsed);
+}
+
+void Timer::loadState(StateReader &r) {
+	_levelTriggered=r.flag();
+	_invert=r.flag();
+	_pulses=r.word();
+	_interval=r.word();
+	_cnt=r.word();
+	_elapsed=r.flag();
+}
+
+/*
+ * Coprocessor members
+ */
+
+unsigned Coprocessor::read(Word addr,Word,Word &data) {
+	if(addr==0) data=_value;
+	else if(addr==4) data=_result;
+	else data=0;
+	return 0;
+}
+
+unsigned Coprocessor::write(Word addr,Word sel,Word data) {
+	if(addr==0) {
+		_value=merge(_value,sel,data);
+		_cnt=50;
+	}
+	return 0;
+}
+
+void Coprocessor::clock() {
+	_irq=(_cnt==1);
+	if(_cnt>0) _cnt--;
+	_result=(_value<<1)+_value;
+}
+
+bool Coprocessor::irq() const {
+	return _irq;
+}
+
+Coprocessor::Counter Coprocessor::quietCycles() const {
+	if(_irq||_result!=(_value<<1)+_value) return 0;
+	if(_cnt==0) return Never;
+	return static_cast<Counter>(_cnt-1);
+}
+
+void Coprocessor::skip(Counter n) {
+	if(_cnt>0) _cnt-=static_cast<int>(n);
+}
+
+void Coprocessor::saveState(StateWriter &w) const {
+	w.word(_value);
+	w.word(_result);
+	w.word(static_cast<Word>(_cnt));
+	w.flag(_irq);
+}
+
+void Coprocessor::loadState(StateReader &r) {
+	_value=r.word();
+	_result=r.word();
+	_cnt=static_cast<int>(r.word());
+	_irq=r.flag();
+}
+
+/*
+ * Scrambler members
+ */
+
+Scrambler::Scrambler(int tap1,int tap2):
+	_tap1(tap1),
+	_tap2(tap2),
+	_reg((Slave::Word(1)<<tap2)-1),
+	_period(0)
+{
+	Scrambler s=*this;
+	do {
+		s.clock();
+		_period++;
+	} while(s._reg!=_reg);
+}
+
+void Scrambler::clock() {
+	auto feedback=((_reg>>(_tap2-1))^(_reg>>(_tap1-1)))&1;
+	_reg=((_reg<<1)|feedback)&((Slave::Word(1)<<_tap2)-1);
+}
+
+void Scrambler::skip(Slave::Counter n) {
+	for(n%=_period;n>0;n--) clock();
+}
+
+bool Scrambler::output() const {
+	return (_reg&1)!=0;
+}
+
+unsigned Scrambler::leadingOnes() const {
+	Scrambler s=*this;
+	unsigned n=0;
+	while(s.output()) {
+		s.clock();
+		n++;
+	}
+	return n;
+}
+
+void Scrambler::saveState(StateWriter &w) const {
+	w.word(_reg);
+}
+
+void Scrambler::loadState(StateReader &r) {
+	_reg=r.word();
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Slave abstract class and its derived
+ * classes. These classes model the peripherals of the LXP32 test
+ * platform (see verify/lxp32/src/platform).
+ */
+
+#ifndef PERIPHERALS_H_INCLUDED
+#define PERIPHERALS_H_INCLUDED
+
+#include "memory.h"
+#include "state.h"
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+
+/*
+ * An abstract base class for all data bus slaves. "addr" is
+ * a byte address relative to the slave base. Access functions
+ * return the number of wait states.
+ *
+ * quietCycles() returns the number of subsequent clock cycles
+ * during which neither irq() nor the values returned by read()
+ * can change (Never if the slave is idle), skip() advances the
+ * slave by at most that many cycles at once. advance() uses both
+ * to run the slave for an arbitrary number of cycles.
+ */
+
+class Slave {
+public:
+	typedef std::uint32_t Word;
+	typedef std::uint64_t Counter;
+	
+	static const Counter Never=~Counter(0);
+	
+	virtual ~Slave() {}
+	virtual unsigned read(Word addr,Word sel,Word &data)=0;
+	virtual unsigned write(Word addr,Word sel,Word data)=0;
+	virtual void clock() {}
+	virtual bool irq() const {return false;}
+	virtual Counter quietCycles() const {return Never;}
+	virtual void skip(Counter) {}
+	virtual void saveState(StateWriter &w) const=0;
+	virtual void loadState(StateReader &r)=0;
+	
+	void advance(Counter n);
+	
+// Apply a write with the byte enable mask "sel" to a word
+	static Word merge(Word oldValue,Word sel,Word data);
+};
+
+/*
+ * Program RAM (program_ram.vhd): 64 KiB, registered read acknowledge
+ */
+
+class ProgramRam : public Slave {
+	Memory _data;
+public:
+	static const Word Size=65536;
+	
+	ProgramRam();
+	void load(const std::vector<Word> &image);
+	Word fetch(Word addr) const;
+	const Memory &memory() const;
+	
+	virtual unsigned read(Word addr,Word sel,Word &data) override;
+	virtual unsigned write(Word addr,Word sel,Word data) override;
+	virtual void saveState(StateWriter &w) const override;
+	virtual void loadState(StateReader &r) override;
+};
+
+/*
+ * Test monitor (tb/monitor.vhd): a write to the base address
+ * stores the test result and terminates the simulation
+ */
+
+class Monitor : public Slave {
+	bool _finished=false;
+	Word _result=0;
+	std::ostream *_log=nullptr;
+public:
+	void setLog(std::ostream *os);
+	bool finished() const;
+	Word result() const;
+	
+	virtual unsigned read(Word addr,Word sel,Word &data) override;
+	virtual unsigned write(Word addr,Word sel,Word data) override;
+	virtual void saveState(StateWriter &w) const override;
+	virtual void loadState(StateReader &r) override;
+};
+
+/*
+ * Timer (timer.vhd)
+ */
+
+class Timer : public Slave {
+	bool _levelTriggered=false;
+	bool _invert=false;
+	Word _pulses=0;
+	Word _interval=0;
+	Word _cnt=0;
+	bool _elapsed=false;
+public:
+	virtual unsigned read(Word addr,Word sel,Word &data) override;
+	virtual unsigned write(Word addr,Word sel,Word data) override;
+	virtual void clock() override;
+	virtual bool irq() const override;
+	virtual Counter quietCycles() const override;
+	virtual void skip(Counter n) override;
+	virtual void saveState(StateWriter &w) const override;
+	virtual void loadState(StateReader &r) override;
+};
+
+/*
+ * Coprocessor (coprocessor.vhd): multiplies a value by 3
+ * and raises an interrupt 50 cycles after the value is written
+ */
+
+class Coprocessor : public Slave {
+	Word _value=0;
+	Word _result=0;
+	int _cnt=0;
+	bool _irq=false;
+public:
+	virtual unsigned read(Word addr,Word sel,Word &data) override;
+	virtual unsigned write(Word addr,Word sel,Word data) override;
+	virtual void clock() override;
+	virtual bool irq() const override;
+	virtual Counter quietCycles() const override;
+	virtual void skip(Counter n) override;
+	virtual void saveState(StateWriter &w) const override;
+	virtual void loadState(StateReader &r) override;
+};
+
+/*
+ * Pseudo-random bit sequence generator used for bus
+ * throttling (scrambler.vhd)
+ */
+
+class Scrambler {
+	int _tap1;
+	int _tap2;
+	Slave::Word _reg;
+	Slave::Counter _period;
+public:
+	Scrambler(int tap1,int tap2);
+	void clock();
+	void skip(Slave::Counter n);
+	bool output() const;
+	unsigned leadingOnes() const;
+	void saveState(StateWriter &w) const;
+	void loadState(StateReader &r);
+};
+
+#endif
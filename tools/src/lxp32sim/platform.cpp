@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Platform class.
+ */
+
+#include "platform.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+/*
+ * The data bus as seen by the DMA engine: the slaves are accessed
+ * without throttling, and the engine can't access its own registers
+ */
+
+class Platform::DmaPort : public Dma::Master {
+	Platform &_platform;
+public:
+	DmaPort(Platform &platform): _platform(platform) {}
+	
+	virtual unsigned read(Word addr,Word &data) override {
+		auto &p=_platform;
+		auto slave=p.decode(addr);
+		if(!slave&&!p._mappings.empty()) {
+			auto m=p.decodePlugin(addr);
+			if(m) {
+				p.sync();
+				auto waitStates=m->plugin->read(m->region,addr-m->base,0xF,data);
+				p.schedule();
+				return waitStates;
+			}
+		}
+		if(!slave||slave==&p._dma) {
+			data=0;
+			return 0;
+		}
+		if(slave!=&p._ram&&slave!=&p._monitor) p.sync();
+		return slave->read(addr&0x0FFFFFFF,0xF,data);
+	}
+	
+	virtual unsigned write(Word addr,Word data) override {
+		auto &p=_platform;
+		auto slave=p.decode(addr);
+		if(!slave&&!p._mappings.empty()) {
+			auto m=p.decodePlugin(addr);
+			if(m) {
+				p.sync();
+				auto waitStates=m->plugin->write(m->region,addr-m->base,0xF,data,p._pending);
+				p.schedule();
+				return waitStates;
+			}
+		}
+		if(!slave||slave==&p._dma) return 0;
+		bool clocked=(slave!=&p._ram&&slave!=&p._monitor);
+		if(clocked) p.sync();
+		auto waitStates=slave->write(addr&0x0FFFFFFF,0xF,data);
+		if(clocked) p.schedule();
+		return waitStates;
+	}
+};
+
+Platform::Platform():
+	_intercon(2),
+	_ibusThrottle(9,11),
+	_dbusThrottle(6,7),
+	_requests(2,Counter(Intercon::Never))
+{
+	schedule();
+}
+
+void Platform::setThrottleIbus(bool b) {
+	sync();
+	_throttleIbus=b;
+}
+
+void Platform::setThrottleDbus(bool b) {
+	sync();
+	_throttleDbus=b;
+}
+
+void Platform::setSemihosting(bool b) {
+	_semihosting=b;
+}
+
+void Platform::setDma(bool b) {
+	_dmaEnabled=b;
+}
+
+void Platform::loadImage(const std::vector<Word> &image) {
+	_ram.load(image);
+}
+
+/*
+ * Plugin regions can't overlap with each other, with the test
+ * platform slaves (0x00000000-0x4FFFFFFF) or with the semihosting
+ * slave and the DMA engine if they are enabled
+ */
+
+void Platform::attach(const std::shared_ptr<Plugin> &plugin) {
+	std::vector<Mapping> mappings=_mappings;
+	
+	for(std::size_t i=0;i<plugin->regions();i++) {
+		auto base=plugin->base(i);
+		auto size=plugin->size(i);
+		std::string region="Plugin \""+plugin->name()+"\", region at 0x"+Utils::hex(base);
+		if(size==0||base%4!=0||size%4!=0) throw std::runtime_error(region+": invalid base address or size");
+		if(base<0x50000000||size-1>0xFFFFFFFF-base) throw std::runtime_error(region+": out of the available address range");
+		Mapping m {base,base+(size-1),plugin.get(),i};
+		if(_semihosting&&m.base<=SemihostBase+0x0FFFFFFF&&SemihostBase<=m.last)
+			throw std::runtime_error(region+": overlaps with the semihosting slave");
+		if(_dmaEnabled&&m.base<=DmaBase+0x0FFFFFFF&&DmaBase<=m.last)
+			throw std::runtime_error(region+": overlaps with the DMA engine");
+		for(auto const &other: mappings) {
+			if(m.base<=other.last&&other.base<=m.last)
+				throw std::runtime_error(region+": overlaps with \""+other.plugin->name()+"\"");
+		}
+		mappings.push_back(m);
+	}
+	
+	std::sort(mappings.begin(),mappings.end(),[](const Mapping &a,const Mapping &b){return a.base<b.base;});
+	
+	sync();
+	_plugins.push_back(plugin);
+	_mappings=std::move(mappings);
+	schedule();
+}
+
+Monitor &Platform::monitor() {
+	return _monitor;
+}
+
+const Monitor &Platform::monitor() const {
+	return _monitor;
+}
+
+Semihost &Platform::semihost() {
+	return _semihost;
+}
+
+const Semihost &Platform::semihost() const {
+	return _semihost;
+}
+
+const Dma &Platform::dma() const {
+	return _dma;
+}
+
+Intercon &Platform::intercon() {
+	return _intercon;
+}
+
+const Intercon &Platform::intercon() const {
+	return _intercon;
+}
+
+const ProgramRam &Platform::ram() const {
+	return _ram;
+}
+
+void Platform::saveState(StateWriter &w) const {
+	_ram.saveState(w);
+	_monitor.saveState(w);
+	_timer.saveState(w);
+	_coprocessor.saveState(w);
+	_timer2.saveState(w);
+	_ibusThrottle.saveState(w);
+	_dbusThrottle.saveState(w);
+	w.counter(_pending);
+}
+
+void Platform::loadState(StateReader &r) {
+	_ram.loadState(r);
+	_monitor.loadState(r);
+	_timer.loadState(r);
+	_coprocessor.loadState(r);
+	_timer2.loadState(r);
+	_ibusThrottle.loadState(r);
+	_dbusThrottle.loadState(r);
+	_pending=r.counter();
+	schedule();
+}
+
+/*
+ * Debugger accesses reach the program RAM and plugin memory regions
+ * only: they take no time and have no side effects. Return false
+ * for peripheral registers and unmapped addresses.
+ */
+
+bool Platform::peek(Word addr,Word &data) {
+	if(addr<ProgramRam::Size) {
+		data=_ram.memory().read(addr/4);
+		return true;
+	}
+	if(decode(addr)) return false;
+	auto m=decodePlugin(addr);
+	if(!m) return false;
+	return m->plugin->peek(m->region,addr-m->base,data);
+}
+
+bool Platform::poke(Word addr,Word sel,Word data) {
+	if(addr<ProgramRam::Size) {
+		_ram.write(addr,sel,data);
+		return true;
+	}
+	if(decode(addr)) return false;
+	auto m=decodePlugin(addr);
+	if(!m) return false;
+	return m->plugin->poke(m->region,addr-m->base,sel,data);
+}
+
+unsigned Platform::fetch(Word addr,Word &data) {
+	data=_ram.fetch(addr);
+	if(_throttleIbus) {
+		sync();
+		return _ibusThrottle.leadingOnes();
+	}
+	return 0;
+}
+
+/*
+ * With the DMA engine, the CPU data bus cycles are arbitrated. The
+ * bus cycles of an instruction (two with a read-modify-write cycle)
+ * are issued back to back in the cycle the instruction starts.
+ */
+
+unsigned Platform::read(Word addr,Word sel,Word &data) {
+	if(!_dmaEnabled) return readSlave(addr,sel,data);
+	auto request=_now+_dbusOffset;
+	auto start=grantCpu(request);
+	return releaseCpu(request,start,readSlave(addr,sel,data));
+}
+
+unsigned Platform::write(Word addr,Word sel,Word data) {
+	if(!_dmaEnabled) return writeSlave(addr,sel,data);
+	auto request=_now+_dbusOffset;
+	auto start=grantCpu(request);
+	auto waitStates=releaseCpu(request,start,writeSlave(addr,sel,data));
+	_dma.wake(_now+_dbusOffset); // a started engine requests the bus when the cycle ends
+	return waitStates;
+}
+
+std::uint8_t Platform::clock() {
+	if(++_pending>_nextEvent) sync();
+	if(_dmaEnabled) {
+		_now++;
+		_dbusOffset=0;
+		if(_dma.request()<_now) runDma(_now);
+	}
+	return _irq;
+}
+
+Platform::Counter Platform::quietCycles(Counter limit,bool accesses) {
+	if(accesses&&(_throttleIbus||_throttleDbus)) return 0;
+	if(_dmaEnabled&&_dma.busy()) return 0;
+	return std::min(limit,_nextEvent-_pending);
+}
+
+void Platform::skip(Counter n) {
+	_pending+=n;
+	_now+=n;
+}
+
+/*
+ * Private members
+ */
+
+/*
+ * The program RAM and the test monitor are not clocked, so there
+ * is no need to bring the peripherals up to date to access them
+ */
+
+unsigned Platform::readSlave(Word addr,Word sel,Word &data) {
+	unsigned waitStates=0;
+	auto slave=decode(addr);
+	if(!slave&&!_mappings.empty()) {
+		auto m=decodePlugin(addr);
+		if(m) return readPlugin(*m,addr,sel,data);
+	}
+	if(_throttleDbus||(slave!=&_ram&&slave!=&_monitor)) sync();
+	if(_throttleDbus) waitStates=_dbusThrottle.leadingOnes();
+	if(slave) waitStates+=slave->read(addr&0x0FFFFFFF,sel,data);
+	else data=0;
+	return waitStates;
+}
+
+unsigned Platform::writeSlave(Word addr,Word sel,Word data) {
+	unsigned waitStates=0;
+	auto slave=decode(addr);
+	if(!slave&&!_mappings.empty()) {
+		auto m=decodePlugin(addr);
+		if(m) return writePlugin(*m,addr,sel,data);
+	}
+	bool clocked=(slave&&slave!=&_ram&&slave!=&_monitor);
+	if(_throttleDbus||clocked) sync();
+	if(_throttleDbus) waitStates=_dbusThrottle.leadingOnes();
+	if(slave) waitStates+=slave->write(addr&0x0FFFFFFF,sel,data);
+	if(clocked) schedule();
+	return waitStates;
+}
+
+/*
+ * The DMA engine wins the arbitration as long as its requests are
+ * not later than the CPU request (or the bus becoming free)
+ */
+
+Platform::Counter Platform::grantCpu(Counter request) {
+	Counter decision=0;
+	_requests[CpuMaster]=request;
+	for(;;) {
+		_requests[DmaMaster]=_dma.request();
+		if(_intercon.arbitrate(_requests,decision)!=DmaMaster) break;
+		dmaCycle(decision);
+	}
+	return _intercon.begin(CpuMaster,request,decision);
+}
+
+unsigned Platform::releaseCpu(Counter request,Counter start,unsigned waitStates) {
+	waitStates=_intercon.end(CpuMaster,request,start,waitStates);
+	_dbusOffset+=waitStates+1;
+	return waitStates;
+}
+
+// Runs the DMA bus cycles decided before the "until" cycle
+
+void Platform::runDma(Counter until) {
+	Counter decision=0;
+	_requests[CpuMaster]=Intercon::Never;
+	for(;;) {
+		_requests[DmaMaster]=_dma.request();
+		if(_intercon.arbitrate(_requests,decision)!=DmaMaster||decision>=until) break;
+		dmaCycle(decision);
+	}
+}
+
+void Platform::dmaCycle(Counter decision) {
+	auto request=_dma.request();
+	auto start=_intercon.begin(DmaMaster,request,decision);
+	DmaPort port(*this);
+	auto cycles=_dma.cycle(port,start,_intercon.registeredFeedback());
+	_intercon.end(DmaMaster,request,start,cycles-1);
+	schedule();
+}
+
+Slave *Platform::decode(Word addr) {
+	switch(addr>>28) {
+	case 0:
+		return &_ram;
+	case 1:
+		return &_monitor;
+	case 2:
+		return &_timer;
+	case 3:
+		return &_coprocessor;
+	case 4:
+		return &_timer2;
+	case 6:
+		if(_semihosting) return &_semihost;
+		return nullptr;
+	case 7:
+		if(_dmaEnabled) return &_dma;
+		return nullptr;
+	default:
+		return nullptr; // unmapped addresses are acknowledged and read as zero
+	}
+}
+
+const Platform::Mapping *Platform::decodePlugin(Word addr) const {
+	auto it=std::upper_bound(_mappings.begin(),_mappings.end(),addr,
+		[](Word a,const Mapping &m){return a<m.base;});
+	if(it==_mappings.begin()) return nullptr;
+	--it;
+	if(addr>it->last) return nullptr;
+	return &*it;
+}
+
+/*
+ * RAM-like regions and posted writes don't depend on the device
+ * time, so the device doesn't have to be brought up to date
+ */
+
+unsigned Platform::readPlugin(const Mapping &m,Word addr,Word sel,Word &data) {
+	unsigned waitStates=0;
+	bool clocked=m.plugin->clocked(m.region,false);
+	if(_throttleDbus||clocked) sync();
+	if(_throttleDbus) waitStates=_dbusThrottle.leadingOnes();
+	waitStates+=m.plugin->read(m.region,addr-m.base,sel,data);
+	if(clocked) schedule(); // reads can have side effects
+	return waitStates;
+}
+
+unsigned Platform::writePlugin(const Mapping &m,Word addr,Word sel,Word data) {
+	unsigned waitStates=0;
+	bool clocked=m.plugin->clocked(m.region,true);
+	if(_throttleDbus||clocked) sync();
+	if(_throttleDbus) waitStates=_dbusThrottle.leadingOnes();
+	waitStates+=m.plugin->write(m.region,addr-m.base,sel,data,_pending);
+	if(clocked) schedule();
+	return waitStates;
+}
+
+void Platform::sync() {
+	if(_pending==0) return;
+	_timer.advance(_pending);
+	_coprocessor.advance(_pending);
+	_timer2.advance(_pending);
+	_semihost.advance(_pending);
+	for(auto const &plugin: _plugins) plugin->advance(_pending);
+	if(_throttleIbus) _ibusThrottle.skip(_pending);
+	if(_throttleDbus) _dbusThrottle.skip(_pending);
+	_pending=0;
+	schedule();
+}
+
+/*
+ * Find the earliest peripheral event and update the interrupt
+ * request lines. Same wiring as in platform.vhd:
+ * "0000"&timer2&coprocessor&timer&timer (the DMA engine, which is
+ * not part of platform.vhd, uses the next line)
+ */
+
+void Platform::schedule() {
+	_nextEvent=std::min(_timer.quietCycles(),std::min(_coprocessor.quietCycles(),_timer2.quietCycles()));
+	
+	_irq=0;
+	if(_timer.irq()) _irq|=0x03;
+	if(_coprocessor.irq()) _irq|=0x04;
+	if(_timer2.irq()) _irq|=0x08;
+	if(_dmaEnabled&&_dma.irq()) _irq|=DmaIrq;
+	
+	for(auto const &plugin: _plugins) {
+		_nextEvent=std::min(_nextEvent,plugin->quietCycles());
+		_irq|=plugin->irq();
+	}
+}
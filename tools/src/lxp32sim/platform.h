@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Platform class which models the LXP32
+ * test platform: the interconnect, the peripherals, the interrupt
+ * wiring and the optional pseudo-random bus throttling.
+ *
+ * Peripherals are scheduled by events: instead of being clocked
+ * every cycle, they are only advanced when the next peripheral
+ * event (e.g. a timer interrupt) is due or when they are accessed.
+ *
+ * Devices loaded from plugins (see Plugin) are decoded at the
+ * addresses not used by the test platform and scheduled the same way.
+ * The semihosting slave (see Semihost) is only decoded if enabled.
+ *
+ * The DMA engine (see Dma), if enabled, is decoded at 0x70000000 and
+ * shares the data bus with the CPU through a wigen interconnect model
+ * (see Intercon). The DMA engine is connected to the higher priority
+ * port, like the external master port of platform.vhd. Bus cycles are
+ * arbitrated when they are issued, so the CPU data bus wait states
+ * include the cycles spent waiting for the DMA engine. The instruction
+ * bus is not shared. Slaves see the DMA accesses without throttling,
+ * and peripherals see them at the time of the CPU cycle being
+ * simulated, which can be off by the length of a DMA burst.
+ */
+
+#ifndef PLATFORM_H_INCLUDED
+#define PLATFORM_H_INCLUDED
+
+#include "bus.h"
+#include "dma.h"
+#include "intercon.h"
+#include "peripherals.h"
+#include "plugin.h"
+#include "semihost.h"
+
+#include <vector>
+#include <memory>
+
+class Platform : public Bus {
+public:
+	static const Word SemihostBase=0x60000000;
+	static const Word DmaBase=0x70000000;
+	static const std::uint8_t DmaIrq=0x10;
+	static const int DmaMaster=0;
+	static const int CpuMaster=1;
+
+private:
+	ProgramRam _ram;
+	Monitor _monitor;
+	Timer _timer;
+	Coprocessor _coprocessor;
+	Timer _timer2;
+	Semihost _semihost;
+	bool _semihosting=false;
+	
+	Dma _dma;
+	bool _dmaEnabled=false;
+	Intercon _intercon;
+	
+	Scrambler _ibusThrottle;
+	Scrambler _dbusThrottle;
+	bool _throttleIbus=false;
+	bool _throttleDbus=false;
+	
+// Plugin regions, sorted by address
+	struct Mapping {
+		Word base;
+		Word last;
+		Plugin *plugin;
+		std::size_t region;
+	};
+	
+	std::vector<std::shared_ptr<Plugin> > _plugins;
+	std::vector<Mapping> _mappings;
+	
+// Cycles not yet applied to the peripherals, cycles until the next event
+	Counter _pending=0;
+	Counter _nextEvent=0;
+	std::uint8_t _irq=0;
+	
+// Current cycle and the data bus cycles of the current CPU cycle (for arbitration)
+	Counter _now=0;
+	Counter _dbusOffset=0;
+	std::vector<Counter> _requests;
+
+public:
+	Platform();
+	
+	void setThrottleIbus(bool b);
+	void setThrottleDbus(bool b);
+	void setSemihosting(bool b);
+	void setDma(bool b);
+	
+	void loadImage(const std::vector<Word> &image);
+	void attach(const std::shared_ptr<Plugin> &plugin);
+	
+	Monitor &monitor();
+	const Monitor &monitor() const;
+	Semihost &semihost();
+	const Semihost &semihost() const;
+	const Dma &dma() const;
+	Intercon &intercon();
+	const Intercon &intercon() const;
+	const ProgramRam &ram() const;
+	
+	void saveState(StateWriter &w) const;
+	void loadState(StateReader &r);
+	
+	bool peek(Word addr,Word &data);
+	bool poke(Word addr,Word sel,Word data);
+	
+	virtual unsigned fetch(Word addr,Word &data) override;
+	virtual unsigned read(Word addr,Word sel,Word &data) override;
+	virtual unsigned write(Word addr,Word sel,Word data) override;
+	virtual std::uint8_t clock() override;
+	virtual Counter quietCycles(Counter limit,bool accesses) override;
+	virtual void skip(Counter n) override;
+
+private:
+	class DmaPort;
+	
+	unsigned readSlave(Word addr,Word sel,Word &data);
+	unsigned writeSlave(Word addr,Word sel,Word data);
+	Counter grantCpu(Counter request);
+	unsigned releaseCpu(Counter request,Counter start,unsigned waitStates);
+	void runDma(Counter until);
+	void dmaCycle(Counter decision);
+	Slave *decode(Word addr);
+	const Mapping *decodePlugin(Word addr) const;
+	unsigned readPlugin(const Mapping &m,Word addr,Word sel,Word &data);
+	unsigned writePlugin(const Mapping &m,Word addr,Word sel,Word data);
+	void sync();
+	void schedule();
+};
+
+#endif
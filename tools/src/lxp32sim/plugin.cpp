@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Plugin class.
+ */
+
+#include "plugin.h"
+#include "peripherals.h"
+
+#include <stdexcept>
+#include <cstring>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <dlfcn.h>
+#endif
+
+Plugin::Plugin(const std::string &filename,const std::string &args):
+	_filename(filename)
+{
+	std::memset(&_device,0,sizeof(_device));
+
+#ifdef _WIN32
+	auto lib=::LoadLibraryA(filename.c_str());
+	if(!lib) throw std::runtime_error("Cannot load plugin \""+filename+"\"");
+	_library=lib;
+	auto create=reinterpret_cast<lxp32sim_create_device_fn>(::GetProcAddress(lib,LXP32SIM_CREATE_DEVICE_SYMBOL));
+#else
+	_library=::dlopen(filename.c_str(),RTLD_NOW|RTLD_LOCAL);
+	if(!_library) throw std::runtime_error("Cannot load plugin: "+std::string(::dlerror()));
+// Conversion between object and function pointers is conditionally supported in C++11
+	lxp32sim_create_device_fn create;
+	auto sym=::dlsym(_library,LXP32SIM_CREATE_DEVICE_SYMBOL);
+	static_assert(sizeof(create)==sizeof(sym),"Unsupported function pointer size");
+	std::memcpy(&create,&sym,sizeof(create));
+#endif
+
+	try {
+		if(!create) throw std::runtime_error("\""+filename+"\" is not an lxp32sim plugin");
+		
+		_device.abi_version=LXP32SIM_PLUGIN_ABI_VERSION;
+		if(create(args.c_str(),&_device)!=0) {
+			std::string msg="Plugin \""+filename+"\" failed to create a device";
+			if(_device.error) msg+=std::string(": ")+_device.error;
+			throw std::runtime_error(msg);
+		}
+		_created=true;
+		
+		if(_device.abi_version!=LXP32SIM_PLUGIN_ABI_VERSION)
+			throw std::runtime_error("Plugin \""+filename+"\" was built for an unsupported ABI version");
+		if(_device.num_regions>0&&!_device.regions)
+			throw std::runtime_error("Plugin \""+filename+"\": region table is missing");
+		if(_device.irq_line<-1||_device.irq_line>7)
+			throw std::runtime_error("Plugin \""+filename+"\": invalid interrupt request line");
+		if((_device.flags&LXP32SIM_DEVICE_POSTED_WRITES)&&!_device.write_batch)
+			throw std::runtime_error("Plugin \""+filename+"\": posted writes require a write_batch() callback");
+		
+		_memory.resize(_device.num_regions);
+		for(std::size_t i=0;i<_device.num_regions;i++) {
+			auto &r=_device.regions[i];
+			if(r.kind!=LXP32SIM_REGION_IO&&r.kind!=LXP32SIM_REGION_RAM&&r.kind!=LXP32SIM_REGION_ROM)
+				throw std::runtime_error("Plugin \""+filename+"\": invalid region kind");
+			if(r.kind!=LXP32SIM_REGION_IO&&!r.memory) {
+				_memory[i].assign(r.size/4,0);
+				if(!_memory[i].empty()) r.memory=_memory[i].data();
+			}
+		}
+	}
+	catch(std::exception &) {
+		unload();
+		throw;
+	}
+}
+
+Plugin::~Plugin() {
+	try {
+		flush();
+	}
+	catch(std::exception &) {}
+	unload();
+}
+
+std::string Plugin::name() const {
+	if(_device.name) return _device.name;
+	return _filename;
+}
+
+std::size_t Plugin::regions() const {
+	return _device.num_regions;
+}
+
+Plugin::Word Plugin::base(std::size_t region) const {
+	return _device.regions[region].base;
+}
+
+Plugin::Word Plugin::size(std::size_t region) const {
+	return _device.regions[region].size;
+}
+
+unsigned Plugin::read(std::size_t region,Word offset,Word sel,Word &data) {
+	auto const &r=_device.regions[region];
+	if(r.kind!=LXP32SIM_REGION_IO) {
+		data=r.memory[offset/4];
+		return r.wait_states;
+	}
+	flush();
+	data=0;
+	if(!_device.read) return 0;
+	return _device.read(_device.instance,static_cast<std::uint32_t>(region),offset,sel,&data);
+}
+
+/*
+ * "pending" is the number of cycles elapsed since the device was
+ * last advanced, used to stamp posted writes
+ */
+
+unsigned Plugin::write(std::size_t region,Word offset,Word sel,Word data,Counter pending) {
+	auto const &r=_device.regions[region];
+	if(r.kind==LXP32SIM_REGION_RAM) {
+		r.memory[offset/4]=Slave::merge(r.memory[offset/4],sel,data);
+		return r.wait_states;
+	}
+	if(r.kind==LXP32SIM_REGION_ROM) return r.wait_states;
+	if(_device.flags&LXP32SIM_DEVICE_POSTED_WRITES) {
+		lxp32sim_access a;
+		a.cycle=_time+pending;
+		a.region=static_cast<std::uint32_t>(region);
+		a.offset=offset;
+		a.sel=sel;
+		a.data=data;
+		_posted.push_back(a);
+		if(_posted.size()>=MaxPostedWrites) flush();
+		return _device.posted_wait_states;
+	}
+	if(!_device.write) return 0;
+	return _device.write(_device.instance,static_cast<std::uint32_t>(region),offset,sel,data);
+}
+
+/*
+ * Returns true if the access can change the device state, i.e. the
+ * device must be brought up to date before it and rescheduled after it
+ */
+
+bool Plugin::clocked(std::size_t region,bool write) const {
+	if(_device.regions[region].kind!=LXP32SIM_REGION_IO) return false;
+	if(write&&(_device.flags&LXP32SIM_DEVICE_POSTED_WRITES)) return false;
+	return true;
+}
+
+/*
+ * Debugger accesses: RAM and ROM regions can be read, RAM regions
+ * can be written. I/O regions are not accessed since device reads
+ * and writes can have side effects.
+ */
+
+bool Plugin::peek(std::size_t region,Word offset,Word &data) const {
+	auto const &r=_device.regions[region];
+	if(r.kind==LXP32SIM_REGION_IO) return false;
+	data=r.memory[offset/4];
+	return true;
+}
+
+bool Plugin::poke(std::size_t region,Word offset,Word sel,Word data) {
+	auto const &r=_device.regions[region];
+	if(r.kind!=LXP32SIM_REGION_RAM) return false;
+	r.memory[offset/4]=Slave::merge(r.memory[offset/4],sel,data);
+	return true;
+}
+
+void Plugin::advance(Counter n) {
+	flush();
+	if(_device.tick&&n>0) _device.tick(_device.instance,n);
+	_time+=n;
+}
+
+Plugin::Counter Plugin::quietCycles() {
+	if(_device.quiet_cycles) return _device.quiet_cycles(_device.instance);
+	if(_device.tick) return 0;
+	return Never;
+}
+
+// Returns the interrupt request lines asserted by the device
+
+std::uint8_t Plugin::irq() {
+	if(_device.irq_line<0||!_device.irq) return 0;
+	if(!_device.irq(_device.instance)) return 0;
+	return static_cast<std::uint8_t>(1<<_device.irq_line);
+}
+
+/*
+ * Private members
+ */
+
+void Plugin::flush() {
+	if(_posted.empty()) return;
+	_device.write_batch(_device.instance,_posted.data(),static_cast<std::uint32_t>(_posted.size()));
+	_posted.clear();
+}
+
+void Plugin::unload() {
+	if(_created&&_device.destroy) _device.destroy(_device.instance);
+	_created=false;
+	if(!_library) return;
+#ifdef _WIN32
+	::FreeLibrary(static_cast<HMODULE>(_library));
+#else
+	::dlclose(_library);
+#endif
+	_library=nullptr;
+}
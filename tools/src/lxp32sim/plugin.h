@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Plugin class which loads a peripheral model
+ * from a shared object (see lxp32simplugin.h) and creates one device
+ * instance. Instances are attached to a Platform and shared between
+ * its copies, so a platform with plugins attached shouldn't be forked
+ * more than once.
+ */
+
+#ifndef PLUGIN_H_INCLUDED
+#define PLUGIN_H_INCLUDED
+
+#include "lxp32simplugin.h"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class Plugin {
+public:
+	typedef std::uint32_t Word;
+	typedef std::uint64_t Counter;
+	
+	static const Counter Never=~Counter(0);
+	static const std::size_t MaxPostedWrites=256;
+
+private:
+	std::string _filename;
+	void *_library=nullptr;
+	lxp32sim_device _device;
+	bool _created=false;
+	std::vector<std::vector<Word> > _memory; // allocated for RAM and ROM regions
+	std::vector<lxp32sim_access> _posted;
+	Counter _time=0; // cycles the device has been advanced by
+
+public:
+	Plugin(const std::string &filename,const std::string &args);
+	Plugin(const Plugin &)=delete;
+	Plugin &operator=(const Plugin &)=delete;
+	~Plugin();
+	
+	std::string name() const;
+	std::size_t regions() const;
+	Word base(std::size_t region) const;
+	Word size(std::size_t region) const;
+	
+	unsigned read(std::size_t region,Word offset,Word sel,Word &data);
+	unsigned write(std::size_t region,Word offset,Word sel,Word data,Counter pending);
+	bool clocked(std::size_t region,bool write) const;
+	bool peek(std::size_t region,Word offset,Word &data) const;
+	bool poke(std::size_t region,Word offset,Word sel,Word data);
+	
+	void advance(Counter n);
+	Counter quietCycles();
+	std::uint8_t irq();
+
+private:
+	void flush();
+	void unload();
+};
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Profile class.
+ */
+
+#include "profile.h"
+#include "disassembler.h"
+
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <map>
+#include <cctype>
+
+static bool isIdentifier(const std::string &str) {
+	if(str.empty()) return false;
+	if(!std::isalpha(static_cast<unsigned char>(str[0]))&&str[0]!='_') return false;
+	for(auto ch: str) {
+		if(!std::isalnum(static_cast<unsigned char>(ch))&&ch!='_') return false;
+	}
+	return true;
+}
+
+static std::string percentage(Profile::Counter value,Profile::Counter total) {
+	std::ostringstream ss;
+	double pct=0;
+	if(total>0) pct=100.0*static_cast<double>(value)/static_cast<double>(total);
+	ss<<std::fixed<<std::setprecision(2)<<std::setw(6)<<pct<<'%';
+	return ss.str();
+}
+
+Profile::Profile(std::size_t words):
+	_executions(words),
+	_cycles(words) {}
+
+Profile::Counter Profile::executions(Word pc) const {
+	auto i=pc>>2;
+	if(i>=_executions.size()) return 0;
+	return _executions[i];
+}
+
+Profile::Counter Profile::cycles(Word pc) const {
+	auto i=pc>>2;
+	if(i>=_cycles.size()) return 0;
+	return _cycles[i];
+}
+
+Profile::Counter Profile::totalExecutions() const {
+	Counter sum=0;
+	for(auto n: _executions) sum+=n;
+	return sum;
+}
+
+Profile::Counter Profile::totalCycles() const {
+	Counter sum=0;
+	for(auto n: _cycles) sum+=n;
+	return sum;
+}
+
+/*
+ * Write a flat profile: cycles and instructions aggregated by symbol,
+ * the most expensive symbols first. Lines are formatted as comments
+ * so that the summary can be prepended to the listing.
+ */
+
+void Profile::writeSummary(std::ostream &os,const SymbolMap &symbols) const {
+	struct Entry {
+		Counter executions=0;
+		Counter cycles=0;
+	};
+	
+	std::map<Word,Entry> groups;
+	
+	for(std::size_t i=0;i<_cycles.size();i++) {
+		if(_cycles[i]==0&&_executions[i]==0) continue;
+		auto &e=groups[symbols.symbolAddress(static_cast<Word>(i*4))];
+		e.executions+=_executions[i];
+		e.cycles+=_cycles[i];
+	}
+	
+	std::vector<std::pair<Word,Entry> > sorted(groups.begin(),groups.end());
+	std::stable_sort(sorted.begin(),sorted.end(),[](const std::pair<Word,Entry> &a,const std::pair<Word,Entry> &b) {
+		return a.second.cycles>b.second.cycles;
+	});
+	
+	auto total=totalCycles();
+	
+	os<<"// Flat profile: "<<total<<" cycles, "<<totalExecutions()<<" instructions"<<std::endl;
+	os<<"//"<<std::endl;
+	os<<"//       Cycles        %  Instructions  Symbol"<<std::endl;
+	for(auto const &g: sorted) {
+		os<<"// "<<std::setw(12)<<g.second.cycles<<"  "<<percentage(g.second.cycles,total);
+		os<<"  "<<std::setw(12)<<g.second.executions<<"  "<<symbols.resolve(g.first)<<std::endl;
+	}
+}
+
+/*
+ * Write an annotated disassembly listing in the lxp32dump format.
+ * Execution count, cycle count and the share of total cycles
+ * are appended to the comment of each instruction.
+ */
+
+void Profile::writeListing(std::ostream &os,const std::vector<Word> &code,const SymbolMap &symbols) const {
+	std::stringstream image(std::ios_base::in|std::ios_base::out|std::ios_base::binary);
+	for(auto w: code) {
+		char buf[4];
+		for(int i=0;i<4;i++) buf[i]=static_cast<char>(w>>(i*8));
+		image.write(buf,4);
+	}
+	
+	std::stringstream listing;
+	Disassembler disasm(image,listing);
+	disasm.setFormat(Disassembler::Bin);
+	disasm.dump();
+	
+	std::vector<std::string> lines;
+	std::size_t width=0;
+	std::string line;
+	while(std::getline(listing,line)) {
+		lines.push_back(line);
+		width=std::max(width,line.size());
+	}
+	
+	auto total=totalCycles();
+	
+	writeSummary(os,symbols);
+	os<<std::endl;
+	os<<"// Columns: address: word, executions, cycles, % of total cycles"<<std::endl;
+	
+	for(auto const &l: lines) {
+		auto pos=l.find("// ");
+		if(pos==std::string::npos) {
+			os<<l<<std::endl;
+			continue;
+		}
+		auto addr=static_cast<Word>(std::stoul(l.substr(pos+3,8),nullptr,16));
+		
+		auto sym=symbols.symbolAt(addr);
+		if(!sym.empty()) {
+			os<<std::endl;
+			if(isIdentifier(sym)) os<<sym<<':'<<std::endl;
+			else os<<"// "<<sym<<std::endl;
+		}
+		
+		os<<l;
+		auto n=executions(addr);
+		auto c=cycles(addr);
+		if(n>0||c>0) {
+			os<<std::string(width-l.size(),' ');
+			os<<std::setw(12)<<n<<std::setw(12)<<c<<"  "<<percentage(c,total);
+		}
+		os<<std::endl;
+	}
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Profile class which collects instruction
+ * and cycle counts for each instruction address and produces a flat
+ * profile and an annotated disassembly listing.
+ */
+
+#ifndef PROFILE_H_INCLUDED
+#define PROFILE_H_INCLUDED
+
+#include "symbolmap.h"
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+
+class Profile {
+public:
+	typedef std::uint32_t Word;
+	typedef std::uint64_t Counter;
+private:
+	std::vector<Counter> _executions;
+	std::vector<Counter> _cycles;
+public:
+	Profile(std::size_t words);
+	
+	void addExecution(Word pc,Counter cycles) {
+		auto i=pc>>2;
+		if(i>=_executions.size()) return;
+		_executions[i]++;
+		_cycles[i]+=cycles;
+	}
+	
+	void addCycles(Word pc,Counter cycles) {
+		auto i=pc>>2;
+		if(i<_cycles.size()) _cycles[i]+=cycles;
+	}
+	
+	Counter executions(Word pc) const;
+	Counter cycles(Word pc) const;
+	Counter totalExecutions() const;
+	Counter totalCycles() const;
+	
+	void writeSummary(std::ostream &os,const SymbolMap &symbols) const;
+	void writeListing(std::ostream &os,const std::vector<Word> &code,const SymbolMap &symbols) const;
+};
+
+#endif
@@ -0,0 +1,706 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Runner class.
+ */
+
+#include "runner.h"
+#include "image.h"
+#include "profile.h"
+#include "callgraph.h"
+#include "tracewriter.h"
+#include "coverage.h"
+#include "coveragereport.h"
+#include "irqstats.h"
+#include "lockstep.h"
+#include "gdbserver.h"
+#include "multicore.h"
+#include "plugin.h"
+#include "batch.h"
+#include "parallel.h"
+#include "utils.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+
+void Runner::setSettings(const Settings &s) {
+	_settings=s;
+}
+
+const Runner::Settings &Runner::settings() const {
+	return _settings;
+}
+
+void Runner::setThreads(unsigned n) {
+	_threads=n;
+}
+
+void Runner::addFile(const std::string &filename) {
+	_files.push_back(filename);
+}
+
+/*
+ * Tests are executed in two phases. First, each input file is loaded
+ * (or restored from a snapshot) and run up to the fork point. Then
+ * the resulting checkpoints are forked into continuations which
+ * run to completion. Both phases are distributed among worker threads.
+ */
+
+std::vector<Runner::Result> Runner::run() const {
+	if(!_settings.lockstepFileName.empty()) return runLockstep();
+	if(!_settings.gdbAddress.empty()) return runGdb();
+	if(_settings.cores>0) return runMultiCore();
+	if(_settings.batch) return runBatch();
+	
+	struct Job {
+		std::size_t file;
+		bool poke;
+		Cpu::Word value;
+	};
+	
+	std::vector<Simulator> checkpoints(_files.size());
+	std::vector<Cpu::Counter> startCycles(_files.size());
+	std::vector<Result> prefixResults(_files.size());
+	std::vector<Program> programs(_files.size());
+	
+// Profiling and tracing are only supported for a single continuation (see main.cpp)
+	std::unique_ptr<Profile> profile;
+	if(!_settings.profileFileName.empty()) profile.reset(new Profile(ProgramRam::Size/4));
+	std::unique_ptr<CallGraph> callGraph;
+	if(!_settings.foldedFileName.empty()||!_settings.callTreeFileName.empty()) callGraph.reset(new CallGraph);
+	std::unique_ptr<TraceWriter> trace;
+	if(!_settings.traceFileName.empty()) trace.reset(new TraceWriter(_settings.traceFileName));
+	auto irqSchedule=openIrqSchedule();
+	
+// Coverage is collected separately for each test and continuation, then merged
+	bool coverage=!_settings.coverageFileName.empty();
+	std::vector<Coverage> prefixCoverage(_files.size());
+	
+// Interrupt statistics are collected the same way, but reported for each continuation
+	bool irqStats=!_settings.irqStatsFileName.empty();
+	std::vector<IrqStats> prefixIrqStats(_files.size());
+	
+// Performance regions are measured the same way, but only if the program defines them
+	std::vector<PerfRegions> prefixPerf(_files.size());
+	
+	Parallel::forEach(_files.size(),_threads,[&](std::size_t i) {
+		auto &sim=checkpoints[i];
+		auto &res=prefixResults[i];
+		std::ostringstream log;
+		
+		res.filename=_files[i];
+		if(_settings.verbose) sim.platform().monitor().setLog(&log);
+		sim.platform().semihost().setConsole(&log);
+		
+		try {
+			prepare(sim,_files[i],programs[i]);
+			if(coverage) {
+				prefixCoverage[i]=Coverage(programs[i].code.size());
+				sim.cpu().setCoverage(&prefixCoverage[i]);
+			}
+			sim.cpu().setProfile(profile.get());
+			if(callGraph) callGraph->reset(sim.cpu().pc());
+			sim.cpu().setCallGraph(callGraph.get());
+			sim.cpu().setTrace(trace.get());
+			sim.cpu().setIrqSchedule(irqSchedule.get());
+			if(irqStats) sim.cpu().setIrqStats(&prefixIrqStats[i]);
+			prefixPerf[i]=programs[i].perfRegions;
+			if(!prefixPerf[i].empty()) sim.cpu().setPerfRegions(&prefixPerf[i]);
+			startCycles[i]=sim.cpu().cycles();
+			sim.run(std::min(_settings.forkCycle,_settings.cycleLimit));
+			res.status=Result::Success;
+		}
+		catch(std::exception &ex) {
+			res.status=Result::Error;
+			res.message=ex.what();
+		}
+		
+		sim.platform().monitor().setLog(nullptr);
+		sim.platform().semihost().setConsole(nullptr);
+		res.log=log.str();
+	});
+	
+	std::vector<Job> jobs;
+	for(std::size_t i=0;i<_files.size();i++) {
+		if(_settings.poke) {
+			for(auto value: _settings.pokeValues) jobs.push_back(Job {i,true,value});
+		}
+		else jobs.push_back(Job {i,false,0});
+	}
+	
+	std::vector<Result> results(jobs.size());
+	std::vector<Coverage> jobCoverage(coverage?jobs.size():0);
+	std::vector<IrqStats> jobIrqStats(irqStats?jobs.size():0);
+	std::vector<PerfRegions> jobPerf(jobs.size());
+	
+	Parallel::forEach(jobs.size(),_threads,[&](std::size_t j) {
+		auto const &job=jobs[j];
+		auto &res=results[j];
+		
+		res=prefixResults[job.file];
+		if(res.status==Result::Error) return;
+		
+		Simulator sim(checkpoints[job.file]); // fork
+		std::ostringstream log;
+		if(_settings.verbose) sim.platform().monitor().setLog(&log);
+		sim.platform().semihost().setConsole(&log);
+		
+		try {
+			if(coverage) {
+				jobCoverage[j]=Coverage(programs[job.file].code.size());
+				sim.cpu().setCoverage(&jobCoverage[j]);
+			}
+			if(irqStats) {
+				jobIrqStats[j]=prefixIrqStats[job.file];
+				sim.cpu().setIrqStats(&jobIrqStats[j]);
+			}
+			jobPerf[j]=prefixPerf[job.file];
+			if(!jobPerf[j].empty()) sim.cpu().setPerfRegions(&jobPerf[j]);
+			if(job.poke) {
+				res.filename+=" [0x"+Utils::hex(_settings.pokeAddr)+"=0x"+Utils::hex(job.value)+"]";
+				sim.platform().write(_settings.pokeAddr&~Cpu::Word(3),0xF,job.value);
+			}
+			auto elapsed=sim.cpu().cycles()-startCycles[job.file];
+			if(_settings.samplePeriod>0) {
+				Sampler sampler(_settings.samplePeriod,_settings.sampleWindow,_settings.sampleWarmup);
+				if(elapsed<_settings.cycleLimit) sampler.run(sim,_settings.cycleLimit-elapsed);
+				log<<samplingSummary(sampler,sim.cpu().instructions());
+			}
+			else if(elapsed<_settings.cycleLimit) sim.run(_settings.cycleLimit-elapsed);
+			if(sim.cpu().icache()) log<<icacheSummary(sim.cpu().icache()->stats());
+			if(_settings.dma) log<<dmaSummary(sim.platform());
+			finish(sim,res);
+			if(!jobPerf[j].empty()) checkBudgets(jobPerf[j],res,log);
+			if(!_settings.snapshotFileName.empty()) sim.save(_settings.snapshotFileName);
+		}
+		catch(std::exception &ex) {
+			res.status=Result::Error;
+			res.message=ex.what();
+		}
+		
+		sim.platform().monitor().setLog(nullptr);
+		sim.platform().semihost().setConsole(nullptr);
+		res.cycles=sim.cpu().cycles();
+		res.instructions=sim.cpu().instructions();
+		res.log+=log.str();
+	});
+	
+	if(trace) trace->close();
+	if(irqSchedule) {
+		irqSchedule->close();
+		if(!results.empty()) results[0].log+=irqScheduleSummary(*irqSchedule);
+	}
+	
+	if(!_files.empty()&&prefixResults[0].status!=Result::Error) {
+		if(profile) {
+			auto out=openOutput(_settings.profileFileName);
+			profile->writeListing(*out,programs[0].code,programs[0].symbols);
+		}
+		if(callGraph&&!_settings.foldedFileName.empty()) {
+			auto out=openOutput(_settings.foldedFileName);
+			callGraph->writeFolded(*out,programs[0].symbols);
+		}
+		if(callGraph&&!_settings.callTreeFileName.empty()) {
+			auto out=openOutput(_settings.callTreeFileName);
+			callGraph->writeTree(*out,programs[0].symbols);
+		}
+	}
+	
+	if(coverage) {
+		for(std::size_t j=0;j<jobs.size();j++) {
+			if(prefixResults[jobs[j].file].status!=Result::Error) prefixCoverage[jobs[j].file].merge(jobCoverage[j]);
+		}
+		CoverageReport report;
+		for(std::size_t i=0;i<_files.size();i++) {
+			if(prefixResults[i].status==Result::Error) continue;
+			report.add(_files[i],prefixCoverage[i],programs[i].code,programs[i].lines);
+		}
+		auto out=openOutput(_settings.coverageFileName);
+		report.write(*out);
+	}
+	
+	if(irqStats) {
+		auto out=openOutput(_settings.irqStatsFileName);
+		*out<<"{"<<std::endl<<"  \"tests\": [";
+		bool first=true;
+		for(std::size_t j=0;j<jobs.size();j++) {
+			if(prefixResults[jobs[j].file].status==Result::Error) continue;
+			if(!first) *out<<",";
+			first=false;
+			*out<<std::endl<<"    {\"test\": "<<Utils::jsonString(results[j].filename)<<", \"vectors\": ";
+			jobIrqStats[j].writeJson(*out,"    ");
+			*out<<"}";
+		}
+		*out<<std::endl<<"  ]"<<std::endl<<"}"<<std::endl;
+	}
+	
+	return results;
+}
+
+/*
+ * Private members
+ */
+
+/*
+ * Tests are executed sequentially, in the same order as they appear
+ * in the log. The simulation stops at the first divergence.
+ */
+
+std::vector<Runner::Result> Runner::runLockstep() const {
+	std::ifstream file;
+	std::istream *log=&std::cin;
+	if(_settings.lockstepFileName!="-") {
+		file.open(_settings.lockstepFileName);
+		if(!file) throw std::runtime_error("Cannot open \""+_settings.lockstepFileName+"\"");
+		log=&file;
+	}
+	
+	std::vector<Result> results;
+	
+	Lockstep lockstep(*log,_settings.lockstepFileName);
+	
+	for(auto const &filename: _files) {
+		Result res;
+		Simulator sim;
+		std::ostringstream out;
+		Program program;
+		
+		res.filename=filename;
+		if(_settings.verbose) sim.platform().monitor().setLog(&out);
+		
+		try {
+			prepare(sim,filename,program);
+			lockstep.setTarget(sim.platform());
+			sim.cpu().setBus(lockstep);
+			lockstep.beginTest();
+			sim.run(_settings.cycleLimit);
+			if(sim.finished()) lockstep.endTest();
+			else lockstep.skipTest();
+			finish(sim,res);
+		}
+		catch(Lockstep::Divergence &ex) {
+			res.status=Result::Error;
+			res.message="divergence detected";
+			out<<"Divergence: "<<ex.what()<<std::endl;
+			out<<"Program counter: 0x"<<Utils::hex(sim.cpu().pc())<<std::endl;
+			auto sym=program.symbols.resolve(sim.cpu().pc());
+			if(!program.symbols.empty()) out<<"Location: "<<sym<<std::endl;
+			out<<"Cycles: "<<sim.cpu().cycles()<<", instructions: "<<sim.cpu().instructions();
+			if(sim.cpu().halted()) out<<" (halted)";
+			out<<std::endl;
+			for(int r=0;r<256;r+=8) {
+				out<<"    ";
+				for(int i=r;i<r+8;i++) {
+					auto name=Cpu::registerName(i);
+					name.resize(4,' ');
+					out<<name<<" "<<Utils::hex(sim.cpu().reg(i))<<((i<r+7)?"  ":"");
+				}
+				out<<std::endl;
+			}
+		}
+		catch(std::exception &ex) {
+			res.status=Result::Error;
+			res.message=ex.what();
+		}
+		
+		sim.platform().monitor().setLog(nullptr);
+		sim.cpu().setBus(sim.platform());
+		res.cycles=sim.cpu().cycles();
+		res.instructions=sim.cpu().instructions();
+		res.log=out.str();
+		results.push_back(res);
+		if(res.status==Result::Error) break;
+	}
+	
+	return results;
+}
+
+/*
+ * A single test is run under control of the debugger. If the debugger
+ * detaches before the test finishes, the simulation continues.
+ */
+
+std::vector<Runner::Result> Runner::runGdb() const {
+	Result res;
+	Simulator sim;
+	std::ostringstream out;
+	Program program;
+	std::unique_ptr<IrqSchedule> irqSchedule;
+	
+	res.filename=_files.at(0);
+	if(_settings.verbose) sim.platform().monitor().setLog(&out);
+	sim.platform().semihost().setConsole(&std::cout); // shown immediately while debugging
+	
+	try {
+		prepare(sim,res.filename,program);
+		irqSchedule=openIrqSchedule();
+		sim.cpu().setIrqSchedule(irqSchedule.get());
+		bool killed;
+		{
+			GdbServer server(sim,program.symbols);
+			server.setCycleLimit(_settings.cycleLimit);
+			auto address=server.listen(_settings.gdbAddress);
+			std::cout<<"Waiting for GDB connection on "<<address<<std::endl;
+			server.serve();
+			killed=server.killed();
+		}
+		auto elapsed=sim.cpu().cycles();
+		if(!killed&&elapsed<_settings.cycleLimit) sim.run(_settings.cycleLimit-elapsed);
+		finish(sim,res);
+	}
+	catch(std::exception &ex) {
+		res.status=Result::Error;
+		res.message=ex.what();
+	}
+	
+	sim.platform().monitor().setLog(nullptr);
+	sim.platform().semihost().setConsole(nullptr);
+	sim.cpu().setIrqSchedule(nullptr);
+	res.cycles=sim.cpu().cycles();
+	res.instructions=sim.cpu().instructions();
+	res.log=out.str();
+	if(irqSchedule) {
+		try {
+			irqSchedule->close();
+			res.log+=irqScheduleSummary(*irqSchedule);
+		}
+		catch(std::exception &ex) {
+			res.status=Result::Error;
+			res.message=ex.what();
+		}
+	}
+	return std::vector<Result> {res};
+}
+
+/*
+ * Each test runs on a multi-core system (one host thread per core),
+ * tests are executed one after another. Interconnect statistics are
+ * reported for each core.
+ */
+
+std::vector<Runner::Result> Runner::runMultiCore() const {
+	std::vector<Result> results;
+	
+	for(auto const &filename: _files) {
+		Result res;
+		MultiCore system(_settings.cores);
+		std::ostringstream out;
+		
+		res.filename=filename;
+		if(_settings.verbose) system.monitor().setLog(&out);
+		
+		try {
+			for(int i=0;i<system.cores();i++) {
+				system.cpu(i).setMulArch(_settings.mulArch);
+				system.cpu(i).setDividerEnabled(_settings.dividerEnabled);
+				system.cpu(i).setDbusRmw(_settings.dbusRmw);
+			}
+			system.intercon().setPipelinedArbiter(_settings.pipelinedArbiter);
+			system.intercon().setRegisteredFeedback(_settings.registeredFeedback);
+			system.intercon().setUnsafeDecoder(_settings.unsafeDecoder);
+			system.setIdleSkipping(_settings.idleSkipping);
+			
+			if(Simulator::isSnapshot(filename)) throw std::runtime_error("Snapshots can't be run on a multi-core system");
+			Image image;
+			image.load(filename,_settings.includeSearchDirs);
+			system.loadImage(image.words());
+			
+			system.run(_settings.cycleLimit);
+			
+			if(!system.finished()) res.status=Result::Timeout;
+			else {
+				res.returnCode=system.monitor().result();
+				if(res.returnCode==1) res.status=Result::Success;
+				else res.status=Result::Failure;
+			}
+			
+			for(int i=0;i<system.cores();i++) {
+				auto const &stats=system.intercon().stats(i);
+				out<<"Core "<<i<<": "<<system.instructions(i)<<" instructions, ";
+				out<<stats.reads<<" reads, "<<stats.writes<<" writes, ";
+				out<<stats.busCycles<<" bus cycles, "<<stats.stallCycles<<" stall cycles";
+				out<<" (max "<<stats.maxStall<<")"<<std::endl;
+			}
+		}
+		catch(std::exception &ex) {
+			res.status=Result::Error;
+			res.message=ex.what();
+		}
+		
+		system.monitor().setLog(nullptr);
+		res.cycles=system.cycles();
+		res.instructions=system.instructions();
+		res.log=out.str();
+		results.push_back(res);
+	}
+	
+	return results;
+}
+
+/*
+ * The first file is the program, the others are its inputs. Inputs are
+ * split into groups of "batchLanes", each group is run by a Batch on one
+ * worker thread. Lanes that the batch engine doesn't support are rerun
+ * on the complete platform, so the results are the same as if each
+ * input was run separately.
+ */
+
+std::vector<Runner::Result> Runner::runBatch() const {
+	if(Simulator::isSnapshot(_files[0])) throw std::runtime_error("Batch mode can't start from a snapshot");
+	
+	Simulator base;
+	Program program;
+	prepare(base,_files[0],program);
+	
+	auto inputs=_files.size()-1;
+	auto groups=(inputs+_settings.batchLanes-1)/_settings.batchLanes;
+	std::vector<Result> results(inputs);
+	
+	Parallel::forEach(groups,_threads,[&](std::size_t g) {
+		auto first=g*_settings.batchLanes;
+		auto last=std::min(first+_settings.batchLanes,inputs);
+		
+// Inputs that can't be loaded don't get a lane
+		std::vector<std::size_t> lanes;
+		std::vector<std::vector<Cpu::Word> > data;
+		for(auto j=first;j<last;j++) {
+			results[j].filename=_files[j+1];
+			try {
+				data.push_back(loadInput(_files[j+1]));
+				lanes.push_back(j);
+			}
+			catch(std::exception &ex) {
+				results[j].status=Result::Error;
+				results[j].message=ex.what();
+			}
+		}
+		if(lanes.empty()) return;
+		
+		Batch batch(program.code,lanes.size());
+		batch.setMulArch(_settings.mulArch);
+		batch.setDividerEnabled(_settings.dividerEnabled);
+		batch.setDbusRmw(_settings.dbusRmw);
+		batch.setVerbose(_settings.verbose);
+		for(std::size_t l=0;l<lanes.size();l++) {
+			for(std::size_t k=0;k<data[l].size();k++)
+				batch.write(l,_settings.batchInputAddr+static_cast<Cpu::Word>(k*4),data[l][k]);
+		}
+		batch.run(_settings.cycleLimit);
+		
+		std::size_t rerun=0;
+		for(std::size_t l=0;l<lanes.size();l++) {
+			auto &res=results[lanes[l]];
+			
+			if(batch.status(l)==Batch::Unsupported) {
+				rerun++;
+				Simulator sim(base);
+				std::ostringstream log;
+				if(_settings.verbose) sim.platform().monitor().setLog(&log);
+				sim.platform().semihost().setConsole(&log);
+				try {
+					for(std::size_t k=0;k<data[l].size();k++)
+						sim.platform().write(_settings.batchInputAddr+static_cast<Cpu::Word>(k*4),0xF,data[l][k]);
+					sim.run(_settings.cycleLimit);
+					finish(sim,res);
+				}
+				catch(std::exception &ex) {
+					res.status=Result::Error;
+					res.message=ex.what();
+				}
+				sim.platform().monitor().setLog(nullptr);
+				sim.platform().semihost().setConsole(nullptr);
+				res.cycles=sim.cpu().cycles();
+				res.instructions=sim.cpu().instructions();
+				res.log=log.str();
+				continue;
+			}
+			
+			if(batch.status(l)==Batch::Timeout) res.status=Result::Timeout;
+			else {
+				res.returnCode=batch.result(l);
+				if(res.returnCode==1) res.status=Result::Success;
+				else res.status=Result::Failure;
+			}
+			res.cycles=batch.cycles(l);
+			res.instructions=batch.instructions(l);
+			res.log=batch.log(l);
+		}
+		
+		std::ostringstream summary;
+		summary<<"Batch: "<<lanes.size()<<" lane(s), "<<batch.steps()<<" step(s), ";
+		summary<<std::fixed<<std::setprecision(2)<<100*batch.utilization()<<"% lane utilization, ";
+		summary<<rerun<<" input(s) rerun on the complete platform"<<std::endl;
+		results[lanes.front()].log.insert(0,summary.str());
+	});
+	
+	return results;
+}
+
+void Runner::prepare(Simulator &sim,const std::string &filename,Program &program) const {
+	sim.cpu().setMulArch(_settings.mulArch);
+	sim.cpu().setDividerEnabled(_settings.dividerEnabled);
+	sim.cpu().setDbusRmw(_settings.dbusRmw);
+	sim.platform().setThrottleIbus(_settings.throttleIbus);
+	sim.platform().setThrottleDbus(_settings.throttleDbus);
+	sim.platform().setSemihosting(_settings.semihosting);
+	sim.platform().setDma(_settings.dma);
+	sim.platform().intercon().setPipelinedArbiter(_settings.pipelinedArbiter);
+	sim.platform().intercon().setRegisteredFeedback(_settings.registeredFeedback);
+	if(_settings.icache) sim.cpu().setICache(_settings.icacheLatency,_settings.icacheBurstSize,_settings.icachePrefetchSize);
+	sim.setIdleSkipping(_settings.idleSkipping);
+	
+	if(Simulator::isSnapshot(filename)) {
+		sim.restore(filename);
+		auto const &mem=sim.platform().ram().memory();
+		std::size_t size=mem.size();
+		while(size>0&&mem.read(size-1)==0) size--;
+		program.code.clear();
+		for(std::size_t i=0;i<size;i++) program.code.push_back(mem.read(i));
+	}
+	else {
+		Image image;
+		image.load(filename,_settings.includeSearchDirs);
+		sim.loadImage(image.words());
+		program.code=image.words();
+		program.lines=image.lines();
+		if(!image.map().empty()) {
+			std::istringstream map(image.map());
+			program.symbols.load(map);
+			map.clear();
+			map.seekg(0);
+			program.perfRegions.load(map);
+		}
+	}
+	
+	if(!_settings.mapFileName.empty()) {
+		program.symbols.loadFile(_settings.mapFileName);
+		std::ifstream map(_settings.mapFileName);
+		if(program.perfRegions.empty()) program.perfRegions.load(map);
+	}
+	
+// Each simulator gets its own device instances
+	for(auto const &p: _settings.plugins) sim.platform().attach(std::make_shared<Plugin>(p.first,p.second));
+}
+
+std::unique_ptr<IrqSchedule> Runner::openIrqSchedule() const {
+	std::unique_ptr<IrqSchedule> schedule;
+	if(!_settings.irqRecordFileName.empty())
+		schedule.reset(new IrqSchedule(_settings.irqRecordFileName,IrqSchedule::Record));
+	else if(!_settings.irqReplayFileName.empty())
+		schedule.reset(new IrqSchedule(_settings.irqReplayFileName,IrqSchedule::Replay));
+	return schedule;
+}
+
+// Batch mode input: the size in bytes followed by the data (little-endian)
+
+std::vector<Cpu::Word> Runner::loadInput(const std::string &filename) const {
+	std::ifstream in(filename,std::ios_base::in|std::ios_base::binary);
+	if(!in) throw std::runtime_error("Cannot open \""+filename+"\"");
+	std::vector<char> bytes((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+	
+	if(bytes.size()>ProgramRam::Size-_settings.batchInputAddr-4)
+		throw std::runtime_error("Input doesn't fit in the program RAM");
+	
+	std::vector<Cpu::Word> words(1+(bytes.size()+3)/4,0);
+	words[0]=static_cast<Cpu::Word>(bytes.size());
+	for(std::size_t i=0;i<bytes.size();i++)
+		words[1+i/4]|=static_cast<Cpu::Word>(static_cast<unsigned char>(bytes[i]))<<((i%4)*8);
+	return words;
+}
+
+std::string Runner::irqScheduleSummary(const IrqSchedule &schedule) {
+	std::ostringstream out;
+	out<<"Interrupt schedule: "<<schedule.changes()<<" line change(s) ";
+	if(schedule.mode()==IrqSchedule::Record) out<<"recorded"<<std::endl;
+	else {
+		out<<"replayed";
+		if(!schedule.exhausted()) out<<", the recording continues beyond this point";
+		out<<std::endl;
+	}
+	return out.str();
+}
+
+std::string Runner::icacheSummary(const ICache::Stats &stats) {
+	std::ostringstream out;
+	out<<"Instruction cache: "<<stats.fetches<<" fetches, "<<stats.misses<<" misses, ";
+	out<<stats.stallCycles<<" stall cycles"<<std::endl;
+	return out.str();
+}
+
+std::string Runner::dmaSummary(const Platform &platform) {
+	auto const &dma=platform.dma().stats();
+	auto const &cpu=platform.intercon().stats(Platform::CpuMaster);
+	std::ostringstream out;
+	out<<"DMA: "<<dma.descriptors<<" descriptors, "<<dma.words<<" words, ";
+	out<<dma.busCycles<<" bus cycles; CPU data bus: "<<cpu.stallCycles<<" stall cycles";
+	out<<" (max "<<cpu.maxStall<<")"<<std::endl;
+	return out.str();
+}
+
+std::string Runner::samplingSummary(const Sampler &sampler,Cpu::Counter instructions) {
+	std::ostringstream out;
+	out<<"Sampling: "<<sampler.samples()<<" window(s), ";
+	if(instructions>0) {
+		out<<std::fixed<<std::setprecision(2);
+		out<<100.0*static_cast<double>(sampler.detailedInstructions())/static_cast<double>(instructions);
+		out<<"% of instructions simulated in detail"<<std::endl;
+	}
+	else out<<"no instructions executed"<<std::endl;
+	if(sampler.samples()==0) return out.str();
+	
+	auto cpi=sampler.meanCpi();
+	auto ci=sampler.confidence();
+	auto n=static_cast<double>(instructions);
+	out<<std::fixed<<std::setprecision(4);
+	out<<"Sampling: CPI "<<cpi;
+	if(sampler.samples()>1) out<<" +/- "<<ci<<" (95% confidence)";
+	out<<std::setprecision(0);
+	out<<", estimated "<<cpi*n;
+	if(sampler.samples()>1) {
+		out<<" +/- "<<ci*n<<" cycles ("<<std::setprecision(2)<<(cpi>0?100.0*ci/cpi:0.0)<<"%)";
+	}
+	else out<<" cycles";
+	out<<std::endl;
+	return out.str();
+}
+
+std::unique_ptr<std::ostream> Runner::openOutput(const std::string &filename) {
+	std::unique_ptr<std::ostream> out(new std::ofstream(filename));
+	if(!*out) throw std::runtime_error("Cannot open \""+filename+"\" for writing");
+	return out;
+}
+
+void Runner::finish(Simulator &sim,Result &res) const {
+	if(!sim.finished()) res.status=Result::Timeout;
+	else if(!sim.platform().monitor().finished()) {
+// Semihosting exit: zero means success
+		res.returnCode=sim.platform().semihost().exitCode();
+		if(res.returnCode==0) res.status=Result::Success;
+		else res.status=Result::Failure;
+	}
+	else {
+		res.returnCode=sim.platform().monitor().result();
+		if(res.returnCode==1) res.status=Result::Success;
+		else res.status=Result::Failure;
+	}
+}
+
+/*
+ * A test that passes functionally fails if a performance region
+ * has exceeded its cycle budget
+ */
+
+void Runner::checkBudgets(const PerfRegions &regions,Result &res,std::ostream &log) {
+	regions.report(log);
+	if(res.status==Result::Success&&!regions.withinBudget()) {
+		res.status=Result::Failure;
+		res.message="cycle budget exceeded";
+	}
+}
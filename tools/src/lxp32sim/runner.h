@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Runner class which executes a set of
+ * firmware tests on the simulated platform using a pool of
+ * worker threads.
+ */
+
+#ifndef RUNNER_H_INCLUDED
+#define RUNNER_H_INCLUDED
+
+#include "simulator.h"
+#include "symbolmap.h"
+#include "image.h"
+#include "irqschedule.h"
+#include "sampler.h"
+#include "perfregions.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <utility>
+#include <iostream>
+#include <cstdint>
+
+class Runner {
+public:
+	struct Settings {
+		Cpu::MulArch mulArch=CoreProfile::MulDsp;
+		bool dividerEnabled=true;
+		bool dbusRmw=false;
+		bool throttleIbus=false;
+		bool throttleDbus=false;
+		bool idleSkipping=true;
+		bool semihosting=false;
+// DMA engine sharing the data bus (uses the interconnect options below)
+		bool dma=false;
+// LXP32C instruction cache model (ibus latency, IBUS_BURST_SIZE, IBUS_PREFETCH_SIZE)
+		bool icache=false;
+		unsigned icacheLatency=0;
+		unsigned icacheBurstSize=16;
+		unsigned icachePrefetchSize=32;
+// Sampling mode (0: disabled): period, measurement window and warm-up in instructions
+		Cpu::Counter samplePeriod=0;
+		Cpu::Counter sampleWindow=0;
+		Cpu::Counter sampleWarmup=0;
+		bool verbose=false;
+		Cpu::Counter cycleLimit=100000000;
+		std::vector<std::string> includeSearchDirs;
+// Checkpointing: run each test up to "forkCycle" once, then fork
+// one continuation per value written to "pokeAddr"
+		Cpu::Counter forkCycle=0;
+		bool poke=false;
+		Cpu::Word pokeAddr=0;
+		std::vector<Cpu::Word> pokeValues;
+		std::string snapshotFileName;
+// Profiling
+		std::string profileFileName;
+		std::string foldedFileName;
+		std::string callTreeFileName;
+		std::string mapFileName;
+// Execution trace
+		std::string traceFileName;
+// Interrupt line schedule: record to or replay from a file
+		std::string irqRecordFileName;
+		std::string irqReplayFileName;
+// Instruction and branch coverage report
+		std::string coverageFileName;
+// Interrupt latency and handler duration histograms
+		std::string irqStatsFileName;
+// Lockstep: compare data bus transactions against a dbus_monitor log
+		std::string lockstepFileName;
+// Debugging: serve a GDB connection on this address
+		std::string gdbAddress;
+// Multi-core system (0: single-core test platform) and the interconnect
+		int cores=0;
+		bool pipelinedArbiter=false;
+		bool registeredFeedback=false;
+		bool unsafeDecoder=false;
+// Peripheral plugins: file names and argument strings
+		std::vector<std::pair<std::string,std::string> > plugins;
+// Batch mode: the first file is run on each of the others, stored at "batchInputAddr"
+		bool batch=false;
+		Cpu::Word batchInputAddr=0;
+		std::size_t batchLanes=64;
+	};
+	
+	struct Result {
+		enum Status {Success,Failure,Timeout,Error};
+		
+		std::string filename;
+		Status status=Error;
+		Cpu::Word returnCode=0;
+		Cpu::Counter cycles=0;
+		Cpu::Counter instructions=0;
+		std::string message;
+		std::string log;
+	};
+
+private:
+// Information about the program under test, used for reporting
+	struct Program {
+		std::vector<Cpu::Word> code;
+		SymbolMap symbols;
+		Image::LineTable lines;
+		PerfRegions perfRegions;
+	};
+	
+	Settings _settings;
+	unsigned _threads=0;
+	std::vector<std::string> _files;
+
+public:
+	void setSettings(const Settings &s);
+	const Settings &settings() const;
+	void setThreads(unsigned n);
+	void addFile(const std::string &filename);
+	
+	std::vector<Result> run() const;
+
+private:
+	std::vector<Result> runLockstep() const;
+	std::vector<Result> runGdb() const;
+	std::vector<Result> runMultiCore() const;
+	std::vector<Result> runBatch() const;
+	void prepare(Simulator &sim,const std::string &filename,Program &program) const;
+	void finish(Simulator &sim,Result &res) const;
+	static void checkBudgets(const PerfRegions &regions,Result &res,std::ostream &log);
+	std::unique_ptr<IrqSchedule> openIrqSchedule() const;
+	std::vector<Cpu::Word> loadInput(const std::string &filename) const;
+	static std::string irqScheduleSummary(const IrqSchedule &schedule);
+	static std::string icacheSummary(const ICache::Stats &stats);
+	static std::string dmaSummary(const Platform &platform);
+	static std::string samplingSummary(const Sampler &sampler,Cpu::Counter instructions);
+	
+	static std::unique_ptr<std::ostream> openOutput(const std::string &filename);
+};
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Sampler class.
+ */
+
+#include "sampler.h"
+
+#include <stdexcept>
+#include <cmath>
+
+Sampler::Sampler(Counter period,Counter window,Counter warmup):
+	_period(period),
+	_window(window),
+	_warmup(warmup)
+{
+	if(window==0||period<window+warmup) throw std::runtime_error("Invalid sampling parameters");
+}
+
+/*
+ * Same as Simulator::run(). A window interrupted by the end of the
+ * run is not counted.
+ */
+
+Sampler::Counter Sampler::run(Simulator &sim,Counter cycles) {
+	auto &cpu=sim.cpu();
+	auto start=cpu.cycles();
+	auto functional=_period-_window-_warmup;
+	
+	while(!sim.finished()&&cpu.cycles()-start<cycles) {
+		Counter phaseEnd;
+		bool window=false;
+		if(_position<functional) phaseEnd=functional;
+		else if(_position<functional+_warmup) phaseEnd=functional+_warmup;
+		else {
+			phaseEnd=_period;
+			window=true;
+		}
+		
+		bool detailed=(_position>=functional);
+		cpu.setICacheTiming(detailed);
+		
+		auto c=cpu.cycles();
+		auto i=cpu.instructions();
+		sim.run(cycles-(c-start),phaseEnd-_position);
+		auto executed=cpu.instructions()-i;
+		
+		if(detailed) _detailed+=executed;
+		if(window) {
+			_windowCycles+=cpu.cycles()-c;
+			_windowInstructions+=executed;
+		}
+		_position+=executed;
+		
+// Idle skipping can overshoot the end of a phase
+		if(_position>=_period) {
+			if(window&&_windowInstructions>0) {
+				auto cpi=static_cast<double>(_windowCycles)/static_cast<double>(_windowInstructions);
+				_samples++;
+				_sum+=cpi;
+				_sumSquares+=cpi*cpi;
+			}
+			_position=0;
+			_windowCycles=0;
+			_windowInstructions=0;
+		}
+	}
+	
+	cpu.setICacheTiming(true);
+	return cpu.cycles()-start;
+}
+
+Sampler::Counter Sampler::samples() const {
+	return _samples;
+}
+
+Sampler::Counter Sampler::detailedInstructions() const {
+	return _detailed;
+}
+
+double Sampler::meanCpi() const {
+	if(_samples==0) return 0;
+	return _sum/static_cast<double>(_samples);
+}
+
+/*
+ * Half-width of the 95% confidence interval for the mean CPI
+ * (normal approximation), 0 if there are less than two samples
+ */
+
+double Sampler::confidence() const {
+	if(_samples<2) return 0;
+	auto n=static_cast<double>(_samples);
+	auto mean=_sum/n;
+	auto variance=(_sumSquares-n*mean*mean)/(n-1);
+	if(variance<0) variance=0;
+	return 1.96*std::sqrt(variance/n);
+}
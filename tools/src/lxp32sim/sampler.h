@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Sampler class which runs a simulation in
+ * the sampling mode (in the style of SMARTS): the instruction stream
+ * is divided into periods, and most of each period is executed
+ * functionally, with the instruction cache timing turned off (the
+ * cache is only warmed). The end of each period is simulated in
+ * detail: a warm-up part, then a measurement window whose CPI is
+ * recorded. Total cycles are extrapolated from the mean CPI of all
+ * windows, with a confidence interval based on their variance.
+ */
+
+#ifndef SAMPLER_H_INCLUDED
+#define SAMPLER_H_INCLUDED
+
+#include "simulator.h"
+
+class Sampler {
+public:
+	typedef Simulator::Counter Counter;
+
+private:
+	Counter _period;
+	Counter _window;
+	Counter _warmup;
+	
+	Counter _position=0; // instructions executed in the current period
+	Counter _windowCycles=0;
+	Counter _windowInstructions=0;
+	
+	Counter _samples=0;
+	double _sum=0;
+	double _sumSquares=0;
+	Counter _detailed=0;
+
+public:
+	Sampler(Counter period,Counter window,Counter warmup);
+	
+	Counter run(Simulator &sim,Counter cycles);
+	
+	Counter samples() const;
+	Counter detailedInstructions() const;
+	double meanCpi() const;
+	double confidence() const;
+};
+
+#endif
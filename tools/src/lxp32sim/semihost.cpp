@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Semihost class.
+ */
+
+#include "semihost.h"
+
+Semihost::Semihost(): _files(MaxFiles) {}
+
+void Semihost::setConsole(std::ostream *os) {
+	_console=os;
+}
+
+bool Semihost::exited() const {
+	return _exited;
+}
+
+Semihost::Word Semihost::exitCode() const {
+	return _exitCode;
+}
+
+unsigned Semihost::read(Word addr,Word sel,Word &data) {
+	data=0;
+	switch(addr) {
+	case CyclesLo:
+		_cyclesHi=static_cast<Word>(_cycles>>32);
+		data=static_cast<Word>(_cycles);
+		break;
+	case CyclesHi:
+		data=_cyclesHi;
+		break;
+	case Status:
+		data=_status;
+		break;
+	case Data:
+		if(auto f=file()) {
+			for(int i=0;i<4;i++) {
+				if(!(sel&(1<<i))) continue;
+				auto ch=f->get();
+				if(ch==std::char_traits<char>::eof()) break;
+				data|=static_cast<Word>(static_cast<unsigned char>(ch))<<(i*8);
+			}
+			f->clear();
+		}
+		break;
+	case Avail:
+		if(auto f=file()) {
+			auto pos=f->tellg();
+			f->seekg(0,std::ios_base::end);
+			auto end=f->tellg();
+			f->seekg(pos);
+			if(pos>=0&&end>pos) data=static_cast<Word>(end-pos);
+			f->clear();
+		}
+		break;
+	}
+	return 0;
+}
+
+unsigned Semihost::write(Word addr,Word sel,Word data) {
+	switch(addr) {
+	case Putc:
+		for(int i=0;i<4;i++) {
+			if(sel&(1<<i)) {
+				if(_console) _console->put(static_cast<char>(data>>(i*8)));
+				break;
+			}
+		}
+		break;
+	case Exit:
+		_exitCode=data;
+		_exited=true;
+		break;
+	case Path:
+		for(int i=0;i<4;i++) {
+			if(sel&(1<<i)) {
+				_path.push_back(static_cast<char>(data>>(i*8)));
+				break;
+			}
+		}
+		break;
+	case Open:
+		open(data);
+		break;
+	case Handle:
+		_handle=data;
+		break;
+	case Data:
+		if(auto f=file()) {
+			for(int i=0;i<4;i++) {
+				if(sel&(1<<i)) f->put(static_cast<char>(data>>(i*8)));
+			}
+		}
+		break;
+	case Close:
+		if(data<MaxFiles) _files[data].reset();
+		break;
+	}
+	return 0;
+}
+
+void Semihost::clock() {
+	_cycles++;
+}
+
+void Semihost::skip(Counter n) {
+	_cycles+=n;
+}
+
+// Host files can't be restored, so semihosting is not a part of snapshots
+
+void Semihost::saveState(StateWriter &) const {}
+
+void Semihost::loadState(StateReader &) {}
+
+/*
+ * Private members
+ */
+
+std::fstream *Semihost::file() {
+	if(_handle>=MaxFiles) return nullptr;
+	return _files[_handle].get();
+}
+
+void Semihost::open(Word mode) {
+	std::string path;
+	path.swap(_path);
+	_status=Invalid;
+	
+	std::ios_base::openmode flags=std::ios_base::binary;
+	if(mode==0) flags|=std::ios_base::in;
+	else if(mode==1) flags|=std::ios_base::out|std::ios_base::trunc;
+	else if(mode==2) flags|=std::ios_base::out|std::ios_base::app;
+	else return;
+	
+	for(Word i=0;i<MaxFiles;i++) {
+		if(_files[i]) continue;
+		std::shared_ptr<std::fstream> f(new std::fstream(path,flags));
+		if(!*f) return;
+		_files[i]=f;
+		_status=i;
+		return;
+	}
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Semihost class, a simulator-only slave that
+ * gives the firmware access to the host: console output, host files,
+ * a cycle counter and an exit code. Register offsets are listed below
+ * and in semihost.inc, which can be included by the firmware.
+ *
+ * Files are identified by small integer handles. DATA transfers the
+ * bytes selected by SEL_I() (in ascending lane order) to or from the
+ * file selected with HANDLE, so word and byte accesses can be mixed.
+ * Bytes read beyond the end of a file are zero.
+ *
+ * Open files are shared between copies of the slave.
+ */
+
+#ifndef SEMIHOST_H_INCLUDED
+#define SEMIHOST_H_INCLUDED
+
+#include "peripherals.h"
+
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <string>
+
+class Semihost : public Slave {
+public:
+	enum Register {
+		Putc=0x00, // W: write the selected byte to the console
+		Exit=0x04, // W: stop the test with the written exit code
+		CyclesLo=0x08, // R: cycle counter, reading latches the high word
+		CyclesHi=0x0C, // R
+		Path=0x10, // W: append the selected byte to the file name
+		Open=0x14, // W: open the file (mode: 0 - read, 1 - write, 2 - append)
+		Status=0x18, // R: handle of the opened file or 0xFFFFFFFF
+		Handle=0x1C, // W: select a file for DATA and AVAIL
+		Data=0x20, // RW: transfer the selected bytes
+		Avail=0x24, // R: bytes left until the end of the file
+		Close=0x28 // W: close the file with the written handle
+	};
+	
+	static const Word MaxFiles=16;
+	static const Word Invalid=0xFFFFFFFF;
+
+private:
+	std::ostream *_console=nullptr;
+	bool _exited=false;
+	Word _exitCode=0;
+	Counter _cycles=0;
+	Word _cyclesHi=0;
+	std::string _path;
+	Word _status=Invalid;
+	Word _handle=0;
+	std::vector<std::shared_ptr<std::fstream> > _files;
+
+public:
+	Semihost();
+	
+	void setConsole(std::ostream *os);
+	bool exited() const;
+	Word exitCode() const;
+	
+	virtual unsigned read(Word addr,Word sel,Word &data) override;
+	virtual unsigned write(Word addr,Word sel,Word data) override;
+	virtual void clock() override;
+	virtual void skip(Counter n) override;
+	virtual void saveState(StateWriter &w) const override;
+	virtual void loadState(StateReader &r) override;
+
+private:
+	std::fstream *file();
+	void open(Word mode);
+};
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Simulator class.
+ */
+
+#include "simulator.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+
+static const char *snapshotId="LXP32SIM";
+static const std::uint32_t snapshotVersion=2;
+
+Simulator::Simulator(): _cpu(_platform) {}
+
+Simulator::Simulator(const Simulator &other):
+	_platform(other._platform),
+	_cpu(other._cpu),
+	_idleSkipping(other._idleSkipping)
+{
+	_cpu.setBus(_platform);
+}
+
+Simulator &Simulator::operator=(const Simulator &other) {
+	_platform=other._platform;
+	_cpu=other._cpu;
+	_idleSkipping=other._idleSkipping;
+	_cpu.setBus(_platform);
+	return *this;
+}
+
+Platform &Simulator::platform() {
+	return _platform;
+}
+
+const Platform &Simulator::platform() const {
+	return _platform;
+}
+
+Cpu &Simulator::cpu() {
+	return _cpu;
+}
+
+const Cpu &Simulator::cpu() const {
+	return _cpu;
+}
+
+void Simulator::setIdleSkipping(bool b) {
+	_idleSkipping=b;
+}
+
+void Simulator::loadImage(const std::vector<Word> &image) {
+	_platform.loadImage(image);
+}
+
+bool Simulator::finished() const {
+	return _platform.monitor().finished()||_platform.semihost().exited();
+}
+
+/*
+ * Run until the test monitor reports a result (or the firmware exits
+ * through semihosting), the specified number of cycles elapses or at
+ * least the specified number of instructions is executed. Returns the
+ * number of cycles executed.
+ * Idle periods are skipped without exceeding the cycle budget.
+ */
+
+Simulator::Counter Simulator::run(Counter cycles,Counter instructions) {
+	auto start=_cpu.cycles();
+	auto startInstructions=_cpu.instructions();
+	_cpu.resetLoopDetection(); // the platform could have been modified
+	while(!finished()&&_cpu.cycles()-start<cycles&&_cpu.instructions()-startInstructions<instructions)
+		_cpu.step(_idleSkipping?cycles-(_cpu.cycles()-start):0);
+	return _cpu.cycles()-start;
+}
+
+void Simulator::save(const std::string &filename) const {
+	std::ofstream out(filename,std::ios_base::out|std::ios_base::binary);
+	if(!out) throw std::runtime_error("Cannot open \""+filename+"\" for writing");
+	out.write(snapshotId,std::strlen(snapshotId));
+	StateWriter w(out);
+	w.word(snapshotVersion);
+	_cpu.saveState(w);
+	_platform.saveState(w);
+}
+
+void Simulator::restore(const std::string &filename) {
+	if(!isSnapshot(filename)) throw std::runtime_error("\""+filename+"\" is not a snapshot file");
+	std::ifstream in(filename,std::ios_base::in|std::ios_base::binary);
+	in.seekg(std::strlen(snapshotId));
+	StateReader r(in);
+	if(r.word()!=snapshotVersion) throw std::runtime_error("Unsupported snapshot version");
+	_cpu.loadState(r);
+	_platform.loadState(r);
+}
+
+bool Simulator::isSnapshot(const std::string &filename) {
+	auto idSize=std::strlen(snapshotId);
+	std::ifstream in(filename,std::ios_base::in|std::ios_base::binary);
+	if(!in) return false;
+	std::vector<char> buf(idSize);
+	in.read(buf.data(),idSize);
+	if(static_cast<std::size_t>(in.gcount())!=idSize) return false;
+	return !std::memcmp(buf.data(),snapshotId,idSize);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Simulator class which combines the CPU
+ * model with the test platform. A Simulator object can be copied
+ * (forked) cheaply since the program RAM is copy-on-write, and its
+ * complete state can be saved to a snapshot file and restored later.
+ */
+
+#ifndef SIMULATOR_H_INCLUDED
+#define SIMULATOR_H_INCLUDED
+
+#include "cpu.h"
+#include "platform.h"
+
+#include <vector>
+#include <string>
+
+class Simulator {
+	Platform _platform;
+	Cpu _cpu;
+	bool _idleSkipping=true;
+public:
+	typedef Cpu::Word Word;
+	typedef Cpu::Counter Counter;
+	
+	Simulator();
+	Simulator(const Simulator &other);
+	Simulator &operator=(const Simulator &other);
+	
+	Platform &platform();
+	const Platform &platform() const;
+	Cpu &cpu();
+	const Cpu &cpu() const;
+	
+	void setIdleSkipping(bool b);
+	
+	void loadImage(const std::vector<Word> &image);
+	bool finished() const;
+	Counter run(Counter cycles,Counter instructions=~Counter(0));
+	
+	void save(const std::string &filename) const;
+	void restore(const std::string &filename);
+	static bool isSnapshot(const std::string &filename);
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the StateWriter and
+ * StateReader classes.
+ */
+
+#include "state.h"
+
+#include <stdexcept>
+
+/*
+ * StateWriter members
+ */
+
+StateWriter::StateWriter(std::ostream &os): _os(os) {}
+
+void StateWriter::word(std::uint32_t w) {
+	char buf[4];
+	for(int i=0;i<4;i++) buf[i]=static_cast<char>(w>>(i*8));
+	_os.write(buf,4);
+	if(!_os) throw std::runtime_error("Cannot write snapshot");
+}
+
+void StateWriter::counter(std::uint64_t c) {
+	word(static_cast<std::uint32_t>(c));
+	word(static_cast<std::uint32_t>(c>>32));
+}
+
+void StateWriter::flag(bool b) {
+	word(b?1:0);
+}
+
+/*
+ * StateReader members
+ */
+
+StateReader::StateReader(std::istream &is): _is(is) {}
+
+std::uint32_t StateReader::word() {
+	char buf[4];
+	_is.read(buf,4);
+	if(_is.gcount()!=4) throw std::runtime_error("Unexpected end of snapshot");
+	std::uint32_t w=0;
+	for(int i=0;i<4;i++) w|=static_cast<std::uint32_t>(static_cast<unsigned char>(buf[i]))<<(i*8);
+	return w;
+}
+
+std::uint64_t StateReader::counter() {
+	std::uint64_t low=word();
+	std::uint64_t high=word();
+	return low|(high<<32);
+}
+
+bool StateReader::flag() {
+	return word()!=0;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the StateWriter and StateReader classes
+ * which are used to store simulator state in a snapshot file.
+ * Values are stored in little-endian byte order.
+ */
+
+#ifndef STATE_H_INCLUDED
+#define STATE_H_INCLUDED
+
+#include <iostream>
+#include <cstdint>
+
+class StateWriter {
+	std::ostream &_os;
+public:
+	StateWriter(std::ostream &os);
+	void word(std::uint32_t w);
+	void counter(std::uint64_t c);
+	void flag(bool b);
+};
+
+class StateReader {
+	std::istream &_is;
+public:
+	StateReader(std::istream &is);
+	std::uint32_t word();
+	std::uint64_t counter();
+	bool flag();
+};
+
+#endif
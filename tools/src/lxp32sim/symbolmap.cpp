@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the SymbolMap class.
+ */
+
+#include "symbolmap.h"
+#include "utils.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+void SymbolMap::load(std::istream &is) {
+	std::map<Word,std::string> objects;
+	std::string line;
+	
+	while(std::getline(is,line)) {
+		if(line.compare(0,8,"Object \"")==0) {
+// Object "name" at address XXXXXXXX
+			auto end=line.find('"',8);
+			auto pos=line.find(" at address ");
+			if(end==std::string::npos||pos==std::string::npos) continue;
+			objects.emplace(std::stoul(line.substr(pos+12),nullptr,16),line.substr(8,end-8));
+			continue;
+		}
+		
+// name XXXXXXXX Local|Exported
+		std::istringstream ss(line);
+		std::string name,addr,type;
+		if(!(ss>>name>>addr>>type)) continue;
+		if(type!="Local"&&type!="Exported") continue;
+		if(name.find('.')!=std::string::npos) continue; // perf_begin/perf_end markers
+		try {
+			addSymbol(std::stoul(addr,nullptr,16),name);
+		}
+		catch(std::exception &) {
+			throw std::runtime_error("Bad map file line: \""+line+"\"");
+		}
+	}
+	
+// Object names are used only where there is no label
+	for(auto const &obj: objects) _symbols.emplace(obj);
+}
+
+void SymbolMap::loadFile(const std::string &filename) {
+	std::ifstream in(filename);
+	if(!in) throw std::runtime_error("Cannot open \""+filename+"\"");
+	load(in);
+}
+
+void SymbolMap::addSymbol(Word addr,const std::string &name) {
+	_symbols[addr]=name;
+}
+
+bool SymbolMap::empty() const {
+	return _symbols.empty();
+}
+
+const std::map<SymbolMap::Word,std::string> &SymbolMap::symbols() const {
+	return _symbols;
+}
+
+/*
+ * Returns the name of the symbol defined exactly at the given
+ * address, or an empty string
+ */
+
+std::string SymbolMap::symbolAt(Word addr) const {
+	auto it=_symbols.find(addr);
+	if(it==_symbols.end()) return std::string();
+	return it->second;
+}
+
+/*
+ * Returns "symbol+offset" for the nearest preceding symbol,
+ * or a hexadecimal address if there is none
+ */
+
+std::string SymbolMap::resolve(Word addr) const {
+	auto it=_symbols.upper_bound(addr);
+	if(it==_symbols.begin()) return "0x"+Utils::hex(addr);
+	--it;
+	if(it->first==addr) return it->second;
+	return it->second+"+0x"+Utils::hex(static_cast<Word>(addr-it->first));
+}
+
+/*
+ * Returns the address of the nearest preceding symbol
+ * (0 if there is none)
+ */
+
+SymbolMap::Word SymbolMap::symbolAddress(Word addr) const {
+	auto it=_symbols.upper_bound(addr);
+	if(it==_symbols.begin()) return 0;
+	return (--it)->first;
+}
+
+/*
+ * Looks up a symbol by name
+ */
+
+bool SymbolMap::find(const std::string &name,Word &addr) const {
+	for(auto const &sym: _symbols) {
+		if(sym.second==name) {
+			addr=sym.first;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the SymbolMap class which maps code addresses
+ * to symbol names. Symbols are read from a map file produced
+ * by the linker (see Linker::generateMap()).
+ */
+
+#ifndef SYMBOLMAP_H_INCLUDED
+#define SYMBOLMAP_H_INCLUDED
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <cstdint>
+
+class SymbolMap {
+public:
+	typedef std::uint32_t Word;
+private:
+	std::map<Word,std::string> _symbols;
+public:
+	void load(std::istream &is);
+	void loadFile(const std::string &filename);
+	void addSymbol(Word addr,const std::string &name);
+	
+	bool empty() const;
+	const std::map<Word,std::string> &symbols() const;
+	
+	std::string symbolAt(Word addr) const;
+	std::string resolve(Word addr) const;
+	Word symbolAddress(Word addr) const;
+	bool find(const std::string &name,Word &addr) const;
+};
+
+#endif
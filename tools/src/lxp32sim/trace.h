@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the execution trace file format shared by
+ * the TraceWriter and TraceReader classes.
+ *
+ * A trace file starts with an 8-byte identifier and a version word.
+ * It is followed by a sequence of blocks, each block consisting of
+ * its raw size, compressed size and the LZ-compressed (see lz.h)
+ * records. Every block can be decoded independently. The file ends
+ * with the block index, the total number of instructions, the index
+ * offset and an 8-byte index identifier. All integers are
+ * little-endian.
+ *
+ * Record encoding: the first byte holds the record type (bits 0-1)
+ * and type-specific flags (bits 2-7). Variable-length integers use
+ * 7 bits per byte, least significant group first; signed values are
+ * zigzag-encoded.
+ *
+ *   Instruction: bit 2 - PC is not sequential (signed PC delta follows),
+ *                bit 3 - instruction word differs from the last one
+ *                        seen at this PC in the block (word follows),
+ *                bits 4-7 - cycle delta, 15 means that the delta
+ *                        follows as a variable-length integer.
+ *   Read, Write: bits 4-7 - byte select; followed by the signed
+ *                address delta and the data.
+ *   Interrupt:   bits 4-7 - vector; followed by the cycle delta.
+ */
+
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Trace {
+	typedef std::uint32_t Word;
+	typedef std::uint64_t Counter;
+	
+	static const char FileId[]="LXP32TRC";
+	static const char IndexId[]="LXP32IDX";
+	static const Word Version=1;
+	static const std::size_t IdSize=8;
+	
+	enum RecordType {InstructionRecord=0,ReadRecord=1,WriteRecord=2,InterruptRecord=3};
+	
+	static const std::uint8_t NonSequential=0x04;
+	static const std::uint8_t NewWord=0x08;
+	static const unsigned MaxInlineDelta=15;
+	
+// Size of the direct-mapped table of instruction words per PC
+	static const std::size_t WordTableSize=1024;
+	
+	struct Event {
+		enum Type {Instruction,Read,Write,Interrupt};
+		
+		Type type=Instruction;
+		Counter cycle=0; // of the instruction or interrupt (for bus accesses: of the instruction)
+		Word addr=0; // instruction: PC, bus access: byte address of the word
+		Word data=0; // instruction: instruction word, bus access: data
+		std::uint8_t sel=0; // bus access: byte select
+		int vector=0; // interrupt: vector number
+	};
+}
+
+#endif
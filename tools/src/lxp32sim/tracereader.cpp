@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the TraceReader class.
+ */
+
+#include "tracereader.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+#include <cstring>
+
+TraceReader::TraceReader(const std::string &filename):
+	_is(filename,std::ios_base::in|std::ios_base::binary),
+	_filename(filename),
+	_wordPc(Trace::WordTableSize),
+	_words(Trace::WordTableSize)
+{
+	if(!_is) throw std::runtime_error("Cannot open \""+filename+"\"");
+	
+	char id[Trace::IdSize];
+	_is.read(id,Trace::IdSize);
+	if(_is.gcount()!=Trace::IdSize||std::memcmp(id,Trace::FileId,Trace::IdSize))
+		throw std::runtime_error("\""+filename+"\" is not a trace file");
+	if(readWord()!=Trace::Version) throw std::runtime_error("Unsupported trace file version");
+	
+// Footer: instruction count, index offset, index identifier
+	_is.seekg(-static_cast<std::streamoff>(16+Trace::IdSize),std::ios_base::end);
+	_totalInstructions=readCounter();
+	auto indexOffset=readCounter();
+	_is.read(id,Trace::IdSize);
+	if(_is.gcount()!=Trace::IdSize||std::memcmp(id,Trace::IndexId,Trace::IdSize))
+		throw std::runtime_error("\""+filename+"\" has no index (the trace was not closed properly)");
+	
+	_is.seekg(indexOffset);
+	auto n=readWord();
+	for(Word i=0;i<n;i++) {
+		IndexEntry e;
+		e.offset=readCounter();
+		e.instruction=readCounter();
+		e.cycle=readCounter();
+		_index.push_back(e);
+	}
+}
+
+TraceReader::Counter TraceReader::instructions() const {
+	return _totalInstructions;
+}
+
+std::size_t TraceReader::blocks() const {
+	return _index.size();
+}
+
+/*
+ * Returns the index of the next instruction to be read
+ */
+
+TraceReader::Counter TraceReader::position() const {
+	return _instruction;
+}
+
+/*
+ * Returns the next event, or false at the end of the trace
+ */
+
+bool TraceReader::next(Event &e) {
+	while(_pos>=_raw.size()) {
+		if(!loadBlock(_block)) return false;
+	}
+	
+	auto header=byte();
+	auto type=header&0x03;
+	
+	if(type==Trace::InstructionRecord) {
+		Counter delta=header>>4;
+		if(delta>=Trace::MaxInlineDelta) delta=varint();
+		auto pc=_nextPc;
+		if(header&Trace::NonSequential) pc+=static_cast<Word>(signedVarint());
+		auto slot=(pc>>2)%Trace::WordTableSize;
+		if(header&Trace::NewWord) {
+			_wordPc[slot]=pc;
+			_words[slot]=word();
+		}
+		else if(_wordPc[slot]!=pc) corrupted();
+		
+		_cycle+=delta;
+		e.type=Event::Instruction;
+		e.cycle=_cycle;
+		e.addr=pc;
+		e.data=_words[slot];
+		e.sel=0;
+		e.vector=0;
+		_nextPc=pc+(((e.data>>26)==0x01)?8:4);
+		_instruction++;
+	}
+	else if(type==Trace::InterruptRecord) {
+		_cycle+=varint();
+		e.type=Event::Interrupt;
+		e.cycle=_cycle;
+		e.addr=0;
+		e.data=0;
+		e.sel=0;
+		e.vector=header>>4;
+	}
+	else {
+		_dataAddr+=static_cast<Word>(signedVarint());
+		e.type=(type==Trace::ReadRecord)?Event::Read:Event::Write;
+		e.cycle=_cycle;
+		e.addr=_dataAddr;
+		e.data=static_cast<Word>(varint());
+		e.sel=header>>4;
+		e.vector=0;
+	}
+	
+	return true;
+}
+
+/*
+ * Position the reader so that the next event returned by next()
+ * is the specified instruction. Only the block containing
+ * the instruction is decoded.
+ */
+
+void TraceReader::seek(Counter instruction) {
+	if(instruction>_totalInstructions) instruction=_totalInstructions;
+	
+	auto it=std::upper_bound(_index.begin(),_index.end(),instruction,
+		[](Counter i,const IndexEntry &e) {return i<e.instruction;});
+	if(it!=_index.begin()) --it;
+	
+	if(!loadBlock(it-_index.begin())) return;
+	
+	Event e;
+	for(;;) {
+		auto pos=_pos;
+		auto block=_block;
+		auto state=std::make_tuple(_instruction,_cycle,_nextPc,_dataAddr);
+		if(!next(e)) return;
+		if(e.type==Event::Instruction&&_instruction>instruction) {
+// Step back: the instruction record must be returned by the next call
+			if(block!=_block) loadBlock(block); // the record starts a new block
+			else {
+				_pos=pos;
+				std::tie(_instruction,_cycle,_nextPc,_dataAddr)=state;
+			}
+			return;
+		}
+	}
+}
+
+/*
+ * Private members
+ */
+
+bool TraceReader::loadBlock(std::size_t block) {
+	if(block>=_index.size()) {
+		_raw.clear();
+		_pos=0;
+		_block=_index.size();
+		_instruction=_totalInstructions;
+		return false;
+	}
+	
+	_is.clear();
+	_is.seekg(_index[block].offset);
+	auto rawSize=readWord();
+	auto compressedSize=readWord();
+	_compressed.resize(compressedSize);
+	_is.read(reinterpret_cast<char*>(_compressed.data()),compressedSize);
+	if(static_cast<Word>(_is.gcount())!=compressedSize) corrupted();
+	Lz::decompress(_compressed,rawSize,_raw);
+	
+	_block=block+1;
+	_pos=0;
+	_instruction=_index[block].instruction;
+	_cycle=_index[block].cycle;
+	_nextPc=0;
+	_dataAddr=0;
+	std::fill(_wordPc.begin(),_wordPc.end(),1);
+	return true;
+}
+
+std::uint8_t TraceReader::byte() {
+	if(_pos>=_raw.size()) corrupted();
+	return _raw[_pos++];
+}
+
+TraceReader::Counter TraceReader::varint() {
+	Counter value=0;
+	for(int shift=0;shift<64;shift+=7) {
+		auto b=byte();
+		value|=static_cast<Counter>(b&0x7F)<<shift;
+		if(!(b&0x80)) return value;
+	}
+	corrupted();
+	return 0;
+}
+
+std::int32_t TraceReader::signedVarint() {
+	auto v=static_cast<Word>(varint());
+	return static_cast<std::int32_t>((v>>1)^(~(v&1)+1));
+}
+
+TraceReader::Word TraceReader::word() {
+	Word w=0;
+	for(int i=0;i<4;i++) w|=static_cast<Word>(byte())<<(i*8);
+	return w;
+}
+
+TraceReader::Word TraceReader::readWord() {
+	char buf[4];
+	_is.read(buf,4);
+	if(_is.gcount()!=4) corrupted();
+	Word w=0;
+	for(int i=0;i<4;i++) w|=static_cast<Word>(static_cast<unsigned char>(buf[i]))<<(i*8);
+	return w;
+}
+
+TraceReader::Counter TraceReader::readCounter() {
+	Counter low=readWord();
+	Counter high=readWord();
+	return low|(high<<32);
+}
+
+void TraceReader::corrupted() const {
+	throw std::runtime_error("\""+_filename+"\" is corrupted");
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the TraceReader class which replays
+ * an execution trace recorded by TraceWriter. Random access
+ * to any instruction is supported through the block index.
+ */
+
+#ifndef TRACEREADER_H_INCLUDED
+#define TRACEREADER_H_INCLUDED
+
+#include "trace.h"
+#include "lz.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+class TraceReader {
+public:
+	typedef Trace::Word Word;
+	typedef Trace::Counter Counter;
+	typedef Trace::Event Event;
+
+private:
+	struct IndexEntry {
+		Counter offset;
+		Counter instruction;
+		Counter cycle;
+	};
+	
+	std::ifstream _is;
+	std::string _filename;
+	std::vector<IndexEntry> _index;
+	Counter _totalInstructions=0;
+	
+	std::size_t _block=0; // next block to load
+	Lz::Buffer _raw;
+	Lz::Buffer _compressed;
+	std::size_t _pos=0;
+	
+// Decoder state
+	Counter _instruction=0; // index of the next instruction
+	Counter _cycle=0;
+	Word _nextPc=0;
+	Word _dataAddr=0;
+	std::vector<Word> _wordPc;
+	std::vector<Word> _words;
+
+public:
+	TraceReader(const std::string &filename);
+	
+	Counter instructions() const;
+	std::size_t blocks() const;
+	Counter position() const;
+	
+	bool next(Event &e);
+	void seek(Counter instruction);
+
+private:
+	bool loadBlock(std::size_t block);
+	std::uint8_t byte();
+	Counter varint();
+	std::int32_t signedVarint();
+	Word word();
+	
+	Word readWord();
+	Counter readCounter();
+	void corrupted() const;
+};
+
+#endif
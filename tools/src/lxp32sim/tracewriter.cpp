@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the TraceWriter class.
+ */
+
+#include "tracewriter.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+TraceWriter::TraceWriter(const std::string &filename,std::size_t blockSize):
+	_os(filename,std::ios_base::out|std::ios_base::binary),
+	_filename(filename),
+	_blockSize(blockSize),
+	_wordPc(Trace::WordTableSize),
+	_words(Trace::WordTableSize)
+{
+	if(!_os) throw std::runtime_error("Cannot open \""+filename+"\" for writing");
+	_os.write(Trace::FileId,Trace::IdSize);
+	writeWord(Trace::Version);
+	_raw.reserve(_blockSize+64);
+}
+
+TraceWriter::~TraceWriter() {
+	try {
+		close();
+	}
+	catch(std::exception &) {}
+}
+
+void TraceWriter::interrupt(Counter cycle,int vector) {
+	if(_raw.size()>=_blockSize) flushBlock();
+	if(_raw.empty()) startBlock(cycle);
+	_raw.push_back(static_cast<std::uint8_t>(Trace::InterruptRecord|(vector<<4)));
+	putVarint(cycle-_cycle);
+	_cycle=cycle;
+}
+
+/*
+ * Write the last block and the index. Called automatically
+ * by the destructor.
+ */
+
+void TraceWriter::close() {
+	if(_closed) return;
+	_closed=true;
+	
+	flushBlock();
+	
+	auto indexOffset=static_cast<Counter>(_os.tellp());
+	writeWord(static_cast<Word>(_index.size()));
+	for(auto const &e: _index) {
+		writeCounter(e.offset);
+		writeCounter(e.instruction);
+		writeCounter(e.cycle);
+	}
+	writeCounter(_instructions);
+	writeCounter(indexOffset);
+	_os.write(Trace::IndexId,Trace::IdSize);
+	_os.close();
+	if(!_os) throw std::runtime_error("Cannot write \""+_filename+"\"");
+}
+
+/*
+ * Private members
+ */
+
+void TraceWriter::startBlock(Counter cycle) {
+	_index.push_back(IndexEntry {static_cast<Counter>(_os.tellp()),_instructions,cycle});
+	_cycle=cycle;
+	_nextPc=0;
+	_dataAddr=0;
+	std::fill(_wordPc.begin(),_wordPc.end(),1); // never matches an aligned PC
+}
+
+void TraceWriter::flushBlock() {
+	if(_raw.empty()) return;
+	Lz::compress(_raw,_compressed);
+	writeWord(static_cast<Word>(_raw.size()));
+	writeWord(static_cast<Word>(_compressed.size()));
+	_os.write(reinterpret_cast<const char*>(_compressed.data()),_compressed.size());
+	if(!_os) throw std::runtime_error("Cannot write \""+_filename+"\"");
+	_raw.clear();
+}
+
+void TraceWriter::writeWord(Word w) {
+	char buf[4];
+	for(int i=0;i<4;i++) buf[i]=static_cast<char>(w>>(i*8));
+	_os.write(buf,4);
+}
+
+void TraceWriter::writeCounter(Counter c) {
+	writeWord(static_cast<Word>(c));
+	writeWord(static_cast<Word>(c>>32));
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the TraceWriter class which records
+ * an execution trace (see trace.h).
+ */
+
+#ifndef TRACEWRITER_H_INCLUDED
+#define TRACEWRITER_H_INCLUDED
+
+#include "trace.h"
+#include "lz.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+class TraceWriter {
+public:
+	typedef Trace::Word Word;
+	typedef Trace::Counter Counter;
+	
+	static const std::size_t DefaultBlockSize=65536;
+
+private:
+	struct IndexEntry {
+		Counter offset;
+		Counter instruction;
+		Counter cycle;
+	};
+	
+	std::ofstream _os;
+	std::string _filename;
+	std::size_t _blockSize;
+	bool _closed=false;
+	
+	Lz::Buffer _raw;
+	Lz::Buffer _compressed;
+	std::vector<IndexEntry> _index;
+	
+// Encoder state, reset at the beginning of each block
+	Counter _instructions=0;
+	Counter _cycle=0;
+	Word _nextPc=0;
+	Word _dataAddr=0;
+	std::vector<Word> _wordPc;
+	std::vector<Word> _words;
+
+public:
+	TraceWriter(const std::string &filename,std::size_t blockSize=DefaultBlockSize);
+	~TraceWriter();
+	
+	void instruction(Counter cycle,Word pc,Word word) {
+		if(_raw.size()>=_blockSize) flushBlock();
+		if(_raw.empty()) startBlock(cycle);
+		
+		std::uint8_t header=Trace::InstructionRecord;
+		if(pc!=_nextPc) header|=Trace::NonSequential;
+		auto slot=(pc>>2)%Trace::WordTableSize;
+		if(_wordPc[slot]!=pc||_words[slot]!=word) header|=Trace::NewWord;
+		auto delta=cycle-_cycle;
+		header|=static_cast<std::uint8_t>((delta<Trace::MaxInlineDelta?delta:Trace::MaxInlineDelta)<<4);
+		
+		_raw.push_back(header);
+		if(delta>=Trace::MaxInlineDelta) putVarint(delta);
+		if(header&Trace::NonSequential) putSigned(static_cast<std::int32_t>(pc-_nextPc));
+		if(header&Trace::NewWord) {
+			putWord(word);
+			_wordPc[slot]=pc;
+			_words[slot]=word;
+		}
+		
+		_cycle=cycle;
+		_nextPc=pc+(((word>>26)==0x01)?8:4); // lc occupies two words
+		_instructions++;
+	}
+	
+	void read(Word addr,std::uint8_t sel,Word data) {
+		access(Trace::ReadRecord,addr,sel,data);
+	}
+	
+	void write(Word addr,std::uint8_t sel,Word data) {
+		access(Trace::WriteRecord,addr,sel,data);
+	}
+	
+	void interrupt(Counter cycle,int vector);
+	
+	void close();
+
+private:
+	void access(Trace::RecordType type,Word addr,std::uint8_t sel,Word data) {
+		if(_raw.empty()) return; // an access always follows an instruction in the same block
+		_raw.push_back(static_cast<std::uint8_t>(type|(sel<<4)));
+		putSigned(static_cast<std::int32_t>(addr-_dataAddr));
+		putVarint(data);
+		_dataAddr=addr;
+	}
+	
+	void putVarint(Counter value) {
+		while(value>=0x80) {
+			_raw.push_back(static_cast<std::uint8_t>(value|0x80));
+			value>>=7;
+		}
+		_raw.push_back(static_cast<std::uint8_t>(value));
+	}
+	
+	void putSigned(std::int32_t value) {
+		putVarint((static_cast<Word>(value)<<1)^static_cast<Word>(value>>31));
+	}
+	
+	void putWord(Word w) {
+		for(int i=0;i<4;i++) _raw.push_back(static_cast<std::uint8_t>(w>>(i*8)));
+	}
+	
+	void startBlock(Counter cycle);
+	void flushBlock();
+	void writeWord(Word w);
+	void writeCounter(Counter c);
+};
+
+#endif
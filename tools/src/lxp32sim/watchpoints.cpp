@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the Watchpoints class.
+ */
+
+#include "watchpoints.h"
+
+Watchpoints::Watchpoints(): _pages(std::size_t(1)<<(32-PageBits)) {}
+
+void Watchpoints::setTarget(Bus &target) {
+	_target=&target;
+}
+
+void Watchpoints::insert(Type type,Word addr,Word len) {
+	if(len==0) len=1;
+	_watches.push_back(Watch {type,addr,len});
+	updatePages(addr,len,1);
+}
+
+bool Watchpoints::remove(Type type,Word addr,Word len) {
+	if(len==0) len=1;
+	for(auto it=_watches.begin();it!=_watches.end();++it) {
+		if(it->type==type&&it->addr==addr&&it->len==len) {
+			_watches.erase(it);
+			updatePages(addr,len,-1);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Watchpoints::hit() const {
+	return _hit;
+}
+
+const Watchpoints::Watch &Watchpoints::lastHit() const {
+	return _lastHit;
+}
+
+void Watchpoints::clearHit() {
+	_hit=false;
+}
+
+unsigned Watchpoints::fetch(Word addr,Word &data) {
+	return _target->fetch(addr,data);
+}
+
+unsigned Watchpoints::read(Word addr,Word sel,Word &data) {
+	if(_pages[addr>>PageBits]) check(addr,sel,false);
+	return _target->read(addr,sel,data);
+}
+
+unsigned Watchpoints::write(Word addr,Word sel,Word data) {
+	if(_pages[addr>>PageBits]) check(addr,sel,true);
+	return _target->write(addr,sel,data);
+}
+
+std::uint8_t Watchpoints::clock() {
+	return _target->clock();
+}
+
+/*
+ * Private members
+ */
+
+void Watchpoints::check(Word addr,Word sel,bool write) {
+	for(auto const &w: _watches) {
+		if(w.type==WatchWrite&&!write) continue;
+		if(w.type==WatchRead&&write) continue;
+		for(Word i=0;i<4;i++) {
+			if(!(sel&(1<<i))) continue;
+			Word byte=addr+i;
+			if(byte-w.addr<w.len) { // wraps around for byte<w.addr
+				_hit=true;
+				_lastHit=w;
+				return;
+			}
+		}
+	}
+}
+
+void Watchpoints::updatePages(Word addr,Word len,int delta) {
+	Word end=addr+len-1;
+	if(end<addr) end=0xFFFFFFFF;
+	Word first=addr>>PageBits;
+	Word last=end>>PageBits;
+	for(Word p=first;;p++) {
+		_pages[p]=static_cast<std::uint16_t>(_pages[p]+delta);
+		if(p==last) break;
+	}
+}
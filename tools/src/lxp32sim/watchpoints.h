@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the Watchpoints class which is inserted
+ * between the CPU and the platform to detect data bus accesses
+ * to watched memory ranges. Like Breakpoints, it keeps per-page
+ * counters, so that accesses to pages without watchpoints are
+ * not slowed down.
+ */
+
+#ifndef WATCHPOINTS_H_INCLUDED
+#define WATCHPOINTS_H_INCLUDED
+
+#include "bus.h"
+
+#include <vector>
+#include <cstdint>
+
+class Watchpoints : public Bus {
+public:
+	enum Type {WatchWrite,WatchRead,WatchAccess};
+	
+	struct Watch {
+		Type type;
+		Word addr;
+		Word len;
+	};
+	
+	static const int PageBits=12;
+
+private:
+	Bus *_target=nullptr;
+	std::vector<Watch> _watches;
+	std::vector<std::uint16_t> _pages;
+	bool _hit=false;
+	Watch _lastHit;
+
+public:
+	Watchpoints();
+	
+	void setTarget(Bus &target);
+	
+	void insert(Type type,Word addr,Word len);
+	bool remove(Type type,Word addr,Word len);
+	
+	bool hit() const;
+	const Watch &lastHit() const;
+	void clearHit();
+	
+	virtual unsigned fetch(Word addr,Word &data) override;
+	virtual unsigned read(Word addr,Word sel,Word &data) override;
+	virtual unsigned write(Word addr,Word sel,Word data) override;
+	virtual std::uint8_t clock() override;
+
+private:
+	void check(Word addr,Word sel,bool write);
+	void updatePages(Word addr,Word len,int delta);
+};
+
+#endif
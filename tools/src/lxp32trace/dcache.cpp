@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the DCache class.
+ */
+
+#include "dcache.h"
+
+#include <stdexcept>
+
+static bool isPowerOfTwo(DCache::Word w) {
+	return w!=0&&(w&(w-1))==0;
+}
+
+DCache::DCache(const Config &config,unsigned latency,unsigned hitWaitStates):
+	_config(config),
+	_latency(latency),
+	_hitWaitStates(hitWaitStates)
+{
+	if(!isPowerOfTwo(config.lineSize)||config.lineSize<4)
+		throw std::runtime_error("Cache line size must be a power of two not less than 4");
+	if(!isPowerOfTwo(config.ways)) throw std::runtime_error("Cache associativity must be a power of two");
+	if(!isPowerOfTwo(config.size)||config.size<config.ways*config.lineSize)
+		throw std::runtime_error("Cache size must be a power of two not less than associativity times line size");
+	
+	_sets=config.size/(config.ways*config.lineSize);
+	while((Word(1)<<_lineShift)<config.lineSize) _lineShift++;
+	_lines.resize(config.size/config.lineSize);
+}
+
+void DCache::access(Word addr,bool write) {
+	auto lineAddr=addr>>_lineShift;
+	auto set=lineAddr&(_sets-1);
+	auto tag=lineAddr/_sets;
+	_time++;
+	
+	if(write) _stats.writes++;
+	else _stats.reads++;
+	
+	auto line=lookup(set,tag);
+	if(line) {
+		if(write) _stats.writeHits++;
+		else _stats.readHits++;
+		line->used=_time;
+		if(write&&_config.policy==WriteThrough) _stats.waitStates+=_latency;
+		else {
+			if(write) line->dirty=true;
+			_stats.waitStates+=_hitWaitStates;
+		}
+		return;
+	}
+	
+	if(write&&_config.policy==WriteThrough) { // no write allocation
+		_stats.waitStates+=_latency;
+		return;
+	}
+	
+	auto &v=victim(set);
+	if(v.valid&&v.dirty) {
+		_stats.writeBacks++;
+		_stats.waitStates+=burstCycles();
+	}
+	_stats.fills++;
+	_stats.waitStates+=burstCycles()+_hitWaitStates;
+	v.tag=tag;
+	v.valid=true;
+	v.dirty=write;
+	v.used=_time;
+}
+
+const DCache::Stats &DCache::stats() const {
+	return _stats;
+}
+
+std::string DCache::policyName(Policy policy) {
+	if(policy==WriteThrough) return "wt";
+	return "wb";
+}
+
+/*
+ * Private members
+ */
+
+DCache::Line *DCache::lookup(Word set,Word tag) {
+	auto first=&_lines[set*_config.ways];
+	for(Word i=0;i<_config.ways;i++) {
+		if(first[i].valid&&first[i].tag==tag) return &first[i];
+	}
+	return nullptr;
+}
+
+DCache::Line &DCache::victim(Word set) {
+	auto first=&_lines[set*_config.ways];
+	auto v=first;
+	for(Word i=0;i<_config.ways;i++) {
+		if(!first[i].valid) return first[i];
+		if(first[i].used<v->used) v=&first[i];
+	}
+	return *v;
+}
+
+unsigned DCache::burstCycles() const {
+	return _latency+(_config.lineSize/4-1);
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the DCache class, a model of a hypothetical
+ * data cache between the LXP32 data bus and a slow memory, used to
+ * estimate its benefit from recorded data bus transactions.
+ *
+ * The cache is set-associative with LRU replacement. Two write
+ * policies are supported: write-back with write allocation, and
+ * write-through without write allocation.
+ *
+ * Timing (in wait states of the data bus cycle): a hit costs
+ * "hitWaitStates". Filling a line costs "latency" cycles for the
+ * first word plus one cycle for each subsequent word (an incrementing
+ * burst); writing back a dirty line costs the same. A write-through
+ * write costs "latency" cycles. Without the cache, every access
+ * costs "latency" cycles.
+ */
+
+#ifndef DCACHE_H_INCLUDED
+#define DCACHE_H_INCLUDED
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class DCache {
+public:
+	typedef std::uint32_t Word;
+	typedef std::uint64_t Counter;
+	
+	enum Policy {WriteBack,WriteThrough};
+	
+	struct Config {
+		Word size; // in bytes
+		Word ways;
+		Word lineSize; // in bytes
+		Policy policy;
+	};
+	
+	struct Stats {
+		Counter reads=0;
+		Counter writes=0;
+		Counter readHits=0;
+		Counter writeHits=0;
+		Counter fills=0;
+		Counter writeBacks=0;
+		Counter waitStates=0;
+	};
+
+private:
+	struct Line {
+		Word tag=0;
+		bool valid=false;
+		bool dirty=false;
+		Counter used=0; // for LRU replacement
+	};
+	
+	Config _config;
+	unsigned _latency;
+	unsigned _hitWaitStates;
+	Word _sets;
+	Word _lineShift=0;
+	std::vector<Line> _lines; // "ways" consecutive lines per set
+	Counter _time=0;
+	Stats _stats;
+
+public:
+	DCache(const Config &config,unsigned latency,unsigned hitWaitStates);
+	
+	void access(Word addr,bool write);
+	const Stats &stats() const;
+	
+	static std::string policyName(Policy policy);
+
+private:
+	Line *lookup(Word set,Word tag);
+	Line &victim(Word set);
+	unsigned burstCycles() const;
+};
+
+#endif
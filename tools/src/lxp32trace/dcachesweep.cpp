@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module implements members of the DCacheSweep class.
+ */
+
+#include "dcachesweep.h"
+#include "tracereader.h"
+#include "parallel.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+
+void DCacheSweep::setRange(Word base,Word last) {
+	_rangeBase=base;
+	_rangeLast=last;
+}
+
+void DCacheSweep::load(const std::string &filename) {
+	std::ifstream in(filename,std::ios_base::in|std::ios_base::binary);
+	if(!in) throw std::runtime_error("Cannot open \""+filename+"\"");
+	char id[Trace::IdSize];
+	in.read(id,Trace::IdSize);
+	bool trace=(in.gcount()==Trace::IdSize&&!std::memcmp(id,Trace::FileId,Trace::IdSize));
+	in.close();
+	
+	if(trace) loadTrace(filename);
+	else loadLog(filename);
+}
+
+DCacheSweep::Counter DCacheSweep::reads() const {
+	return _reads;
+}
+
+DCacheSweep::Counter DCacheSweep::writes() const {
+	return _writes;
+}
+
+DCacheSweep::Counter DCacheSweep::cacheable() const {
+	return _accesses.size();
+}
+
+DCacheSweep::Counter DCacheSweep::cycles() const {
+	return _cycles;
+}
+
+std::vector<DCacheSweep::Result> DCacheSweep::run(const std::vector<DCache::Config> &configs,
+	unsigned latency,unsigned hitWaitStates,unsigned threads) const
+{
+	std::vector<Result> results(configs.size());
+	std::vector<std::string> errors(configs.size());
+	
+	Parallel::forEach(configs.size(),threads,[&](std::size_t i) {
+		try {
+			DCache cache(configs[i],latency,hitWaitStates);
+			for(auto a: _accesses) cache.access(a&~Word(3),(a&1)!=0);
+			results[i].config=configs[i];
+			results[i].stats=cache.stats();
+		}
+		catch(std::exception &ex) {
+			errors[i]=ex.what();
+		}
+	});
+	
+	for(auto const &err: errors) {
+		if(!err.empty()) throw std::runtime_error(err);
+	}
+	
+	return results;
+}
+
+/*
+ * Private members
+ */
+
+void DCacheSweep::loadTrace(const std::string &filename) {
+	TraceReader reader(filename);
+	TraceReader::Event e;
+	
+	while(reader.next(e)) {
+		if(e.type==TraceReader::Event::Instruction) _cycles=e.cycle;
+		else if(e.type==TraceReader::Event::Read) add(e.addr,false);
+		else if(e.type==TraceReader::Event::Write) add(e.addr,true);
+	}
+}
+
+// dbus_monitor log: "R|W <address> <sel> <data>" (hexadecimal) or "reset"
+
+void DCacheSweep::loadLog(const std::string &filename) {
+	std::ifstream in(filename);
+	if(!in) throw std::runtime_error("Cannot open \""+filename+"\"");
+	
+	std::string line;
+	Counter lineNumber=0;
+	
+	while(std::getline(in,line)) {
+		lineNumber++;
+		std::istringstream ss(line);
+		std::string type,addr,sel,data;
+		if(!(ss>>type)||type=="reset") continue;
+		try {
+			if(!(ss>>addr>>sel>>data)||(type!="R"&&type!="W")) throw std::exception();
+			add(static_cast<Word>(std::stoul(addr,nullptr,16)),type=="W");
+		}
+		catch(std::exception &) {
+			throw std::runtime_error(filename+":"+std::to_string(lineNumber)+": bad transaction \""+line+"\"");
+		}
+	}
+}
+
+void DCacheSweep::add(Word addr,bool write) {
+	if(write) _writes++;
+	else _reads++;
+	if(addr<_rangeBase||addr>_rangeLast) return;
+	_accesses.push_back((addr&~Word(3))|(write?1:0));
+}
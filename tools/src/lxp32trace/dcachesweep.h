@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * This module defines the DCacheSweep class which replays recorded
+ * data bus transactions through a set of data cache configurations
+ * (see DCache), one configuration per worker thread at a time.
+ *
+ * Transactions are read either from an execution trace recorded by
+ * lxp32sim or from a log written by the dbus_monitor testbench
+ * component (DBUS_LOG). Only transactions within the cacheable
+ * address range are replayed; the others are assumed to bypass
+ * the cache.
+ */
+
+#ifndef DCACHESWEEP_H_INCLUDED
+#define DCACHESWEEP_H_INCLUDED
+
+#include "dcache.h"
+
+#include <vector>
+#include <string>
+
+class DCacheSweep {
+public:
+	typedef DCache::Word Word;
+	typedef DCache::Counter Counter;
+	
+	struct Result {
+		DCache::Config config;
+		DCache::Stats stats;
+	};
+
+private:
+	Word _rangeBase=0;
+	Word _rangeLast=0x0FFFFFFF;
+	
+// Cacheable transactions: word address, bit 0 is set for writes
+	std::vector<Word> _accesses;
+	Counter _reads=0;
+	Counter _writes=0;
+	Counter _cycles=0; // 0 if unknown
+
+public:
+	void setRange(Word base,Word last);
+	void load(const std::string &filename);
+	
+	Counter reads() const;
+	Counter writes() const;
+	Counter cacheable() const;
+	Counter cycles() const;
+	
+	std::vector<Result> run(const std::vector<DCache::Config> &configs,
+		unsigned latency,unsigned hitWaitStates,unsigned threads) const;
+
+private:
+	void loadTrace(const std::string &filename);
+	void loadLog(const std::string &filename);
+	void add(Word addr,bool write);
+};
+
+#endif
@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2016 by Alex I. Kuznetsov.
+ *
+ * Part of the LXP32 CPU IP core.
+ *
+ * Main translation unit for the LXP32 execution trace viewer.
+ */
+
+#include "tracereader.h"
+#include "dcachesweep.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+
+static void displayUsage(std::ostream &os,const char *program) {
+	os<<std::endl;
+	os<<"Usage:"<<std::endl;
+	os<<"    "<<program<<" [ option(s) | input file ]"<<std::endl<<std::endl;
+	
+	os<<"Options:"<<std::endl;
+	os<<"    -h, --help   Display a short help message"<<std::endl;
+	os<<"    -i           Display trace information only"<<std::endl;
+	os<<"    -n <count>   Number of instructions to display, default: all"<<std::endl;
+	os<<"    -o <file>    Output file name, default: standard output"<<std::endl;
+	os<<"    -s <index>   Index of the first instruction to display, default: 0"<<std::endl;
+	os<<"    --           Do not interpret subsequent arguments as options"<<std::endl;
+	os<<std::endl;
+	os<<"Data cache analysis options:"<<std::endl;
+	os<<"    -dcache               Estimate the effect of a data cache instead of"<<std::endl;
+	os<<"                          displaying the trace"<<std::endl;
+	os<<"    -hit <cycles>         Wait states on a cache hit, default: 1"<<std::endl;
+	os<<"    -j <threads>          Number of threads, default: number of CPU cores"<<std::endl;
+	os<<"    -latency <cycles>     Memory latency, default: 10"<<std::endl;
+	os<<"    -line <list>          Line sizes in bytes, default: 16,32"<<std::endl;
+	os<<"    -policy <list>        Write policies (wb, wt), default: wb,wt"<<std::endl;
+	os<<"    -range <base>,<size>  Cacheable address range, default: 0,0x10000000"<<std::endl;
+	os<<"    -size <list>          Cache sizes in bytes (K suffix allowed),"<<std::endl;
+	os<<"                          default: 1K,2K,4K,8K"<<std::endl;
+	os<<"    -ways <list>          Associativities, default: 1,2,4"<<std::endl;
+	os<<std::endl;
+	os<<"Input file is an execution trace recorded by lxp32sim with the -trace option."<<std::endl;
+	os<<"With -dcache, it can also be a data bus log written by the dbus_monitor"<<std::endl;
+	os<<"testbench component."<<std::endl;
+}
+
+static std::string hex(std::uint32_t w) {
+	std::ostringstream ss;
+	ss<<std::hex<<std::uppercase<<std::setfill('0')<<std::setw(8)<<w;
+	return ss.str();
+}
+
+static TraceReader::Counter parseCounter(const char *str,const char *what) {
+	try {
+		return std::stoull(str,nullptr,0);
+	}
+	catch(std::exception &) {
+		throw std::runtime_error(std::string("Invalid ")+what);
+	}
+}
+
+// Comma-separated list of numbers, optionally with a "K" (kibibytes) suffix
+
+static std::vector<DCache::Word> parseList(const std::string &str,const char *what) {
+	std::vector<DCache::Word> list;
+	std::istringstream ss(str);
+	std::string item;
+	while(std::getline(ss,item,',')) {
+		DCache::Word scale=1;
+		if(!item.empty()&&(item.back()=='K'||item.back()=='k')) {
+			scale=1024;
+			item.pop_back();
+		}
+		if(item.empty()||item.find_first_not_of("0123456789abcdefABCDEFxX")!=std::string::npos)
+			throw std::runtime_error(std::string("Invalid ")+what);
+		auto value=parseCounter(item.c_str(),what)*scale;
+		if(value>0xFFFFFFFF) throw std::runtime_error(std::string("Invalid ")+what);
+		list.push_back(static_cast<DCache::Word>(value));
+	}
+	if(list.empty()) throw std::runtime_error(std::string("Invalid ")+what);
+	return list;
+}
+
+static void analyzeDCache(std::ostream &os,const DCacheSweep &sweep,
+	const std::vector<DCache::Config> &configs,unsigned latency,unsigned hitWaitStates,unsigned threads)
+{
+	auto results=sweep.run(configs,latency,hitWaitStates,threads);
+	DCache::Counter uncached=sweep.cacheable()*latency;
+	
+	os<<"Data bus transactions: "<<sweep.reads()+sweep.writes()<<" (";
+	os<<sweep.reads()<<" reads, "<<sweep.writes()<<" writes), cacheable: "<<sweep.cacheable()<<std::endl;
+	os<<"Wait states without cache: "<<uncached<<std::endl;
+	if(sweep.cycles()>0) {
+		os<<"Trace cycles: "<<sweep.cycles()<<std::endl;
+		os<<"Projected cycles without cache: "<<sweep.cycles()+uncached<<std::endl;
+	}
+	os<<std::endl;
+	
+	os<<std::setw(8)<<"Size"<<std::setw(6)<<"Ways"<<std::setw(6)<<"Line"<<std::setw(8)<<"Policy";
+	os<<std::setw(10)<<"Hit rate"<<std::setw(14)<<"Wait states"<<std::setw(14)<<"Saved";
+	if(sweep.cycles()>0) os<<std::setw(10)<<"Saved %";
+	os<<std::endl;
+	
+	os<<std::fixed<<std::setprecision(2);
+	for(auto const &r: results) {
+		auto const &st=r.stats;
+		auto accesses=st.reads+st.writes;
+		double hitRate=accesses?100.0*(st.readHits+st.writeHits)/accesses:0;
+		auto saved=static_cast<long long>(uncached)-static_cast<long long>(st.waitStates);
+		os<<std::setw(8)<<r.config.size<<std::setw(6)<<r.config.ways<<std::setw(6)<<r.config.lineSize;
+		os<<std::setw(8)<<DCache::policyName(r.config.policy);
+		os<<std::setw(9)<<hitRate<<"%"<<std::setw(14)<<st.waitStates<<std::setw(14)<<saved;
+		if(sweep.cycles()>0) os<<std::setw(9)<<100.0*saved/(sweep.cycles()+uncached)<<"%";
+		os<<std::endl;
+	}
+}
+
+int main(int argc,char *argv[]) try {
+	std::string inputFileName,outputFileName;
+	bool noMoreOptions=false;
+	bool infoOnly=false;
+	TraceReader::Counter start=0;
+	TraceReader::Counter count=~TraceReader::Counter(0);
+	bool dcache=false;
+	std::vector<DCache::Word> sizes={1024,2048,4096,8192};
+	std::vector<DCache::Word> ways={1,2,4};
+	std::vector<DCache::Word> lineSizes={16,32};
+	std::vector<DCache::Policy> policies={DCache::WriteBack,DCache::WriteThrough};
+	unsigned latency=10;
+	unsigned hitWaitStates=1;
+	unsigned threads=0;
+	DCache::Word rangeBase=0;
+	DCache::Word rangeLast=0x0FFFFFFF;
+	
+	std::cerr<<"LXP32 Execution Trace Viewer"<<std::endl;
+	std::cerr<<"Copyright (c) 2016-2019 by Alex I. Kuznetsov"<<std::endl;
+	
+	if(argc<=1) {
+		displayUsage(std::cout,argv[0]);
+		return 0;
+	}
+	
+	for(int i=1;i<argc;i++) {
+		if(argv[i][0]!='-'||noMoreOptions) {
+			if(inputFileName.empty()) inputFileName=argv[i];
+			else throw std::runtime_error("Only one input file name can be specified");
+		}
+		else if(!strcmp(argv[i],"--")) noMoreOptions=true;
+		else if(!strcmp(argv[i],"-h")||!strcmp(argv[i],"--help")) {
+			displayUsage(std::cout,argv[0]);
+			return 0;
+		}
+		else if(!strcmp(argv[i],"-dcache")) {
+			dcache=true;
+		}
+		else if(!strcmp(argv[i],"-hit")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			hitWaitStates=static_cast<unsigned>(parseCounter(argv[i],"hit wait states"));
+		}
+		else if(!strcmp(argv[i],"-i")) {
+			infoOnly=true;
+		}
+		else if(!strcmp(argv[i],"-j")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			threads=static_cast<unsigned>(parseCounter(argv[i],"number of threads"));
+			if(threads==0) throw std::runtime_error("Invalid number of threads");
+		}
+		else if(!strcmp(argv[i],"-latency")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			latency=static_cast<unsigned>(parseCounter(argv[i],"memory latency"));
+		}
+		else if(!strcmp(argv[i],"-line")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			lineSizes=parseList(argv[i],"line size list");
+		}
+		else if(!strcmp(argv[i],"-n")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			count=parseCounter(argv[i],"instruction count");
+		}
+		else if(!strcmp(argv[i],"-o")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			outputFileName=argv[i];
+		}
+		else if(!strcmp(argv[i],"-policy")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			policies.clear();
+			std::istringstream ss(argv[i]);
+			std::string item;
+			while(std::getline(ss,item,',')) {
+				if(item=="wb") policies.push_back(DCache::WriteBack);
+				else if(item=="wt") policies.push_back(DCache::WriteThrough);
+				else throw std::runtime_error("Invalid write policy: \""+item+"\"");
+			}
+			if(policies.empty()) throw std::runtime_error("Invalid write policy list");
+		}
+		else if(!strcmp(argv[i],"-range")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			auto range=parseList(argv[i],"cacheable address range");
+			if(range.size()!=2||range[1]==0||range[1]-1>0xFFFFFFFF-range[0])
+				throw std::runtime_error("Invalid cacheable address range");
+			rangeBase=range[0];
+			rangeLast=range[0]+(range[1]-1);
+		}
+		else if(!strcmp(argv[i],"-s")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			start=parseCounter(argv[i],"instruction index");
+		}
+		else if(!strcmp(argv[i],"-size")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			sizes=parseList(argv[i],"cache size list");
+		}
+		else if(!strcmp(argv[i],"-ways")) {
+			if(++i==argc) {
+				displayUsage(std::cerr,argv[0]);
+				return EXIT_FAILURE;
+			}
+			ways=parseList(argv[i],"associativity list");
+		}
+		else throw std::runtime_error(std::string("Unrecognized option: \"")+argv[i]+"\"");
+	}
+	
+	if(inputFileName.empty()) throw std::runtime_error("No input file name was specified");
+	
+	std::ofstream out;
+	std::ostream *os=&std::cout;
+	if(!outputFileName.empty()) {
+		out.open(outputFileName,std::ios_base::out);
+		if(!out) throw std::runtime_error("Cannot open \""+outputFileName+"\"");
+		os=&out;
+	}
+	
+	if(dcache) {
+		std::vector<DCache::Config> configs;
+		for(auto size: sizes) {
+			for(auto w: ways) {
+				for(auto line: lineSizes) {
+					for(auto policy: policies) configs.push_back({size,w,line,policy});
+				}
+			}
+		}
+		
+		DCacheSweep sweep;
+		sweep.setRange(rangeBase,rangeLast);
+		sweep.load(inputFileName);
+		analyzeDCache(*os,sweep,configs,latency,hitWaitStates,threads);
+		return 0;
+	}
+	
+	TraceReader reader(inputFileName);
+	
+	if(infoOnly) {
+		*os<<"Instructions: "<<reader.instructions()<<std::endl;
+		*os<<"Blocks: "<<reader.blocks()<<std::endl;
+		return 0;
+	}
+	
+	reader.seek(start);
+	
+// Instruction index, cycle, address, data
+	TraceReader::Event e;
+	TraceReader::Counter displayed=0;
+	
+	while(reader.next(e)) {
+		switch(e.type) {
+		case TraceReader::Event::Instruction:
+			if(displayed==count) return 0;
+			displayed++;
+			*os<<std::setw(12)<<reader.position()-1<<std::setw(14)<<e.cycle;
+			*os<<"  "<<hex(e.addr)<<": "<<hex(e.data)<<std::endl;
+			break;
+		case TraceReader::Event::Interrupt:
+			*os<<std::setw(26)<<e.cycle<<"  interrupt "<<e.vector<<std::endl;
+			break;
+		default:
+			*os<<std::setw(40)<<((e.type==TraceReader::Event::Read)?"read  ":"write ");
+			*os<<hex(e.addr)<<" sel="<<static_cast<int>(e.sel)<<" data="<<hex(e.data)<<std::endl;
+			break;
+		}
+	}
+}
+catch(std::exception &ex) {
+	std::cerr<<"Error: "<<ex.what()<<std::endl;
+	return EXIT_FAILURE;
+}
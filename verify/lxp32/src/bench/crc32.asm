@@ -0,0 +1,138 @@
+/*
+ * Benchmark: CRC-32 (IEEE 802.3, reflected). The first 1 KB of data
+ * is processed bit by bit, then a 256-entry lookup table is built
+ * and all 4 KB are processed byte by byte.
+ */
+
+#define DATA 0x00008000
+#define TABLE 0x00004000
+#define WORDS 1024
+#define BITWISE_BYTES 1024
+#define TABLE_BYTES 4096
+#define EXPECTED_BITWISE 0x9BA8B4E3
+#define EXPECTED_TABLE 0xD19AF2D3
+
+	lc r100, 0x10000000 // test result output pointer
+	lc r101, halt
+	lc r102, failure
+	lc sp, 0x00010000 // stack pointer
+	
+// Generate the data
+	lc r30, DATA
+	lc r31, WORDS
+	lc r32, 0x12345678 // xorshift state
+	lc r35, generate_loop
+generate_loop:
+	sl r0, r32, 13
+	xor r32, r32, r0
+	sru r0, r32, 17
+	xor r32, r32, r0
+	sl r0, r32, 5
+	xor r32, r32, r0
+	sw r30, r32
+	add r30, r30, 4
+	sub r31, r31, 1
+	cjmpne r35, r31, 0 // generate_loop
+
+#perf_begin kernel
+	lc r1, DATA
+	lc r2, BITWISE_BYTES
+	lc r0, crc32_bitwise
+	call r0
+	mov r40, r0
+	
+	lc r1, TABLE
+	lc r0, crc32_make_table
+	call r0
+	
+	lc r1, DATA
+	lc r2, TABLE_BYTES
+	lc r3, TABLE
+	lc r0, crc32_table
+	call r0
+	mov r41, r0
+#perf_end kernel
+
+	lc r0, EXPECTED_BITWISE
+	cjmpne r102, r40, r0 // failure
+	lc r0, EXPECTED_TABLE
+	cjmpne r102, r41, r0 // failure
+	
+	sw r100, 1
+	jmp r101 // halt
+
+failure:
+	sw r100, 2
+
+halt:
+	hlt
+	jmp r101 // halt
+	
+// CRC of r2 bytes (non-zero) at r1, bit by bit, returned in r0
+crc32_bitwise:
+	lc r0, 0xFFFFFFFF
+	lc r6, 0xEDB88320 // reflected polynomial
+	lc r7, crc32_bitwise_byte
+	lc r8, crc32_bitwise_bit
+crc32_bitwise_byte:
+	lub r3, r1
+	xor r0, r0, r3
+	mov r4, 8
+crc32_bitwise_bit:
+// Branchless: crc=(crc>>1)^(poly&-(crc&1))
+	and r5, r0, 1
+	neg r5, r5
+	and r5, r5, r6
+	sru r0, r0, 1
+	xor r0, r0, r5
+	sub r4, r4, 1
+	cjmpne r8, r4, 0 // crc32_bitwise_bit
+	add r1, r1, 1
+	sub r2, r2, 1
+	cjmpne r7, r2, 0 // crc32_bitwise_byte
+	not r0, r0
+	ret
+	
+// Build the lookup table at r1 (1 KB)
+crc32_make_table:
+	mov r2, 0 // byte value
+	lc r6, 0xEDB88320
+	lc r7, crc32_make_table_entry
+	lc r8, crc32_make_table_bit
+	lc r9, 256
+crc32_make_table_entry:
+	mov r0, r2
+	mov r4, 8
+crc32_make_table_bit:
+	and r5, r0, 1
+	neg r5, r5
+	and r5, r5, r6
+	sru r0, r0, 1
+	xor r0, r0, r5
+	sub r4, r4, 1
+	cjmpne r8, r4, 0 // crc32_make_table_bit
+	sw r1, r0
+	add r1, r1, 4
+	add r2, r2, 1
+	cjmpne r7, r2, r9 // crc32_make_table_entry
+	ret
+	
+// CRC of r2 bytes (non-zero) at r1 using the table at r3, returned in r0
+crc32_table:
+	lc r0, 0xFFFFFFFF
+	lc r6, 0xFF
+	lc r7, crc32_table_loop
+crc32_table_loop:
+	lub r4, r1
+	xor r4, r4, r0
+	and r4, r4, r6
+	sl r4, r4, 2
+	add r4, r4, r3
+	lw r4, r4
+	sru r0, r0, 8
+	xor r0, r0, r4
+	add r1, r1, 1
+	sub r2, r2, 1
+	cjmpne r7, r2, 0 // crc32_table_loop
+	not r0, r0
+	ret
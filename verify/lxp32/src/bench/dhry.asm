@@ -0,0 +1,195 @@
+/*
+ * Benchmark: a Dhrystone-like mix of procedure calls, string copy
+ * and comparison, record assignment, integer arithmetic (including
+ * multiplication and division) and branches, repeated 1000 times.
+ * The hardware divider is used if the core has one (it is detected
+ * at run time), otherwise rt_divu_restoring from the runtime library
+ * is called (link with lxp32rt.la).
+ */
+
+#include "lxp32rt.inc"
+
+#define ITERATIONS 1000
+#define REC_WORDS 12
+#define EXPECTED 0x7A153C2D
+
+	lc r100, 0x10000000 // test result output pointer
+	lc r101, halt
+	lc r102, failure
+	lc sp, 0x00010000 // stack pointer
+	
+// Select the division routine: without the divider, "divu" returns 0
+	lc r20, hw_divu
+	lc r22, divider_selected
+	mov r0, 7
+	divu r0, r0, 2
+	cjmpe r22, r0, 3 // divider_selected
+	lc r20, rt_divu_restoring
+divider_selected:
+
+#perf_begin kernel
+	mov r30, 1 // iteration
+	mov r32, 0 // checksum
+	lc r31, ITERATIONS
+	lc r33, main_loop
+	lc r34, case1
+	lc r35, case2
+	lc r36, case3
+	lc r37, switch_end
+main_loop:
+// String assignment and comparison
+	lc r1, buffer
+	lc r2, str2
+	lc r0, proc_strcpy
+	call r0
+	lc r1, buffer
+	lc r2, str1
+	lc r0, proc_strcmp
+	call r0
+	mov r43, r0
+	
+// Integer arithmetic
+	and r40, r30, 3
+	add r40, r40, 2 // int1
+	mov r41, 3 // int2
+	mul r42, r40, 5
+	sub r42, r42, r41 // int3=5*int1-int2
+	mov r1, r40
+	mov r2, r41
+	lc r0, proc_7
+	call r0
+	mov r44, r0
+	mul r41, r41, r40 // int2=int2*int1
+	mov r1, r41
+	mov r2, r42
+	call r20
+	mov r40, r0 // int1=int2/int3
+	sub r0, r41, r42
+	mul r41, r0, 7
+	sub r41, r41, r40 // int2=7*(int2-int3)-int1
+	
+// Record assignment, then modify both records
+	lc r1, rec_b
+	lc r2, rec_a
+	lc r0, proc_record
+	call r0
+	lc r1, rec_b
+	add r1, r1, 4
+	sw r1, r42
+	and r0, r30, 7
+	sl r0, r0, 2
+	lc r1, rec_a
+	add r1, r1, r0
+	lw r2, r1
+	add r2, r2, r40
+	sw r1, r2
+	lc r1, rec_b
+	add r1, r1, r0
+	lw r46, r1
+	
+// Switch on an enumeration
+	and r0, r30, 3
+	cjmpe r34, r0, 1 // case1
+	cjmpe r35, r0, 2 // case2
+	cjmpe r36, r0, 3 // case3
+	mov r45, 10
+	jmp r37 // switch_end
+case1:
+	mov r45, 20
+	jmp r37 // switch_end
+case2:
+	mov r45, 30
+	jmp r37 // switch_end
+case3:
+	mov r45, 40
+switch_end:
+
+// Add everything to the checksum
+	add r0, r40, r41
+	add r0, r0, r42
+	add r0, r0, r43
+	add r0, r0, r44
+	add r0, r0, r45
+	add r0, r0, r46
+	sl r1, r32, 3
+	sru r2, r32, 29
+	or r32, r1, r2
+	xor r32, r32, r0
+	
+	add r30, r30, 1
+	cjmpuge r33, r31, r30 // main_loop
+#perf_end kernel
+
+	lc r0, EXPECTED
+	cjmpne r102, r32, r0 // failure
+	
+	sw r100, 1
+	jmp r101 // halt
+
+failure:
+	sw r100, 2
+
+halt:
+	hlt
+	jmp r101 // halt
+	
+// Copy the null-terminated string at r2 to r1
+proc_strcpy:
+	lc r4, proc_strcpy_loop
+proc_strcpy_loop:
+	lub r3, r2
+	sb r1, r3
+	add r1, r1, 1
+	add r2, r2, 1
+	cjmpne r4, r3, 0 // proc_strcpy_loop
+	ret
+	
+// Compare the null-terminated strings at r1 and r2, return the
+// difference of the first mismatching characters in r0
+proc_strcmp:
+	lc r5, proc_strcmp_loop
+proc_strcmp_loop:
+	lub r3, r1
+	lub r4, r2
+	sub r0, r3, r4
+	cjmpne rp, r0, 0
+	add r1, r1, 1
+	add r2, r2, 1
+	cjmpne r5, r3, 0 // proc_strcmp_loop
+	ret
+
+proc_7:
+	add r0, r1, r2
+	add r0, r0, 2
+	ret
+	
+// Copy a record from r2 to r1
+proc_record:
+	mov r3, REC_WORDS
+	lc r5, proc_record_loop
+proc_record_loop:
+	lw r4, r2
+	sw r1, r4
+	add r1, r1, 4
+	add r2, r2, 4
+	sub r3, r3, 1
+	cjmpne r5, r3, 0 // proc_record_loop
+	ret
+
+hw_divu:
+	divu r0, r1, r2
+	modu r1, r1, r2
+	ret
+
+str1:
+	.byte "DHRYSTONE PROGRAM, 1'ST STRING", 0
+str2:
+	.byte "DHRYSTONE PROGRAM, 2'ND STRING", 0
+buffer:
+	.reserve 32
+	
+	.align
+rec_a:
+	.word 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12
+rec_b:
+	.reserve 48
@@ -0,0 +1,116 @@
+/*
+ * Benchmark: 32-bit division. 512 pseudo-random pairs of operands
+ * with divisors of all magnitudes are divided as unsigned and signed
+ * numbers. The hardware divider is used if the core has one (it is
+ * detected at run time), otherwise rt_divu_restoring and
+ * rt_divs_restoring from the runtime library are called (link with
+ * lxp32rt.la).
+ */
+
+#include "lxp32rt.inc"
+
+#define PAIRS 512
+#define DATA 0x00008000
+#define EXPECTED 0x4BC7839B
+
+	lc r100, 0x10000000 // test result output pointer
+	lc r101, halt
+	lc r102, failure
+	lc sp, 0x00010000 // stack pointer
+	
+// Generate the operands: (dividend, divisor) pairs
+	lc r30, DATA
+	lc r31, PAIRS
+	lc r32, 0x12345678 // xorshift state
+	lc r35, generate_loop
+generate_loop:
+	sl r0, r32, 13
+	xor r32, r32, r0
+	sru r0, r32, 17
+	xor r32, r32, r0
+	sl r0, r32, 5
+	xor r32, r32, r0
+	sw r30, r32
+	sl r0, r32, 13
+	xor r32, r32, r0
+	sru r0, r32, 17
+	xor r32, r32, r0
+	sl r0, r32, 5
+	xor r32, r32, r0
+	and r0, r32, 31
+	sru r0, r32, r0
+	or r0, r0, 1
+	add r1, r30, 4
+	sw r1, r0
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r35, r31, 0 // generate_loop
+	
+// Select the division routines: without the divider, "divu" returns 0
+	lc r20, hw_divu
+	lc r21, hw_divs
+	lc r22, divider_selected
+	mov r0, 7
+	divu r0, r0, 2
+	cjmpe r22, r0, 3 // divider_selected
+	lc r20, rt_divu_restoring
+	lc r21, rt_divs_restoring
+divider_selected:
+
+#perf_begin kernel
+	lc r30, DATA
+	lc r31, PAIRS
+	mov r32, 0 // checksum
+	lc r33, kernel_loop
+	lc r36, mix
+kernel_loop:
+	lw r34, r30
+	add r0, r30, 4
+	lw r35, r0
+	mov r1, r34
+	mov r2, r35
+	call r20 // unsigned division
+	call r36 // mix
+	mov r1, r34
+	mov r2, r35
+	call r21 // signed division
+	call r36 // mix
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r33, r31, 0 // kernel_loop
+#perf_end kernel
+
+	lc r0, EXPECTED
+	cjmpne r102, r32, r0 // failure
+	
+	sw r100, 1
+	jmp r101 // halt
+
+failure:
+	sw r100, 2
+
+halt:
+	hlt
+	jmp r101 // halt
+	
+// Add the quotient (r0) and the remainder (r1) to the checksum
+mix:
+	sl r2, r32, 5
+	sru r3, r32, 27
+	or r32, r2, r3
+	add r32, r32, r0
+	sl r2, r32, 5
+	sru r3, r32, 27
+	or r32, r2, r3
+	add r32, r32, r1
+	ret
+
+hw_divu:
+	divu r0, r1, r2
+	modu r1, r1, r2
+	ret
+
+hw_divs:
+	divs r0, r1, r2
+	mods r1, r1, r2
+	ret
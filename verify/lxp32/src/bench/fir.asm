@@ -0,0 +1,133 @@
+/*
+ * Benchmark: 32-tap FIR filter applied to 1024 16-bit samples
+ * (multiply-accumulate with 32-bit words, the inner loop is
+ * unrolled by 4).
+ */
+
+#define SAMPLES 1024
+#define TAPS 32
+#define OUTPUTS 993 // SAMPLES-TAPS+1
+#define INPUT 0x00008000
+#define LAST_TAP_INPUT 0x0000807C // INPUT+(TAPS-1)*4
+#define OUTPUT 0x00006000
+#define COEFS 0x00004000
+#define EXPECTED 0xEB3508D6
+
+	lc r100, 0x10000000 // test result output pointer
+	lc r101, halt
+	lc r102, failure
+	lc sp, 0x00010000 // stack pointer
+	
+// Generate the input samples
+	lc r30, INPUT
+	lc r31, SAMPLES
+	lc r32, 0x12345678 // xorshift state
+	lc r35, generate_loop
+generate_loop:
+	sl r0, r32, 13
+	xor r32, r32, r0
+	sru r0, r32, 17
+	xor r32, r32, r0
+	sl r0, r32, 5
+	xor r32, r32, r0
+	sl r0, r32, 16
+	srs r0, r0, 16 // sign-extended 16-bit sample
+	sw r30, r0
+	add r30, r30, 4
+	sub r31, r31, 1
+	cjmpne r35, r31, 0 // generate_loop
+	
+// Coefficients: h[k]=(k+1)*(TAPS-k), a symmetric window
+	lc r30, COEFS
+	mov r31, 0
+	lc r35, coefs_loop
+coefs_loop:
+	add r0, r31, 1
+	sub r1, TAPS, r31
+	mul r0, r0, r1
+	sw r30, r0
+	add r30, r30, 4
+	add r31, r31, 1
+	cjmpne r35, r31, TAPS // coefs_loop
+
+#perf_begin kernel
+	lc r1, OUTPUT
+	lc r2, LAST_TAP_INPUT
+	lc r3, OUTPUTS
+	lc r0, fir
+	call r0
+#perf_end kernel
+
+// Verify the checksum of the output
+	lc r30, OUTPUT
+	lc r31, OUTPUTS
+	mov r32, 0
+	lc r35, checksum_loop
+checksum_loop:
+	lw r0, r30
+	sl r1, r32, 5
+	sru r2, r32, 27
+	or r32, r1, r2
+	add r32, r32, r0
+	add r30, r30, 4
+	sub r31, r31, 1
+	cjmpne r35, r31, 0 // checksum_loop
+	
+	lc r0, EXPECTED
+	cjmpne r102, r32, r0 // failure
+	
+	sw r100, 1
+	jmp r101 // halt
+
+failure:
+	sw r100, 2
+
+halt:
+	hlt
+	jmp r101 // halt
+	
+// Filter r3 outputs to r1, r2 points to the newest input sample of
+// the first output; y[n]=sum(h[k]*x[n-k])>>8
+fir:
+	lc r10, COEFS
+	lc r11, fir_output
+	lc r12, fir_taps
+fir_output:
+	mov r0, 0 // accumulator
+	mov r4, r10 // coefficient pointer
+	mov r5, r2 // input pointer (goes backwards)
+	mov r6, TAPS
+fir_taps:
+	lw r7, r4
+	lw r8, r5
+	mul r7, r7, r8
+	add r0, r0, r7
+	add r9, r4, 4
+	lw r7, r9
+	sub r9, r5, 4
+	lw r8, r9
+	mul r7, r7, r8
+	add r0, r0, r7
+	add r9, r4, 8
+	lw r7, r9
+	sub r9, r5, 8
+	lw r8, r9
+	mul r7, r7, r8
+	add r0, r0, r7
+	add r9, r4, 12
+	lw r7, r9
+	sub r9, r5, 12
+	lw r8, r9
+	mul r7, r7, r8
+	add r0, r0, r7
+	add r4, r4, 16
+	sub r5, r5, 16
+	sub r6, r6, 4
+	cjmpne r12, r6, 0 // fir_taps
+	srs r0, r0, 8
+	sw r1, r0
+	add r1, r1, 4
+	add r2, r2, 4
+	sub r3, r3, 1
+	cjmpne r11, r3, 0 // fir_output
+	ret
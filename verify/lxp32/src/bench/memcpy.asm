@@ -0,0 +1,137 @@
+/*
+ * Benchmark: memory fill and copy. A 16 KB buffer is filled with
+ * a pattern, 12 KB are copied over it word by word, then 2000 bytes
+ * are copied byte by byte between unaligned addresses.
+ */
+
+#define SRC 0x00004000
+#define DST 0x00008000
+#define WORDS 4096
+#define BYTE_SRC 0x00004001 // SRC+1
+#define BYTE_DST 0x0000B003 // DST+12291
+#define EXPECTED 0xCAC58BCC
+
+	lc r100, 0x10000000 // test result output pointer
+	lc r101, halt
+	lc r102, failure
+	lc sp, 0x00010000 // stack pointer
+	
+// Generate the source data
+	lc r30, SRC
+	lc r31, WORDS
+	lc r32, 0x12345678 // xorshift state
+	lc r35, generate_loop
+generate_loop:
+	sl r0, r32, 13
+	xor r32, r32, r0
+	sru r0, r32, 17
+	xor r32, r32, r0
+	sl r0, r32, 5
+	xor r32, r32, r0
+	sw r30, r32
+	add r30, r30, 4
+	sub r31, r31, 1
+	cjmpne r35, r31, 0 // generate_loop
+
+#perf_begin kernel
+	lc r1, DST
+	lc r2, 0x5A5A5A5A
+	lc r3, WORDS
+	lc r0, memset_words
+	call r0
+	
+	lc r1, DST
+	lc r2, SRC
+	lc r3, 3072
+	lc r0, memcpy_words
+	call r0
+	
+	lc r1, BYTE_DST
+	lc r2, BYTE_SRC
+	lc r3, 2000
+	lc r0, memcpy_bytes
+	call r0
+#perf_end kernel
+
+// Verify the checksum of the destination buffer
+	lc r30, DST
+	lc r31, WORDS
+	mov r32, 0
+	lc r35, checksum_loop
+checksum_loop:
+	lw r0, r30
+	sl r1, r32, 5
+	sru r2, r32, 27
+	or r32, r1, r2
+	xor r32, r32, r0
+	add r30, r30, 4
+	sub r31, r31, 1
+	cjmpne r35, r31, 0 // checksum_loop
+	
+	lc r0, EXPECTED
+	cjmpne r102, r32, r0 // failure
+	
+	sw r100, 1
+	jmp r101 // halt
+
+failure:
+	sw r100, 2
+
+halt:
+	hlt
+	jmp r101 // halt
+	
+// Fill r3 words (a multiple of 4) at r1 with r2
+memset_words:
+	lc r4, memset_words_loop
+	add r5, r1, 4
+	add r6, r1, 8
+	add r7, r1, 12
+memset_words_loop:
+	sw r1, r2
+	sw r5, r2
+	sw r6, r2
+	sw r7, r2
+	add r1, r1, 16
+	add r5, r5, 16
+	add r6, r6, 16
+	add r7, r7, 16
+	sub r3, r3, 4
+	cjmpne r4, r3, 0 // memset_words_loop
+	ret
+	
+// Copy r3 words (a multiple of 4) from r2 to r1
+memcpy_words:
+	lc r4, memcpy_words_loop
+memcpy_words_loop:
+	lw r5, r2
+	add r9, r2, 4
+	lw r6, r9
+	add r9, r2, 8
+	lw r7, r9
+	add r9, r2, 12
+	lw r8, r9
+	sw r1, r5
+	add r9, r1, 4
+	sw r9, r6
+	add r9, r1, 8
+	sw r9, r7
+	add r9, r1, 12
+	sw r9, r8
+	add r1, r1, 16
+	add r2, r2, 16
+	sub r3, r3, 4
+	cjmpne r4, r3, 0 // memcpy_words_loop
+	ret
+	
+// Copy r3 bytes (non-zero) from r2 to r1
+memcpy_bytes:
+	lc r4, memcpy_bytes_loop
+memcpy_bytes_loop:
+	lub r5, r2
+	sb r1, r5
+	add r1, r1, 1
+	add r2, r2, 1
+	sub r3, r3, 1
+	cjmpne r4, r3, 0 // memcpy_bytes_loop
+	ret
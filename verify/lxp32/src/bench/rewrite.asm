@@ -0,0 +1,440 @@
+/*
+ * Test: instructions rewritten by lxp32asm for the core profile (see
+ * the -mcore option). Division and multiplication by constants,
+ * including negative and power-of-two divisors, folded constant
+ * operands, a destination register which is also an operand and rp
+ * operands are checked against precomputed results. Without the
+ * divider, the remaining division instructions are replaced with
+ * calls to rt_emu_udiv and rt_emu_sdiv, which must preserve all
+ * registers but the destination one.
+ *
+ * The results don't depend on the profile. Assemble for each one and
+ * link with lxp32rt.la, e.g.:
+ *     lxp32asm -i <tools> -mcore nodiv,mul=seq rewrite.asm lxp32rt.la
+ *     lxp32sim -nd -m seq a.out
+ * On failure, the number of the failed check is returned.
+ */
+
+	lc r100, 0x10000000 // test result output pointer
+	lc r101, halt
+	lc r102, failure
+	lc sp, 0x00010000 // stack pointer
+	
+// Operands
+	lc r10, -1000
+	lc r11, 1000
+	lc r12, 0x80000000
+	mov r13, 7
+	mov r14, -7
+	lc r15, 0x12345678
+	
+// Registers which must be preserved
+	lc r0, 0xA0A0A0A0
+	lc r3, 0xA3A3A3A3
+	lc r4, 0xA4A4A4A4
+	lc r5, 0xA5A5A5A5
+	lc r6, 0xA6A6A6A6
+	lc r7, 0xA7A7A7A7
+	lc r8, 0xA8A8A8A8
+	lc r9, 0xA9A9A9A9
+	
+// Power-of-two divisors, unsigned
+	lc r103, 2
+	divu r1, r10, 1
+	lc r2, 0xFFFFFC18
+	cjmpne r102, r1, r2 // failure
+	lc r103, 3
+	divu r1, r10, 8
+	lc r2, 0x1FFFFF83
+	cjmpne r102, r1, r2 // failure
+	lc r103, 4
+	divu r1, r12, 64
+	lc r2, 0x02000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 5
+	modu r1, r10, 16
+	lc r2, 0x00000008
+	cjmpne r102, r1, r2 // failure
+	lc r103, 6
+	modu r1, r11, 1
+	lc r2, 0x00000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 7
+	modu r1, r12, 127
+	lc r2, 0x00000008
+	cjmpne r102, r1, r2 // failure
+	
+// Power-of-two divisors, signed, including negative ones
+	lc r103, 8
+	divs r1, r10, 1
+	lc r2, 0xFFFFFC18
+	cjmpne r102, r1, r2 // failure
+	lc r103, 9
+	divs r1, r10, -1
+	lc r2, 0x000003E8
+	cjmpne r102, r1, r2 // failure
+	lc r103, 10
+	divs r1, r11, -1
+	lc r2, 0xFFFFFC18
+	cjmpne r102, r1, r2 // failure
+	lc r103, 11
+	mods r1, r10, 1
+	lc r2, 0x00000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 12
+	mods r1, r10, -1
+	lc r2, 0x00000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 13
+	divs r1, r10, 2
+	lc r2, 0xFFFFFE0C
+	cjmpne r102, r1, r2 // failure
+	lc r103, 14
+	divs r1, r11, -2
+	lc r2, 0xFFFFFE0C
+	cjmpne r102, r1, r2 // failure
+	lc r103, 15
+	divs r1, r14, 2
+	lc r2, 0xFFFFFFFD
+	cjmpne r102, r1, r2 // failure
+	lc r103, 16
+	divs r1, r10, 4
+	lc r2, 0xFFFFFF06
+	cjmpne r102, r1, r2 // failure
+	lc r103, 17
+	divs r1, r10, -4
+	lc r2, 0x000000FA
+	cjmpne r102, r1, r2 // failure
+	lc r103, 18
+	divs r1, r14, -8
+	lc r2, 0x00000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 19
+	divs r1, r12, 64
+	lc r2, 0xFE000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 20
+	divs r1, r12, -128
+	lc r2, 0x01000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 21
+	divs r1, r11, -128
+	lc r2, 0xFFFFFFF9
+	cjmpne r102, r1, r2 // failure
+	lc r103, 22
+	mods r1, r10, 2
+	lc r2, 0x00000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 23
+	mods r1, r10, 8
+	lc r2, 0x00000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 24
+	mods r1, r10, -8
+	lc r2, 0x00000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 25
+	mods r1, r11, -16
+	lc r2, 0x00000008
+	cjmpne r102, r1, r2 // failure
+	lc r103, 26
+	mods r1, r14, 4
+	lc r2, 0xFFFFFFFD
+	cjmpne r102, r1, r2 // failure
+	lc r103, 27
+	mods r1, r12, -128
+	lc r2, 0x00000000
+	cjmpne r102, r1, r2 // failure
+	
+// Other constant divisors (the hardware divider or a call)
+	lc r103, 28
+	divu r1, r10, 10
+	lc r2, 0x19999935
+	cjmpne r102, r1, r2 // failure
+	lc r103, 29
+	divu r1, r11, -3
+	lc r2, 0x00000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 30
+	modu r1, r10, 100
+	lc r2, 0x00000060
+	cjmpne r102, r1, r2 // failure
+	lc r103, 31
+	divs r1, r10, 7
+	lc r2, 0xFFFFFF72
+	cjmpne r102, r1, r2 // failure
+	lc r103, 32
+	divs r1, r11, -7
+	lc r2, 0xFFFFFF72
+	cjmpne r102, r1, r2 // failure
+	lc r103, 33
+	mods r1, r10, 7
+	lc r2, 0xFFFFFFFA
+	cjmpne r102, r1, r2 // failure
+	lc r103, 34
+	mods r1, r14, -3
+	lc r2, 0xFFFFFFFF
+	cjmpne r102, r1, r2 // failure
+	
+// Register operands
+	lc r103, 35
+	divu r1, r10, r13
+	lc r2, 0x24924895
+	cjmpne r102, r1, r2 // failure
+	lc r103, 36
+	divu r1, r11, r14
+	lc r2, 0x00000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 37
+	modu r1, r10, r13
+	lc r2, 0x00000005
+	cjmpne r102, r1, r2 // failure
+	lc r103, 38
+	divs r1, r10, r13
+	lc r2, 0xFFFFFF72
+	cjmpne r102, r1, r2 // failure
+	lc r103, 39
+	divs r1, r10, r14
+	lc r2, 0x0000008E
+	cjmpne r102, r1, r2 // failure
+	lc r103, 40
+	divs r1, r12, r14
+	lc r2, 0x12492492
+	cjmpne r102, r1, r2 // failure
+	lc r103, 41
+	mods r1, r10, r13
+	lc r2, 0xFFFFFFFA
+	cjmpne r102, r1, r2 // failure
+	lc r103, 42
+	mods r1, r11, r14
+	lc r2, 0x00000006
+	cjmpne r102, r1, r2 // failure
+	lc r103, 43
+	mul r1, r10, r13
+	lc r2, 0xFFFFE4A8
+	cjmpne r102, r1, r2 // failure
+	lc r103, 44
+	mul r1, r15, r14
+	lc r2, 0x8091A2B8
+	cjmpne r102, r1, r2 // failure
+	
+// Constant operands are folded
+	lc r103, 45
+	divu r1, -1, 3
+	lc r2, 0x55555555
+	cjmpne r102, r1, r2 // failure
+	lc r103, 46
+	divs r1, -100, 7
+	lc r2, 0xFFFFFFF2
+	cjmpne r102, r1, r2 // failure
+	lc r103, 47
+	modu r1, -1, 10
+	lc r2, 0x00000005
+	cjmpne r102, r1, r2 // failure
+	lc r103, 48
+	mods r1, -100, 7
+	lc r2, 0xFFFFFFFE
+	cjmpne r102, r1, r2 // failure
+	lc r103, 49
+	mul r1, 127, -128
+	lc r2, 0xFFFFC080
+	cjmpne r102, r1, r2 // failure
+	lc r103, 50
+	mul r1, -1, -1
+	lc r2, 0x00000001
+	cjmpne r102, r1, r2 // failure
+	
+// Multiplication by constants (non-adjacent form)
+	lc r103, 51
+	mul r1, r10, 0
+	lc r2, 0x00000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 52
+	mul r1, r10, 1
+	lc r2, 0xFFFFFC18
+	cjmpne r102, r1, r2 // failure
+	lc r103, 53
+	mul r1, r10, -1
+	lc r2, 0x000003E8
+	cjmpne r102, r1, r2 // failure
+	lc r103, 54
+	mul r1, r10, 2
+	lc r2, 0xFFFFF830
+	cjmpne r102, r1, r2 // failure
+	lc r103, 55
+	mul r1, r11, 3
+	lc r2, 0x00000BB8
+	cjmpne r102, r1, r2 // failure
+	lc r103, 56
+	mul r1, r11, -3
+	lc r2, 0xFFFFF448
+	cjmpne r102, r1, r2 // failure
+	lc r103, 57
+	mul r1, r10, 7
+	lc r2, 0xFFFFE4A8
+	cjmpne r102, r1, r2 // failure
+	lc r103, 58
+	mul r1, r15, 10
+	lc r2, 0xB60B60B0
+	cjmpne r102, r1, r2 // failure
+	lc r103, 59
+	mul r1, r15, 85
+	lc r2, 0x0B60B5D8
+	cjmpne r102, r1, r2 // failure
+	lc r103, 60
+	mul r1, r15, -85
+	lc r2, 0xF49F4A28
+	cjmpne r102, r1, r2 // failure
+	lc r103, 61
+	mul r1, r10, 127
+	lc r2, 0xFFFE0FE8
+	cjmpne r102, r1, r2 // failure
+	lc r103, 62
+	mul r1, r15, -128
+	lc r2, 0xE5D4C400
+	cjmpne r102, r1, r2 // failure
+	lc r103, 63
+	mul r1, r12, -1
+	lc r2, 0x80000000
+	cjmpne r102, r1, r2 // failure
+	lc r103, 64
+	mul r1, 9, r15
+	lc r2, 0xA3D70A38
+	cjmpne r102, r1, r2 // failure
+	lc r103, 65
+	mul r1, -6, r10
+	lc r2, 0x00001770
+	cjmpne r102, r1, r2 // failure
+	
+// The destination register is also an operand
+	lc r103, 66
+	mov r16, r10
+	divu r16, r16, 8
+	lc r2, 0x1FFFFF83
+	cjmpne r102, r16, r2 // failure
+	lc r103, 67
+	mov r16, r10
+	divs r16, r16, 4
+	lc r2, 0xFFFFFF06
+	cjmpne r102, r16, r2 // failure
+	lc r103, 68
+	mov r16, r14
+	divs r16, r16, -2
+	lc r2, 0x00000003
+	cjmpne r102, r16, r2 // failure
+	lc r103, 69
+	mov r16, r10
+	mods r16, r16, 8
+	lc r2, 0x00000000
+	cjmpne r102, r16, r2 // failure
+	lc r103, 70
+	mov r16, r10
+	divs r16, r16, 7
+	lc r2, 0xFFFFFF72
+	cjmpne r102, r16, r2 // failure
+	lc r103, 71
+	mov r16, r11
+	modu r16, r16, r13
+	lc r2, 0x00000006
+	cjmpne r102, r16, r2 // failure
+	lc r103, 72
+	mov r16, r13
+	divs r16, r10, r16
+	lc r2, 0xFFFFFF72
+	cjmpne r102, r16, r2 // failure
+	lc r103, 73
+	mov r16, r10
+	mul r16, r16, 8
+	lc r2, 0xFFFFE0C0
+	cjmpne r102, r16, r2 // failure
+	lc r103, 74
+	mov r16, r10
+	mul r16, r16, -10
+	lc r2, 0x00002710
+	cjmpne r102, r16, r2 // failure
+	lc r103, 75
+	mov r16, r15
+	mul r16, r16, 85
+	lc r2, 0x0B60B5D8
+	cjmpne r102, r16, r2 // failure
+	lc r103, 76
+	mov r16, r11
+	mul r16, r16, r16
+	lc r2, 0x000F4240
+	cjmpne r102, r16, r2 // failure
+	
+// The return address register (rp) as an operand
+	lc r103, 77
+	mov rp, r10
+	divu rp, rp, 8
+	lc r2, 0x1FFFFF83
+	cjmpne r102, rp, r2 // failure
+	lc r103, 78
+	mov rp, r10
+	divs rp, rp, -4
+	lc r2, 0x000000FA
+	cjmpne r102, rp, r2 // failure
+	lc r103, 79
+	mov rp, r10
+	mods rp, rp, r13
+	lc r2, 0xFFFFFFFA
+	cjmpne r102, rp, r2 // failure
+	lc r103, 80
+	mov rp, r14
+	divs rp, r10, rp
+	lc r2, 0x0000008E
+	cjmpne r102, rp, r2 // failure
+	lc r103, 81
+	mov rp, r15
+	mul rp, rp, 10
+	lc r2, 0xB60B60B0
+	cjmpne r102, rp, r2 // failure
+	lc r103, 82
+	mov rp, r13
+	divs r1, r10, rp
+	lc r2, 0xFFFFFF72
+	cjmpne r102, r1, r2 // failure
+	lc r103, 83
+	mov rp, r11
+	modu r1, rp, 7
+	lc r2, 0x00000006
+	cjmpne r102, r1, r2 // failure
+	
+// Check the preserved registers
+	lc r103, 84
+	lc r2, 0xA0A0A0A0
+	cjmpne r102, r0, r2 // failure
+	lc r2, 0xA3A3A3A3
+	cjmpne r102, r3, r2 // failure
+	lc r2, 0xA4A4A4A4
+	cjmpne r102, r4, r2 // failure
+	lc r2, 0xA5A5A5A5
+	cjmpne r102, r5, r2 // failure
+	lc r2, 0xA6A6A6A6
+	cjmpne r102, r6, r2 // failure
+	lc r2, 0xA7A7A7A7
+	cjmpne r102, r7, r2 // failure
+	lc r2, 0xA8A8A8A8
+	cjmpne r102, r8, r2 // failure
+	lc r2, 0xA9A9A9A9
+	cjmpne r102, r9, r2 // failure
+	lc r2, -1000
+	cjmpne r102, r10, r2 // failure
+	lc r2, 1000
+	cjmpne r102, r11, r2 // failure
+	lc r2, 0x80000000
+	cjmpne r102, r12, r2 // failure
+	cjmpne r102, r13, 7 // failure
+	cjmpne r102, r14, -7 // failure
+	lc r2, 0x12345678
+	cjmpne r102, r15, r2 // failure
+	
+	sw r100, 1
+	jmp r101 // halt
+
+failure:
+	sw r100, r103
+
+halt:
+	hlt
+	jmp r101 // halt
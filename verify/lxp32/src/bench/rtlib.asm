@@ -0,0 +1,429 @@
+/*
+ * Benchmark: the runtime library (tools/src/lxp32rt). Every routine
+ * is called on a set of pseudo-random operands within its own region,
+ * so that the simulator reports the minimum, maximum and mean number
+ * of cycles per call, including the call and the return. The results
+ * are added to a checksum, which doesn't depend on the variants
+ * selected by the linker.
+ *
+ * Link with the archive built for the core configuration, e.g.:
+ *     lxp32asm -i <tools> -mcore nodiv,mul=seq -m rtlib.map rtlib.asm lxp32rt.la
+ *     lxp32sim -nd -m seq -map rtlib.map rtlib.bin
+ */
+
+#define PAIRS 256
+#define DIV_DATA 0x00004000
+#define MUL_DATA 0x00004800
+#define MUL64_DATA 0x00005000
+#define SRC 0x00006000
+#define DST 0x00007000
+#define DST_SIZE 1040
+#define EXPECTED 0x4E75E808
+
+#include "lxp32rt.inc"
+
+	lc r100, 0x10000000 // test result output pointer
+	lc r101, halt
+	lc r102, failure
+	lc sp, 0x00010000 // stack pointer
+	
+// Generate the operands: division, multiplication and 64-bit
+// multiplication pairs, then the source buffer
+	lc r30, DIV_DATA
+	lc r31, PAIRS
+	lc r32, 0x12345678 // xorshift state
+	lc r33, xorshift
+	lc r35, generate_div
+generate_div:
+	call r33
+	sw r30, r32
+	call r33
+	and r0, r32, 31
+	sru r0, r32, r0
+	or r0, r0, 1
+	add r1, r30, 4
+	sw r1, r0
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r35, r31, 0 // generate_div
+	
+	lc r31, PAIRS
+	lc r35, generate_mul
+generate_mul:
+	call r33
+	sw r30, r32
+	call r33
+	and r0, r32, 31
+	sru r0, r32, r0
+	add r1, r30, 4
+	sw r1, r0
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r35, r31, 0 // generate_mul
+	
+	lc r31, PAIRS
+	lc r35, generate_mul64
+generate_mul64:
+	call r33
+	and r0, r32, 16
+	sru r0, r32, r0
+	sw r30, r0
+	call r33
+	and r0, r32, 16
+	sru r0, r32, r0
+	add r1, r30, 4
+	sw r1, r0
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r35, r31, 0 // generate_mul64
+	
+	lc r30, SRC
+	lc r31, 256
+	lc r35, generate_src
+generate_src:
+	call r33
+	sw r30, r32
+	add r30, r30, 4
+	sub r31, r31, 1
+	cjmpne r35, r31, 0 // generate_src
+	
+	mov r32, 0 // checksum
+	lc r36, mix
+	
+// divu_restoring
+	lc r30, DIV_DATA
+	lc r31, PAIRS
+	lc r33, divu_restoring_loop
+	lc r37, rt_divu_restoring
+divu_restoring_loop:
+	lw r1, r30
+	add r0, r30, 4
+	lw r2, r0
+#perf_begin divu_restoring
+	call r37
+#perf_end divu_restoring
+	mov r38, r1
+	call r36 // mix
+	mov r0, r38
+	call r36 // mix
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r33, r31, 0 // divu_restoring_loop
+	
+// divu_nonrestoring
+	lc r30, DIV_DATA
+	lc r31, PAIRS
+	lc r33, divu_nonrestoring_loop
+	lc r37, rt_divu_nonrestoring
+divu_nonrestoring_loop:
+	lw r1, r30
+	add r0, r30, 4
+	lw r2, r0
+#perf_begin divu_nonrestoring
+	call r37
+#perf_end divu_nonrestoring
+	mov r38, r1
+	call r36 // mix
+	mov r0, r38
+	call r36 // mix
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r33, r31, 0 // divu_nonrestoring_loop
+	
+// divu
+	lc r30, DIV_DATA
+	lc r31, PAIRS
+	lc r33, divu_loop
+	lc r37, rt_divu
+divu_loop:
+	lw r1, r30
+	add r0, r30, 4
+	lw r2, r0
+#perf_begin divu
+	call r37
+#perf_end divu
+	mov r38, r1
+	call r36 // mix
+	mov r0, r38
+	call r36 // mix
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r33, r31, 0 // divu_loop
+	
+// divs
+	lc r30, DIV_DATA
+	lc r31, PAIRS
+	lc r33, divs_loop
+	lc r37, rt_divs
+divs_loop:
+	lw r1, r30
+	add r0, r30, 4
+	lw r2, r0
+#perf_begin divs
+	call r37
+#perf_end divs
+	mov r38, r1
+	call r36 // mix
+	mov r0, r38
+	call r36 // mix
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r33, r31, 0 // divs_loop
+	
+// divs_restoring
+	lc r30, DIV_DATA
+	lc r31, PAIRS
+	lc r33, divs_restoring_loop
+	lc r37, rt_divs_restoring
+divs_restoring_loop:
+	lw r1, r30
+	add r0, r30, 4
+	lw r2, r0
+#perf_begin divs_restoring
+	call r37
+#perf_end divs_restoring
+	mov r38, r1
+	call r36 // mix
+	mov r0, r38
+	call r36 // mix
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r33, r31, 0 // divs_restoring_loop
+	
+// mul
+	lc r30, MUL_DATA
+	lc r31, PAIRS
+	lc r33, mul_loop
+	lc r37, rt_mul
+mul_loop:
+	lw r1, r30
+	add r0, r30, 4
+	lw r2, r0
+#perf_begin mul
+	call r37
+#perf_end mul
+	call r36 // mix
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r33, r31, 0 // mul_loop
+	
+// mul_small
+	lc r30, MUL_DATA
+	lc r31, PAIRS
+	lc r33, mul_small_loop
+	lc r37, rt_mul
+mul_small_loop:
+	lw r1, r30
+	add r0, r30, 4
+	lw r2, r0
+	and r2, r2, 3
+#perf_begin mul_small
+	call r37
+#perf_end mul_small
+	call r36 // mix
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r33, r31, 0 // mul_small_loop
+	
+// mul_shiftadd
+	lc r30, MUL_DATA
+	lc r31, PAIRS
+	lc r33, mul_shiftadd_loop
+	lc r37, rt_mul_shiftadd
+mul_shiftadd_loop:
+	lw r1, r30
+	add r0, r30, 4
+	lw r2, r0
+#perf_begin mul_shiftadd
+	call r37
+#perf_end mul_shiftadd
+	call r36 // mix
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r33, r31, 0 // mul_shiftadd_loop
+	
+// mulu64
+	lc r30, MUL64_DATA
+	lc r31, PAIRS
+	lc r33, mulu64_loop
+	lc r37, rt_mulu64
+mulu64_loop:
+	lw r1, r30
+	add r0, r30, 4
+	lw r2, r0
+#perf_begin mulu64
+	call r37
+#perf_end mulu64
+	mov r38, r1
+	call r36 // mix
+	mov r0, r38
+	call r36 // mix
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r33, r31, 0 // mulu64_loop
+	
+// muls64
+	lc r30, MUL64_DATA
+	lc r31, PAIRS
+	lc r33, muls64_loop
+	lc r37, rt_muls64
+muls64_loop:
+	lw r1, r30
+	add r0, r30, 4
+	lw r2, r0
+#perf_begin muls64
+	call r37
+#perf_end muls64
+	mov r38, r1
+	call r36 // mix
+	mov r0, r38
+	call r36 // mix
+	add r30, r30, 8
+	sub r31, r31, 1
+	cjmpne r33, r31, 0 // muls64_loop
+	
+// mul64: pairs of 64-bit operands
+	lc r30, MUL64_DATA
+	lc r31, 128
+	lc r33, mul64_loop
+	lc r37, rt_mul64
+mul64_loop:
+	lw r1, r30
+	add r0, r30, 4
+	lw r2, r0
+	add r0, r30, 8
+	lw r3, r0
+	add r0, r30, 12
+	lw r4, r0
+#perf_begin mul64
+	call r37
+#perf_end mul64
+	mov r38, r1
+	call r36 // mix
+	mov r0, r38
+	call r36 // mix
+	add r30, r30, 16
+	sub r31, r31, 1
+	cjmpne r33, r31, 0 // mul64_loop
+	
+// Memory routines: every length with every destination and source
+// offset. The destination buffer is filled with a pattern, a block
+// is copied into it, then a block is filled; the whole buffer is
+// added to the checksum after each step.
+	lc r40, lengths
+	mov r41, 10
+	lc r42, length_loop
+	lc r46, offset_loop
+	lc r47, checksum_dst
+length_loop:
+	lw r43, r40
+	mov r44, 0 // destination offset
+	mov r45, 0 // source offset
+offset_loop:
+	lc r1, DST
+	mov r2, 0x5A
+	lc r3, DST_SIZE
+	lc r0, rt_memset
+	call r0
+	lc r1, DST
+	add r1, r1, r44
+	lc r2, SRC
+	add r2, r2, r45
+	mov r3, r43
+	lc r37, rt_memcpy
+#perf_begin memcpy
+	call r37
+#perf_end memcpy
+	call r47 // checksum_dst
+	lc r1, DST
+	add r1, r1, r45
+	mov r2, r43
+	mov r3, r43
+	lc r37, rt_memset
+#perf_begin memset
+	call r37
+#perf_end memset
+	call r47 // checksum_dst
+// For comparison: the same copy byte by byte
+	lc r1, DST
+	add r1, r1, r44
+	lc r2, SRC
+	add r2, r2, r45
+	mov r3, r43
+	lc r37, copy_bytes
+#perf_begin memcpy_bytes
+	call r37
+#perf_end memcpy_bytes
+	add r45, r45, 1
+	and r45, r45, 3
+	cjmpne r46, r45, 0 // offset_loop
+	add r44, r44, 1
+	cjmpne r46, r44, 4 // offset_loop
+	add r40, r40, 4
+	sub r41, r41, 1
+	cjmpne r42, r41, 0 // length_loop
+	
+	lc r0, EXPECTED
+	cjmpne r102, r32, r0 // failure
+	
+	sw r100, 1
+	jmp r101 // halt
+
+failure:
+	sw r100, 2
+
+halt:
+	hlt
+	jmp r101 // halt
+	
+// Next xorshift32 value in r32
+xorshift:
+	sl r0, r32, 13
+	xor r32, r32, r0
+	sru r0, r32, 17
+	xor r32, r32, r0
+	sl r0, r32, 5
+	xor r32, r32, r0
+	ret
+	
+// Add r0 to the checksum
+mix:
+	sl r2, r32, 5
+	sru r3, r32, 27
+	or r32, r2, r3
+	add r32, r32, r0
+	ret
+	
+// Add the destination buffer to the checksum
+checksum_dst:
+	lc r50, DST
+	lc r51, DST_SIZE
+	lc r52, checksum_dst_loop
+checksum_dst_loop:
+	lw r0, r50
+	sl r2, r32, 5
+	sru r3, r32, 27
+	or r32, r2, r3
+	add r32, r32, r0
+	add r50, r50, 4
+	sub r51, r51, 4
+	cjmpne r52, r51, 0 // checksum_dst_loop
+	ret
+	
+// Copy r3 bytes from r2 to r1
+copy_bytes:
+	lc r10, copy_bytes_loop
+	lc r11, copy_bytes_done
+	cjmpe r11, r3, 0 // copy_bytes_done
+copy_bytes_loop:
+	lub r0, r2
+	sb r1, r0
+	add r1, r1, 1
+	add r2, r2, 1
+	sub r3, r3, 1
+	cjmpne r10, r3, 0 // copy_bytes_loop
+copy_bytes_done:
+	ret
+
+lengths:
+	.word 0, 1, 3, 8, 13, 16, 31, 64, 255, 1000
@@ -0,0 +1,104 @@
+/*
+ * Benchmark: Shell sort of 2048 pseudo-random unsigned words
+ * (Ciura's gap sequence). The result is checked to be ordered
+ * and to contain the same words as the input.
+ */
+
+#define DATA 0x00008000
+#define WORDS 2048
+#define DATA_END 0x0000A000 // DATA+WORDS*4
+
+	lc r100, 0x10000000 // test result output pointer
+	lc r101, halt
+	lc r102, failure
+	lc sp, 0x00010000 // stack pointer
+	
+// Generate the data, remember their sum and XOR
+	lc r30, DATA
+	lc r31, WORDS
+	lc r32, 0x12345678 // xorshift state
+	mov r33, 0 // sum
+	mov r34, 0 // XOR
+	lc r35, generate_loop
+generate_loop:
+	sl r0, r32, 13
+	xor r32, r32, r0
+	sru r0, r32, 17
+	xor r32, r32, r0
+	sl r0, r32, 5
+	xor r32, r32, r0
+	sw r30, r32
+	add r33, r33, r32
+	xor r34, r34, r32
+	add r30, r30, 4
+	sub r31, r31, 1
+	cjmpne r35, r31, 0 // generate_loop
+
+#perf_begin kernel
+	lc r1, DATA
+	lc r2, DATA_END
+	lc r0, shell_sort
+	call r0
+#perf_end kernel
+
+// Check the order, the sum and the XOR
+	lc r30, DATA
+	lc r31, WORDS
+	mov r36, 0 // previous word
+	lc r35, check_loop
+check_loop:
+	lw r0, r30
+	cjmpul r102, r0, r36 // failure
+	mov r36, r0
+	sub r33, r33, r0
+	xor r34, r34, r0
+	add r30, r30, 4
+	sub r31, r31, 1
+	cjmpne r35, r31, 0 // check_loop
+	
+	cjmpne r102, r33, 0 // failure
+	cjmpne r102, r34, 0 // failure
+	
+	sw r100, 1
+	jmp r101 // halt
+
+failure:
+	sw r100, 2
+
+halt:
+	hlt
+	jmp r101 // halt
+	
+// Sort the words from r1 up to (not including) r2 in ascending order
+shell_sort:
+	lc r3, gaps
+	lc r10, shell_sort_gap
+	lc r11, shell_sort_element
+	lc r12, shell_sort_shift
+	lc r13, shell_sort_insert
+shell_sort_gap:
+	lw r4, r3 // gap in bytes
+	cjmpe rp, r4, 0 // done
+	add r3, r3, 4
+	add r5, r1, r4 // the first element to insert
+	cjmpuge r10, r5, r2 // shell_sort_gap: the gap is too large
+shell_sort_element:
+	lw r6, r5 // element being inserted
+	mov r7, r5 // insertion position
+shell_sort_shift:
+	sub r8, r7, r4
+	cjmpul r13, r8, r1 // shell_sort_insert
+	lw r9, r8
+	cjmpule r13, r9, r6 // shell_sort_insert
+	sw r7, r9
+	mov r7, r8
+	jmp r12 // shell_sort_shift
+shell_sort_insert:
+	sw r7, r6
+	add r5, r5, 4
+	cjmpul r11, r5, r2 // shell_sort_element
+	jmp r10 // shell_sort_gap
+	
+// Ciura's gap sequence in bytes, terminated by zero
+gaps:
+	.word 2804, 1204, 528, 228, 92, 40, 16, 4, 0
@@ -0,0 +1,43 @@
+/*
+ * This test verifies that an edge-triggered interrupt wakes up
+ * the CPU from the halted state while the request line is held
+ */
+
+	lc r100, 0x10000000 // test result output pointer
+	lc r101, halt
+	lc r102, failure
+	lc r103, 0x40000000 // timer: number of pulses (0xFFFFFFFF - infinite)
+	lc r104, 0x40000004 // timer: delay between pulses (in cycles)
+	lc r105, 0x40000008 // timer: trigger mode
+	
+// The timer holds its interrupt request until it is cleared,
+// the CPU reacts to the rising edge
+	mov cr, 0
+	lc iv3, timer_handler
+	sw r105, 1
+	lc cr, 0x00000008 // enable interrupt
+	
+	mov r34, 0 // interrupt call counter
+	
+	sw r104, 100
+	sw r103, 1
+	
+	hlt
+	
+	cjmpne r102, r34, 1 // failure
+	
+	sw r100, 1
+	jmp r101 // halt
+	
+failure:
+	sw r100, 2
+	
+halt:
+	hlt
+	jmp r101 // halt
+	
+timer_handler:
+	add r34, r34, 1
+	lc r0, 0x10000004
+	sw r0, r34
+	iret
@@ -7,16 +7,28 @@
 --
 -- Monitors LXP32 data bus transactions, optionally throttles them.
 --
+-- If LOG_FILE is not empty, each completed transaction is written
+-- to this file (or named pipe) as a text line:
+--     R|W <address> <byte select> <data>
+-- (hexadecimal values, the address is a byte address). A "reset"
+-- line is written when the reset is asserted. The log can be
+-- checked against the lxp32sim simulator (-lockstep option).
+--
 -- Note: regardless of whether this description is synthesizable,
 -- it was designed exclusively for simulation purposes.
 ---------------------------------------------------------------------
 
+use std.textio.all;
+
 library ieee;
 use ieee.std_logic_1164.all;
 
+use work.common_pkg.all;
+
 entity dbus_monitor is
 	generic(
-		THROTTLE: boolean
+		THROTTLE: boolean;
+		LOG_FILE: string:=""
 	);
 	port(
 		clk_i: in std_logic;
@@ -91,6 +103,38 @@ wbm_sel_o<=wbs_sel_i;
 wbm_adr_o<=wbs_adr_i;
 wbm_dat_o<=wbs_dat_i;
 
+-- Log transactions
+
+gen_log: if LOG_FILE'length>0 generate
+	process (clk_i) is
+		file f: text open write_mode is LOG_FILE;
+		variable l: line;
+		variable in_reset: boolean:=false;
+	begin
+		if rising_edge(clk_i) then
+			if rst_i='1' then
+				if not in_reset then
+					write(l,string'("reset"));
+					writeline(f,l);
+				end if;
+				in_reset:=true;
+			else
+				in_reset:=false;
+				if wbs_cyc_i='1' and wbs_stb_i='1' and wbm_ack_i='1' then
+					if wbs_we_i='1' then
+						write(l,"W "&hex_string(wbs_adr_i&"00")&" "&
+							hex_string(wbs_sel_i)&" "&hex_string(wbs_dat_i));
+					else
+						write(l,"R "&hex_string(wbs_adr_i&"00")&" "&
+							hex_string(wbs_sel_i)&" "&hex_string(wbm_dat_i));
+					end if;
+					writeline(f,l);
+				end if;
+			end if;
+		end if;
+	end process;
+end generate;
+
 -- Check handshake correctness
 
 process (clk_i) is
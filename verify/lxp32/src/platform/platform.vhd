@@ -21,7 +21,8 @@ entity platform is
 		CPU_MUL_ARCH: string;
 		MODEL_LXP32C: boolean;
 		THROTTLE_DBUS: boolean;
-		THROTTLE_IBUS: boolean
+		THROTTLE_IBUS: boolean;
+		DBUS_LOG: string:=""
 	);
 	port(
 		clk_i: in std_logic;
@@ -277,7 +278,8 @@ end generate;
 
 dbus_monitor_inst: entity work.dbus_monitor(rtl)
 	generic map(
-		THROTTLE=>THROTTLE_DBUS
+		THROTTLE=>THROTTLE_DBUS,
+		LOG_FILE=>DBUS_LOG
 	)
 	port map(
 		clk_i=>clk_i,
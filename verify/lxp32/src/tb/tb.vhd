@@ -10,6 +10,8 @@
 -- Parameters:
 --     CPU_DBUS_RMW:    DBUS_RMW CPU generic
 --     CPU_MUL_ARCH:    MUL_ARCH CPU generic
+--     DBUS_LOG:        If non-empty, CPU data bus transactions are
+--                      logged to this file (see dbus_monitor.vhd)
 --     MODEL_LXP32C:    when true, simulates LXP32C variant (with
 --                      instruction cache), otherwise LXP32U
 --     TEST_CASE:       If non-empty, selects a test case to run.
@@ -33,6 +35,7 @@ entity tb is
 	generic(
 		CPU_DBUS_RMW: boolean:=false;
 		CPU_MUL_ARCH: string:="dsp";
+		DBUS_LOG: string:="";
 		MODEL_LXP32C: boolean:=true;
 		TEST_CASE: string:="";
 		THROTTLE_DBUS: boolean:=true;
@@ -63,7 +66,8 @@ dut: entity work.platform(rtl)
 		CPU_MUL_ARCH=>CPU_MUL_ARCH,
 		MODEL_LXP32C=>MODEL_LXP32C,
 		THROTTLE_DBUS=>THROTTLE_DBUS,
-		THROTTLE_IBUS=>THROTTLE_IBUS
+		THROTTLE_IBUS=>THROTTLE_IBUS,
+		DBUS_LOG=>DBUS_LOG
 	)
 	port map(
 		clk_i=>clk,
@@ -136,6 +140,7 @@ begin
 		run_test("test019.ram",clk,globals,soc_wbs_in,soc_wbs_out,monitor_out);
 		run_test("test020.ram",clk,globals,soc_wbs_in,soc_wbs_out,monitor_out);
 		run_test("test021.ram",clk,globals,soc_wbs_in,soc_wbs_out,monitor_out);
+		run_test("test022.ram",clk,globals,soc_wbs_in,soc_wbs_out,monitor_out);
 	else
 		run_test(TEST_CASE,clk,globals,soc_wbs_in,soc_wbs_out,monitor_out);
 	end if;